@@ -13,6 +13,7 @@ static HINSTANCE hInst;
 static Utf8Ini settings;
 static wchar_t szIniFile[MAX_PATH] = L"";
 static CRITICAL_SECTION csIni;
+static volatile LONG settingsGeneration = 0; //changed by every write to the settings
 static CRITICAL_SECTION csTranslate;
 static bool bDisableGUIUpdate;
 
@@ -171,6 +172,8 @@ BRIDGE_IMPEXP bool BridgeSettingSet(const char* section, const char* key, const
             success = settings.SetValue(section, key, "");
         else
             success = settings.SetValue(section, key, value);
+        if(success)
+            InterlockedIncrement(&settingsGeneration);
         LeaveCriticalSection(&csIni);
     }
     return success;
@@ -241,11 +244,17 @@ BRIDGE_IMPEXP bool BridgeSettingRead(int* errorLine)
         success = settings.Deserialize(iniData, errline);
         if(errorLine)
             *errorLine = errline;
+        InterlockedIncrement(&settingsGeneration);
         LeaveCriticalSection(&csIni);
     }
     return success;
 }
 
+BRIDGE_IMPEXP duint BridgeSettingGetGeneration()
+{
+    return (duint)settingsGeneration;
+}
+
 BRIDGE_IMPEXP int BridgeGetDbgVersion()
 {
     return DBG_VERSION;
@@ -53,6 +53,7 @@ BRIDGE_IMPEXP bool BridgeSettingSet(const char* section, const char* key, const
 BRIDGE_IMPEXP bool BridgeSettingSetUint(const char* section, const char* key, duint value);
 BRIDGE_IMPEXP bool BridgeSettingFlush();
 BRIDGE_IMPEXP bool BridgeSettingRead(int* errorLine);
+BRIDGE_IMPEXP duint BridgeSettingGetGeneration();
 BRIDGE_IMPEXP int BridgeGetDbgVersion();
 
 #ifdef __cplusplus
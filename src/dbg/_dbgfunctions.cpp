@@ -26,6 +26,8 @@
 #include "tcpconnections.h"
 #include "watch.h"
 #include "animate.h"
+#include "label.h"
+#include "bookmark.h"
 
 static DBGFUNCTIONS _dbgfunctions;
 
@@ -295,6 +297,20 @@ static bool _enumtcpconnections(ListOf(TCPCONNECTIONINFO) connections)
     return BridgeList<TCPCONNECTIONINFO>::CopyData(connections, connectionsV);
 }
 
+static bool _bpgetchanges(duint* sequence, ListOf(BPCHANGE) changes)
+{
+    std::vector<BPCHANGE> changesV;
+    bool result = BpGetChanges(sequence, changesV);
+    BridgeList<BPCHANGE>::CopyData(changes, changesV);
+    return result;
+}
+
+// Everything the label of an address depends on, the generations only increase so the sum changes with any of them
+static duint _symbolstategetgeneration()
+{
+    return MemGetMapGeneration() + LabelGetGeneration() + SafeSymGetGeneration();
+}
+
 void dbgfunctionsinit()
 {
     _dbgfunctions.AssembleAtEx = _assembleatex;
@@ -352,4 +368,11 @@ void dbgfunctionsinit()
     _dbgfunctions.AnimateCommand = _dbg_animatecommand;
     _dbgfunctions.DbgSetDebuggeeInitScript = dbgsetdebuggeeinitscript;
     _dbgfunctions.DbgGetDebuggeeInitScript = dbggetdebuggeeinitscript;
+    _dbgfunctions.MemGetMapGeneration = MemGetMapGeneration;
+    _dbgfunctions.BpGetGeneration = BpGetGeneration;
+    _dbgfunctions.LabelGetGeneration = LabelGetGeneration;
+    _dbgfunctions.BookmarkGetGeneration = BookmarkGetGeneration;
+    _dbgfunctions.SymGetGeneration = SafeSymGetGeneration;
+    _dbgfunctions.BpGetChanges = _bpgetchanges;
+    _dbgfunctions.SymbolStateGetGeneration = _symbolstategetgeneration;
 }
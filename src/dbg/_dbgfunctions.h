@@ -84,6 +84,19 @@ typedef struct
 // The longest ip address is 1234:6789:1234:6789:1234:6789:123.567.901.345 (46 bytes)
 #define TCP_ADDR_SIZE 50
 
+typedef enum
+{
+    BpChangeAdded,
+    BpChangeModified,
+    BpChangeRemoved
+} BPCHANGEKIND;
+
+typedef struct
+{
+    BPCHANGEKIND kind;
+    BRIDGEBP bp; //only the type, address and module are set when the breakpoint was removed
+} BPCHANGE;
+
 typedef struct
 {
     char RemoteAddress[TCP_ADDR_SIZE];
@@ -146,6 +159,13 @@ typedef int (*MODGETPARTY)(duint base);
 typedef void (*MODSETPARTY)(duint base, int party);
 typedef bool(*WATCHISWATCHDOGTRIGGERED)(unsigned int id);
 typedef bool(*MEMISCODEPAGE)(duint addr, bool refresh);
+typedef duint(*MEMGETMAPGENERATION)();
+typedef duint(*BPGETGENERATION)();
+typedef duint(*LABELGETGENERATION)();
+typedef duint(*BOOKMARKGETGENERATION)();
+typedef duint(*SYMGETGENERATION)();
+typedef bool(*BPGETCHANGES)(duint* sequence, ListOf(BPCHANGE) changes);
+typedef duint(*SYMBOLSTATEGETGENERATION)();
 typedef bool(*ANIMATECOMMAND)(const char* command);
 typedef void(*DBGSETDEBUGGEEINITSCRIPT)(const char* fileName);
 typedef const char* (*DBGGETDEBUGGEEINITSCRIPT)();
@@ -207,6 +227,13 @@ typedef struct DBGFUNCTIONS_
     ANIMATECOMMAND AnimateCommand;
     DBGSETDEBUGGEEINITSCRIPT DbgSetDebuggeeInitScript;
     DBGGETDEBUGGEEINITSCRIPT DbgGetDebuggeeInitScript;
+    MEMGETMAPGENERATION MemGetMapGeneration;
+    BPGETGENERATION BpGetGeneration;
+    LABELGETGENERATION LabelGetGeneration;
+    BOOKMARKGETGENERATION BookmarkGetGeneration;
+    SYMGETGENERATION SymGetGeneration;
+    BPGETCHANGES BpGetChanges;
+    SYMBOLSTATEGETGENERATION SymbolStateGetGeneration; //modules, labels and loaded symbols
 } DBGFUNCTIONS;
 
 #ifdef BUILD_DBG
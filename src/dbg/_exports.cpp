@@ -34,6 +34,7 @@
 #include "argument.h"
 #include "watch.h"
 #include "animate.h"
+#include "guiupdate.h"
 
 static bool bOnlyCipAutoComments = false;
 static duint cacheCflags = 0;
@@ -855,6 +856,7 @@ extern "C" DLL_EXPORT duint _dbg_sendmessage(DBGMSG type, void* param1, void* pa
         bSkipInt3Stepping = settingboolget("Engine", "SkipInt3Stepping");
         bIgnoreInconsistentBreakpoints = settingboolget("Engine", "IgnoreInconsistentBreakpoints");
         bNoForegroundWindow = settingboolget("Gui", "NoForegroundWindow");
+        dbgupdateeventsettings();
 
         duint setting;
         if(BridgeSettingGetUint("Engine", "BreakpointType", &setting))
@@ -909,6 +911,12 @@ extern "C" DLL_EXPORT duint _dbg_sendmessage(DBGMSG type, void* param1, void* pa
             _dbg_setanimateinterval((unsigned int)animateInterval);
         else
             _dbg_setanimateinterval(50); // 20 commands per second
+
+        duint updateFrameRate;
+        if(BridgeSettingGetUint("Gui", "UpdateFrameRate", &updateFrameRate))
+            GuiUpdateSetFrameRate((unsigned int)updateFrameRate);
+        else
+            GuiUpdateSetFrameRate(0); // 60 frames per second
     }
     break;
 
@@ -1,7 +1,9 @@
 #include <assert.h>
 #include <thread>
 #include "AnalysisPass.h"
+#include "workpool.h"
 #include "memory.h"
+#include <capstone_wrapper.h>
 
 AnalysisPass::AnalysisPass(duint VirtualStart, duint VirtualEnd, BBlockArray & MainBlocks) : m_MainBlocks(MainBlocks)
 {
@@ -12,9 +14,9 @@ AnalysisPass::AnalysisPass(duint VirtualStart, duint VirtualEnd, BBlockArray & M
     m_VirtualEnd = VirtualEnd;
     m_InternalMaxThreads = 0;
 
-    // Read remote instruction data to local memory
+    // Read remote instruction data to local memory (zero padded for the decoder)
     m_DataSize = VirtualEnd - VirtualStart;
-    m_Data = (unsigned char*)VirtualAlloc(nullptr, m_DataSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    m_Data = (unsigned char*)VirtualAlloc(nullptr, m_DataSize + MAX_DISASM_BUFFER, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 
     if(!MemRead(VirtualStart, m_Data, m_DataSize))
     {
@@ -92,4 +94,16 @@ duint AnalysisPass::IdealThreadCount()
 void AnalysisPass::SetIdealThreadCount(duint Count)
 {
     m_InternalMaxThreads = (BYTE)min(Count, 255);
+}
+
+duint AnalysisPass::ChunkSize(duint Total, duint Minimum)
+{
+    // When the pass was limited to fewer threads than the pool has, split it in at most
+    // that many chunks, so no more threads than that can work on it at the same time
+    auto & pool = WorkPool::Global();
+    duint threads = IdealThreadCount();
+    if(threads < pool.Threads())
+        return max(max((Total + threads - 1) / threads, Minimum), 1);
+
+    return pool.Grain(Total, Minimum);
 }
\ No newline at end of file
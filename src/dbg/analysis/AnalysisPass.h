@@ -35,6 +35,7 @@ protected:
     duint FindBBlockIndex(BasicBlock* Block);
     duint IdealThreadCount();
     void SetIdealThreadCount(duint Count);
+    duint ChunkSize(duint Total, duint Minimum);
 
 private:
     BYTE m_InternalMaxThreads;
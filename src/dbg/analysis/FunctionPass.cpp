@@ -1,5 +1,5 @@
 #include "FunctionPass.h"
-#include <ppl.h>
+#include "workpool.h"
 #include "memory.h"
 #include "console.h"
 #include "debugger.h"
@@ -69,30 +69,23 @@ const char* FunctionPass::GetName()
 
 bool FunctionPass::Analyse()
 {
-    // THREAD_WORK = ceil(TOTAL / # THREADS)
-    duint workAmount = (m_MainBlocks.size() + (IdealThreadCount() - 1)) / IdealThreadCount();
+    // Divide the blocks up in chunks, idle threads steal the chunks of busy threads
+    duint workAmount = ChunkSize(m_MainBlocks.size(), 256);
 
-    // Initialize thread vector
-    auto threadFunctions = new std::vector<FunctionDef>[IdealThreadCount()];
+    // Initialize chunk vector
+    std::vector<std::vector<FunctionDef>> threadFunctions(WorkPool::ChunkCount(m_MainBlocks.size(), workAmount));
 
-    concurrency::parallel_for(duint(0), IdealThreadCount(), [&](duint i)
+    WorkPool::Global().ParallelFor(m_MainBlocks.size(), workAmount, [&](duint i, duint start, duint end)
     {
-        // Memory allocation optimization
-        // TODO: Option to conserve memory
-        threadFunctions[i].reserve(30000);
-
         // Execute
-        duint threadWorkStart = (workAmount * i);
-        duint threadWorkStop = min((threadWorkStart + workAmount), m_MainBlocks.size());
-
-        AnalysisWorker(threadWorkStart, threadWorkStop, &threadFunctions[i]);
+        AnalysisWorker(start, end, &threadFunctions[i]);
     });
 
-    // Merge thread vectors into single local
+    // Merge chunk vectors into single local
     std::vector<FunctionDef> funcs;
 
-    for(duint i = 0; i < IdealThreadCount(); i++)
-        std::move(threadFunctions[i].begin(), threadFunctions[i].end(), std::back_inserter(funcs));
+    for(auto & functions : threadFunctions)
+        std::move(functions.begin(), functions.end(), std::back_inserter(funcs));
 
     // Sort and remove duplicates
     std::sort(funcs.begin(), funcs.end());
@@ -107,7 +100,6 @@ bool FunctionPass::Analyse()
     }
     GuiUpdateAllViews();
 
-    delete[] threadFunctions;
     return true;
 }
 
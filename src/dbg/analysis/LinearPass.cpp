@@ -1,8 +1,7 @@
 #include <thread>
-#include <ppl.h>
 #include "AnalysisPass.h"
 #include "LinearPass.h"
-#include <capstone_wrapper.h>
+#include "workpool.h"
 
 LinearPass::LinearPass(duint VirtualStart, duint VirtualEnd, BBlockArray & MainBlocks)
     : AnalysisPass(VirtualStart, VirtualEnd, MainBlocks)
@@ -26,17 +25,19 @@ const char* LinearPass::GetName()
 
 bool LinearPass::Analyse()
 {
-    // Divide the work up between each thread
-    // THREAD_WORK = (TOTAL / # THREADS)
-    duint workAmount = m_DataSize / IdealThreadCount();
+    // Decode the range once, the analyses that run on the same data share it
+    m_Instructions = InstructionCache::Acquire(m_VirtualStart, m_DataSize, m_Data);
 
-    // Initialize thread vector
-    auto threadBlocks = new std::vector<BasicBlock>[IdealThreadCount()];
+    // Divide the work up in chunks, idle threads steal the chunks of busy threads
+    duint workAmount = ChunkSize(m_DataSize, 0x4000);
 
-    concurrency::parallel_for(duint(0), IdealThreadCount(), [&](duint i)
+    // Initialize chunk vector
+    std::vector<BBlockArray> threadBlocks(WorkPool::ChunkCount(m_DataSize, workAmount));
+
+    WorkPool::Global().ParallelFor(m_DataSize, workAmount, [&](duint i, duint start, duint end)
     {
-        duint threadWorkStart = m_VirtualStart + (workAmount * i);
-        duint threadWorkStop = min((threadWorkStart + workAmount), m_VirtualEnd);
+        duint threadWorkStart = m_VirtualStart + start;
+        duint threadWorkStop = m_VirtualStart + end;
 
         // Allow a 256-byte variance of scanning because of
         // integer rounding errors and instruction overlap
@@ -48,7 +49,7 @@ bool LinearPass::Analyse()
 
         // Memory allocation optimization
         // TODO: Option to conserve memory
-        threadBlocks[i].reserve(100000);
+        threadBlocks[i].reserve((threadWorkStop - threadWorkStart) / 16);
 
         // Execute
         AnalysisWorker(threadWorkStart, threadWorkStop, &threadBlocks[i]);
@@ -57,23 +58,21 @@ bool LinearPass::Analyse()
     // Clear old data and combine vectors
     m_MainBlocks.clear();
 
-    for(duint i = 0; i < IdealThreadCount(); i++)
+    for(auto & blocks : threadBlocks)
     {
-        std::move(threadBlocks[i].begin(), threadBlocks[i].end(), std::back_inserter(m_MainBlocks));
+        std::move(blocks.begin(), blocks.end(), std::back_inserter(m_MainBlocks));
 
         // Free old elements to conserve memory further
-        BBlockArray().swap(threadBlocks[i]);
+        BBlockArray().swap(blocks);
     }
 
-    // Free memory ASAP
-    delete[] threadBlocks;
-
     // Sort and remove duplicates
     std::sort(m_MainBlocks.begin(), m_MainBlocks.end());
     m_MainBlocks.erase(std::unique(m_MainBlocks.begin(), m_MainBlocks.end()), m_MainBlocks.end());
 
     // Run overlap analysis sub-pass
     AnalyseOverlaps();
+    m_Instructions.reset();
     return true;
 }
 
@@ -88,17 +87,16 @@ void LinearPass::AnalyseOverlaps()
     // This also checks for basic block targets jumping into
     // the middle of other basic blocks.
     //
-    // THREAD_WORK = ceil(TOTAL / # THREADS)
     duint workTotal = m_MainBlocks.size();
-    duint workAmount = (workTotal + (IdealThreadCount() - 1)) / IdealThreadCount();
+    duint workAmount = ChunkSize(workTotal, 256);
 
-    // Initialize thread vectors
-    auto threadInserts = new std::vector<BasicBlock>[IdealThreadCount()];
+    // Initialize chunk vectors
+    std::vector<BBlockArray> threadInserts(WorkPool::ChunkCount(workTotal, workAmount));
 
-    concurrency::parallel_for(duint(0), IdealThreadCount(), [&](duint i)
+    WorkPool::Global().ParallelFor(workTotal, workAmount, [&](duint i, duint start, duint end)
     {
-        duint threadWorkStart = (workAmount * i);
-        duint threadWorkStop = min((threadWorkStart + workAmount), workTotal);
+        duint threadWorkStart = start;
+        duint threadWorkStop = end;
 
         // Again, allow an overlap of +/- 1 entry
         if(threadWorkStart > 0)
@@ -114,14 +112,12 @@ void LinearPass::AnalyseOverlaps()
     // THREAD VECTOR
     std::vector<BasicBlock> overlapInserts;
     {
-        for(duint i = 0; i < IdealThreadCount(); i++)
-            std::move(threadInserts[i].begin(), threadInserts[i].end(), std::back_inserter(overlapInserts));
+        for(auto & inserts : threadInserts)
+            std::move(inserts.begin(), inserts.end(), std::back_inserter(overlapInserts));
 
         // Sort and remove duplicates
         std::sort(overlapInserts.begin(), overlapInserts.end());
         overlapInserts.erase(std::unique(overlapInserts.begin(), overlapInserts.end()), overlapInserts.end());
-
-        delete[] threadInserts;
     }
 
     // GLOBAL VECTOR
@@ -142,9 +138,10 @@ void LinearPass::AnalyseOverlaps()
 
 void LinearPass::AnalysisWorker(duint Start, duint End, BBlockArray* Blocks)
 {
-    Capstone disasm;
+    const auto & instructions = *m_Instructions;
+    auto index = instructions.LowerBound(Start);
 
-    duint blockBegin = Start;        // BBlock starting virtual address
+    duint blockBegin = index < instructions.Count() ? instructions[index].address : Start; // BBlock starting virtual address
     duint blockEnd = 0;              // BBlock ending virtual address
 
     bool blockPrevPad = false;       // Indicator if the last instruction was padding
@@ -152,31 +149,29 @@ void LinearPass::AnalysisWorker(duint Start, duint End, BBlockArray* Blocks)
 
     int insnCount = 0;               // Temporary number of instructions counted for a block
 
-    for(duint i = Start; i < End;)
+    // Bytes that can't be determined are not in the linear sweep and are skipped
+    for(; index < instructions.Count(); index++)
     {
-        if(!disasm.Disassemble(i, TranslateAddress(i), int(End - i)))
-        {
-            // Skip instructions that can't be determined
-            i++;
-            continue;
-        }
+        const auto & instruction = instructions[index];
+        if(instruction.address + instruction.size > End)
+            break;
 
         // Increment counters
-        i += disasm.Size();
+        duint i = instruction.address + instruction.size;
         blockEnd = i;
         insnCount++;
 
         // The basic block ends here if it is a branch
-        bool call = disasm.InGroup(CS_GRP_CALL);    // CALL
-        bool jmp = disasm.InGroup(CS_GRP_JUMP);     // JUMP
-        bool ret = disasm.InGroup(CS_GRP_RET);      // RETURN
-        bool padding = disasm.IsFilling();          // INSTRUCTION PADDING
+        bool call = instruction.Is(InstructionCache::FlagCall);         // CALL
+        bool jmp = instruction.Is(InstructionCache::FlagJump);          // JUMP
+        bool ret = instruction.Is(InstructionCache::FlagRet);           // RETURN
+        bool padding = instruction.Is(InstructionCache::FlagFilling);   // INSTRUCTION PADDING
 
         if(padding)
         {
             // PADDING is treated differently. They are all created as their
             // own separate block for more analysis later.
-            duint realBlockEnd = blockEnd - disasm.Size();
+            duint realBlockEnd = blockEnd - instruction.size;
 
             if((realBlockEnd - blockBegin) > 0)
             {
@@ -211,32 +206,19 @@ void LinearPass::AnalysisWorker(duint Start, duint End, BBlockArray* Blocks)
                 if(!padding)
                 {
                     // Check if absolute jump, regardless of operand
-                    if(disasm.GetId() == X86_INS_JMP)
+                    if(instruction.Is(InstructionCache::FlagJmp))
                         block->SetFlag(BASIC_BLOCK_FLAG_ABSJMP);
 
                     // Figure out the operand type(s)
-                    const auto & operand = disasm.x86().operands[0];
-
-                    if(operand.type == X86_OP_IMM)
+                    if(instruction.Is(InstructionCache::FlagOp0Imm))
                     {
                         // Branch target immediate
-                        block->Target = (duint)operand.imm;
+                        block->Target = instruction.destination;
                     }
                     else
                     {
                         // Indirects (no operand, register, or memory)
                         block->SetFlag(BASIC_BLOCK_FLAG_INDIRECT);
-
-                        if(operand.type == X86_OP_MEM &&
-                                operand.mem.base == X86_REG_RIP &&
-                                operand.mem.index == X86_REG_INVALID &&
-                                operand.mem.scale == 1)
-                        {
-                            /*
-                            block->SetFlag(BASIC_BLOCK_FLAG_INDIRPTR);
-                            block->Target = (duint)operand.mem.disp;
-                            */
-                        }
                     }
                 }
             }
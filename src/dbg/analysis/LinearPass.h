@@ -2,6 +2,7 @@
 
 #include "AnalysisPass.h"
 #include "BasicBlock.h"
+#include "instructioncache.h"
 
 class LinearPass : public AnalysisPass
 {
@@ -17,4 +18,6 @@ private:
     void AnalysisWorker(duint Start, duint End, BBlockArray* Blocks);
     void AnalysisOverlapWorker(duint Start, duint End, BBlockArray* Insertions);
     BasicBlock* CreateBlockWorker(BBlockArray* Blocks, duint Start, duint End, bool Call, bool Jmp, bool Ret, bool Pad);
+
+    std::shared_ptr<const InstructionCache> m_Instructions;
 };
\ No newline at end of file
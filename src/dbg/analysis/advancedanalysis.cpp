@@ -69,6 +69,7 @@ void AdvancedAnalysis::SetMarkers()
             FunctionAdd(start, end, false, icount);
         }
     }
+    publishInstructions();
     GuiUpdateAllViews();
 }
 
@@ -78,6 +79,7 @@ void AdvancedAnalysis::analyzeFunction(duint entryPoint, bool writedata)
     CFGraph graph(entryPoint);
     UintSet visited;
     std::queue<duint> queue;
+    InstructionCache::Instruction instruction;
     mEntryPoints.insert(entryPoint);
     queue.push(graph.entryPoint);
     while(!queue.empty())
@@ -92,7 +94,7 @@ void AdvancedAnalysis::analyzeFunction(duint entryPoint, bool writedata)
         while(true)
         {
             node.icount++;
-            if(!mCp.Disassemble(node.end, translateAddr(node.end)))
+            if(!decode(node.end, instruction))
             {
                 if(writedata)
                     mEncMap[node.end - mBase] = (byte)enc_byte;
@@ -102,15 +104,15 @@ void AdvancedAnalysis::analyzeFunction(duint entryPoint, bool writedata)
             if(writedata)
             {
                 mEncMap[node.end - mBase] = (byte)enc_code;
-                for(int i = 1; i < mCp.Size(); i++)
+                for(int i = 1; i < instruction.size; i++)
                     mEncMap[node.end - mBase + i] = (byte)enc_middle;
             }
-            if(mCp.InGroup(CS_GRP_JUMP) || mCp.IsLoop())   //jump
+            if(instruction.Is(InstructionCache::FlagJump))   //jump
             {
                 //set the branch destinations
-                node.brtrue = mCp.BranchDestination();
-                if(mCp.GetId() != X86_INS_JMP)   //unconditional jumps dont have a brfalse
-                    node.brfalse = node.end + mCp.Size();
+                node.brtrue = instruction.destination;
+                if(!instruction.Is(InstructionCache::FlagJmp))   //unconditional jumps dont have a brfalse
+                    node.brfalse = node.end + instruction.size;
 
                 //add node to the function graph
                 graph.AddNode(node);
@@ -123,20 +125,20 @@ void AdvancedAnalysis::analyzeFunction(duint entryPoint, bool writedata)
 
                 break;
             }
-            if(mCp.InGroup(CS_GRP_CALL))   //call
+            if(instruction.Is(InstructionCache::FlagCall))   //call
             {
                 //TODO: handle no return
-                duint target = mCp.BranchDestination();
+                duint target = instruction.destination;
                 if(inRange(target) && mEntryPoints.find(target) == mEntryPoints.end())
                     mCandidateEPs.insert(target);
             }
-            if(mCp.InGroup(CS_GRP_RET))   //return
+            if(instruction.Is(InstructionCache::FlagRet))   //return
             {
                 node.terminal = true;
                 graph.AddNode(node);
                 break;
             }
-            node.end += mCp.Size();
+            node.end += instruction.size;
         }
     }
     mFunctions.push_back(graph);
@@ -148,36 +150,20 @@ void AdvancedAnalysis::linearXrefPass()
     dputs("Starting xref analysis...");
     auto ticks = GetTickCount();
 
-    for(auto addr = mBase; addr < mBase + mSize;)
+    const auto & cache = instructions();
+    for(size_t i = 0; i < cache.Count(); i++)
     {
-        if(!mCp.Disassemble(addr, translateAddr(addr)))
-        {
-            addr++;
-            continue;
-        }
-        addr += mCp.Size();
+        const auto & instruction = cache[i];
 
         XREF xref;
         xref.valid = true;
-        xref.addr = 0;
-        xref.from = mCp.Address();
-        for(auto i = 0; i < mCp.OpCount(); i++)
-        {
-            duint dest = mCp.ResolveOpValue(i, [](x86_reg)->size_t
-            {
-                return 0;
-            });
-            if(inRange(dest))
-            {
-                xref.addr = dest;
-                break;
-            }
-        }
+        xref.addr = instruction.reference;
+        xref.from = instruction.address;
         if(xref.addr)
         {
-            if(mCp.InGroup(CS_GRP_CALL))
+            if(instruction.Is(InstructionCache::FlagCall))
                 xref.type = XREF_CALL;
-            else if(mCp.InGroup(CS_GRP_JUMP))
+            else if(instruction.Is(InstructionCache::FlagJump))
                 xref.type = XREF_JMP;
             else
                 xref.type = XREF_DATA;
@@ -217,93 +203,66 @@ void AdvancedAnalysis::findInvalidXrefs()
     }
 }
 
-bool isFloatInstruction(x86_insn opcode)
-{
-    switch(opcode)
-    {
-    case X86_INS_FLD:
-    case X86_INS_FST:
-    case X86_INS_FSTP:
-    case X86_INS_FADD:
-    case X86_INS_FSUB:
-    case X86_INS_FSUBR:
-    case X86_INS_FMUL:
-    case X86_INS_FDIV:
-    case X86_INS_FDIVR:
-    case X86_INS_FCOM:
-    case X86_INS_FCOMP:
-
-        return true;
-    default:
-        return false;
-    }
-}
-
 void AdvancedAnalysis::writeDataXrefs()
 {
+    InstructionCache::Instruction instruction;
     for(auto & vec : mXrefs)
     {
         for(auto & xref : vec.second)
         {
             if(xref.type == XREF_DATA && xref.valid)
             {
-                if(!mCp.Disassemble(xref.from, translateAddr(xref.from)))
+                if(!decode(xref.from, instruction))
                 {
                     xref.valid = false;
                     continue;
                 }
-                auto opcode = mCp.GetId();
-                bool isfloat = isFloatInstruction(opcode);
-                for(auto i = 0; i < mCp.OpCount(); i++)
-                {
-                    auto & op = mCp[i];
-                    ENCODETYPE type = enc_unknown;
+                if(!instruction.memSize)
+                    continue;
 
-                    //Todo: Analyze op type and set correct type
-                    if(op.type == X86_OP_MEM)
-                    {
-                        duint datasize = op.size;
-                        duint size = datasize;
-                        duint offset = xref.addr - mBase;
-                        switch(op.size)
-                        {
-                        case 1:
-                            type = enc_byte;
-                            break;
-                        case 2:
-                            type = enc_word;
-                            break;
-                        case 4:
-                            type = isfloat ? enc_real4 : enc_dword;
-                            break;
-                        case 6:
-                            type = enc_fword;
-                            break;
-                        case 8:
-                            type = isfloat ? enc_real8 : enc_qword;
-                            break;
-                        case 10:
-                            type = isfloat ? enc_real10 : enc_tbyte;
-                            break;
-                        case 16:
-                            type = enc_oword;
-                            break;
-                        case 32:
-                            type = enc_ymmword;
-                            break;
-                            //case 64: type = enc_zmmword; break;
-                        }
-                        if(datasize == 1)
-                        {
-                            memset(mEncMap + offset, (byte)type, size);
-                        }
-                        else
-                        {
-                            memset(mEncMap + offset, (byte)enc_middle, size);
-                            for(duint i = offset; i < offset + size; i += datasize)
-                                mEncMap[i] = (byte)type;
-                        }
-                    }
+                //Todo: Analyze op type and set correct type
+                bool isfloat = instruction.Is(InstructionCache::FlagFloat);
+                ENCODETYPE type = enc_unknown;
+                duint datasize = instruction.memSize;
+                duint size = datasize;
+                duint offset = xref.addr - mBase;
+                switch(instruction.memSize)
+                {
+                case 1:
+                    type = enc_byte;
+                    break;
+                case 2:
+                    type = enc_word;
+                    break;
+                case 4:
+                    type = isfloat ? enc_real4 : enc_dword;
+                    break;
+                case 6:
+                    type = enc_fword;
+                    break;
+                case 8:
+                    type = isfloat ? enc_real8 : enc_qword;
+                    break;
+                case 10:
+                    type = isfloat ? enc_real10 : enc_tbyte;
+                    break;
+                case 16:
+                    type = enc_oword;
+                    break;
+                case 32:
+                    type = enc_ymmword;
+                    break;
+                    //case 64: type = enc_zmmword; break;
+                }
+                if(datasize == 1)
+                {
+                    memset(mEncMap + offset, (byte)type, size);
+                }
+                else
+                {
+                    memset(mEncMap + offset, (byte)enc_middle, size);
+                    for(duint i = offset; i < offset + size; i += datasize)
+                        mEncMap[i] = (byte)type;
                 }
             }
         }
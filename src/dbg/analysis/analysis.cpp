@@ -1,5 +1,6 @@
 #include "analysis.h"
 #include "memory.h"
+#include "incrementalanalysis.h"
 
 Analysis::Analysis(duint base, duint size)
 {
@@ -12,4 +13,21 @@ Analysis::Analysis(duint base, duint size)
 Analysis::~Analysis()
 {
     delete[] mData;
+}
+
+const InstructionCache & Analysis::instructions()
+{
+    if(!mInstructions)
+        mInstructions = InstructionCache::Acquire(mBase, mSize, mData);
+    return *mInstructions;
+}
+
+void Analysis::publishInstructions()
+{
+    if(!mInstructions)
+        return;
+    InstructionCache::Publish(mInstructions);
+    //the databases match the snapshot, so earlier changes are no longer pending
+    std::vector<Range> dirty;
+    AnalysisDirtyGet(mBase, mBase + mSize - 1, dirty, true);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "_global.h"
 #include <capstone_wrapper.h>
+#include "instructioncache.h"
 
 class Analysis
 {
@@ -18,6 +19,7 @@ protected:
     duint mSize;
     unsigned char* mData;
     Capstone mCp;
+    std::shared_ptr<const InstructionCache> mInstructions;
 
     bool inRange(duint addr) const
     {
@@ -28,6 +30,16 @@ protected:
     {
         return inRange(addr) ? mData + (addr - mBase) : nullptr;
     }
+
+    const InstructionCache & instructions();
+
+    //Only for passes that rewrote both the function and the xref database of the whole range
+    void publishInstructions();
+
+    bool decode(duint addr, InstructionCache::Instruction & instruction)
+    {
+        return instructions().Decode(mCp, addr, translateAddr(addr), instruction);
+    }
 };
 
 #endif //_ANALYSIS_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "TitanEngine/TitanEngine.h"
 #include "memory.h"
 #include "function.h"
+#include "workpool.h"
 
 ControlFlowAnalysis::ControlFlowAnalysis(duint base, duint size, bool exceptionDirectory)
     : Analysis(base, size),
@@ -67,19 +68,19 @@ void ControlFlowAnalysis::Analyse()
     auto ticks = GetTickCount();
 
     BasicBlockStarts();
-    dprintf("Basic block starts in %ums!\n", GetTickCount() - ticks);
+    dprintf("Basic block starts in %ums (peak memory %uKB)!\n", GetTickCount() - ticks, peakMemoryUsage() / 1024);
     ticks = GetTickCount();
 
     BasicBlocks();
-    dprintf("Basic blocks in %ums!\n", GetTickCount() - ticks);
+    dprintf("Basic blocks in %ums (peak memory %uKB)!\n", GetTickCount() - ticks, peakMemoryUsage() / 1024);
     ticks = GetTickCount();
 
     Functions();
-    dprintf("Functions in %ums!\n", GetTickCount() - ticks);
+    dprintf("Functions in %ums (peak memory %uKB)!\n", GetTickCount() - ticks, peakMemoryUsage() / 1024);
     ticks = GetTickCount();
 
     FunctionRanges();
-    dprintf("Function ranges in %ums!\n", GetTickCount() - ticks);
+    dprintf("Function ranges in %ums (peak memory %uKB)!\n", GetTickCount() - ticks, peakMemoryUsage() / 1024);
 
     dprintf("Analysis finished!\n");
 }
@@ -135,141 +136,229 @@ void ControlFlowAnalysis::SetMarkers()
 
 void ControlFlowAnalysis::BasicBlockStarts()
 {
-    mBlockStarts.insert(mBase);
+    // Divide the linear disassembly in chunks, the results are merged in chunk order so they are deterministic
+    const auto & cache = instructions();
+    auto count = cache.Count();
+    auto & pool = WorkPool::Global();
+    auto workAmount = pool.Grain(count, 256);
+    auto threadCount = WorkPool::ChunkCount(count, workAmount);
+    std::vector<UintSet> threadBlockStarts(threadCount);
+    std::vector<UintSet> threadFunctionStarts(threadCount);
+
+    pool.ParallelFor(count, workAmount, [&](duint i, duint workStart, duint workEnd)
+    {
+        BasicBlockStartsWorker(workStart, workEnd, threadBlockStarts[i], threadFunctionStarts[i]);
+    });
+
+    duint blockStartCount = 1, functionStartCount = 0;
+    for(duint i = 0; i < threadCount; i++)
+    {
+        blockStartCount += threadBlockStarts[i].size();
+        functionStartCount += threadFunctionStarts[i].size();
+    }
+    mBlockStarts.reserve(blockStartCount);
+    mFunctionStarts.reserve(functionStartCount);
+
+    mBlockStarts.push_back(mBase);
+    for(duint i = 0; i < threadCount; i++)
+    {
+        mBlockStarts.insert(mBlockStarts.end(), threadBlockStarts[i].begin(), threadBlockStarts[i].end());
+        UintSet().swap(threadBlockStarts[i]);
+        mFunctionStarts.insert(mFunctionStarts.end(), threadFunctionStarts[i].begin(), threadFunctionStarts[i].end());
+        UintSet().swap(threadFunctionStarts[i]);
+    }
+    sortUnique(mBlockStarts);
+    sortUnique(mFunctionStarts);
+}
+
+void ControlFlowAnalysis::BasicBlockStartsWorker(duint startIndex, duint endIndex, UintSet & blockStarts, UintSet & functionStarts) const
+{
+    typedef InstructionCache::Instruction Instruction;
+    const auto & cache = *mInstructions;
+    auto isNoDestJump = [](const Instruction & instruction)
+    {
+        return instruction.Is(InstructionCache::FlagJump) && instruction.Is(InstructionCache::FlagJmp) && !instruction.reference;
+    };
+
+    // Walk back to an instruction after which the filling state is known to be off (non-filling, no RET and no indirect JMP)
+    auto first = startIndex;
+    while(first > 0)
+    {
+        const auto & prev = cache[first - 1];
+        if(!prev.Is(InstructionCache::FlagFilling) && !prev.Is(InstructionCache::FlagRet) && !isNoDestJump(prev))
+            break;
+        first--;
+    }
+
     auto bSkipFilling = false;
-    for(duint i = 0; i < mSize;)
+    for(auto i = first; i < endIndex; i++)
     {
-        auto addr = mBase + i;
-        if(mCp.Disassemble(addr, translateAddr(addr), MAX_DISASM_BUFFER))
+        const auto & instruction = cache[i];
+        auto addr = instruction.address;
+        auto owned = i >= startIndex; //only the partition that owns the instruction records its results
+        if(bSkipFilling) //handle filling skip mode
         {
-            if(bSkipFilling) //handle filling skip mode
-            {
-                if(!mCp.IsFilling()) //do nothing until the filling stopped
-                {
-                    bSkipFilling = false;
-                    mBlockStarts.insert(addr);
-                }
-            }
-            else if(mCp.InGroup(CS_GRP_RET)) //RET breaks control flow
-            {
-                bSkipFilling = true; //skip INT3/NOP/whatever filling bytes (those are not part of the control flow)
-            }
-            else if(mCp.InGroup(CS_GRP_JUMP) || mCp.IsLoop())   //branches
+            if(!instruction.Is(InstructionCache::FlagFilling)) //do nothing until the filling stopped
             {
-                auto dest1 = getReferenceOperand();
-                duint dest2 = 0;
-                if(mCp.GetId() != X86_INS_JMP)    //conditional jump
-                    dest2 = addr + mCp.Size();
-
-                if(!dest1 && !dest2)  //TODO: better code for this (make sure absolutely no filling is inserted)
-                    bSkipFilling = true;
-                if(dest1)
-                    mBlockStarts.insert(dest1);
-                if(dest2)
-                    mBlockStarts.insert(dest2);
+                bSkipFilling = false;
+                if(owned)
+                    blockStarts.push_back(addr);
             }
-            else if(mCp.InGroup(CS_GRP_CALL))
-            {
-                auto dest1 = getReferenceOperand();
-                if(dest1)
-                {
-                    mBlockStarts.insert(dest1);
-                    mFunctionStarts.insert(dest1);
-                }
-            }
-            else
+        }
+        else if(instruction.Is(InstructionCache::FlagRet)) //RET breaks control flow
+        {
+            bSkipFilling = true; //skip INT3/NOP/whatever filling bytes (those are not part of the control flow)
+        }
+        else if(instruction.Is(InstructionCache::FlagJump))   //branches
+        {
+            auto dest1 = instruction.reference;
+            duint dest2 = 0;
+            if(!instruction.Is(InstructionCache::FlagJmp))    //conditional jump
+                dest2 = addr + instruction.size;
+
+            if(!dest1 && !dest2)  //TODO: better code for this (make sure absolutely no filling is inserted)
+                bSkipFilling = true;
+            if(dest1 && owned)
+                blockStarts.push_back(dest1);
+            if(dest2 && owned)
+                blockStarts.push_back(dest2);
+        }
+        else if(instruction.Is(InstructionCache::FlagCall))
+        {
+            auto dest1 = instruction.reference;
+            if(dest1 && owned)
             {
-                auto dest1 = getReferenceOperand();
-                if(dest1)
-                    mBlockStarts.insert(dest1);
+                blockStarts.push_back(dest1);
+                functionStarts.push_back(dest1);
             }
-            i += mCp.Size();
         }
         else
-            i++;
+        {
+            auto dest1 = instruction.reference;
+            if(dest1 && owned)
+                blockStarts.push_back(dest1);
+        }
     }
 }
 
 void ControlFlowAnalysis::BasicBlocks()
 {
-    for(auto i = mBlockStarts.begin(); i != mBlockStarts.end(); ++i)
+    // Every block only depends on its own start and the next start, so the block starts are partitioned
+    auto startCount = mBlockStarts.size();
+    auto & pool = WorkPool::Global();
+    auto workAmount = pool.Grain(startCount, 64);
+    auto threadCount = WorkPool::ChunkCount(startCount, workAmount);
+    std::vector<std::vector<BasicBlock>> threadBlocks(threadCount);
+    std::vector<UintPairSet> threadParents(threadCount);
+
+    pool.ParallelFor(startCount, workAmount, [&](duint i, duint workStart, duint workEnd)
+    {
+        BasicBlocksWorker(workStart, workEnd, threadBlocks[i], threadParents[i]);
+    });
+
+    // Chunks are ordered by block start, so concatenating keeps mBlocks sorted
+    duint blockCount = 0, parentCount = 0;
+    for(duint i = 0; i < threadCount; i++)
+    {
+        blockCount += threadBlocks[i].size();
+        parentCount += threadParents[i].size();
+    }
+    mBlocks.reserve(blockCount);
+    mParentMap.reserve(parentCount);
+    for(duint i = 0; i < threadCount; i++)
+    {
+        mBlocks.insert(mBlocks.end(), threadBlocks[i].begin(), threadBlocks[i].end());
+        std::vector<BasicBlock>().swap(threadBlocks[i]);
+        mParentMap.insert(mParentMap.end(), threadParents[i].begin(), threadParents[i].end());
+        UintPairSet().swap(threadParents[i]);
+    }
+    std::sort(mParentMap.begin(), mParentMap.end());
+    mParentMap.erase(std::unique(mParentMap.begin(), mParentMap.end()), mParentMap.end());
+    UintSet().swap(mBlockStarts);
+
+#ifdef _WIN64
+    auto count = 0;
+    enumerateFunctionRuntimeEntries64([&](PRUNTIME_FUNCTION Function)
+    {
+        auto funcAddr = mModuleBase + Function->BeginAddress;
+        auto funcEnd = mModuleBase + Function->EndAddress;
+
+        // If within limits...
+        if(inRange(funcAddr) && inRange(funcEnd))
+            mFunctionStarts.push_back(funcAddr);
+        count++;
+        return true;
+    });
+    sortUnique(mFunctionStarts);
+    dprintf("%u functions from the exception directory...\n", count);
+#endif // _WIN64
+
+    dprintf("%u basic blocks, %u function starts detected...\n", mBlocks.size(), mFunctionStarts.size());
+}
+
+void ControlFlowAnalysis::BasicBlocksWorker(duint startIndex, duint endIndex, std::vector<BasicBlock> & blocks, UintPairSet & parents) const
+{
+    Capstone cp;
+    InstructionCache::Instruction instruction;
+    auto insertParent = [&parents](duint child, duint parent)
     {
-        auto start = *i;
+        if(child && parent)
+            parents.push_back(UintPair(child, parent));
+    };
+    for(auto i = startIndex; i < endIndex; i++)
+    {
+        auto start = mBlockStarts[i];
         if(!inRange(start))
             continue;
-        auto nextStart = mBase + mSize;
-        auto next = std::next(i);
-        if(next != mBlockStarts.end())
-            nextStart = *next;
+        auto nextStart = i + 1 < mBlockStarts.size() ? mBlockStarts[i + 1] : mBase + mSize;
         for(duint addr = start, prevaddr; addr < mBase + mSize;)
         {
             prevaddr = addr;
-            if(mCp.Disassemble(addr, translateAddr(addr), MAX_DISASM_BUFFER))
+            if(mInstructions->Decode(cp, addr, translateAddr(addr), instruction))
             {
-                if(mCp.InGroup(CS_GRP_RET))
+                if(instruction.Is(InstructionCache::FlagRet))
                 {
-                    insertBlock(BasicBlock(start, addr, 0, 0)); //leaf block
+                    blocks.push_back(BasicBlock(start, addr, 0, 0)); //leaf block
                     break;
                 }
-                else if(mCp.InGroup(CS_GRP_JUMP) || mCp.IsLoop())
+                else if(instruction.Is(InstructionCache::FlagJump))
                 {
-                    auto dest1 = getReferenceOperand();
-                    auto dest2 = mCp.GetId() != X86_INS_JMP ? addr + mCp.Size() : 0;
-                    insertBlock(BasicBlock(start, addr, dest1, dest2));
+                    auto dest1 = instruction.reference;
+                    auto dest2 = !instruction.Is(InstructionCache::FlagJmp) ? addr + instruction.size : 0;
+                    blocks.push_back(BasicBlock(start, addr, dest1, dest2));
                     insertParent(dest1, start);
                     insertParent(dest2, start);
                     break;
                 }
-                addr += mCp.Size();
+                addr += instruction.size;
             }
             else
                 addr++;
             if(addr == nextStart)   //special case handling overlapping blocks
             {
-                insertBlock(BasicBlock(start, prevaddr, 0, nextStart));
+                blocks.push_back(BasicBlock(start, prevaddr, 0, nextStart));
                 insertParent(nextStart, start);
                 break;
             }
         }
     }
-    mBlockStarts.clear();
-
-#ifdef _WIN64
-    auto count = 0;
-    enumerateFunctionRuntimeEntries64([&](PRUNTIME_FUNCTION Function)
-    {
-        auto funcAddr = mModuleBase + Function->BeginAddress;
-        auto funcEnd = mModuleBase + Function->EndAddress;
-
-        // If within limits...
-        if(inRange(funcAddr) && inRange(funcEnd))
-            mFunctionStarts.insert(funcAddr);
-        count++;
-        return true;
-    });
-    dprintf("%u functions from the exception directory...\n", count);
-#endif // _WIN64
-
-    dprintf("%u basic blocks, %u function starts detected...\n", mBlocks.size(), mFunctionStarts.size());
 }
 
 void ControlFlowAnalysis::Functions()
 {
-    typedef std::pair<BasicBlock*, const UintSet*> DelayedBlock;
+    typedef std::pair<BasicBlock*, ParentRange> DelayedBlock;
     std::vector<DelayedBlock> delayedBlocks;
     for(auto & it : mBlocks)
     {
-        auto block = &it.second;
+        auto block = &it;
         auto parents = findParents(block->start);
         if(!block->function)
         {
-            if(!parents || mFunctionStarts.count(block->start))  //no parents = function start
+            if(parents.first == parents.second || std::binary_search(mFunctionStarts.begin(), mFunctionStarts.end(), block->start))  //no parents = function start
             {
                 auto functionStart = block->start;
                 block->function = functionStart;
-                UintSet functionBlocks;
-                functionBlocks.insert(functionStart);
-                mFunctions[functionStart] = functionBlocks;
+                mFunctions.push_back(functionStart); //blocks are sorted, so this stays sorted
             }
             else //in function
             {
@@ -289,101 +378,60 @@ void ControlFlowAnalysis::Functions()
     for(auto & delayedBlock : delayedBlocks)
     {
         auto block = delayedBlock.first;
-        auto parents = delayedBlock.second;
-        auto function = findFunctionStart(block, parents);
+        auto function = findFunctionStart(block, delayedBlock.second);
         if(!function)
-        {
             continue;
-            /*dprintf("unresolved block %s\n", blockToString(block).c_str());
-            if(parents)
-            {
-                dprintf("parents:\n");
-                for(auto parent : *parents)
-                    dprintf("  %s\n", blockToString(findBlock(parent)).c_str());
-            }
-            else
-                dprintf("parents: null");
-            dprintf("left: %s\n", blockToString(findBlock(block->left)).c_str());
-            dprintf("right: %s\n", blockToString(findBlock(block->right)).c_str());
-            return;*/
-        }
         block->function = function;
         resolved++;
     }
     dprintf("%u/%u delayed blocks resolved (%u/%u still left, probably unreferenced functions)\n", resolved, delayedCount, delayedCount - resolved, mBlocks.size());
-    auto unreferencedCount = 0;
-    for(const auto & block : mBlocks)
-    {
-        auto found = mFunctions.find(block.second.function);
-        if(found == mFunctions.end())  //unreferenced block
-        {
-            unreferencedCount++;
-            continue;
-        }
-        found->second.insert(block.second.start);
-    }
-    dprintf("%u/%u unreferenced blocks\n", unreferencedCount, mBlocks.size());
     dprintf("%u functions found!\n", mFunctions.size());
 }
 
 void ControlFlowAnalysis::FunctionRanges()
 {
-    //iterate over the functions and then find the deepest block = function end
-    for(const auto & function : mFunctions)
+    //the deepest block of every function = function end
+    mFunctionRanges.reserve(mFunctions.size());
+    for(auto start : mFunctions)
+        mFunctionRanges.push_back({ start, start });
+    UintSet().swap(mFunctions);
+    auto unreferencedCount = 0;
+    for(const auto & block : mBlocks)
     {
-        auto start = function.first;
-        auto end = start;
-        for(auto blockstart : function.second)
+        auto found = std::lower_bound(mFunctionRanges.begin(), mFunctionRanges.end(), Range(block.function, 0));
+        if(!block.function || found == mFunctionRanges.end() || found->first != block.function)  //unreferenced block
         {
-            auto block = findBlock(blockstart);
-            if(!block)
-                DebugBreak(); //this shouldn't happen
-            if(block->end > end)
-                end = block->end;
+            unreferencedCount++;
+            continue;
         }
-        mFunctionRanges.push_back({ start, end });
+        if(block.end > found->second)
+            found->second = block.end;
     }
-}
-
-void ControlFlowAnalysis::insertBlock(BasicBlock block)
-{
-    if(mBlocks.find(block.start) != mBlocks.end())
-        DebugBreak();
-    mBlocks[block.start] = block;
+    dprintf("%u/%u unreferenced blocks\n", unreferencedCount, mBlocks.size());
 }
 
 const ControlFlowAnalysis::BasicBlock* ControlFlowAnalysis::findBlock(duint start) const
 {
     if(!start)
         return nullptr;
-    auto found = mBlocks.find(start);
-    return found != mBlocks.end() ? &found->second : nullptr;
-}
-
-void ControlFlowAnalysis::insertParent(duint child, duint parent)
-{
-    if(!child || !parent)
-        return;
-    auto found = mParentMap.find(child);
-    if(found == mParentMap.end())
+    auto found = std::lower_bound(mBlocks.begin(), mBlocks.end(), start, [](const BasicBlock & block, duint start)
     {
-        UintSet parents;
-        parents.insert(parent);
-        mParentMap[child] = parents;
-    }
-    else
-        found->second.insert(parent);
+        return block.start < start;
+    });
+    return found != mBlocks.end() && found->start == start ? &*found : nullptr;
 }
 
-const ControlFlowAnalysis::UintSet* ControlFlowAnalysis::findParents(duint child) const
+ControlFlowAnalysis::ParentRange ControlFlowAnalysis::findParents(duint child) const
 {
     if(!child)
-        return nullptr;
-    auto found = mParentMap.find(child);
-    return found != mParentMap.end() ? &found->second : nullptr;
+        return ParentRange(mParentMap.end(), mParentMap.end());
+    return std::equal_range(mParentMap.begin(), mParentMap.end(), UintPair(child, 0), [](const UintPair & a, const UintPair & b)
+    {
+        return a.first < b.first;
+    });
 }
 
-duint ControlFlowAnalysis::findFunctionStart(const BasicBlock* block, const UintSet* parents) const
+duint ControlFlowAnalysis::findFunctionStart(const BasicBlock* block, const ParentRange & parents) const
 {
     if(!block)
         return 0;
@@ -395,10 +443,10 @@ duint ControlFlowAnalysis::findFunctionStart(const BasicBlock* block, const Uint
     auto right = findBlock(block->right);
     if(right && right->function)
         return right->function;
-    for(auto start : *parents)
+    for(auto it = parents.first; it != parents.second; ++it)
     {
-        auto parent = findBlock(start);
-        if(parent->function)
+        auto parent = findBlock(it->second);
+        if(parent && parent->function)
             return parent->function;
     }
     return 0;
@@ -411,27 +459,18 @@ String ControlFlowAnalysis::blockToString(const BasicBlock* block)
     return block->toString();
 }
 
-duint ControlFlowAnalysis::getReferenceOperand() const
+void ControlFlowAnalysis::sortUnique(UintSet & set)
 {
-    for(auto i = 0; i < mCp.OpCount(); i++)
-    {
-        const auto & op = mCp.x86().operands[i];
-        if(op.type == X86_OP_IMM)
-        {
-            auto dest = duint(op.imm);
-            if(inRange(dest))
-                return dest;
-        }
-        else if(op.type == X86_OP_MEM)
-        {
-            auto dest = duint(op.mem.disp);
-            if(op.mem.base == X86_REG_RIP)  //rip-relative
-                dest += mCp.Address() + mCp.Size();
-            if(inRange(dest))
-                return dest;
-        }
-    }
-    return 0;
+    std::sort(set.begin(), set.end());
+    set.erase(std::unique(set.begin(), set.end()), set.end());
+}
+
+duint ControlFlowAnalysis::peakMemoryUsage()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if(!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
 }
 
 #ifdef _WIN64
@@ -43,7 +43,10 @@ private:
         }
     };
 
-    typedef std::unordered_set<duint> UintSet;
+    typedef std::vector<duint> UintSet; //sorted, no duplicates
+    typedef std::pair<duint, duint> UintPair;
+    typedef std::vector<UintPair> UintPairSet; //sorted, no duplicates
+    typedef std::pair<UintPairSet::const_iterator, UintPairSet::const_iterator> ParentRange;
 
     duint mModuleBase;
     duint mFunctionInfoSize;
@@ -51,22 +54,23 @@ private:
 
     UintSet mBlockStarts;
     UintSet mFunctionStarts;
-    std::unordered_map<duint, BasicBlock> mBlocks; //start of block -> block
-    std::unordered_map<duint, UintSet> mParentMap; //start child -> parents
-    std::unordered_map<duint, UintSet> mFunctions; //function start -> function block starts
+    std::vector<BasicBlock> mBlocks; //sorted by block start
+    UintPairSet mParentMap; //start child -> parent
+    UintSet mFunctions; //function starts
     std::vector<Range> mFunctionRanges; //function start -> function range TODO: smarter stuff with overlapping ranges
 
     void BasicBlockStarts();
+    void BasicBlockStartsWorker(duint startIndex, duint endIndex, UintSet & blockStarts, UintSet & functionStarts) const;
     void BasicBlocks();
+    void BasicBlocksWorker(duint startIndex, duint endIndex, std::vector<BasicBlock> & blocks, UintPairSet & parents) const;
     void Functions();
     void FunctionRanges();
-    void insertBlock(BasicBlock block);
     const BasicBlock* findBlock(duint start) const;
-    void insertParent(duint child, duint parent);
-    const UintSet* findParents(duint child) const;
-    duint findFunctionStart(const BasicBlock* block, const UintSet* parents) const;
+    ParentRange findParents(duint child) const;
+    duint findFunctionStart(const BasicBlock* block, const ParentRange & parents) const;
     static String blockToString(const BasicBlock* block);
-    duint getReferenceOperand() const;
+    static void sortUnique(UintSet & set);
+    static duint peakMemoryUsage();
 
 #ifdef _WIN64
     void enumerateFunctionRuntimeEntries64(std::function<bool(PRUNTIME_FUNCTION)> Callback) const;
@@ -0,0 +1,233 @@
+#include "incrementalanalysis.h"
+#include <queue>
+#include "console.h"
+#include "module.h"
+#include "function.h"
+#include "xrefs.h"
+#include "encodemap.h"
+#include "threading.h"
+
+static std::vector<Range> dirtyRanges; //sorted, merged, inclusive
+
+IncrementalAnalysis::IncrementalAnalysis(duint base, duint size)
+    : Analysis(base, size)
+{
+}
+
+void IncrementalAnalysis::Analyse()
+{
+    dputs("Starting incremental analysis...");
+    auto ticks = GetTickCount();
+
+    auto last = InstructionCache::Last(mBase, mSize);
+    if(!last)
+    {
+        dputs("No previous analysis of this range, run a full analysis (analadv) first!");
+        return;
+    }
+    AnalysisDirtyGet(mBase, mBase + mSize - 1, mDirty, false);
+    if(mDirty.empty())
+    {
+        dputs("Nothing changed since the last analysis!");
+        return;
+    }
+
+    mInstructions = last->Patch(mData, mDirty, mRemoved, mAdded);
+    dprintf("%u dirty ranges, %u instructions removed, %u instructions added\n", (unsigned int)mDirty.size(), (unsigned int)mRemoved.size(), (unsigned int)mAdded.size());
+
+    //functions that contain changed bytes are derived again from their entry point
+    auto modbase = ModBaseFromAddr(mBase);
+    char modname[MAX_MODULE_SIZE] = "";
+    if(modbase)
+        ModNameFromAddr(modbase, modname, true);
+    std::vector<FUNCTIONSINFO> functions;
+    FunctionGetList(functions);
+    std::vector<duint> starts; //every function can grow up to the next one
+    for(const auto & function : functions)
+        if(strcmp(function.mod, modname) == 0)
+            starts.push_back(function.start + modbase);
+    std::sort(starts.begin(), starts.end());
+    for(const auto & function : functions)
+    {
+        if(function.manual || strcmp(function.mod, modname) != 0)
+            continue;
+        auto start = function.start + modbase;
+        auto end = function.end + modbase;
+        if(!inRange(start) || !isDirty(start, end + MAX_DISASM_BUFFER))
+            continue;
+        auto next = std::upper_bound(starts.begin(), starts.end(), start);
+        auto limit = next != starts.end() ? *next - 1 : mBase + mSize - 1;
+        FunctionUpdate update;
+        update.oldStart = start;
+        if(!functionExtent(start, max(limit, end), update))
+            update.start = 0;
+        mFunctionUpdates.push_back(update);
+    }
+    dprintf("%u functions analysed again\n", (unsigned int)mFunctionUpdates.size());
+
+    dprintf("Incremental analysis finished in %ums!\n", GetTickCount() - ticks);
+}
+
+void IncrementalAnalysis::SetMarkers()
+{
+    if(!mInstructions)
+        return;
+
+    //only touch the xrefs that actually changed
+    typedef std::pair<duint, duint> XrefPair; //from, addr
+    std::vector<XrefPair> oldXrefs, newXrefs, deleted, inserted;
+    for(const auto & instruction : mRemoved)
+        if(instruction.reference)
+            oldXrefs.push_back(XrefPair(instruction.address, instruction.reference));
+    for(const auto & instruction : mAdded)
+        if(instruction.reference)
+            newXrefs.push_back(XrefPair(instruction.address, instruction.reference));
+    std::set_difference(oldXrefs.begin(), oldXrefs.end(), newXrefs.begin(), newXrefs.end(), std::back_inserter(deleted));
+    std::set_difference(newXrefs.begin(), newXrefs.end(), oldXrefs.begin(), oldXrefs.end(), std::back_inserter(inserted));
+    for(const auto & xref : deleted)
+        XrefDelete(xref.second, xref.first);
+    for(const auto & xref : inserted)
+        XrefAdd(xref.second, xref.first);
+
+    //new instructions that replace instructions previously typed as code stay code
+    std::vector<Range> codeRanges;
+    for(const auto & instruction : mRemoved)
+        if(EncodeMapGetType(instruction.address, instruction.size) == enc_code)
+            codeRanges.push_back(Range(instruction.address, instruction.address + instruction.size - 1));
+    for(const auto & instruction : mAdded)
+    {
+        auto found = std::upper_bound(codeRanges.begin(), codeRanges.end(), Range(instruction.address, ~0));
+        if(found != codeRanges.begin() && std::prev(found)->second >= instruction.address)
+            EncodeMapSetType(instruction.address, instruction.size, enc_code);
+    }
+
+    //functions, only the function that was analysed again is ever deleted
+    for(const auto & update : mFunctionUpdates)
+    {
+        duint start, end, icount;
+        if(!FunctionGet(update.oldStart, &start, &end, &icount))
+            continue;
+        if(update.start && start == update.start && end == update.end && icount == update.icount)
+            continue;
+        FunctionDelete(update.oldStart);
+        if(!update.start)
+            continue;
+        if(!FunctionAdd(update.start, update.end, false, update.icount))
+        {
+            dprintf("Function %p-%p overlaps another function, keeping %p-%p\n", update.start, update.end, start, end);
+            FunctionAdd(start, end, false, icount);
+        }
+    }
+    dprintf("%u xrefs deleted, %u xrefs added\n", (unsigned int)deleted.size(), (unsigned int)inserted.size());
+
+    //the databases now match the patched snapshot, later changes stay pending
+    InstructionCache::Publish(mInstructions);
+    std::vector<Range> handled;
+    for(const auto & range : mDirty)
+        AnalysisDirtyGet(range.first, range.second, handled, true);
+
+    GuiUpdateAllViews();
+}
+
+bool IncrementalAnalysis::isDirty(duint start, duint end) const
+{
+    for(const auto & range : mDirty)
+        if(range.first <= end && range.second >= start)
+            return true;
+    return false;
+}
+
+bool IncrementalAnalysis::functionExtent(duint entry, duint limit, FunctionUpdate & update)
+{
+    //BFS through the instructions starting at the entry point, bounded to [entry, limit]
+    update.start = entry;
+    update.end = entry;
+    update.icount = 0;
+    std::unordered_set<duint> visited;
+    std::queue<duint> queue;
+    Instruction instruction;
+    queue.push(entry);
+    while(!queue.empty())
+    {
+        auto addr = queue.front();
+        queue.pop();
+        while(addr <= limit && inRange(addr) && visited.insert(addr).second)
+        {
+            if(!decode(addr, instruction))
+            {
+                addr++;
+                continue;
+            }
+            if(addr + instruction.size - 1 > limit) //would overlap the next function
+                break;
+            update.icount++;
+            update.end = max(update.end, addr + instruction.size - 1);
+            if(instruction.Is(InstructionCache::FlagJump))
+            {
+                //jumps that leave the window are tail calls or belong to other functions
+                if(instruction.destination >= entry && instruction.destination <= limit)
+                    queue.push(instruction.destination);
+                if(!instruction.Is(InstructionCache::FlagJmp) && !instruction.Is(InstructionCache::FlagLjmp))
+                    queue.push(addr + instruction.size);
+                break;
+            }
+            if(instruction.Is(InstructionCache::FlagRet))
+                break;
+            addr += instruction.size;
+        }
+    }
+    return update.icount != 0;
+}
+
+void AnalysisDirtyAdd(duint Start, duint Size)
+{
+    if(!Size)
+        return;
+    Range range(Start, Start + Size - 1);
+    EXCLUSIVE_ACQUIRE(LockAnalysisDirty);
+    //merge with overlapping and adjacent ranges
+    auto first = std::lower_bound(dirtyRanges.begin(), dirtyRanges.end(), range, [](const Range & a, const Range & b)
+    {
+        return a.second + 1 < b.first;
+    });
+    auto last = first;
+    for(; last != dirtyRanges.end() && last->first <= range.second + 1; ++last)
+    {
+        range.first = min(range.first, last->first);
+        range.second = max(range.second, last->second);
+    }
+    first = dirtyRanges.erase(first, last);
+    dirtyRanges.insert(first, range);
+}
+
+void AnalysisDirtyGet(duint Start, duint End, std::vector<Range> & Ranges, bool Clear)
+{
+    Ranges.clear();
+    std::vector<Range> remaining;
+    EXCLUSIVE_ACQUIRE(LockAnalysisDirty);
+    for(const auto & range : dirtyRanges)
+    {
+        if(range.second < Start || range.first > End)
+        {
+            remaining.push_back(range);
+            continue;
+        }
+        Ranges.push_back(Range(max(range.first, Start), min(range.second, End)));
+        if(!Clear)
+            remaining.push_back(range);
+        else
+        {
+            if(range.first < Start)
+                remaining.push_back(Range(range.first, Start - 1));
+            if(range.second > End)
+                remaining.push_back(Range(End + 1, range.second));
+        }
+    }
+    dirtyRanges.swap(remaining);
+}
+
+void AnalysisDirtyClear()
+{
+    EXCLUSIVE_ACQUIRE(LockAnalysisDirty);
+    dirtyRanges.clear();
+}
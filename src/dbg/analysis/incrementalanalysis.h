@@ -0,0 +1,38 @@
+#ifndef _INCREMENTALANALYSIS_H
+#define _INCREMENTALANALYSIS_H
+
+#include "analysis.h"
+
+//Re-analyses only the bytes that changed since the last analysis of the same range.
+class IncrementalAnalysis : public Analysis
+{
+public:
+    explicit IncrementalAnalysis(duint base, duint size);
+    void Analyse() override;
+    void SetMarkers() override;
+
+private:
+    typedef InstructionCache::Instruction Instruction;
+
+    struct FunctionUpdate
+    {
+        duint oldStart;
+        duint start;
+        duint end;
+        duint icount;
+    };
+
+    std::vector<Range> mDirty;
+    std::vector<Instruction> mRemoved;
+    std::vector<Instruction> mAdded;
+    std::vector<FunctionUpdate> mFunctionUpdates;
+
+    bool isDirty(duint start, duint end) const;
+    bool functionExtent(duint entry, duint limit, FunctionUpdate & update);
+};
+
+void AnalysisDirtyAdd(duint Start, duint Size);
+void AnalysisDirtyGet(duint Start, duint End, std::vector<Range> & Ranges, bool Clear);
+void AnalysisDirtyClear();
+
+#endif //_INCREMENTALANALYSIS_H
@@ -0,0 +1,311 @@
+#include "instructioncache.h"
+#include "threading.h"
+#include "murmurhash.h"
+#include "workpool.h"
+
+InstructionCache::InstructionCache(duint base, duint size)
+    : mBase(base),
+      mSize(size),
+      mHash(0)
+{
+}
+
+void InstructionCache::Build(const unsigned char* data)
+{
+    // Sweep chunks in parallel, each starting at its own chunk start
+    auto & pool = WorkPool::Global();
+    auto workAmount = pool.Grain(mSize, 0x4000);
+    auto threadCount = WorkPool::ChunkCount(mSize, workAmount);
+    std::vector<std::vector<Instruction>> threadInstructions(threadCount);
+
+    pool.ParallelFor(mSize, workAmount, [&](duint i, duint start, duint end)
+    {
+        threadInstructions[i].reserve((end - start) / 3);
+        sweep(mBase + start, mBase + end, data, threadInstructions[i]);
+    });
+
+    // Stitch the partitions together so the result is identical to a single linear sweep
+    duint total = 0;
+    for(const auto & instructions : threadInstructions)
+        total += instructions.size();
+    mInstructions.clear();
+    mInstructions.reserve(total);
+
+    Capstone cp;
+    duint addr = mBase; //where a single linear sweep would continue
+    auto step = [&]()
+    {
+        if(cp.Disassemble(addr, data + (addr - mBase), MAX_DISASM_BUFFER))
+        {
+            Instruction instruction;
+            fromCapstone(cp, instruction);
+            mInstructions.push_back(instruction);
+            addr += cp.Size();
+        }
+        else
+            addr++;
+    };
+    for(duint i = 0; i < threadCount; i++)
+    {
+        auto & instructions = threadInstructions[i];
+        auto workEnd = mBase + min(workAmount * (i + 1), mSize);
+        auto compare = [](const Instruction & instruction, duint address)
+        {
+            return instruction.address < address;
+        };
+        auto found = std::lower_bound(instructions.begin(), instructions.end(), addr, compare);
+        while(true)
+        {
+            if(found == instructions.end())  //never synchronized, finish the partition ourselves
+            {
+                while(addr < workEnd)
+                    step();
+                break;
+            }
+            if(found->address == addr)  //synchronized with the partition sweep
+            {
+                mInstructions.insert(mInstructions.end(), found, instructions.end());
+                const auto & last = mInstructions.back();
+                addr = max(last.address + last.size, workEnd);
+                break;
+            }
+            if(found->address > addr)
+                step();
+            else
+                found = std::lower_bound(found, instructions.end(), addr, compare);
+        }
+        std::vector<Instruction>().swap(instructions);
+    }
+}
+
+bool InstructionCache::Decode(Capstone & cp, duint addr, const unsigned char* data, Instruction & instruction) const
+{
+    auto index = Find(addr);
+    if(index != Count())
+    {
+        instruction = mInstructions[index];
+        return true;
+    }
+    // Not on the linear sweep (overlapping instruction or jump into the middle of an instruction)
+    if(!data || !cp.Disassemble(addr, data, MAX_DISASM_BUFFER))
+        return false;
+    fromCapstone(cp, instruction);
+    return true;
+}
+
+size_t InstructionCache::Find(duint addr) const
+{
+    auto index = LowerBound(addr);
+    return index != Count() && mInstructions[index].address == addr ? index : Count();
+}
+
+size_t InstructionCache::LowerBound(duint addr) const
+{
+    auto found = std::lower_bound(mInstructions.begin(), mInstructions.end(), addr, [](const Instruction & instruction, duint addr)
+    {
+        return instruction.address < addr;
+    });
+    return found - mInstructions.begin();
+}
+
+std::shared_ptr<const InstructionCache> InstructionCache::Patch(const unsigned char* data, const std::vector<Range> & dirty, std::vector<Instruction> & removed, std::vector<Instruction> & added) const
+{
+    auto cache = std::make_shared<InstructionCache>(mBase, mSize);
+    cache->mHash = duint(murmurhash(data, int(mSize)));
+    auto & instructions = cache->mInstructions;
+    instructions.reserve(Count());
+
+    Capstone cp;
+    size_t index = 0; //next old instruction
+    duint addr = mBase; //where a single linear sweep over the new data would continue
+    for(const auto & range : dirty) //sorted, inclusive ranges
+    {
+        auto start = max(range.first, mBase);
+        auto end = min(range.second + 1, mBase + mSize);
+        if(start >= end)
+            continue;
+
+        // Instructions that end before the dirty bytes decode the same
+        for(; index < Count() && mInstructions[index].address + mInstructions[index].size <= start; index++)
+        {
+            instructions.push_back(mInstructions[index]);
+            addr = mInstructions[index].address + mInstructions[index].size;
+        }
+
+        // Sweep the new data until the sweep is synchronized with an old instruction after the dirty bytes
+        while(addr < mBase + mSize)
+        {
+            for(; index < Count() && mInstructions[index].address < addr; index++)
+                removed.push_back(mInstructions[index]);
+            if(addr >= end && index < Count() && mInstructions[index].address == addr)
+                break;
+            if(cp.Disassemble(addr, data + (addr - mBase), MAX_DISASM_BUFFER))
+            {
+                Instruction instruction;
+                fromCapstone(cp, instruction);
+                instructions.push_back(instruction);
+                added.push_back(instruction);
+                addr += cp.Size();
+            }
+            else
+                addr++;
+        }
+    }
+    for(; index < Count(); index++)
+        instructions.push_back(mInstructions[index]);
+    return cache;
+}
+
+// Only the last snapshot is kept, this is enough to share the decoding between chained analyses.
+// Snapshots bigger than lastCacheLimit are only shared while an analysis still holds them.
+static const size_t lastCacheLimit = 16 * 1024 * 1024;
+static std::weak_ptr<const InstructionCache> lastCache;
+static std::shared_ptr<const InstructionCache> lastCacheKeep;
+// Snapshot the function and xref databases were last written from, the base of the incremental analysis
+static std::shared_ptr<const InstructionCache> baseCache;
+
+std::shared_ptr<const InstructionCache> InstructionCache::Acquire(duint base, duint size, const unsigned char* data)
+{
+    auto hash = duint(murmurhash(data, int(size)));
+    {
+        EXCLUSIVE_ACQUIRE(LockInstructionCache);
+        auto last = lastCache.lock();
+        if(last && last->mBase == base && last->mSize == size && last->mHash == hash)
+            return last;
+        if(baseCache && baseCache->mBase == base && baseCache->mSize == size && baseCache->mHash == hash)
+            return baseCache;
+    }
+
+    auto cache = std::make_shared<InstructionCache>(base, size);
+    cache->mHash = hash;
+    cache->Build(data);
+
+    EXCLUSIVE_ACQUIRE(LockInstructionCache);
+    setLast(cache);
+    return cache;
+}
+
+std::shared_ptr<const InstructionCache> InstructionCache::Last(duint base, duint size)
+{
+    EXCLUSIVE_ACQUIRE(LockInstructionCache);
+    if(baseCache && baseCache->mBase == base && baseCache->mSize == size)
+        return baseCache;
+    return nullptr;
+}
+
+void InstructionCache::Publish(const std::shared_ptr<const InstructionCache> & cache)
+{
+    EXCLUSIVE_ACQUIRE(LockInstructionCache);
+    setLast(cache);
+    baseCache = cache;
+}
+
+void InstructionCache::setLast(const std::shared_ptr<const InstructionCache> & cache)
+{
+    lastCache = cache;
+    if(cache && cache->Count() * sizeof(Instruction) <= lastCacheLimit)
+        lastCacheKeep = cache;
+    else
+        lastCacheKeep.reset();
+}
+
+static bool isFloatInstruction(x86_insn opcode)
+{
+    switch(opcode)
+    {
+    case X86_INS_FLD:
+    case X86_INS_FST:
+    case X86_INS_FSTP:
+    case X86_INS_FADD:
+    case X86_INS_FSUB:
+    case X86_INS_FSUBR:
+    case X86_INS_FMUL:
+    case X86_INS_FDIV:
+    case X86_INS_FDIVR:
+    case X86_INS_FCOM:
+    case X86_INS_FCOMP:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void InstructionCache::fromCapstone(const Capstone & cp, Instruction & instruction) const
+{
+    instruction.address = cp.Address();
+    instruction.destination = 0;
+    instruction.reference = 0;
+    instruction.immediate = 0;
+    instruction.flags = 0;
+    instruction.size = (unsigned char)cp.Size();
+    instruction.memSize = 0;
+
+    auto id = cp.GetId();
+    if(cp.InGroup(CS_GRP_JUMP) || cp.IsLoop())
+        instruction.flags |= FlagJump;
+    if(cp.IsLoop())
+        instruction.flags |= FlagLoop;
+    if(cp.InGroup(CS_GRP_CALL))
+        instruction.flags |= FlagCall;
+    if(cp.InGroup(CS_GRP_RET))
+        instruction.flags |= FlagRet;
+    if(cp.IsFilling())
+        instruction.flags |= FlagFilling;
+    if(isFloatInstruction(id))
+        instruction.flags |= FlagFloat;
+    if(id == X86_INS_JMP)
+        instruction.flags |= FlagJmp;
+    else if(id == X86_INS_LJMP)
+        instruction.flags |= FlagLjmp;
+    else if(id == X86_INS_LOOP)
+        instruction.flags |= FlagLoopInsn;
+    if(instruction.Is(FlagJump) || instruction.Is(FlagCall))
+        instruction.destination = cp.BranchDestination();
+
+    for(auto i = 0; i < cp.OpCount(); i++)
+    {
+        const auto & op = cp[i];
+        if(op.type == X86_OP_IMM)
+        {
+            if(i == 0)
+                instruction.flags |= FlagOp0Imm;
+            auto dest = duint(op.imm);
+            if(inRange(dest))
+            {
+                if(!instruction.reference)
+                    instruction.reference = dest;
+                if(!instruction.immediate)
+                    instruction.immediate = dest;
+            }
+        }
+        else if(op.type == X86_OP_MEM)
+        {
+            if(i == 0)
+                instruction.flags |= FlagOp0Mem;
+            if(!instruction.memSize)
+                instruction.memSize = op.size;
+            auto dest = duint(op.mem.disp);
+            if(op.mem.base == X86_REG_RIP)  //rip-relative
+                dest += cp.Address() + cp.Size();
+            if(inRange(dest) && !instruction.reference)
+                instruction.reference = dest;
+        }
+    }
+}
+
+void InstructionCache::sweep(duint start, duint end, const unsigned char* data, std::vector<Instruction> & instructions) const
+{
+    Capstone cp;
+    Instruction instruction;
+    for(auto addr = start; addr < end;)
+    {
+        if(cp.Disassemble(addr, data + (addr - mBase), MAX_DISASM_BUFFER))
+        {
+            fromCapstone(cp, instruction);
+            instructions.push_back(instruction);
+            addr += cp.Size();
+        }
+        else
+            addr++;
+    }
+}
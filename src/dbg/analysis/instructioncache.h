@@ -0,0 +1,86 @@
+#ifndef _INSTRUCTIONCACHE_H
+#define _INSTRUCTIONCACHE_H
+
+#include "_global.h"
+#include "addrinfo.h"
+#include <capstone_wrapper.h>
+#include <memory>
+
+//Decode-once store of the linear disassembly of a memory snapshot, shared by the analysis passes.
+class InstructionCache
+{
+public:
+    enum InstructionFlags : unsigned short
+    {
+        FlagJump = 1 << 0, //CS_GRP_JUMP or a loop instruction
+        FlagLoop = 1 << 1, //loop instructions (IsLoop)
+        FlagCall = 1 << 2, //CS_GRP_CALL
+        FlagRet = 1 << 3, //CS_GRP_RET
+        FlagFilling = 1 << 4, //padding (IsFilling)
+        FlagJmp = 1 << 5, //X86_INS_JMP
+        FlagLjmp = 1 << 6, //X86_INS_LJMP
+        FlagLoopInsn = 1 << 7, //X86_INS_LOOP
+        FlagOp0Imm = 1 << 8, //the first operand is an immediate
+        FlagOp0Mem = 1 << 9, //the first operand is a memory operand
+        FlagFloat = 1 << 10 //x87 load/store/arithmetic (memSize is a real4/real8/real10)
+    };
+
+    struct Instruction
+    {
+        duint address;
+        duint destination; //branch destination (0 if there is none or it is indirect)
+        duint reference; //first operand value (immediate or resolved memory operand) inside the range
+        duint immediate; //first immediate operand inside the range
+        unsigned short flags;
+        unsigned char size; //0 if the bytes could not be disassembled
+        unsigned char memSize; //access size of the first memory operand
+
+        bool Is(unsigned short flag) const
+        {
+            return (flags & flag) != 0;
+        }
+    };
+
+    explicit InstructionCache(duint base, duint size);
+    InstructionCache(const InstructionCache & that) = delete;
+
+    void Build(const unsigned char* data);
+    bool Decode(Capstone & cp, duint addr, const unsigned char* data, Instruction & instruction) const;
+    size_t Find(duint addr) const;
+    //Index of the first instruction at or after addr (Count() if there is none)
+    size_t LowerBound(duint addr) const;
+
+    size_t Count() const
+    {
+        return mInstructions.size();
+    }
+
+    const Instruction & operator[](size_t index) const
+    {
+        return mInstructions[index];
+    }
+
+    std::shared_ptr<const InstructionCache> Patch(const unsigned char* data, const std::vector<Range> & dirty, std::vector<Instruction> & removed, std::vector<Instruction> & added) const;
+
+    static std::shared_ptr<const InstructionCache> Acquire(duint base, duint size, const unsigned char* data);
+    //Last published snapshot of the range (the databases were written from it)
+    static std::shared_ptr<const InstructionCache> Last(duint base, duint size);
+    static void Publish(const std::shared_ptr<const InstructionCache> & cache);
+
+private:
+    duint mBase;
+    duint mSize;
+    duint mHash;
+    std::vector<Instruction> mInstructions; //sorted by address
+
+    bool inRange(duint addr) const
+    {
+        return addr >= mBase && addr < mBase + mSize;
+    }
+
+    void fromCapstone(const Capstone & cp, Instruction & instruction) const;
+    static void setLast(const std::shared_ptr<const InstructionCache> & cache);
+    void sweep(duint start, duint end, const unsigned char* data, std::vector<Instruction> & instructions) const;
+};
+
+#endif //_INSTRUCTIONCACHE_H
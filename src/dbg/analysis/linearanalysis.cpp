@@ -41,18 +41,14 @@ void LinearAnalysis::sortCleanup()
 void LinearAnalysis::populateReferences()
 {
     //linear immediate reference scan (call <addr>, push <addr>, mov [somewhere], <addr>)
-    for(duint i = 0; i < mSize;)
+    const auto & cache = instructions();
+    for(size_t i = 0; i < cache.Count(); i++)
     {
-        auto addr = mBase + i;
-        if(mCp.Disassemble(addr, translateAddr(addr), MAX_DISASM_BUFFER))
-        {
-            auto ref = getReferenceOperand();
-            if(ref)
-                mFunctions.push_back({ ref, 0 });
-            i += mCp.Size();
-        }
-        else
-            i++;
+        const auto & instruction = cache[i];
+        if(instruction.Is(InstructionCache::FlagJump))  //skip jumps/loops
+            continue;
+        if(instruction.immediate)
+            mFunctions.push_back({ instruction.immediate, 0 });
     }
     sortCleanup();
 }
@@ -71,8 +67,9 @@ void LinearAnalysis::analyseFunctions()
         auto end = findFunctionEnd(function.start, maxaddr);
         if(end)
         {
-            if(mCp.Disassemble(end, translateAddr(end), MAX_DISASM_BUFFER))
-                function.end = end + mCp.Size() - 1;
+            InstructionCache::Instruction instruction;
+            if(decode(end, instruction))
+                function.end = end + instruction.size - 1;
             else
                 function.end = end;
         }
@@ -82,10 +79,11 @@ void LinearAnalysis::analyseFunctions()
 duint LinearAnalysis::findFunctionEnd(duint start, duint maxaddr)
 {
     //disassemble first instruction for some heuristics
-    if(mCp.Disassemble(start, translateAddr(start), MAX_DISASM_BUFFER))
+    InstructionCache::Instruction instruction;
+    if(decode(start, instruction))
     {
         //JMP [123456] ; import
-        if(mCp.InGroup(CS_GRP_JUMP) && mCp.x86().operands[0].type == X86_OP_MEM)
+        if(instruction.Is(InstructionCache::FlagJump) && instruction.Is(InstructionCache::FlagOp0Mem))
             return 0;
     }
 
@@ -94,15 +92,14 @@ duint LinearAnalysis::findFunctionEnd(duint start, duint maxaddr)
     duint jumpback = 0;
     for(duint addr = start, fardest = 0; addr < maxaddr;)
     {
-        if(mCp.Disassemble(addr, translateAddr(addr), MAX_DISASM_BUFFER))
+        if(decode(addr, instruction))
         {
-            if(addr + mCp.Size() > maxaddr)  //we went past the maximum allowed address
+            if(addr + instruction.size > maxaddr)  //we went past the maximum allowed address
                 break;
 
-            const auto & op = mCp.x86().operands[0];
-            if((mCp.InGroup(CS_GRP_JUMP) || mCp.IsLoop()) && op.type == X86_OP_IMM)   //jump
+            if(instruction.Is(InstructionCache::FlagJump) && instruction.Is(InstructionCache::FlagOp0Imm))   //jump
             {
-                auto dest = duint(op.imm);
+                auto dest = instruction.destination;
 
                 if(dest >= maxaddr)   //jump across function boundaries
                 {
@@ -112,39 +109,22 @@ duint LinearAnalysis::findFunctionEnd(duint start, duint maxaddr)
                 {
                     fardest = dest;
                 }
-                else if(end && dest < end && (mCp.GetId() == X86_INS_JMP || mCp.GetId() == X86_INS_LOOP)) //save the last JMP backwards
+                else if(end && dest < end && (instruction.Is(InstructionCache::FlagJmp) || instruction.Is(InstructionCache::FlagLoopInsn))) //save the last JMP backwards
                 {
                     jumpback = addr;
                 }
             }
-            else if(mCp.InGroup(CS_GRP_RET))   //possible function end?
+            else if(instruction.Is(InstructionCache::FlagRet))   //possible function end?
             {
                 end = addr;
                 if(fardest < addr)  //we stop if the farthest JXX destination forward is before this RET
                     break;
             }
 
-            addr += mCp.Size();
+            addr += instruction.size;
         }
         else
             addr++;
     }
     return end < jumpback ? jumpback : end;
-}
-
-duint LinearAnalysis::getReferenceOperand() const
-{
-    for(auto i = 0; i < mCp.OpCount(); i++)
-    {
-        const auto & op = mCp.x86().operands[i];
-        if(mCp.InGroup(CS_GRP_JUMP) || mCp.IsLoop())  //skip jumps/loops
-            continue;
-        if(op.type == X86_OP_IMM)  //we are looking for immediate references
-        {
-            auto dest = duint(op.imm);
-            if(inRange(dest))
-                return dest;
-        }
-    }
-    return 0;
 }
\ No newline at end of file
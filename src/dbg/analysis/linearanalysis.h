@@ -34,7 +34,6 @@ private:
     void populateReferences();
     void analyseFunctions();
     duint findFunctionEnd(duint start, duint maxaddr);
-    duint getReferenceOperand() const;
 };
 
 #endif //_LINEARANALYSIS_H
\ No newline at end of file
@@ -61,6 +61,8 @@ void RecursiveAnalysis::analyzeFunction(duint entryPoint)
     CFGraph graph(entryPoint);
     UintSet visited;
     std::queue<duint> queue;
+    InstructionCache::Instruction instruction;
+    instruction.address = 0;
     queue.push(graph.entryPoint);
     while(!queue.empty())
     {
@@ -82,47 +84,37 @@ void RecursiveAnalysis::analyzeFunction(duint entryPoint)
         {
             if(!inRange(node.end))
             {
-                node.end = mCp.Address();
+                node.end = instruction.address;
                 node.terminal = true;
                 graph.AddNode(node);
                 break;
             }
 
             node.icount++;
-            if(!mCp.Disassemble(node.end, translateAddr(node.end)))
+            if(!decode(node.end, instruction))
             {
                 node.end++;
                 continue;
             }
 
             //do xref analysis on the instruction
-            XREF xref;
-            xref.addr = 0;
-            xref.from = mCp.Address();
-            for(auto i = 0; i < mCp.OpCount(); i++)
+            if(instruction.reference)
             {
-                duint dest = mCp.ResolveOpValue(i, [](x86_reg)->size_t
-                {
-                    return 0;
-                });
-                if(inRange(dest))
-                {
-                    xref.addr = dest;
-                    break;
-                }
-            }
-            if(xref.addr)
+                XREF xref;
+                xref.addr = instruction.reference;
+                xref.from = instruction.address;
                 mXrefs.push_back(xref);
+            }
 
-            if(mCp.InGroup(CS_GRP_JUMP) || mCp.IsLoop()) //jump
+            if(instruction.Is(InstructionCache::FlagJump)) //jump
             {
                 //set the branch destinations
-                node.brtrue = mCp.BranchDestination();
-                if(mCp.GetId() != X86_INS_JMP && mCp.GetId() != X86_INS_LJMP)  //unconditional jumps dont have a brfalse
-                    node.brfalse = node.end + mCp.Size();
+                node.brtrue = instruction.destination;
+                if(!instruction.Is(InstructionCache::FlagJmp) && !instruction.Is(InstructionCache::FlagLjmp))  //unconditional jumps dont have a brfalse
+                    node.brfalse = node.end + instruction.size;
 
                 //consider register/memory branches as terminal nodes
-                if(mCp[0].type != X86_OP_IMM)
+                if(!instruction.Is(InstructionCache::FlagOp0Imm))
                     node.terminal = true;
 
                 //add node to the function graph
@@ -136,17 +128,17 @@ void RecursiveAnalysis::analyzeFunction(duint entryPoint)
 
                 break;
             }
-            if(mCp.InGroup(CS_GRP_CALL))  //call
+            if(instruction.Is(InstructionCache::FlagCall))  //call
             {
                 //TODO: add this to a queue to be analyzed later
             }
-            if(mCp.InGroup(CS_GRP_RET))  //return
+            if(instruction.Is(InstructionCache::FlagRet))  //return
             {
                 node.terminal = true;
                 graph.AddNode(node);
                 break;
             }
-            node.end += mCp.Size();
+            node.end += instruction.size;
         }
     }
     //second pass: split overlapping blocks introduced by backedges
@@ -158,7 +150,7 @@ void RecursiveAnalysis::analyzeFunction(duint entryPoint)
         while(addr < node.end)
         {
             icount++;
-            auto size = mCp.Disassemble(addr, translateAddr(addr)) ? mCp.Size() : 1;
+            auto size = decode(addr, instruction) ? instruction.size : 1;
             if(graph.nodes.count(addr + size))
             {
                 node.end = addr;
@@ -187,7 +179,7 @@ void RecursiveAnalysis::analyzeFunction(duint entryPoint)
             node.brtrue = 0;
         if(!node.icount)
             continue;
-        auto size = node.end - node.start + (mCp.Disassemble(node.end, translateAddr(node.end)) ? mCp.Size() : 1);
+        auto size = node.end - node.start + (decode(node.end, instruction) ? instruction.size : 1);
         node.data.resize(size);
         for(duint i = 0; i < size; i++)
             node.data[i] = inRange(node.start + i) ? *translateAddr(node.start + i) : 0;
@@ -0,0 +1,173 @@
+#include "workpool.h"
+
+WorkPool::WorkPool(size_t Workers)
+    : mQueued(0),
+      mStop(false)
+{
+    for(size_t i = 0; i <= Workers; i++)
+        mQueues.push_back(std::unique_ptr<Queue>(new Queue));
+    mWorkers.reserve(Workers);
+    for(size_t i = 0; i < Workers; i++)
+        mWorkers.push_back(std::thread(&WorkPool::worker, this, i));
+}
+
+WorkPool::~WorkPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mSleepLock);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for(auto & thread : mWorkers)
+        thread.join();
+}
+
+void WorkPool::ParallelFor(size_t Count, size_t Grain, const ChunkFunction & Body)
+{
+    if(!Grain)
+        Grain = 1;
+    if(Count <= Grain || mWorkers.empty())
+    {
+        for(size_t start = 0; start < Count; start += Grain)
+            Body(start / Grain, start, Count - start > Grain ? start + Grain : Count);
+        return;
+    }
+
+    Job job;
+    job.body = &Body;
+    job.grain = Grain;
+    job.remaining = Count;
+    auto index = self();
+    Task task = { &job, 0, Count };
+    run(index, task);
+
+    //help with the pending tasks (of any job) until the stolen parts of this job are done
+    while(job.remaining)
+    {
+        if(pop(index, task) || steal(index, task))
+            run(index, task);
+        else
+        {
+            //the other parts are being executed, sleep until the last one is done
+            std::unique_lock<std::mutex> lock(job.lock);
+            job.done.wait(lock, [&job]()
+            {
+                return job.remaining == 0;
+            });
+        }
+    }
+    //the thread that finished the last part may still be signaling, wait until it released the job
+    std::lock_guard<std::mutex> lock(job.lock);
+}
+
+size_t WorkPool::Grain(size_t Count, size_t Minimum) const
+{
+    auto grain = Count / (Threads() * 8);
+    if(grain < Minimum)
+        grain = Minimum;
+    return grain ? grain : 1;
+}
+
+WorkPool & WorkPool::Global()
+{
+    //never destroyed, joining the workers while the DLL is unloaded would deadlock
+    static std::once_flag once;
+    static WorkPool* pool;
+    std::call_once(once, []()
+    {
+        size_t threads = std::thread::hardware_concurrency();
+        if(threads > 1) //don't consume 100% of the CPU
+            threads -= 1;
+        pool = new WorkPool(threads ? threads - 1 : 0); //the calling thread is the last one
+    });
+    return *pool;
+}
+
+size_t WorkPool::self() const
+{
+    auto id = std::this_thread::get_id();
+    for(size_t i = 0; i < mWorkers.size(); i++)
+        if(mWorkers[i].get_id() == id)
+            return i;
+    return mWorkers.size();
+}
+
+void WorkPool::push(size_t Index, const Task & task)
+{
+    mQueued++;
+    {
+        auto & queue = *mQueues[Index];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        queue.tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mSleepLock);
+    }
+    mWake.notify_one();
+}
+
+bool WorkPool::pop(size_t Index, Task & task)
+{
+    auto & queue = *mQueues[Index];
+    std::lock_guard<std::mutex> lock(queue.lock);
+    if(queue.tasks.empty())
+        return false;
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    mQueued--;
+    return true;
+}
+
+bool WorkPool::steal(size_t Index, Task & task)
+{
+    for(size_t i = 1; i < mQueues.size(); i++)
+    {
+        auto & queue = *mQueues[(Index + i) % mQueues.size()];
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if(queue.tasks.empty())
+            continue;
+        task = queue.tasks.front();
+        queue.tasks.pop_front();
+        mQueued--;
+        return true;
+    }
+    return false;
+}
+
+void WorkPool::run(size_t Index, Task task)
+{
+    auto job = task.job;
+    auto grain = job->grain;
+    while(task.end - task.start > grain)
+    {
+        //split on a chunk boundary and leave the upper half for the thieves
+        Task upper = { job, task.start + ChunkCount(task.end - task.start, grain) / 2 * grain, task.end };
+        push(Index, upper);
+        task.end = upper.start;
+    }
+    (*job->body)(task.start / grain, task.start, task.end);
+    std::lock_guard<std::mutex> lock(job->lock); //the job can be gone once this is released
+    job->remaining -= task.end - task.start;
+    if(!job->remaining)
+        job->done.notify_all();
+}
+
+void WorkPool::worker(size_t Index)
+{
+    while(true)
+    {
+        Task task;
+        if(pop(Index, task) || steal(Index, task))
+        {
+            run(Index, task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mSleepLock);
+        mWake.wait(lock, [this]()
+        {
+            return mQueued != 0 || mStop;
+        });
+        if(mStop)
+            return;
+    }
+}
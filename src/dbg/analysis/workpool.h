@@ -0,0 +1,82 @@
+#ifndef _WORKPOOL_H
+#define _WORKPOOL_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <functional>
+
+//Work-stealing thread pool for the analysis passes (it only depends on the standard library).
+//Ranges are split in halves on chunk boundaries, idle threads steal the biggest pending halves.
+class WorkPool
+{
+public:
+    typedef std::function<void(size_t Chunk, size_t Start, size_t End)> ChunkFunction;
+
+    explicit WorkPool(size_t Workers);
+    ~WorkPool();
+    WorkPool(const WorkPool & that) = delete;
+    WorkPool & operator=(const WorkPool & that) = delete;
+
+    //Calls Body for every chunk of Grain items in [0, Count) and returns when all of them are done.
+    //The calling thread executes tasks while it waits, so this can be nested inside Body.
+    void ParallelFor(size_t Count, size_t Grain, const ChunkFunction & Body);
+
+    //Grain that gives every thread about 8 chunks, but not less than Minimum items
+    size_t Grain(size_t Count, size_t Minimum) const;
+
+    size_t Threads() const
+    {
+        return mWorkers.size() + 1;
+    }
+
+    static size_t ChunkCount(size_t Count, size_t Grain)
+    {
+        return (Count + Grain - 1) / Grain;
+    }
+
+    static WorkPool & Global();
+
+private:
+    struct Job
+    {
+        const ChunkFunction* body;
+        size_t grain;
+        std::atomic<size_t> remaining; //items that were not processed yet
+        std::mutex lock;
+        std::condition_variable done; //signaled when remaining drops to zero
+    };
+
+    struct Task
+    {
+        Job* job;
+        size_t start;
+        size_t end;
+    };
+
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks; //the owner works at the back, thieves take from the front
+    };
+
+    std::vector<std::thread> mWorkers;
+    std::vector<std::unique_ptr<Queue>> mQueues; //one per worker, the last one is shared by the other threads
+    std::mutex mSleepLock;
+    std::condition_variable mWake;
+    std::atomic<size_t> mQueued;
+    bool mStop;
+
+    size_t self() const;
+    void push(size_t Index, const Task & task);
+    bool pop(size_t Index, Task & task);
+    bool steal(size_t Index, Task & task);
+    void run(size_t Index, Task task);
+    void worker(size_t Index);
+};
+
+#endif //_WORKPOOL_H
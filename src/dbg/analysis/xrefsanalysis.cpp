@@ -7,32 +7,17 @@ void XrefsAnalysis::Analyse()
     dputs("Starting xref analysis...");
     auto ticks = GetTickCount();
 
-    for(auto addr = mBase; addr < mBase + mSize;)
+    const auto & cache = instructions();
+    for(size_t i = 0; i < cache.Count(); i++)
     {
-        if(!mCp.Disassemble(addr, translateAddr(addr)))
-        {
-            addr++;
+        const auto & instruction = cache[i];
+        if(!instruction.reference)
             continue;
-        }
-        addr += mCp.Size();
 
         XREF xref;
-        xref.addr = 0;
-        xref.from = mCp.Address();
-        for(auto i = 0; i < mCp.OpCount(); i++)
-        {
-            duint dest = mCp.ResolveOpValue(i, [](x86_reg)->size_t
-            {
-                return 0;
-            });
-            if(inRange(dest))
-            {
-                xref.addr = dest;
-                break;
-            }
-        }
-        if(xref.addr)
-            mXrefs.push_back(xref);
+        xref.addr = instruction.reference;
+        xref.from = instruction.address;
+        mXrefs.push_back(xref);
     }
 
     dprintf("%u xrefs found in %ums!\n", mXrefs.size(), GetTickCount() - ticks);
@@ -1,5 +1,6 @@
 #include "animate.h"
 #include "x64_dbg.h"
+#include "guiupdate.h"
 
 static char animate_command[deflen];
 static unsigned int animate_interval = 50;
@@ -19,6 +20,8 @@ static DWORD WINAPI animateThread(void* arg1)
             Sleep(beforeTime + animate_interval - currentTime);
         }
     }
+    // Show the last step
+    GuiUpdateFlush();
     // Close the handle itself
     HANDLE hAnimateThread2 = hAnimateThread;
     hAnimateThread = nullptr;
@@ -72,3 +72,8 @@ bool BookmarkGetInfo(duint Address, BOOKMARKSINFO* info)
 {
     return bookmarks.GetInfo(Bookmarks::VaKey(Address), info);
 }
+
+duint BookmarkGetGeneration()
+{
+    return bookmarks.Generation();
+}
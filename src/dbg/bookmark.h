@@ -18,5 +18,6 @@ bool BookmarkEnum(BOOKMARKSINFO* List, size_t* Size);
 void BookmarkClear();
 void BookmarkGetList(std::vector<BOOKMARKSINFO> & list);
 bool BookmarkGetInfo(duint Address, BOOKMARKSINFO* info);
+duint BookmarkGetGeneration();
 
 #endif // _BOOKMARK_H
\ No newline at end of file
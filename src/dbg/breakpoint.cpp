@@ -11,9 +11,38 @@
 #include "value.h"
 #include "debugger.h"
 #include "exception.h"
+#include "changejournal.h"
+#include <atomic>
 
 typedef std::pair<BP_TYPE, duint> BreakpointKey;
 std::map<BreakpointKey, BREAKPOINT> breakpoints;
+static std::atomic<duint> bpGeneration(0); //incremented every time a breakpoint changes, except for the hit counts
+
+// What a view needs to find the row of a breakpoint again after it was removed
+struct BreakpointRow
+{
+    duint addr; // rva relative to the base of mod
+    char mod[MAX_MODULE_SIZE];
+};
+
+typedef ChangeJournal<BreakpointKey, BreakpointRow> BreakpointChanges;
+static BreakpointChanges bpChanges; //every change of a breakpoint, the hit counts included
+
+static BreakpointKey bpKey(const BREAKPOINT & bp)
+{
+    if(bp.type != BPDLL && bp.type != BPEXCEPTION)
+        return BreakpointKey(bp.type, ModHashFromName(bp.mod) + bp.addr);
+    return BreakpointKey(bp.type, bp.addr);
+}
+
+// The caller holds LockBreakpoints
+static void bpChanged(BreakpointChanges::Kind kind, const BREAKPOINT & bp)
+{
+    BreakpointRow row;
+    row.addr = bp.addr;
+    strncpy_s(row.mod, bp.mod, _TRUNCATE);
+    bpChanges.Record(kind, bpKey(bp), row);
+}
 
 static void setBpActive(BREAKPOINT & bp)
 {
@@ -107,15 +136,13 @@ bool BpNew(duint Address, bool Enable, bool Singleshot, short OldBytes, BP_TYPE
 
     // Insert new entry to the global list
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
-    if(Type != BPDLL && Type != BPEXCEPTION)
-    {
-        return breakpoints.insert(std::make_pair(BreakpointKey(Type, ModHashFromAddr(Address)), bp)).second;
-    }
-    else
-    {
-        return breakpoints.insert(std::make_pair(BreakpointKey(Type, Address), bp)).second;
-    }
+    BreakpointKey key(Type, Type != BPDLL && Type != BPEXCEPTION ? ModHashFromAddr(Address) : Address);
+    if(!breakpoints.insert(std::make_pair(key, bp)).second)
+        return false;
+    bpChanged(BreakpointChanges::Added, bp);
+    return true;
 }
 
 bool BpNewDll(const char* module, bool Enable, bool Singleshot, DWORD TitanType, const char* Name)
@@ -137,8 +164,12 @@ bool BpNewDll(const char* module, bool Enable, bool Singleshot, DWORD TitanType,
 
     // Insert new entry to the global list
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
-    return breakpoints.insert(std::make_pair(BreakpointKey(BPDLL, bp.addr), bp)).second;
+    if(!breakpoints.insert(std::make_pair(BreakpointKey(BPDLL, bp.addr), bp)).second)
+        return false;
+    bpChanged(BreakpointChanges::Added, bp);
+    return true;
 }
 
 bool BpGet(duint Address, BP_TYPE Type, const char* Name, BREAKPOINT* Bp)
@@ -220,6 +251,7 @@ bool BpUpdateDllPath(const char* module1, BREAKPOINT** newBpInfo)
 {
     const char* dashPos1 = max(strrchr(module1, '\\'), strrchr(module1, '/'));
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
     for(auto & i : breakpoints)
     {
         if(i.second.type == BPDLL && i.second.enabled)
@@ -230,8 +262,10 @@ bool BpUpdateDllPath(const char* module1, BREAKPOINT** newBpInfo)
                 temp = i.second;
                 strcpy_s(temp.mod, module1);
                 temp.addr = ModHashFromName(module1);
+                bpChanged(BreakpointChanges::Removed, i.second);
                 breakpoints.erase(i.first);
                 auto newItem = breakpoints.insert(std::make_pair(BreakpointKey(BPDLL, temp.addr), temp));
+                bpChanged(BreakpointChanges::Added, temp);
                 *newBpInfo = &newItem.first->second;
                 return true;
             }
@@ -246,8 +280,10 @@ bool BpUpdateDllPath(const char* module1, BREAKPOINT** newBpInfo)
                 temp = i.second;
                 strcpy_s(temp.mod, dashPos1 + 1);
                 temp.addr = ModHashFromName(dashPos1 + 1);
+                bpChanged(BreakpointChanges::Removed, i.second);
                 breakpoints.erase(i.first);
                 auto newItem = breakpoints.insert(std::make_pair(BreakpointKey(BPDLL, temp.addr), temp));
+                bpChanged(BreakpointChanges::Added, temp);
                 *newBpInfo = &newItem.first->second;
                 return true;
             }
@@ -271,18 +307,22 @@ bool BpDelete(duint Address, BP_TYPE Type)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Erase the index from the global list
-    if(Type != BPDLL)
-        return (breakpoints.erase(BreakpointKey(Type, ModHashFromAddr(Address))) > 0);
-    else
-        return (breakpoints.erase(BreakpointKey(BPDLL, Address)) > 0);
+    auto found = breakpoints.find(Type != BPDLL ? BreakpointKey(Type, ModHashFromAddr(Address)) : BreakpointKey(BPDLL, Address));
+    if(found == breakpoints.end())
+        return false;
+    bpChanged(BreakpointChanges::Removed, found->second);
+    breakpoints.erase(found);
+    return true;
 }
 
 bool BpEnable(duint Address, BP_TYPE Type, bool Enable)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Check if the breakpoint exists first
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -290,6 +330,8 @@ bool BpEnable(duint Address, BP_TYPE Type, bool Enable)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     bpInfo->enabled = Enable;
 
     //Re-read oldbytes
@@ -305,6 +347,7 @@ bool BpSetName(duint Address, BP_TYPE Type, const char* Name)
 {
     ASSERT_DEBUGGING("Future(?): This is not used anywhere");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // If a name wasn't supplied, set to nothing
     if(!Name)
@@ -316,6 +359,8 @@ bool BpSetName(duint Address, BP_TYPE Type, const char* Name)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     strncpy_s(bpInfo->name, Name, _TRUNCATE);
     return true;
 }
@@ -324,6 +369,7 @@ bool BpSetTitanType(duint Address, BP_TYPE Type, int TitanType)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set the TitanEngine type, separate from BP_TYPE
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -331,6 +377,8 @@ bool BpSetTitanType(duint Address, BP_TYPE Type, int TitanType)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     bpInfo->titantype = TitanType;
     return true;
 }
@@ -339,6 +387,7 @@ bool BpSetBreakCondition(duint Address, BP_TYPE Type, const char* Condition)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint breakCondition
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -346,6 +395,8 @@ bool BpSetBreakCondition(duint Address, BP_TYPE Type, const char* Condition)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     strncpy_s(bpInfo->breakCondition, Condition, _TRUNCATE);
     return true;
 }
@@ -354,6 +405,7 @@ bool BpSetLogText(duint Address, BP_TYPE Type, const char* Log)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint logText
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -361,6 +413,8 @@ bool BpSetLogText(duint Address, BP_TYPE Type, const char* Log)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     strncpy_s(bpInfo->logText, Log, _TRUNCATE);
     return true;
 }
@@ -369,6 +423,7 @@ bool BpSetLogCondition(duint Address, BP_TYPE Type, const char* Condition)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint logText
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -376,6 +431,8 @@ bool BpSetLogCondition(duint Address, BP_TYPE Type, const char* Condition)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     strncpy_s(bpInfo->logCondition, Condition, _TRUNCATE);
     return true;
 }
@@ -384,6 +441,7 @@ bool BpSetCommandText(duint Address, BP_TYPE Type, const char* Cmd)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint hit command
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -391,6 +449,8 @@ bool BpSetCommandText(duint Address, BP_TYPE Type, const char* Cmd)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     strncpy_s(bpInfo->commandText, Cmd, _TRUNCATE);
     return true;
 }
@@ -399,6 +459,7 @@ bool BpSetCommandCondition(duint Address, BP_TYPE Type, const char* Condition)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint hit command
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -406,6 +467,8 @@ bool BpSetCommandCondition(duint Address, BP_TYPE Type, const char* Condition)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     strncpy_s(bpInfo->commandCondition, Condition, _TRUNCATE);
     return true;
 }
@@ -414,6 +477,7 @@ bool BpSetFastResume(duint Address, BP_TYPE Type, bool fastResume)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint fast resume
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -421,6 +485,8 @@ bool BpSetFastResume(duint Address, BP_TYPE Type, bool fastResume)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     bpInfo->fastResume = fastResume;
     return true;
 }
@@ -429,6 +495,7 @@ bool BpSetSingleshoot(duint Address, BP_TYPE Type, bool singleshoot)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint fast resume
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -436,6 +503,8 @@ bool BpSetSingleshoot(duint Address, BP_TYPE Type, bool singleshoot)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     bpInfo->singleshoot = singleshoot;
     return true;
 }
@@ -444,6 +513,7 @@ bool BpSetSilent(duint Address, BP_TYPE Type, bool silent)
 {
     ASSERT_DEBUGGING("Command function call");
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     // Set breakpoint fast resume
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
@@ -451,6 +521,8 @@ bool BpSetSilent(duint Address, BP_TYPE Type, bool silent)
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     bpInfo->silent = silent;
     return true;
 }
@@ -543,16 +615,69 @@ uint32 BpGetHitCount(duint Address, BP_TYPE Type)
 bool BpResetHitCount(duint Address, BP_TYPE Type, uint32 newHitCount)
 {
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
 
     BREAKPOINT* bpInfo = BpInfoFromAddr(Type, Address);
 
     if(!bpInfo)
         return false;
 
+    bpChanged(BreakpointChanges::Modified, *bpInfo);
+
     bpInfo->hitcount = newHitCount;
     return true;
 }
 
+void BpIncreaseHitCount(BREAKPOINT* Bp)
+{
+    // The caller holds LockBreakpoints shared, the hit count only changes the breakpoint list, not the markers
+    InterlockedIncrement(&Bp->hitcount);
+    bpChanged(BreakpointChanges::Modified, *Bp);
+}
+
+duint BpGetGeneration()
+{
+    return bpGeneration;
+}
+
+bool BpGetChanges(duint* Sequence, std::vector<BPCHANGE> & Changes)
+{
+    ASSERT_NONNULL(Sequence);
+    SHARED_ACQUIRE(LockBreakpoints);
+
+    std::vector<BreakpointChanges::Change> changes;
+    size_t current;
+    bool result = bpChanges.Since(*Sequence, changes, current);
+    *Sequence = current;
+    Changes.clear();
+    for(const auto & change : changes)
+    {
+        BREAKPOINT bp;
+        BPCHANGE bridgeChange;
+        auto found = breakpoints.find(change.key);
+        if(change.kind != BreakpointChanges::Removed && found != breakpoints.end())
+        {
+            bp = found->second;
+            bridgeChange.kind = change.kind == BreakpointChanges::Added ? BpChangeAdded : BpChangeModified;
+        }
+        else
+        {
+            // Only the type, address and module of a removed breakpoint are known
+            memset(&bp, 0, sizeof(bp));
+            bp.type = change.key.first;
+            bp.addr = change.value.addr;
+            strncpy_s(bp.mod, change.value.mod, _TRUNCATE);
+            bridgeChange.kind = BpChangeRemoved;
+        }
+        if(bp.type != BPDLL && bp.type != BPEXCEPTION)
+            bp.addr += ModBaseFromName(bp.mod);
+        setBpActive(bp);
+        BpToBridge(&bp, &bridgeChange.bp);
+        Changes.push_back(bridgeChange);
+    }
+    return result;
+}
+
 void BpToBridge(const BREAKPOINT* Bp, BRIDGEBP* BridgeBp)
 {
     //
@@ -687,6 +812,8 @@ static void loadStringValue(JSON value, T & dest, const char* key)
 void BpCacheLoad(JSON Root)
 {
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
+    bpChanges.Reset();
 
     // Remove all existing elements
     breakpoints.clear();
@@ -743,5 +870,7 @@ void BpCacheLoad(JSON Root)
 void BpClear()
 {
     EXCLUSIVE_ACQUIRE(LockBreakpoints);
+    bpGeneration++;
+    bpChanges.Reset();
     breakpoints.clear();
 }
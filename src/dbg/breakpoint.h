@@ -2,6 +2,7 @@
 #define _BREAKPOINT_H
 
 #include "_global.h"
+#include "_dbgfunctions.h"
 
 #define TITANSETDRX(titantype, drx) titantype &= 0x0FF; titantype |= (drx<<8)
 #define TITANGETDRX(titantype) (titantype >> 8) & 0xF
@@ -67,6 +68,9 @@ bool BpEnumAll(BPENUMCALLBACK EnumCallback);
 int BpGetCount(BP_TYPE Type, bool EnabledOnly = false);
 uint32 BpGetHitCount(duint Address, BP_TYPE Type);
 bool BpResetHitCount(duint Address, BP_TYPE Type, uint32 newHitCount);
+void BpIncreaseHitCount(BREAKPOINT* Bp);
+duint BpGetGeneration();
+bool BpGetChanges(duint* Sequence, std::vector<BPCHANGE> & Changes);
 void BpToBridge(const BREAKPOINT* Bp, BRIDGEBP* BridgeBp);
 void BpCacheSave(JSON Root);
 void BpCacheLoad(JSON Root);
@@ -0,0 +1,118 @@
+#ifndef _CHANGEJOURNAL_H
+#define _CHANGEJOURNAL_H
+
+#include <cstddef>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Numbered log of the changes to keyed items, so a view only applies the items that changed since
+ * the last time it looked (it only depends on the standard library). A modification of the item that changed
+ * last is merged into that change, so a burst of hit count updates takes one entry. Only the last capacity
+ * changes are kept, a reader that is further behind (or that is before a Reset) has to reload everything.
+**/
+template<typename Key, typename Value>
+class ChangeJournal
+{
+public:
+    enum Kind
+    {
+        Added,
+        Modified,
+        Removed
+    };
+
+    struct Change
+    {
+        size_t sequence;
+        Kind kind;
+        Key key;
+        Value value;
+    };
+
+    explicit ChangeJournal(size_t capacity = 4096)
+        : sequence(0),
+          oldest(0),
+          capacity(std::max(capacity, size_t(1)))
+    {
+    }
+
+    void Record(Kind kind, const Key & key, const Value & value)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if(kind == Modified && !changes.empty() && changes.back().kind == Modified && changes.back().key == key)
+        {
+            changes.back().sequence = ++sequence;
+            changes.back().value = value;
+            return;
+        }
+        Change change = { ++sequence, kind, key, value };
+        changes.push_back(change);
+        if(changes.size() > capacity)
+        {
+            oldest = changes.front().sequence;
+            changes.pop_front();
+        }
+    }
+
+    //Every item changed (cleared or loaded again)
+    void Reset()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        changes.clear();
+        oldest = ++sequence;
+    }
+
+    size_t Sequence()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return sequence;
+    }
+
+    //The changes after since, one per item: Added when it did not exist at since, Removed when it does not exist now.
+    //Returns false when these changes are not known anymore. current is the sequence to pass next time.
+    bool Since(size_t since, std::vector<Change> & result, size_t & current)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        result.clear();
+        current = sequence;
+        if(since < oldest || since > sequence)
+            return false;
+
+        auto first = std::upper_bound(changes.begin(), changes.end(), since, [](size_t after, const Change & change)
+        {
+            return after < change.sequence;
+        });
+        std::map<Key, std::pair<size_t, bool>> items; //key -> index in result, added after since
+        for(auto i = first; i != changes.end(); ++i)
+        {
+            auto found = items.find(i->key);
+            if(found == items.end())
+            {
+                items.insert(std::make_pair(i->key, std::make_pair(result.size(), i->kind == Added)));
+                result.push_back(*i);
+                continue;
+            }
+            auto & change = result[found->second.first];
+            if(i->kind == Removed)
+                change.kind = Removed;
+            else
+                change.kind = found->second.second ? Added : Modified;
+            change.sequence = i->sequence;
+            change.value = i->value;
+        }
+        return true;
+    }
+
+private:
+    std::mutex lock;
+    std::deque<Change> changes; //sorted by sequence
+    size_t sequence; //of the last change
+    size_t oldest; //readers before this sequence reload everything
+    size_t capacity;
+};
+
+#endif //_CHANGEJOURNAL_H
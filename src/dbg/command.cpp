@@ -12,6 +12,7 @@
 #include "variable.h"
 
 COMMAND* cmd_list = 0;
+static unsigned int cmd_generation = 1; //changes when a command lookup might give a different result
 
 static bool vecContains(std::vector<String>* names, const char* name)
 {
@@ -107,6 +108,7 @@ bool cmdnew(const char* name, CBCOMMAND cbCommand, bool debugonly)
     }
     cmd->cbCommand = cbCommand;
     cmd->debugonly = debugonly;
+    cmd_generation++;
     COMMAND* cur = cmd_list;
     if(!nonext)
     {
@@ -171,6 +173,7 @@ bool cmddel(const char* name)
     COMMAND* found = cmdfind(name, &prev);
     if(!found)
         return false;
+    cmd_generation++;
     delete found->names;
     if(found == cmd_list)
     {
@@ -314,3 +317,12 @@ CMDRESULT cmddirectexec(const char* cmd)
     efree(argv, "cmddirectexec:argv");
     return res;
 }
+
+/**
+\brief Gets the generation of the command list, it changes every time a command is added or deleted.
+\return The command list generation.
+*/
+unsigned int cmdgeneration()
+{
+    return cmd_generation;
+}
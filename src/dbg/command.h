@@ -37,5 +37,6 @@ CBCOMMAND cmdset(const char* name, CBCOMMAND cbCommand, bool debugonly);
 bool cmddel(const char* name);
 CMDRESULT cmdloop(CBCOMMAND cbUnknownCommand, CBCOMMANDPROVIDER cbCommandProvider, CBCOMMANDFINDER cbCommandFinder, bool error_is_fatal);
 CMDRESULT cmddirectexec(const char* cmd);
+unsigned int cmdgeneration();
 
 #endif // _COMMAND_H
@@ -1,4 +1,5 @@
 #include "commandparser.h"
+#include <cstring>
 
 Command::Command(const String & command)
 {
@@ -113,3 +114,38 @@ void Command::dataFinish()
         _data.clear();
     }
 }
+
+void CommandArguments::Parse(const String & command)
+{
+    Command parsed(command);
+    int argcount = parsed.GetArgCount();
+    _command = command;
+    _args.clear();
+    for(int i = 0; i < argcount; i++)
+        _args.push_back(parsed.GetArg(i));
+    _buffer.resize((argcount + 1) * ArgumentSize);
+    _argv.resize(argcount + 1);
+    for(int i = 0; i <= argcount; i++)
+        _argv[i] = _buffer.data() + i * ArgumentSize;
+}
+
+static void copyArgument(char* dest, const String & text)
+{
+    auto length = text.length() < CommandArguments::ArgumentSize ? text.length() : CommandArguments::ArgumentSize - 1;
+    memcpy(dest, text.c_str(), length);
+    dest[length] = '\0';
+}
+
+int CommandArguments::Count() const
+{
+    return (int)_argv.size();
+}
+
+char** CommandArguments::Argv()
+{
+    //the callbacks may modify their arguments
+    copyArgument(_argv[0], _command);
+    for(size_t i = 0; i < _args.size(); i++)
+        copyArgument(_argv[i + 1], _args[i]);
+    return _argv.data();
+}
@@ -1,7 +1,7 @@
 #ifndef _COMMANDPARSER_H
 #define _COMMANDPARSER_H
 
-#include "_global.h"
+#include "stringutils.h"
 
 class Command
 {
@@ -27,4 +27,22 @@ private:
     void dataAppend(const char ch);
 };
 
+//Command parsed once for repeated execution (scripts), argv is rebuilt from the parsed text on every call
+class CommandArguments
+{
+public:
+    void Parse(const String & command);
+    int Count() const;
+    char** Argv();
+
+    //size of every argv buffer, the same as cmddirectexec gives the callbacks (deflen)
+    static const int ArgumentSize = 1024;
+
+private:
+    String _command;
+    std::vector<String> _args;
+    std::vector<char> _buffer;
+    std::vector<char*> _argv;
+};
+
 #endif // _COMMANDPARSER_H
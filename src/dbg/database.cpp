@@ -24,6 +24,8 @@
 #include "plugin_loader.h"
 #include "argument.h"
 #include "debugger.h"
+#include "incrementalanalysis.h"
+#include "memsnapshot.h"
 
 /**
 \brief Directory where program databases are stored (usually in \db). UTF-8 encoding.
@@ -255,6 +257,9 @@ void DbClose()
     LoopClear();
     XrefClear();
     EncodeMapClear();
+    AnalysisDirtyClear();
+    SnapshotClear();
+    InstructionCache::Publish(nullptr);
     BpClear();
     PatchClear();
     GuiSetDebuggeeNotes("");
@@ -1,6 +1,9 @@
 #include "_global.h"
 #include "dbghelp_safe.h"
 #include "threading.h"
+#include <atomic>
+
+static std::atomic<duint> symGeneration(0); //incremented every time symbols are loaded or unloaded
 
 DWORD
 SafeUnDecorateSymbolName(
@@ -21,7 +24,9 @@ SafeSymUnloadModule64(
 )
 {
     EXCLUSIVE_ACQUIRE(LockSym);
-    return SymUnloadModule64(hProcess, BaseOfDll);
+    BOOL result = SymUnloadModule64(hProcess, BaseOfDll);
+    symGeneration++;
+    return result;
 }
 BOOL
 SafeSymSetSearchPathW(
@@ -80,7 +85,9 @@ SafeSymLoadModuleExW(
 )
 {
     EXCLUSIVE_ACQUIRE(LockSym);
-    return SymLoadModuleExW(hProcess, hFile, ImageName, ModuleName, BaseOfDll, DllSize, Data, Flags);
+    DWORD64 result = SymLoadModuleExW(hProcess, hFile, ImageName, ModuleName, BaseOfDll, DllSize, Data, Flags);
+    symGeneration++;
+    return result;
 }
 BOOL
 SafeSymGetModuleInfoW64(
@@ -162,5 +169,12 @@ SafeSymCleanup(
 )
 {
     EXCLUSIVE_ACQUIRE(LockSym);
-    return SymCleanup(hProcess);
-}
\ No newline at end of file
+    BOOL result = SymCleanup(hProcess);
+    symGeneration++;
+    return result;
+}
+
+duint SafeSymGetGeneration()
+{
+    return symGeneration;
+}
@@ -105,4 +105,7 @@ SafeSymCleanup(
     __in HANDLE hProcess
 );
 
+//incremented after every module (re)load and unload and SafeSymCleanup, the symbols of any address can change with it
+duint SafeSymGetGeneration();
+
 #endif //_DBGHELP_SAFE_H
\ No newline at end of file
@@ -23,10 +23,14 @@
 #include "commandline.h"
 #include "stackinfo.h"
 #include "stringformat.h"
+#include "expressionparser.h"
+#include "lrucache.h"
+#include "settingsnapshot.h"
 #include "TraceRecord.h"
 #include "historycontext.h"
 #include "taskthread.h"
 #include "animate.h"
+#include "guiupdate.h"
 #include "simplescript.h"
 #include "capstone_wrapper.h"
 
@@ -92,6 +96,8 @@ bool bSkipInt3Stepping = false;
 bool bIgnoreInconsistentBreakpoints = false;
 bool bNoForegroundWindow = false;
 duint DbgEvents = 0;
+static void readeventsettings(EVENT_SETTINGS & settings);
+static SettingsSnapshot<EVENT_SETTINGS> eventSettings(BridgeSettingGetGeneration, readeventsettings);
 
 static duint dbgcleartracecondition()
 {
@@ -203,7 +209,7 @@ void cbDebuggerPaused()
     dbgClearRtuBreakpoints();
     // Trace record is not handled by this function currently.
     // Signal thread switch warning
-    if(settingboolget("Engine", "HardcoreThreadSwitchWarning"))
+    if(dbgeventsettings()->hardcoreThreadSwitchWarning)
     {
         static DWORD PrevThreadId = 0;
         if(PrevThreadId == 0)
@@ -418,25 +424,19 @@ void DebugUpdateGui(duint disasm_addr, bool stack)
     GuiFocusView(GUI_DISASSEMBLY);
 }
 
-void DebugUpdateGuiSetState(duint disasm_addr, bool stack, DBGSTATE state = paused)
-{
-    GuiSetDebugState(state);
-    DebugUpdateGui(disasm_addr, stack);
-}
 void DebugUpdateGuiSetStateAsync(duint disasm_addr, bool stack, DBGSTATE state)
 {
     // call paused routine to clean up various tracing states.
     if(state == DBGSTATE::paused)
         cbDebuggerPaused();
-    //correctly orders the GuiSetDebugState DebugUpdateGui to prevent drawing inconsistencies
-    static TaskThread_<decltype(&DebugUpdateGuiSetState), duint, bool, DBGSTATE> DebugUpdateGuiSetStateTask(&DebugUpdateGuiSetState);
-    DebugUpdateGuiSetStateTask.WakeUp(disasm_addr, stack, state);
+    //the state is delivered before DebugUpdateGui to prevent drawing inconsistencies
+    //the steps of an animation are always coalesced, a pause is shown right away unless the user keeps stepping
+    GuiUpdateRequest(GUI_UPDATE_STATE | GUI_UPDATE_DISASSEMBLY, disasm_addr, stack, state, state == DBGSTATE::paused && !_dbg_isanimating());
 }
 
 void DebugUpdateGuiAsync(duint disasm_addr, bool stack)
 {
-    static TaskThread_<decltype(&DebugUpdateGui), duint, bool> DebugUpdateGuiTask(&DebugUpdateGui);
-    DebugUpdateGuiTask.WakeUp(disasm_addr, stack);
+    GuiUpdateRequest(GUI_UPDATE_DISASSEMBLY, disasm_addr, stack);
 }
 
 void DebugUpdateBreakpointsViewAsync()
@@ -609,6 +609,12 @@ static void printExceptionBpInfo(const BREAKPOINT & bp, duint CIP)
         dprintf(QT_TRANSLATE_NOOP("DBG", "Exception Breakpoint %s (%p) at %p!\n"), ExceptionCodeToName((unsigned int)bp.addr).c_str(), bp.addr, CIP);
 }
 
+//Breakpoint conditions and log texts are compiled on their first hit (on the debug thread).
+//The text is the key, so changing it compiles it again. Past the limit the least recently hit text is dropped.
+static const size_t BreakpointCacheMax = 1024;
+static LruCache<String, std::shared_ptr<ExpressionParser>> conditionCache(BreakpointCacheMax);
+static LruCache<String, std::shared_ptr<FormatTemplate>> logTemplateCache(BreakpointCacheMax);
+
 static bool getConditionValue(const char* expression)
 {
     auto word = *(uint16*)expression;
@@ -616,16 +622,28 @@ static bool getConditionValue(const char* expression)
         return false;
     if(word == '1')  //short circuit for condition "1\0"
         return true;
+    auto parser = conditionCache.Get(expression, [expression]()
+    {
+        return std::make_shared<ExpressionParser>(expression);
+    });
     duint value;
-    if(valfromstring(expression, &value))
+    if(parser->Calculate(value, valuesignedcalc(), false))
         return value != 0;
     return true;
 }
 
+static String getLogText(const char* logText)
+{
+    auto format = logTemplateCache.Get(logText, [logText]()
+    {
+        return std::make_shared<FormatTemplate>(logText);
+    });
+    return format->Print();
+}
+
 void GuiSetDebugStateAsync(DBGSTATE state)
 {
-    static TaskThread_<decltype(&GuiSetDebugState), DBGSTATE> GuiSetDebugStateTask(&GuiSetDebugState);
-    GuiSetDebugStateTask.WakeUp(state);
+    GuiUpdateRequest(GUI_UPDATE_STATE, 0, false, state, state == paused);
 }
 
 void cbPauseBreakpoint()
@@ -728,7 +746,7 @@ static void cbGenericBreakpoint(BP_TYPE bptype, void* ExceptionAddress = nullptr
     }
 
     // increment hit count
-    InterlockedIncrement(&bpPtr->hitcount);
+    BpIncreaseHitCount(bpPtr);
 
     auto bp = *bpPtr;
     SHARED_RELEASE();
@@ -775,7 +793,7 @@ static void cbGenericBreakpoint(BP_TYPE bptype, void* ExceptionAddress = nullptr
 
     if(*bp.logText && logCondition)  //log
     {
-        dprintf_untranslated("%s\n", stringformatinline(bp.logText).c_str());
+        dprintf_untranslated("%s\n", getLogText(bp.logText).c_str());
     }
     if(*bp.commandText && commandCondition)  //command
     {
@@ -1216,7 +1234,7 @@ static void cbCreateProcess(CREATE_PROCESS_DEBUG_INFO* CreateProcessInfo)
         pDebuggedBase = pCreateProcessBase; //debugged base = executable
         char command[deflen] = "";
 
-        if(settingboolget("Events", "TlsCallbacks"))
+        if(dbgeventsettings()->tlsCallbacks)
         {
             DWORD NumberOfCallBacks = 0;
             TLSGrabCallBackDataW(StringUtils::Utf8ToUtf16(DebugFileName).c_str(), 0, &NumberOfCallBacks);
@@ -1248,13 +1266,13 @@ static void cbCreateProcess(CREATE_PROCESS_DEBUG_INFO* CreateProcessInfo)
             }
         }
 
-        if(settingboolget("Events", "EntryBreakpoint"))
+        if(dbgeventsettings()->entryBreakpoint)
         {
             sprintf_s(command, "bp %p,\"%s\",ss", (duint)CreateProcessInfo->lpStartAddress, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "entry breakpoint")));
             cmddirectexec(command);
         }
 
-        bTraceRecordEnabledDuringTrace = settingboolget("Engine", "TraceRecordEnabledDuringTrace");
+        bTraceRecordEnabledDuringTrace = dbgeventsettings()->traceRecordEnabledDuringTrace;
     }
     GuiUpdateBreakpointsView();
 
@@ -1321,7 +1339,7 @@ static void cbCreateThread(CREATE_THREAD_DEBUG_INFO* CreateThread)
     DWORD dwThreadId = ((DEBUG_EVENT*)GetDebugData())->dwThreadId;
     hActiveThread = ThreadGetHandle(dwThreadId);
 
-    if(settingboolget("Events", "ThreadEntry"))
+    if(dbgeventsettings()->threadEntry)
     {
         String command;
         command = StringUtils::sprintf("bp %p,\"%s %X\",ss", (duint)CreateThread->lpStartAddress, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Thread")), dwThreadId);
@@ -1335,7 +1353,7 @@ static void cbCreateThread(CREATE_THREAD_DEBUG_INFO* CreateThread)
 
     dprintf(QT_TRANSLATE_NOOP("DBG", "Thread %X created, Entry: %p\n"), dwThreadId, CreateThread->lpStartAddress);
 
-    if(settingboolget("Events", "ThreadStart"))
+    if(dbgeventsettings()->threadStart)
     {
         HistoryClear();
         //update memory map
@@ -1375,7 +1393,7 @@ static void cbExitThread(EXIT_THREAD_DEBUG_INFO* ExitThread)
     ThreadExit(dwThreadId);
     dprintf(QT_TRANSLATE_NOOP("DBG", "Thread %X exit\n"), dwThreadId);
 
-    if(settingboolget("Events", "ThreadEnd"))
+    if(dbgeventsettings()->threadEnd)
     {
         //update GUI
         DebugUpdateGuiSetStateAsync(GetContextDataEx(hActiveThread, UE_CIP), true);
@@ -1431,7 +1449,7 @@ static void cbSystemBreakpoint(void* ExceptionData) // TODO: System breakpoint e
     plugincbcall(CB_SYSTEMBREAKPOINT, &callbackInfo);
 
     lock(WAITID_RUN); // Allow the user to run a script file now
-    if(bIsAttached ? settingboolget("Events", "AttachBreakpoint") : settingboolget("Events", "SystemBreakpoint"))
+    if(bIsAttached ? dbgeventsettings()->attachBreakpoint : dbgeventsettings()->systemBreakpoint)
     {
         //lock
         GuiSetDebugStateAsync(paused);
@@ -1480,7 +1498,7 @@ static void cbLoadDll(LOAD_DLL_DEBUG_INFO* LoadDll)
     {
         bIsDebuggingThis = true;
         pDebuggedBase = (duint)base;
-        if(settingboolget("Events", "EntryBreakpoint"))
+        if(dbgeventsettings()->entryBreakpoint)
         {
             bAlreadySetEntry = true;
             sprintf_s(command, "bp %p,\"%s\",ss", pDebuggedBase + pDebuggedEntry, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "entry breakpoint")));
@@ -1489,7 +1507,7 @@ static void cbLoadDll(LOAD_DLL_DEBUG_INFO* LoadDll)
     }
     GuiUpdateBreakpointsView();
 
-    if(settingboolget("Events", "TlsCallbacks"))
+    if(dbgeventsettings()->tlsCallbacks)
     {
         DWORD NumberOfCallBacks = 0;
         TLSGrabCallBackDataW(StringUtils::Utf8ToUtf16(DLLDebugFileName).c_str(), 0, &NumberOfCallBacks);
@@ -1523,7 +1541,7 @@ static void cbLoadDll(LOAD_DLL_DEBUG_INFO* LoadDll)
         }
     }
 
-    if((bBreakOnNextDll || settingboolget("Events", "DllEntry")) && !bAlreadySetEntry)
+    if((bBreakOnNextDll || dbgeventsettings()->dllEntry) && !bAlreadySetEntry)
     {
         auto entry = ModEntryFromAddr(duint(base));
         if(entry)
@@ -1572,7 +1590,7 @@ static void cbLoadDll(LOAD_DLL_DEBUG_INFO* LoadDll)
         bBreakOnNextDll = false;
         cbGenericBreakpoint(BPDLL, DLLDebugFileName);
     }
-    else if(settingboolget("Events", "DllLoad"))
+    else if(dbgeventsettings()->dllLoad)
     {
         //update GUI
         DebugUpdateGuiSetStateAsync(GetContextDataEx(hActiveThread, UE_CIP), true);
@@ -1606,7 +1624,7 @@ static void cbUnloadDll(UNLOAD_DLL_DEBUG_INFO* UnloadDll)
         bBreakOnNextDll = false;
         cbGenericBreakpoint(BPDLL, modname);
     }
-    else if(settingboolget("Events", "DllUnload"))
+    else if(dbgeventsettings()->dllUnload)
     {
         //update GUI
         DebugUpdateGuiSetStateAsync(GetContextDataEx(hActiveThread, UE_CIP), true);
@@ -1650,7 +1668,7 @@ static void cbOutputDebugString(OUTPUT_DEBUG_STRING_INFO* DebugString)
         }
     }
 
-    if(settingboolget("Events", "DebugStrings"))
+    if(dbgeventsettings()->debugStrings)
     {
         //update GUI
         DebugUpdateGuiSetStateAsync(GetContextDataEx(hActiveThread, UE_CIP), true);
@@ -2464,6 +2482,34 @@ void dbgsetforeground()
         SetForegroundWindow(GuiGetWindowHandle());
 }
 
+static void readeventsettings(EVENT_SETTINGS & settings)
+{
+    settings.systemBreakpoint = settingboolget("Events", "SystemBreakpoint");
+    settings.attachBreakpoint = settingboolget("Events", "AttachBreakpoint");
+    settings.tlsCallbacks = settingboolget("Events", "TlsCallbacks");
+    settings.entryBreakpoint = settingboolget("Events", "EntryBreakpoint");
+    settings.dllEntry = settingboolget("Events", "DllEntry");
+    settings.dllLoad = settingboolget("Events", "DllLoad");
+    settings.dllUnload = settingboolget("Events", "DllUnload");
+    settings.threadEntry = settingboolget("Events", "ThreadEntry");
+    settings.threadStart = settingboolget("Events", "ThreadStart");
+    settings.threadEnd = settingboolget("Events", "ThreadEnd");
+    settings.debugStrings = settingboolget("Events", "DebugStrings");
+    settings.hardcoreThreadSwitchWarning = settingboolget("Engine", "HardcoreThreadSwitchWarning");
+    settings.traceRecordEnabledDuringTrace = settingboolget("Engine", "TraceRecordEnabledDuringTrace");
+}
+
+void dbgupdateeventsettings()
+{
+    eventSettings.Update();
+}
+
+std::shared_ptr<const EVENT_SETTINGS> dbgeventsettings()
+{
+    //BridgeSettingSet calls that do not send DBG_SETTINGS_UPDATED change the settings generation
+    return eventSettings.Get();
+}
+
 DWORD WINAPI threadDebugLoop(void* lpParameter)
 {
     debugLoopFunction(lpParameter, false);
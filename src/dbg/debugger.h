@@ -18,6 +18,24 @@ struct INIT_STRUCT
     char* currentfolder;
 };
 
+//settings read by the debug event handlers, parsed again when the settings changed
+struct EVENT_SETTINGS
+{
+    bool systemBreakpoint;
+    bool attachBreakpoint;
+    bool tlsCallbacks;
+    bool entryBreakpoint;
+    bool dllEntry;
+    bool dllLoad;
+    bool dllUnload;
+    bool threadEntry;
+    bool threadStart;
+    bool threadEnd;
+    bool debugStrings;
+    bool hardcoreThreadSwitchWarning;
+    bool traceRecordEnabledDuringTrace;
+};
+
 typedef enum
 {
     CMDL_ERR_READ_PEBBASE = 0,
@@ -111,6 +129,8 @@ bool dbgtraceactive();
 void dbgsetdebuggeeinitscript(const char* fileName);
 const char* dbggetdebuggeeinitscript();
 void dbgsetforeground();
+void dbgupdateeventsettings();
+std::shared_ptr<const EVENT_SETTINGS> dbgeventsettings();
 
 void cbStep();
 void cbRtrStep();
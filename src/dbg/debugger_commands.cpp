@@ -26,6 +26,7 @@
 #include "historycontext.h"
 #include "taskthread.h"
 #include "animate.h"
+#include "memsnapshot.h"
 
 static bool bScyllaLoaded = false;
 duint LoadLibThreadID;
@@ -1033,7 +1034,7 @@ CMDRESULT cbDebugDownloadSymbol(int argc, char* argv[])
     }
     auto symOptions = SafeSymGetOptions();
     SafeSymSetOptions(symOptions & ~SYMOPT_IGNORE_CVREC);
-    if(!SymLoadModuleExW(fdProcessInfo->hProcess, 0, wszModulePath, 0, (DWORD64)modbase, 0, 0, 0)) //load module
+    if(!SafeSymLoadModuleExW(fdProcessInfo->hProcess, 0, wszModulePath, 0, (DWORD64)modbase, 0, 0, 0)) //load module
     {
         dputs(QT_TRANSLATE_NOOP("DBG", "SymLoadModuleEx failed!"));
         SafeSymSetOptions(symOptions);
@@ -1423,6 +1424,73 @@ CMDRESULT cbDebugSetPageRights(int argc, char* argv[])
     return STATUS_CONTINUE;
 }
 
+CMDRESULT cbDebugMemSnapshot(int argc, char* argv[])
+{
+    const char* name = argc > 1 ? argv[1] : "default";
+    duint ticks = GetTickCount();
+    duint pageCount, newPageCount;
+    if(!SnapshotCreate(name, &pageCount, &newPageCount))
+    {
+        dprintf(QT_TRANSLATE_NOOP("DBG", "Failed to create snapshot \"%s\"\n"), name);
+        return STATUS_ERROR;
+    }
+    dprintf(QT_TRANSLATE_NOOP("DBG", "Snapshot \"%s\" created, %u pages (%u new) in %ums\n"), name, (unsigned int)pageCount, (unsigned int)newPageCount, GetTickCount() - ticks);
+    return STATUS_CONTINUE;
+}
+
+CMDRESULT cbDebugMemSnapshotDiff(int argc, char* argv[])
+{
+    const char* oldName = argc > 1 ? argv[1] : "default";
+    const char* newName = argc > 2 ? argv[2] : nullptr;
+    duint ticks = GetTickCount();
+    std::vector<Range> changed;
+    const char* missing;
+    if(!SnapshotDiff(oldName, newName, changed, &missing))
+    {
+        dprintf(QT_TRANSLATE_NOOP("DBG", "Snapshot \"%s\" not found!\n"), missing ? missing : oldName);
+        return STATUS_ERROR;
+    }
+
+    String title = StringUtils::sprintf(GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Snapshot \"%s\" changes")), oldName);
+    GuiReferenceInitialize(title.c_str());
+    GuiReferenceAddColumn(sizeof(duint) * 2, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Address")));
+    GuiReferenceAddColumn(sizeof(duint) * 2, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Size")));
+    GuiReferenceAddColumn(0, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Info")));
+    GuiReferenceSetRowCount(int(changed.size()));
+    for(size_t i = 0; i < changed.size(); i++)
+    {
+        const auto & range = changed[i];
+        char text[MAX_MODULE_SIZE] = "";
+        sprintf_s(text, "%p", range.first);
+        GuiReferenceSetCellContent(int(i), 0, text);
+        sprintf_s(text, "%p", range.second - range.first + 1);
+        GuiReferenceSetCellContent(int(i), 1, text);
+        if(!ModNameFromAddr(range.first, text, true))
+            *text = '\0';
+        GuiReferenceSetCellContent(int(i), 2, text);
+    }
+    GuiReferenceReloadData();
+    dprintf(QT_TRANSLATE_NOOP("DBG", "%u changed range(s) in %ums\n"), (unsigned int)changed.size(), GetTickCount() - ticks);
+    varset("$result", changed.size(), false);
+    return STATUS_CONTINUE;
+}
+
+CMDRESULT cbDebugMemSnapshotDelete(int argc, char* argv[])
+{
+    if(argc < 2)
+    {
+        SnapshotClear();
+        dputs(QT_TRANSLATE_NOOP("DBG", "All snapshots deleted!"));
+        return STATUS_CONTINUE;
+    }
+    if(!SnapshotDelete(argv[1]))
+    {
+        dprintf(QT_TRANSLATE_NOOP("DBG", "Snapshot \"%s\" not found!\n"), argv[1]);
+        return STATUS_ERROR;
+    }
+    return STATUS_CONTINUE;
+}
+
 CMDRESULT cbDebugLoadLib(int argc, char* argv[])
 {
     if(argc < 2)
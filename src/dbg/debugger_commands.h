@@ -136,6 +136,9 @@ CMDRESULT cbDebugLoadLib(int argc, char* argv[]);
 CMDRESULT cbDebugDownloadSymbol(int argc, char* argv[]);
 CMDRESULT cbDebugGetPageRights(int argc, char* argv[]);
 CMDRESULT cbDebugSetPageRights(int argc, char* argv[]);
+CMDRESULT cbDebugMemSnapshot(int argc, char* argv[]);
+CMDRESULT cbDebugMemSnapshotDiff(int argc, char* argv[]);
+CMDRESULT cbDebugMemSnapshotDelete(int argc, char* argv[]);
 CMDRESULT cbDebugSkip(int argc, char* argv[]);
 CMDRESULT cbDebugSetfreezestack(int argc, char* argv[]);
 CMDRESULT cbDebugTraceIntoBeyondTraceRecord(int argc, char* argv[]);
@@ -0,0 +1,55 @@
+/**
+ @file guiupdate.cpp
+
+ @brief Coalesces the GUI update requests and delivers them at most once per frame.
+ */
+
+#include "guiupdate.h"
+#include "debugger.h"
+
+static const unsigned int GuiUpdateDefaultFrameRate = 60;
+//pauses closer together than this are stepping, the last one is shown at the next frame
+static const auto GuiUpdateIdleTimeout = std::chrono::milliseconds(100);
+
+static void guiUpdateDeliver(const GuiUpdateQueue::Update & update)
+{
+    //the state goes first to prevent drawing inconsistencies
+    if(update.views & GUI_UPDATE_STATE)
+        GuiSetDebugState(DBGSTATE(update.state));
+    if(update.views & GUI_UPDATE_DISASSEMBLY)
+        DebugUpdateGui(duint(update.disasmAddr), update.stack); //this also updates all the views
+    if(update.views & GUI_UPDATE_MEMORYMAP)
+        GuiUpdateMemoryView();
+}
+
+static GuiUpdateQueue & guiUpdateQueue()
+{
+    //never destroyed, joining the thread while the DLL is unloaded would deadlock
+    static GuiUpdateQueue* queue = nullptr;
+    static std::once_flag once;
+    std::call_once(once, []()
+    {
+        queue = new GuiUpdateQueue(guiUpdateDeliver, GuiUpdateDefaultFrameRate, GuiUpdateIdleTimeout);
+    });
+    return *queue;
+}
+
+void GuiUpdateRequest(unsigned int Views, duint DisasmAddr, bool Stack, DBGSTATE State, bool Pause)
+{
+    guiUpdateQueue().Request(Views, DisasmAddr, Stack, State, Pause);
+}
+
+void GuiUpdateFlush()
+{
+    guiUpdateQueue().Flush();
+}
+
+void GuiUpdateSetFrameRate(unsigned int FramesPerSecond)
+{
+    guiUpdateQueue().SetFrameRate(FramesPerSecond ? FramesPerSecond : GuiUpdateDefaultFrameRate);
+}
+
+void GuiUpdateGetStats(GUIUPDATESTATS & Stats)
+{
+    Stats = guiUpdateQueue().GetStats();
+}
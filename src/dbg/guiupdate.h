@@ -0,0 +1,14 @@
+#ifndef _GUIUPDATE_H
+#define _GUIUPDATE_H
+
+#include "_global.h"
+#include "guiupdatequeue.h"
+
+//DisasmAddr and Stack are used with GUI_UPDATE_DISASSEMBLY, State with GUI_UPDATE_STATE
+//Pause marks the request of a (non animated) pause, see GuiUpdateQueue::Request
+void GuiUpdateRequest(unsigned int Views, duint DisasmAddr = 0, bool Stack = false, DBGSTATE State = initialized, bool Pause = false);
+void GuiUpdateFlush();
+void GuiUpdateSetFrameRate(unsigned int FramesPerSecond);
+void GuiUpdateGetStats(GUIUPDATESTATS & Stats);
+
+#endif // _GUIUPDATE_H
@@ -0,0 +1,110 @@
+/**
+ @file guiupdatequeue.cpp
+
+ @brief Implements the frame limited queue behind guiupdate.cpp.
+ */
+
+#include "guiupdatequeue.h"
+
+GuiUpdateQueue::GuiUpdateQueue(const Sink & sink, unsigned int framesPerSecond, Clock::duration idleTimeout)
+    : mSink(sink),
+      mFlush(false),
+      mStop(false),
+      mIdleTimeout(idleTimeout)
+{
+    mPending.views = 0;
+    mPending.disasmAddr = 0;
+    mPending.stack = false;
+    mPending.state = 0;
+    mStats.requested = mStats.delivered = mStats.flushed = 0;
+    SetFrameRate(framesPerSecond);
+    mThread = std::thread(&GuiUpdateQueue::loop, this);
+}
+
+//The pending update is dropped, call Flush and wait for the sink first to keep it
+GuiUpdateQueue::~GuiUpdateQueue()
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mThread.join();
+}
+
+void GuiUpdateQueue::Request(unsigned int views, unsigned long long disasmAddr, bool stack, int state, bool pause)
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mPending.views |= views;
+        if(views & GUI_UPDATE_DISASSEMBLY)
+        {
+            mPending.disasmAddr = disasmAddr;
+            mPending.stack |= stack;
+        }
+        if(views & GUI_UPDATE_STATE)
+            mPending.state = state;
+        if(pause)
+        {
+            auto now = Clock::now();
+            if(now - mLastPause >= mIdleTimeout)
+                mFlush = true;
+            mLastPause = now;
+        }
+        mStats.requested++;
+    }
+    mWake.notify_one();
+}
+
+//Delivers the pending update without waiting for the next frame
+void GuiUpdateQueue::Flush()
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if(!mPending.views)
+            return;
+        mFlush = true;
+    }
+    mWake.notify_one();
+}
+
+void GuiUpdateQueue::SetFrameRate(unsigned int framesPerSecond)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    mInterval = std::chrono::milliseconds(1000 / (framesPerSecond ? framesPerSecond : 1));
+}
+
+GUIUPDATESTATS GuiUpdateQueue::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mStats;
+}
+
+void GuiUpdateQueue::loop()
+{
+    auto lastDelivery = Clock::now() - mInterval;
+    std::unique_lock<std::mutex> lock(mLock);
+    while(true)
+    {
+        mWake.wait(lock, [this]()
+        {
+            return mPending.views != 0 || mStop;
+        });
+        //wait for the next frame, the requests that arrive in the meantime are merged
+        while(!mFlush && !mStop && mWake.wait_until(lock, lastDelivery + mInterval) != std::cv_status::timeout)
+            ;
+        if(mStop)
+            break;
+        auto update = mPending;
+        mPending.views = 0;
+        mPending.stack = false;
+        if(mFlush)
+            mStats.flushed++;
+        mFlush = false;
+        mStats.delivered++;
+        lock.unlock();
+        mSink(update);
+        lastDelivery = Clock::now();
+        lock.lock();
+    }
+}
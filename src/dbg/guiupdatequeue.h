@@ -0,0 +1,68 @@
+#ifndef _GUIUPDATEQUEUE_H
+#define _GUIUPDATEQUEUE_H
+
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
+
+//views that can be marked dirty, requests for the same view are coalesced until the next frame
+enum GUIUPDATEVIEW
+{
+    GUI_UPDATE_STATE = 1 << 0, //GuiSetDebugState
+    GUI_UPDATE_DISASSEMBLY = 1 << 1, //DebugUpdateGui (disassembly, title and all the other views)
+    GUI_UPDATE_MEMORYMAP = 1 << 2,
+};
+
+struct GUIUPDATESTATS
+{
+    unsigned long long requested;
+    unsigned long long delivered;
+    unsigned long long flushed;
+};
+
+//Merges the update requests and hands them to a sink on its own thread, at most once per frame.
+//Only uses the standard library so the timing can be tested without the debugger.
+class GuiUpdateQueue
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Update
+    {
+        unsigned int views;
+        unsigned long long disasmAddr; //GUI_UPDATE_DISASSEMBLY
+        bool stack; //GUI_UPDATE_DISASSEMBLY
+        int state; //GUI_UPDATE_STATE
+    };
+
+    typedef std::function<void(const Update & update)> Sink;
+
+    GuiUpdateQueue(const Sink & sink, unsigned int framesPerSecond, Clock::duration idleTimeout);
+    ~GuiUpdateQueue();
+
+    //A pause is delivered right away when the previous pause is longer than the idle timeout ago.
+    //Pauses that follow each other quicker (a held step key) are throttled like the other requests.
+    void Request(unsigned int views, unsigned long long disasmAddr, bool stack, int state, bool pause);
+    void Flush();
+    void SetFrameRate(unsigned int framesPerSecond);
+    GUIUPDATESTATS GetStats();
+
+private:
+    Sink mSink;
+    std::mutex mLock;
+    std::condition_variable mWake;
+    Update mPending;
+    bool mFlush;
+    bool mStop;
+    Clock::duration mInterval;
+    Clock::duration mIdleTimeout;
+    Clock::time_point mLastPause;
+    GUIUPDATESTATS mStats;
+    std::thread mThread;
+
+    void loop();
+};
+
+#endif // _GUIUPDATEQUEUE_H
@@ -1,100 +1,140 @@
 #include "historycontext.h"
-#include "disasm_helper.h"
+#include "historyjournal.h"
 #include "memory.h"
 #include "console.h"
 #include "watch.h"
 #include "threading.h"
+#include "thread.h"
+#include "value.h"
+#include <capstone_wrapper.h>
 
-static const duint HistoryMaxCount = 4096;
-static std::deque<HistoryContext> history;
+static const size_t HistoryMaxMemory = 64 * 1024 * 1024; //the oldest chunks are dropped above this
 
-//This will capture the current instruction
-HistoryContext::HistoryContext()
+static HistoryJournal history(sizeof(TITAN_ENGINE_CONTEXT_t), HistoryMaxMemory);
+
+static void addPreimage(duint addr, size_t size)
+{
+    unsigned char data[HistoryJournal::MaxPreimage];
+    size = min(size, sizeof(data));
+    if(MemRead(addr, data, size))
+        history.AddPreimage(addr, data, size);
+}
+
+static void captureMemory(const TITAN_ENGINE_CONTEXT_t & registers)
 {
-    DISASM_INSTR instruction;
-    if(GetFullContextDataEx(hActiveThread, &registers) && MemIsValidReadPtr(registers.cip))
+    unsigned char buffer[MAX_DISASM_BUFFER];
+    Capstone cp;
+    if(!MemRead(registers.cip, buffer, sizeof(buffer)) || !cp.Disassemble(registers.cip, buffer))
+        return;
+    auto id = cp.GetId();
+    if(id == X86_INS_NOP || id == X86_INS_LEA) //these instructions do not write to the memory
+        return;
+
+    // implicit stack writes
+    size_t stackSize = 0;
+    switch(id)
+    {
+    case X86_INS_PUSH:
+        stackSize = cp.OpCount() && cp[0].size ? cp[0].size : sizeof(duint);
+        break;
+    case X86_INS_PUSHF:
+    case X86_INS_PUSHFD:
+    case X86_INS_PUSHFQ:
+        stackSize = sizeof(duint);
+        break;
+    case X86_INS_PUSHAW:
+    case X86_INS_PUSHAL:
+        stackSize = 8 * sizeof(duint);
+        break;
+    case X86_INS_ENTER:
+        stackSize = (1 + (cp.OpCount() > 1 ? cp[1].imm & 0x1F : 0)) * sizeof(duint);
+        break;
+    default:
+        if(cp.InGroup(CS_GRP_CALL))
+            stackSize = sizeof(duint);
+        break;
+    }
+    if(stackSize)
+        addPreimage(registers.csp - stackSize, stackSize);
+
+    // explicit memory operands, with their real access size
+    for(int i = 0; i < cp.OpCount(); i++)
     {
-        disasmget(registers.cip, &instruction);
-        if(!(memcmp(instruction.instruction, "nop ", 4) == 0 || memcmp(instruction.instruction, "lea ", 4) == 0))
-            // do not process the memory operands of these instructions, because these instructions do not write to the memory.
+        const auto & op = cp[i];
+        if(op.type != X86_OP_MEM)
+            continue;
+        duint addr = cp.ResolveOpValue(i, [&](x86_reg reg)
         {
-            if(memcmp(instruction.instruction, "push", 4) == 0 || memcmp(instruction.instruction, "call", 4) == 0)
-                // push and call instruction : save previous content on the stack
-            {
-                ChangedData olddata;
-                olddata.addr = registers.csp - sizeof(duint);
-                MemRead(olddata.addr, (unsigned char*)olddata.oldvalue, sizeof(duint));
-                ChangedLocation.push_back(olddata);
-            }
-            // TODO: FPU/SSE instructions, ENTER instruction, and possibly other instructions.
-            // These instructions can write more than sizeof(duint) bytes.
-            for(int i = 0; i < instruction.argcount; i++)
-            {
-                DISASM_ARG & arg = instruction.arg[i];
-                if(arg.type == DISASM_ARGTYPE::arg_memory)
-                {
-                    ChangedData olddata;
-                    olddata.addr = arg.value;
-                    memcpy(olddata.oldvalue, &arg.memvalue, sizeof(arg.memvalue));
-                    ChangedLocation.push_back(olddata);
-                }
-            }
-        }
-        invalid = false;
+            auto regName = cp.RegName(reg);
+            return regName ? getregister(nullptr, regName) : 0;
+        });
+#ifdef _WIN64
+        if(op.mem.segment == X86_REG_GS)
+#else //x86
+        if(op.mem.segment == X86_REG_FS)
+#endif //_WIN64
+            addr += ThreadGetLocalBase(ThreadGetId(hActiveThread));
+        addPreimage(addr, op.size ? op.size : sizeof(duint));
     }
-    else
-        invalid = true;
 }
 
-void HistoryContext::restore()
+//This will capture the current instruction
+static void historyAdd()
 {
-    if(!invalid)
+    TITAN_ENGINE_CONTEXT_t registers;
+    if(!GetFullContextDataEx(hActiveThread, &registers) || !MemIsValidReadPtr(registers.cip))
     {
-        for(auto & i : ChangedLocation)
-            MemWrite(i.addr, i.oldvalue, sizeof(duint));
-        SetFullContextDataEx(hActiveThread, &registers);
-        cbWatchdog(0, nullptr);
-        DebugUpdateGui(GetContextDataEx(hActiveThread, UE_CIP), true);
+        history.Begin(nullptr);
+        history.Commit();
+        return;
     }
-    else
+    history.Begin(&registers);
+    captureMemory(registers);
+    history.Commit();
+}
+
+static bool historyRestore()
+{
+    if(history.Empty())
+        return false;
+    TITAN_ENGINE_CONTEXT_t registers;
+    auto restoreMemory = [](size_t addr, const unsigned char* data, size_t size)
+    {
+        MemWrite(addr, data, size);
+    };
+    if(!history.Pop(&registers, restoreMemory))
     {
-        HistoryClear();
         dputs(QT_TRANSLATE_NOOP("DBG", "Cannot restore last instruction."));
+        return true;
     }
-}
+    SetFullContextDataEx(hActiveThread, &registers);
 
-HistoryContext::~HistoryContext()
-{
+    cbWatchdog(0, nullptr);
+    DebugUpdateGui(GetContextDataEx(hActiveThread, UE_CIP), true);
+    return true;
 }
 
 void HistoryAdd()
 {
     EXCLUSIVE_ACQUIRE(LockHistory);
-    if(history.size() > HistoryMaxCount)
-        history.pop_front();
-    history.emplace_back();
+    historyAdd();
 }
 
 void HistoryRestore()
 {
     EXCLUSIVE_ACQUIRE(LockHistory);
-    if(!history.empty())
-    {
-        history.back().restore();
-        history.pop_back();
-    }
-    else
+    if(!historyRestore())
         dputs(QT_TRANSLATE_NOOP("DBG", "History record is empty"));
 }
 
 bool HistoryIsEmpty()
 {
     SHARED_ACQUIRE(LockHistory);
-    return history.empty();
+    return history.Empty();
 }
 
 void HistoryClear()
 {
     EXCLUSIVE_ACQUIRE(LockHistory);
-    history.clear();
+    history.Clear();
 }
@@ -0,0 +1,178 @@
+#include "historyjournal.h"
+#include <cstring>
+#include <algorithm>
+
+static const unsigned char RecordInvalid = 1;
+
+// Record layout: flags (1), delta size (2), pre-image count (2), register delta, pre-images (address, size (2), bytes)
+template<typename T>
+static void put(std::vector<unsigned char> & data, T value)
+{
+    auto bytes = (const unsigned char*)&value;
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+template<typename T>
+static T get(const unsigned char* & data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return value;
+}
+
+HistoryJournal::HistoryJournal(size_t frameSize, size_t maxMemory, size_t chunkSize)
+    : frameSize(frameSize),
+      maxMemory(maxMemory),
+      chunkSize(chunkSize),
+      memory(0),
+      steps(0),
+      top((frameSize + sizeof(Word) - 1) / sizeof(Word)),
+      frame(top.size())
+{
+}
+
+void HistoryJournal::Begin(const void* registers)
+{
+    record.clear();
+    if(!registers)
+    {
+        put<unsigned char>(record, RecordInvalid);
+        put<unsigned short>(record, 0);
+        put<unsigned short>(record, 0);
+        std::fill(top.begin(), top.end(), 0); //the next record is encoded against zero
+        return;
+    }
+    std::fill(frame.begin(), frame.end(), 0);
+    memcpy(frame.data(), registers, frameSize);
+    put<unsigned char>(record, 0);
+    put<unsigned short>(record, 0); //delta size
+    put<unsigned short>(record, 0); //pre-image count
+    encodeRegisters();
+    auto deltaSize = (unsigned short)(record.size() - 5);
+    memcpy(record.data() + 1, &deltaSize, sizeof(deltaSize));
+    top.swap(frame);
+}
+
+void HistoryJournal::AddPreimage(size_t addr, const unsigned char* data, size_t size)
+{
+    size = std::min(size, size_t(MaxPreimage));
+    put(record, addr);
+    put(record, (unsigned short)size);
+    record.insert(record.end(), data, data + size);
+    unsigned short count;
+    memcpy(&count, record.data() + 3, sizeof(count));
+    count++;
+    memcpy(record.data() + 3, &count, sizeof(count));
+}
+
+void HistoryJournal::Commit()
+{
+    if(chunks.empty() || chunks.back().data.capacity() - chunks.back().data.size() < record.size())
+    {
+        chunks.emplace_back();
+        auto & chunk = chunks.back();
+        chunk.data.reserve(std::max(chunkSize, record.size()));
+        memory += chunk.data.capacity();
+    }
+    auto & chunk = chunks.back();
+    auto recordsCapacity = chunk.records.capacity();
+    chunk.records.push_back((unsigned int)chunk.data.size());
+    memory += (chunk.records.capacity() - recordsCapacity) * sizeof(unsigned int);
+    chunk.data.insert(chunk.data.end(), record.begin(), record.end());
+    steps++;
+
+    // The oldest chunks are dropped above the limit
+    while(memory > maxMemory && chunks.size() > 1)
+    {
+        memory -= chunks.front().Memory();
+        steps -= chunks.front().records.size();
+        chunks.pop_front();
+    }
+}
+
+bool HistoryJournal::Pop(void* registers, const PreimageCallback & restore)
+{
+    if(chunks.empty())
+        return false;
+    auto & chunk = chunks.back();
+    auto offset = chunk.records.back();
+    const unsigned char* data = chunk.data.data() + offset;
+    auto flags = get<unsigned char>(data);
+    if(flags & RecordInvalid)
+    {
+        Clear();
+        return false;
+    }
+    auto deltaSize = get<unsigned short>(data);
+    auto count = get<unsigned short>(data);
+    auto delta = data;
+    data += deltaSize;
+    for(unsigned short i = 0; i < count; i++)
+    {
+        auto addr = get<size_t>(data);
+        auto size = get<unsigned short>(data);
+        restore(addr, data, size);
+        data += size;
+    }
+    memcpy(registers, top.data(), frameSize);
+    decodeRegisters(delta, deltaSize); //top now holds the registers of the previous record
+
+    chunk.data.resize(offset);
+    chunk.records.pop_back();
+    steps--;
+    if(chunk.records.empty())
+    {
+        memory -= chunk.Memory();
+        chunks.pop_back();
+    }
+    return true;
+}
+
+bool HistoryJournal::Empty() const
+{
+    return chunks.empty();
+}
+
+void HistoryJournal::Clear()
+{
+    std::deque<Chunk>().swap(chunks);
+    memory = 0;
+    steps = 0;
+    std::fill(top.begin(), top.end(), 0);
+}
+
+// Runs of unchanged words are skipped: (zero word count, changed word count, changed words)...
+void HistoryJournal::encodeRegisters()
+{
+    size_t i = 0;
+    auto words = top.size();
+    while(i < words)
+    {
+        unsigned char skip = 0;
+        while(i < words && skip < 0xFF && frame[i] == top[i])
+            skip++, i++;
+        unsigned char count = 0;
+        while(i + count < words && count < 0xFF && frame[i + count] != top[i + count])
+            count++;
+        if(!count && i == words)
+            break;
+        put(record, skip);
+        put(record, count);
+        for(; count; count--, i++)
+            put(record, Word(frame[i] ^ top[i]));
+    }
+}
+
+void HistoryJournal::decodeRegisters(const unsigned char* delta, size_t size)
+{
+    auto end = delta + size;
+    size_t i = 0;
+    while(delta < end)
+    {
+        i += get<unsigned char>(delta);
+        auto count = get<unsigned char>(delta);
+        for(; count; count--, i++)
+            top[i] ^= get<Word>(delta);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef HISTORYJOURNAL_H
+#define HISTORYJOURNAL_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include <functional>
+
+/**
+ * @brief Undo journal of the single steps, stored in a chunked arena (it only depends on the standard library).
+ * Every record holds the register frame XOR-encoded against the previous step and
+ * the pre-images of the memory the stepped instruction can write.
+**/
+class HistoryJournal
+{
+public:
+    typedef std::function<void(size_t addr, const unsigned char* data, size_t size)> PreimageCallback;
+
+    HistoryJournal(size_t frameSize, size_t maxMemory, size_t chunkSize = 64 * 1024);
+
+    //Starts a record with the registers of the step (nullptr records a step that cannot be undone)
+    void Begin(const void* frame);
+    void AddPreimage(size_t addr, const unsigned char* data, size_t size);
+    void Commit();
+
+    //Undoes the newest step: the pre-images are passed to restore, frame receives the registers.
+    //Returns false (and clears the journal) if the step cannot be undone.
+    bool Pop(void* frame, const PreimageCallback & restore);
+
+    bool Empty() const;
+    void Clear();
+
+    size_t Steps() const
+    {
+        return steps;
+    }
+
+    //Bytes reserved by the chunks, including the record offsets
+    size_t Memory() const
+    {
+        return memory;
+    }
+
+    static const size_t MaxPreimage = 512; //fxsave area
+
+private:
+    typedef unsigned int Word;
+
+    struct Chunk
+    {
+        std::vector<unsigned char> data;
+        std::vector<unsigned int> records; //record offsets
+
+        size_t Memory() const
+        {
+            return data.capacity() + records.capacity() * sizeof(unsigned int);
+        }
+    };
+
+    size_t frameSize;
+    size_t maxMemory;
+    size_t chunkSize;
+    std::deque<Chunk> chunks;
+    size_t memory;
+    size_t steps;
+    std::vector<Word> top; //registers of the newest record
+    std::vector<Word> frame; //registers of the record being built
+    std::vector<unsigned char> record; //record being built
+
+    void encodeRegisters();
+    void decodeRegisters(const unsigned char* delta, size_t size);
+};
+
+#endif //HISTORYJOURNAL_H
@@ -37,6 +37,7 @@
 #include "recursiveanalysis.h"
 #include "xrefsanalysis.h"
 #include "advancedanalysis.h"
+#include "incrementalanalysis.h"
 #include "exhandlerinfo.h"
 #include "symbolinfo.h"
 #include "argument.h"
@@ -44,6 +45,10 @@
 #include "exception.h"
 #include "TraceRecord.h"
 #include "encodemap.h"
+#include "workpool.h"
+#include "yarascan.h"
+#include "guiupdate.h"
+#include <mutex>
 
 static bool bRefinit = false;
 static int maxFindResults = 5000;
@@ -1891,16 +1896,71 @@ static String yara_print_hex_string(const uint8_t* data, int length)
     return result;
 }
 
+//Collects the matches of the (parallel) scans and adds them to the reference view in batches
+class YaraResultSink : public YaraMatchSink
+{
+public:
+    YaraResultSink()
+        : mRows(0)
+    {
+    }
+
+    void Add(size_t addr, const String & rule, const String & pattern) override
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        Row row = { addr, rule, pattern };
+        mPending.push_back(row);
+        if(mPending.size() >= 256)
+            flush();
+    }
+
+    int Flush()
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        flush();
+        return mRows;
+    }
+
+private:
+    struct Row
+    {
+        duint addr;
+        String rule;
+        String pattern;
+    };
+
+    std::mutex mLock;
+    std::vector<Row> mPending;
+    int mRows;
+
+    void flush()
+    {
+        if(mPending.empty())
+            return;
+        GuiReferenceSetRowCount(mRows + int(mPending.size()));
+        for(const auto & row : mPending)
+        {
+            char addr_text[deflen] = "";
+            sprintf(addr_text, "%p", row.addr);
+            GuiReferenceSetCellContent(mRows, 0, addr_text); //Address
+            GuiReferenceSetCellContent(mRows, 1, row.rule.c_str()); //Rule
+            GuiReferenceSetCellContent(mRows, 2, row.pattern.c_str()); //Data
+            mRows++;
+        }
+        mPending.clear();
+    }
+};
+
 struct YaraScanInfo
 {
     duint base;
-    int index;
     bool rawFile;
     const char* modname;
     bool debug;
+    YaraMatchSink* sink;
 
-    YaraScanInfo(duint base, bool rawFile, const char* modname, bool debug)
-        : base(base), index(0), rawFile(rawFile), modname(modname), debug(debug)
+    YaraScanInfo(duint base, bool rawFile, const char* modname, bool debug, YaraMatchSink* sink)
+        : base(base), rawFile(rawFile), modname(modname), debug(debug), sink(sink)
     {
     }
 };
@@ -1917,29 +1977,17 @@ static int yaraScanCallback(int message, void* message_data, void* user_data)
         YR_RULE* yrRule = (YR_RULE*)message_data;
         auto addReference = [scanInfo, yrRule](duint addr, const char* identifier, const std::string & pattern)
         {
-            auto index = scanInfo->index;
-            GuiReferenceSetRowCount(index + 1);
-            scanInfo->index++;
-
-            char addr_text[deflen] = "";
-            sprintf(addr_text, "%p", addr);
-            GuiReferenceSetCellContent(index, 0, addr_text); //Address
             String ruleFullName = "";
             ruleFullName += yrRule->identifier;
-            if(identifier)
-            {
-                ruleFullName += ".";
-                ruleFullName += identifier;
-            }
-            GuiReferenceSetCellContent(index, 1, ruleFullName.c_str()); //Rule
-            GuiReferenceSetCellContent(index, 2, pattern.c_str()); //Data
+            ruleFullName += ".";
+            ruleFullName += identifier;
+            scanInfo->sink->Add(addr, ruleFullName, pattern);
         };
-
         if(STRING_IS_NULL(yrRule->strings))
         {
             if(debug)
                 dprintf(QT_TRANSLATE_NOOP("DBG", "[YARA] Global rule \"%s\' matched!\n"), yrRule->identifier);
-            addReference(base, nullptr, "");
+            scanInfo->sink->AddRule(base, yrRule->identifier);
         }
         else
         {
@@ -1999,6 +2047,93 @@ static int yaraScanCallback(int message, void* message_data, void* user_data)
     return ERROR_SUCCESS; //nicely undocumented what this should be
 }
 
+struct YaraRulesCacheEntry
+{
+    FILETIME lastWrite;
+    ULONGLONG size;
+    std::shared_ptr<YR_RULES> rules;
+};
+
+static std::unordered_map<String, YaraRulesCacheEntry> yaraRulesCache;
+
+//Compiled rules are cached per file and compiled again when the file was written
+static std::shared_ptr<YR_RULES> yaraGetRules(const char* fileName)
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if(!GetFileAttributesExW(StringUtils::Utf8ToUtf16(fileName).c_str(), GetFileExInfoStandard, &attributes))
+    {
+        dprintf(QT_TRANSLATE_NOOP("DBG", "Failed to read the rules file \"%s\"\n"), fileName);
+        return nullptr;
+    }
+    auto size = (ULONGLONG(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+
+    EXCLUSIVE_ACQUIRE(LockYaraRules);
+    auto found = yaraRulesCache.find(fileName);
+    if(found != yaraRulesCache.end())
+    {
+        const auto & entry = found->second;
+        if(CompareFileTime(&entry.lastWrite, &attributes.ftLastWriteTime) == 0 && entry.size == size)
+            return entry.rules;
+        yaraRulesCache.erase(found);
+    }
+
+    String rulesContent;
+    if(!FileHelper::ReadAllText(fileName, rulesContent))
+    {
+        dprintf(QT_TRANSLATE_NOOP("DBG", "Failed to read the rules file \"%s\"\n"), fileName);
+        return nullptr;
+    }
+
+    std::shared_ptr<YR_RULES> rules;
+    YR_COMPILER* yrCompiler;
+    if(yr_compiler_create(&yrCompiler) == ERROR_SUCCESS)
+    {
+        yr_compiler_set_callback(yrCompiler, yaraCompilerCallback, 0);
+        if(yr_compiler_add_string(yrCompiler, rulesContent.c_str(), nullptr) == 0)   //no errors found
+        {
+            YR_RULES* yrRules;
+            if(yr_compiler_get_rules(yrCompiler, &yrRules) == ERROR_SUCCESS)
+                rules = std::shared_ptr<YR_RULES>(yrRules, yr_rules_destroy);
+            else
+                dputs(QT_TRANSLATE_NOOP("DBG", "error while getting the rules!"));
+        }
+        else
+            dputs(QT_TRANSLATE_NOOP("DBG", "errors in the rules file!"));
+        yr_compiler_destroy(yrCompiler);
+    }
+    else
+        dputs(QT_TRANSLATE_NOOP("DBG", "yr_compiler_create failed!"));
+
+    if(rules)
+    {
+        YaraRulesCacheEntry entry;
+        entry.lastWrite = attributes.ftLastWriteTime;
+        entry.size = size;
+        entry.rules = rules;
+        yaraRulesCache[fileName] = entry;
+    }
+    return rules;
+}
+
+void yaraclearcache()
+{
+    EXCLUSIVE_ACQUIRE(LockYaraRules);
+    yaraRulesCache.clear();
+}
+
+//The debuggee memory for the "yara rules, *" scans
+class YaraDebuggeeMemory : public YaraMemorySource
+{
+public:
+    bool Read(size_t address, void* buffer, size_t size) override
+    {
+        return MemRead(address, buffer, size);
+    }
+};
+
+//Regions are scanned in 16MiB chunks, the overlap is larger than any useful string match
+static const YaraRegionScanner yaraRegionScanner(MAX_THREADS, 16 * 1024 * 1024, 64 * 1024);
+
 CMDRESULT cbInstrYara(int argc, char* argv[])
 {
     if(IsArgumentsLessThan(argc, 2))
@@ -2010,9 +2145,14 @@ CMDRESULT cbInstrYara(int argc, char* argv[])
 
     duint base = 0;
     duint size = 0;
-    duint mod = ModBaseFromName(argv[2]);
+    bool allMemory = argc > 2 && strcmp(argv[2], "*") == 0;
+    duint mod = allMemory ? 0 : ModBaseFromName(argv[2]);
     bool rawFile = false;
-    if(mod)
+    if(allMemory)
+    {
+        //every readable region of the memory map
+    }
+    else if(mod)
     {
         base = mod;
         size = ModSizeFromAddr(base);
@@ -2050,80 +2190,92 @@ CMDRESULT cbInstrYara(int argc, char* argv[])
         }
         size = rawFileData.size();
     }
-    Memory<uint8_t*> data(size);
+
+    //the regions of the memory map are scanned separately, a match cannot span two regions
+    std::vector<YaraRegion> regions;
+    if(allMemory)
+    {
+        SHARED_ACQUIRE(LockMemoryPages);
+        for(const auto & page : memoryPages)
+        {
+            const auto & mbi = page.second.mbi;
+            if(mbi.State == MEM_COMMIT && !(mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD)))
+            {
+                YaraRegion region = { duint(mbi.BaseAddress), mbi.RegionSize };
+                regions.push_back(region);
+            }
+        }
+    }
+
+    Memory<uint8_t*> data(allMemory ? 1 : size);
     if(rawFile)
         memcpy(data(), rawFileData.data(), size);
-    else if(!MemRead(base, data(), size))
+    else if(!allMemory && !MemRead(base, data(), size))
     {
         dprintf(QT_TRANSLATE_NOOP("DBG", "failed to read memory page %p[%X]!\n"), base, size);
         return STATUS_ERROR;
     }
 
-    String rulesContent;
-    if(!FileHelper::ReadAllText(argv[1], rulesContent))
-    {
-        dprintf(QT_TRANSLATE_NOOP("DBG", "Failed to read the rules file \"%s\"\n"), argv[1]);
+    auto yrRules = yaraGetRules(argv[1]);
+    if(!yrRules)
         return STATUS_ERROR;
-    }
 
-    bool bSuccess = false;
-    YR_COMPILER* yrCompiler;
-    if(yr_compiler_create(&yrCompiler) == ERROR_SUCCESS)
+    //initialize new reference tab
+    char modname[MAX_MODULE_SIZE] = "";
+    if(allMemory)
+        strcpy_s(modname, "*");
+    else if(!ModNameFromAddr(base, modname, true))
+        sprintf_s(modname, "%p", base);
+    String fullName;
+    const char* fileName = strrchr(argv[1], '\\');
+    if(fileName)
+        fullName = fileName + 1;
+    else
+        fullName = argv[1];
+    fullName += " (";
+    fullName += modname;
+    fullName += ")"; //nanana, very ugly code (long live open source)
+    GuiReferenceInitialize(fullName.c_str());
+    GuiReferenceAddColumn(sizeof(duint) * 2, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Address")));
+    GuiReferenceAddColumn(48, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Rule")));
+    GuiReferenceAddColumn(10, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Data")));
+    GuiReferenceSetRowCount(0);
+    GuiReferenceReloadData();
+    YaraResultSink sink;
+    bool debug = settingboolget("Engine", "YaraDebug");
+    duint ticks = GetTickCount();
+    dputs(QT_TRANSLATE_NOOP("DBG", "[YARA] Scan started..."));
+    int err = ERROR_SUCCESS;
+    if(allMemory)
     {
-        yr_compiler_set_callback(yrCompiler, yaraCompilerCallback, 0);
-        if(yr_compiler_add_string(yrCompiler, rulesContent.c_str(), nullptr) == 0)   //no errors found
+        YaraDebuggeeMemory memory;
+        err = yaraRegionScanner.Scan(WorkPool::Global(), regions, memory, sink, [&](const YaraChunk & chunk, const unsigned char* data, YaraMatchSink & chunkSink)
         {
-            YR_RULES* yrRules;
-            if(yr_compiler_get_rules(yrCompiler, &yrRules) == ERROR_SUCCESS)
-            {
-                //initialize new reference tab
-                char modname[MAX_MODULE_SIZE] = "";
-                if(!ModNameFromAddr(base, modname, true))
-                    sprintf_s(modname, "%p", base);
-                String fullName;
-                const char* fileName = strrchr(argv[1], '\\');
-                if(fileName)
-                    fullName = fileName + 1;
-                else
-                    fullName = argv[1];
-                fullName += " (";
-                fullName += modname;
-                fullName += ")"; //nanana, very ugly code (long live open source)
-                GuiReferenceInitialize(fullName.c_str());
-                GuiReferenceAddColumn(sizeof(duint) * 2, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Address")));
-                GuiReferenceAddColumn(48, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Rule")));
-                GuiReferenceAddColumn(10, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Data")));
-                GuiReferenceSetRowCount(0);
-                GuiReferenceReloadData();
-                YaraScanInfo scanInfo(base, rawFile, argv[2], settingboolget("Engine", "YaraDebug"));
-                duint ticks = GetTickCount();
-                dputs(QT_TRANSLATE_NOOP("DBG", "[YARA] Scan started..."));
-                int err = yr_rules_scan_mem(yrRules, data(), size, 0, yaraScanCallback, &scanInfo, 0);
-                GuiReferenceReloadData();
-                switch(err)
-                {
-                case ERROR_SUCCESS:
-                    dprintf(QT_TRANSLATE_NOOP("DBG", "%u scan results in %ums...\n"), scanInfo.index, GetTickCount() - ticks);
-                    bSuccess = true;
-                    break;
-                case ERROR_TOO_MANY_MATCHES:
-                    dputs(QT_TRANSLATE_NOOP("DBG", "too many matches!"));
-                    break;
-                default:
-                    dputs(QT_TRANSLATE_NOOP("DBG", "error while scanning memory!"));
-                    break;
-                }
-                yr_rules_destroy(yrRules);
-            }
-            else
-                dputs(QT_TRANSLATE_NOOP("DBG", "error while getting the rules!"));
-        }
-        else
-            dputs(QT_TRANSLATE_NOOP("DBG", "errors in the rules file!"));
-        yr_compiler_destroy(yrCompiler);
+            YaraScanInfo scanInfo(chunk.base, false, argv[2], debug, &chunkSink);
+            return yr_rules_scan_mem(yrRules.get(), (uint8_t*)data, chunk.size, 0, yaraScanCallback, &scanInfo, 0);
+        });
     }
     else
-        dputs(QT_TRANSLATE_NOOP("DBG", "yr_compiler_create failed!"));
+    {
+        YaraScanInfo scanInfo(base, rawFile, argv[2], debug, &sink);
+        err = yr_rules_scan_mem(yrRules.get(), data(), size, 0, yaraScanCallback, &scanInfo, 0);
+    }
+    auto results = sink.Flush();
+    GuiReferenceReloadData();
+    bool bSuccess = false;
+    switch(err)
+    {
+    case ERROR_SUCCESS:
+        dprintf(QT_TRANSLATE_NOOP("DBG", "%u scan results in %ums...\n"), results, GetTickCount() - ticks);
+        bSuccess = true;
+        break;
+    case ERROR_TOO_MANY_MATCHES:
+        dputs(QT_TRANSLATE_NOOP("DBG", "too many matches!"));
+        break;
+    default:
+        dputs(QT_TRANSLATE_NOOP("DBG", "error while scanning memory!"));
+        break;
+    }
     return bSuccess ? STATUS_CONTINUE : STATUS_ERROR;
 }
 
@@ -2323,6 +2475,18 @@ CMDRESULT cbInstrAnalxrefs(int argc, char* argv[])
     return STATUS_CONTINUE;
 }
 
+CMDRESULT cbInstrAnalinc(int argc, char* argv[])
+{
+    SELECTIONDATA sel;
+    GuiSelectionGet(GUI_DISASSEMBLY, &sel);
+    duint size = 0;
+    auto base = MemFindBaseAddr(sel.start, &size);
+    IncrementalAnalysis anal(base, size);
+    anal.Analyse();
+    anal.SetMarkers();
+    return STATUS_CONTINUE;
+}
+
 CMDRESULT cbInstrVirtualmod(int argc, char* argv[])
 {
     if(IsArgumentsLessThan(argc, 3))
@@ -2825,6 +2989,14 @@ CMDRESULT cbInstrEnableGuiUpdate(int argc, char* argv[])
     return STATUS_CONTINUE;
 }
 
+CMDRESULT cbInstrGuiUpdateStats(int argc, char* argv[])
+{
+    GUIUPDATESTATS stats;
+    GuiUpdateGetStats(stats);
+    dprintf(QT_TRANSLATE_NOOP("DBG", "GUI updates: %llu requested, %llu delivered (%llu flushed)\n"), stats.requested, stats.delivered, stats.flushed);
+    return STATUS_CONTINUE;
+}
+
 static void printExhandlers(const char* name, const std::vector<duint> & entries)
 {
     if(!entries.size())
@@ -73,6 +73,7 @@ CMDRESULT cbInstrSleep(int argc, char* argv[]);
 CMDRESULT cbInstrFindAsm(int argc, char* argv[]);
 CMDRESULT cbInstrYara(int argc, char* argv[]);
 CMDRESULT cbInstrYaramod(int argc, char* argv[]);
+void yaraclearcache();
 CMDRESULT cbInstrLog(int argc, char* argv[]);
 
 CMDRESULT cbInstrCapstone(int argc, char* argv[]);
@@ -81,6 +82,7 @@ CMDRESULT cbInstrAnalyse(int argc, char* argv[]);
 CMDRESULT cbInstrAnalyseadv(int argc, char* argv[]);
 CMDRESULT cbInstrAnalrecur(int argc, char* argv[]);
 CMDRESULT cbInstrAnalxrefs(int argc, char* argv[]);
+CMDRESULT cbInstrAnalinc(int argc, char* argv[]);
 CMDRESULT cbInstrVisualize(int argc, char* argv[]);
 CMDRESULT cbInstrMeminfo(int argc, char* argv[]);
 CMDRESULT cbInstrCfanalyse(int argc, char* argv[]);
@@ -119,6 +121,7 @@ CMDRESULT cbInstrBriefcheck(int argc, char* argv[]);
 
 CMDRESULT cbInstrDisableGuiUpdate(int argc, char* argv[]);
 CMDRESULT cbInstrEnableGuiUpdate(int argc, char* argv[]);
+CMDRESULT cbInstrGuiUpdateStats(int argc, char* argv[]);
 CMDRESULT cbInstrExhandlers(int argc, char* argv[]);
 CMDRESULT cbInstrInstrUndo(int argc, char* argv[]);
 CMDRESULT cbInstrExinfo(int argc, char* argv[]);
@@ -103,6 +103,11 @@ void LabelGetList(std::vector<LABELSINFO> & list)
     labels.GetList(list);
 }
 
+duint LabelGetGeneration()
+{
+    return labels.Generation();
+}
+
 bool LabelGetInfo(duint Address, LABELSINFO* info)
 {
     return labels.GetInfo(Address, info);
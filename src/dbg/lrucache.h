@@ -0,0 +1,61 @@
+#ifndef _LRUCACHE_H
+#define _LRUCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief Map with a fixed number of entries, a new entry replaces the least recently used one
+ * (it only depends on the standard library).
+**/
+template<typename Key, typename Value>
+class LruCache
+{
+public:
+    explicit LruCache(size_t capacity)
+        : capacity(capacity)
+    {
+    }
+
+    //Returns the entry of key, make() creates it when it is not cached
+    template<typename Make>
+    Value & Get(const Key & key, const Make & make)
+    {
+        auto found = index.find(key);
+        if(found != index.end())
+        {
+            entries.splice(entries.begin(), entries, found->second);
+            return found->second->second;
+        }
+        if(index.size() >= capacity)
+        {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, make());
+        index.emplace(key, entries.begin());
+        return entries.front().second;
+    }
+
+    size_t Size() const
+    {
+        return index.size();
+    }
+
+    void Clear()
+    {
+        index.clear();
+        entries.clear();
+    }
+
+private:
+    typedef std::list<std::pair<Key, Value>> List;
+
+    size_t capacity;
+    List entries; //most recently used first
+    std::unordered_map<Key, typename List::iterator> index;
+};
+
+#endif //_LRUCACHE_H
@@ -5,10 +5,13 @@
  */
 
 #include "_global.h"
+#include "module.h"
 
 extern "C" DLL_EXPORT BOOL APIENTRY DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
 {
     if(fdwReason == DLL_PROCESS_ATTACH)
         hInst = hinstDLL;
+    else if(fdwReason == DLL_THREAD_DETACH || fdwReason == DLL_PROCESS_DETACH)
+        ModThreadDetach();
     return TRUE;
 }
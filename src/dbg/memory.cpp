@@ -10,8 +10,10 @@
 #include "threading.h"
 #include "thread.h"
 #include "module.h"
+#include "guiupdate.h"
 #include "console.h"
 #include "taskthread.h"
+#include "incrementalanalysis.h"
 
 #define PAGE_SHIFT              (12)
 //#define PAGE_SIZE               (4096)
@@ -21,6 +23,7 @@
 
 std::map<Range, MEMPAGE, RangeCompare> memoryPages;
 bool bListAllPages = false;
+static duint memoryPagesGeneration = 0; //incremented every time the memory map changes
 
 void MemUpdateMap()
 {
@@ -234,6 +237,32 @@ void MemUpdateMap()
 
     // Convert the vector to a map
     EXCLUSIVE_ACQUIRE(LockMemoryPages);
+
+    // Nothing to do when the map did not change (the pages are zero-initialized)
+    if(pageVector.size() == memoryPages.size())
+    {
+        auto itr = memoryPages.begin();
+        size_t i = 0;
+        for(; i < pageVector.size(); i++, ++itr)
+            if(memcmp(&pageVector[i], &itr->second, sizeof(MEMPAGE)) != 0)
+                break;
+        if(i == pageVector.size())
+            return;
+    }
+    memoryPagesGeneration++;
+
+    // Pages that appeared or changed protection have to be analysed again
+    if(!memoryPages.empty())
+    {
+        for(auto & page : pageVector)
+        {
+            duint start = (duint)page.mbi.BaseAddress;
+            duint size = (duint)page.mbi.RegionSize;
+            auto found = memoryPages.find(std::make_pair(start, start));
+            if(found == memoryPages.end() || found->first.first != start || found->second.mbi.RegionSize != size || found->second.mbi.Protect != page.mbi.Protect)
+                AnalysisDirtyAdd(start, size);
+        }
+    }
     memoryPages.clear();
 
     for(auto & page : pageVector)
@@ -244,12 +273,18 @@ void MemUpdateMap()
     }
 }
 
+duint MemGetMapGeneration()
+{
+    SHARED_ACQUIRE(LockMemoryPages);
+    return memoryPagesGeneration;
+}
+
 static DWORD WINAPI memUpdateMap()
 {
     if(DbgIsDebugging())
     {
         MemUpdateMap();
-        GuiUpdateMemoryView();
+        GuiUpdateRequest(GUI_UPDATE_MEMORYMAP);
     }
     return 0;
 }
@@ -365,6 +400,10 @@ bool MemWrite(duint BaseAddress, const void* Buffer, duint Size, duint* NumberOf
     // Try a regular WriteProcessMemory call
     bool ret = MemoryWriteSafe(fdProcessInfo->hProcess, (LPVOID)BaseAddress, Buffer, Size, NumberOfBytesWritten);
 
+    // Existing analysis results of the written bytes are outdated
+    if(ret && *NumberOfBytesWritten)
+        AnalysisDirtyAdd(BaseAddress, *NumberOfBytesWritten);
+
     if(ret && *NumberOfBytesWritten == Size)
         return true;
 
@@ -387,7 +426,11 @@ bool MemWrite(duint BaseAddress, const void* Buffer, duint Size, duint* NumberOf
             SIZE_T bytesWritten = 0;
 
             if(MemoryWriteSafe(fdProcessInfo->hProcess, (PVOID)writeBase, ((PBYTE)Buffer + offset), writeSize, &bytesWritten))
+            {
                 *NumberOfBytesWritten += bytesWritten;
+                if(bytesWritten)
+                    AnalysisDirtyAdd(writeBase, bytesWritten);
+            }
 
             offset += writeSize;
             writeBase += writeSize;
@@ -22,6 +22,7 @@ struct SimplePage
 };
 
 void MemUpdateMap();
+duint MemGetMapGeneration();
 void MemUpdateMapAsync();
 duint MemFindBaseAddr(duint Address, duint* Size, bool Refresh = false);
 bool MemRead(duint BaseAddress, void* Buffer, duint Size, duint* NumberOfBytesRead = nullptr, bool cache = false);
@@ -0,0 +1,143 @@
+/**
+ @file memsnapshot.cpp
+
+ @brief Snapshots of the debuggee memory, stored as content-hashed pages that are shared between snapshots.
+ */
+
+#include "memsnapshot.h"
+#include "memory.h"
+#include "threading.h"
+#include "snapshotstore.h"
+#include "workpool.h"
+
+static SnapshotStore snapshotStore;
+static std::unordered_map<String, SnapshotStore::Pages> snapshots;
+
+// The committed and readable regions of the debuggee
+class SnapshotDebuggeeMemory : public SnapshotMemorySource
+{
+public:
+    void Regions(std::vector<SnapshotRegion> & regions) override
+    {
+        MemUpdateMap();
+        SHARED_ACQUIRE(LockMemoryPages);
+        for(const auto & page : memoryPages)
+        {
+            const auto & mbi = page.second.mbi;
+            if(mbi.State == MEM_COMMIT && !(mbi.Protect & (PAGE_NOACCESS | PAGE_GUARD)))
+            {
+                SnapshotRegion region = { duint(mbi.BaseAddress), mbi.RegionSize };
+                regions.push_back(region);
+            }
+        }
+    }
+
+    bool Read(size_t address, void* buffer, size_t size) override
+    {
+        return MemRead(address, buffer, size);
+    }
+};
+
+static void SnapshotCapture(SnapshotStore::Pages & Pages, duint & NewPageCount)
+{
+    SnapshotDebuggeeMemory memory;
+    NewPageCount = snapshotStore.Capture(WorkPool::Global(), memory, Pages);
+}
+
+bool SnapshotCreate(const char* Name, duint* PageCount, duint* NewPageCount)
+{
+    ASSERT_NONNULL(Name);
+    SnapshotStore::Pages pages;
+    duint newPageCount;
+    SnapshotCapture(pages, newPageCount);
+    if(PageCount)
+        *PageCount = pages.size();
+    if(NewPageCount)
+        *NewPageCount = newPageCount;
+
+    EXCLUSIVE_ACQUIRE(LockSnapshots);
+    snapshots[Name].swap(pages);
+    pages.clear(); // Release the pages of the replaced snapshot
+    snapshotStore.Purge();
+    return true;
+}
+
+bool SnapshotDelete(const char* Name)
+{
+    ASSERT_NONNULL(Name);
+    EXCLUSIVE_ACQUIRE(LockSnapshots);
+    if(!snapshots.erase(Name))
+        return false;
+    snapshotStore.Purge();
+    return true;
+}
+
+bool SnapshotDiff(const char* Old, const char* New, std::vector<Range> & Changed, const char** Missing)
+{
+    ASSERT_NONNULL(Old);
+    Changed.clear();
+    if(Missing)
+        *Missing = nullptr;
+
+    // Compare with the current memory if there is no new snapshot
+    SnapshotStore::Pages oldPages, newPages;
+    if(!New)
+    {
+        duint newPageCount;
+        SnapshotCapture(newPages, newPageCount);
+    }
+    bool found = false;
+    {
+        SHARED_ACQUIRE(LockSnapshots);
+        auto oldSnapshot = snapshots.find(Old);
+        auto newSnapshot = New ? snapshots.find(New) : snapshots.end();
+        if(oldSnapshot != snapshots.end() && (!New || newSnapshot != snapshots.end()))
+        {
+            found = true;
+            oldPages = oldSnapshot->second;
+            if(New)
+                newPages = newSnapshot->second;
+        }
+        else if(Missing)
+            *Missing = oldSnapshot == snapshots.end() ? Old : New;
+    }
+    if(!found)
+    {
+        if(!New)
+        {
+            newPages.clear();
+            EXCLUSIVE_ACQUIRE(LockSnapshots);
+            snapshotStore.Purge();
+        }
+        return false;
+    }
+
+    SnapshotStore::Ranges changed;
+    SnapshotStore::Diff(WorkPool::Global(), oldPages, newPages, changed);
+    for(const auto & range : changed)
+        Changed.push_back(Range(range.first, range.second));
+
+    if(!New)
+    {
+        newPages.clear();
+        EXCLUSIVE_ACQUIRE(LockSnapshots);
+        snapshotStore.Purge();
+    }
+    return true;
+}
+
+void SnapshotGetList(std::vector<String> & List)
+{
+    SHARED_ACQUIRE(LockSnapshots);
+    List.clear();
+    for(const auto & snapshot : snapshots)
+        List.push_back(snapshot.first);
+    std::sort(List.begin(), List.end());
+}
+
+void SnapshotClear()
+{
+    EXCLUSIVE_ACQUIRE(LockSnapshots);
+    snapshots.clear();
+    snapshotStore.Clear();
+}
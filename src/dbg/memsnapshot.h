@@ -0,0 +1,12 @@
+#ifndef _MEMSNAPSHOT_H
+#define _MEMSNAPSHOT_H
+
+#include "_global.h"
+
+bool SnapshotCreate(const char* Name, duint* PageCount = nullptr, duint* NewPageCount = nullptr);
+bool SnapshotDelete(const char* Name);
+bool SnapshotDiff(const char* Old, const char* New, std::vector<Range> & Changed, const char** Missing = nullptr);
+void SnapshotGetList(std::vector<String> & List);
+void SnapshotClear();
+
+#endif // _MEMSNAPSHOT_H
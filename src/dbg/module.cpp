@@ -5,9 +5,52 @@
 #include "murmurhash.h"
 #include "memory.h"
 #include "label.h"
+#include "moduleranges.h"
 
 std::map<Range, MODINFO, RangeCompare> modinfo;
 
+static ModuleRanges modranges;
+// __declspec(thread) cannot be used in a DLL on XP, the last hit of every thread is kept in a TLS slot
+static DWORD modcacheslot = TlsAlloc();
+
+static void ModPublishRanges()
+{
+    // LockModules must be held exclusively
+    std::vector<MODRANGE> ranges;
+    ranges.reserve(modinfo.size());
+    for(const auto & mod : modinfo)
+    {
+        MODRANGE range;
+        range.start = mod.first.first;
+        range.end = mod.first.second;
+        range.hash = mod.second.hash;
+        range.party = mod.second.party;
+        ranges.push_back(range);
+    }
+    modranges.Publish(std::move(ranges));
+}
+
+static bool ModRangeFromAddr(duint Address, MODRANGE & Range)
+{
+    // The cache is freed by ModThreadDetach when the thread exits
+    auto cache = (ModuleRanges::Cache*)TlsGetValue(modcacheslot);
+    if(!cache)
+    {
+        cache = new ModuleRanges::Cache;
+        TlsSetValue(modcacheslot, cache);
+    }
+    return modranges.Find(Address, Range, *cache);
+}
+
+void ModThreadDetach()
+{
+    auto cache = (ModuleRanges::Cache*)TlsGetValue(modcacheslot);
+    if(!cache)
+        return;
+    TlsSetValue(modcacheslot, nullptr);
+    delete cache;
+}
+
 void GetModuleInfo(MODINFO & Info, ULONG_PTR FileMapVA)
 {
     // Get the entry point
@@ -153,6 +196,7 @@ bool ModLoad(duint Base, duint Size, const char* FullPath)
     // Add module to list
     EXCLUSIVE_ACQUIRE(LockModules);
     modinfo.insert(std::make_pair(Range(Base, Base + Size - 1), info));
+    ModPublishRanges();
     EXCLUSIVE_RELEASE();
 
     // Put labels for virtual module exports
@@ -188,6 +232,7 @@ bool ModUnload(duint Base)
 
     // Remove it from the list
     modinfo.erase(found);
+    ModPublishRanges();
     EXCLUSIVE_RELEASE();
 
     // Update symbols
@@ -209,6 +254,7 @@ void ModClear()
     }
 
     modinfo.clear();
+    ModPublishRanges();
 
     EXCLUSIVE_RELEASE();
 
@@ -252,27 +298,23 @@ bool ModNameFromAddr(duint Address, char* Name, bool Extension)
 
 duint ModBaseFromAddr(duint Address)
 {
-    SHARED_ACQUIRE(LockModules);
-
-    auto module = ModInfoFromAddr(Address);
+    MODRANGE module;
 
-    if(!module)
+    if(!ModRangeFromAddr(Address, module))
         return 0;
 
-    return module->base;
+    return module.start;
 }
 
 duint ModHashFromAddr(duint Address)
 {
     // Returns a unique hash from a virtual address
-    SHARED_ACQUIRE(LockModules);
-
-    auto module = ModInfoFromAddr(Address);
+    MODRANGE module;
 
-    if(!module)
+    if(!ModRangeFromAddr(Address, module))
         return Address;
 
-    return module->hash + (Address - module->base);
+    return module.hash + (Address - module.start);
 }
 
 duint ModHashFromName(const char* Module)
@@ -312,14 +354,12 @@ duint ModBaseFromName(const char* Module)
 
 duint ModSizeFromAddr(duint Address)
 {
-    SHARED_ACQUIRE(LockModules);
-
-    auto module = ModInfoFromAddr(Address);
+    MODRANGE module;
 
-    if(!module)
+    if(!ModRangeFromAddr(Address, module))
         return 0;
 
-    return module->size;
+    return module.end - module.start + 1;
 }
 
 bool ModSectionsFromAddr(duint Address, std::vector<MODSECTIONINFO>* Sections)
@@ -419,15 +459,13 @@ bool ModAddImportToModule(duint Base, const MODIMPORTINFO & importInfo)
 
 int ModGetParty(duint Address)
 {
-    SHARED_ACQUIRE(LockModules);
-
-    auto module = ModInfoFromAddr(Address);
+    MODRANGE module;
 
     // If the module is not found, it is an user module
-    if(!module)
+    if(!ModRangeFromAddr(Address, module))
         return 0;
 
-    return module->party;
+    return module.party;
 }
 
 void ModSetParty(duint Address, int Party)
@@ -441,4 +479,5 @@ void ModSetParty(duint Address, int Party)
         return;
 
     module->party = Party;
+    ModPublishRanges();
 }
@@ -42,6 +42,7 @@ struct MODINFO
 bool ModLoad(duint Base, duint Size, const char* FullPath);
 bool ModUnload(duint Base);
 void ModClear();
+void ModThreadDetach();
 MODINFO* ModInfoFromAddr(duint Address);
 bool ModNameFromAddr(duint Address, char* Name, bool Extension);
 duint ModBaseFromAddr(duint Address);
@@ -0,0 +1,83 @@
+#ifndef _MODULERANGES_H
+#define _MODULERANGES_H
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct MODRANGE
+{
+    size_t start;
+    size_t end;
+    size_t hash;
+    int party;
+};
+
+/**
+ * @brief Immutable copy of the module ranges, replaced by Publish and read without a lock
+ * (it only depends on the standard library).
+ * The caller keeps a Cache per thread with the last hit, module.cpp uses a TLS slot.
+**/
+class ModuleRanges
+{
+public:
+    struct Cache
+    {
+        unsigned int generation = 0; //0 when empty, only used while it matches the published ranges
+        MODRANGE range;
+    };
+
+    ModuleRanges()
+        : generation(0)
+    {
+    }
+
+    //Replaces the ranges (sorted by start), the writers have to be serialized
+    void Publish(std::vector<MODRANGE> ranges)
+    {
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->generation = generation + 1;
+        snapshot->ranges = std::move(ranges);
+        std::atomic_store(&current, std::shared_ptr<const Snapshot>(snapshot));
+        generation = snapshot->generation;
+    }
+
+    bool Find(size_t address, MODRANGE & range, Cache & cache) const
+    {
+        if(cache.generation && cache.generation == generation.load() && address >= cache.range.start && address <= cache.range.end)
+        {
+            range = cache.range;
+            return true;
+        }
+
+        auto snapshot = std::atomic_load(&current);
+        if(!snapshot)
+            return false;
+        const auto & list = snapshot->ranges;
+        auto found = std::upper_bound(list.begin(), list.end(), address, [](size_t addr, const MODRANGE & range)
+        {
+            return addr < range.start;
+        });
+        if(found == list.begin() || address > (--found)->end)
+            return false;
+
+        cache.generation = snapshot->generation;
+        cache.range = *found;
+        range = *found;
+        return true;
+    }
+
+private:
+    struct Snapshot
+    {
+        unsigned int generation;
+        std::vector<MODRANGE> ranges;
+    };
+
+    std::shared_ptr<const Snapshot> current;
+    std::atomic<unsigned int> generation;
+};
+
+#endif //_MODULERANGES_H
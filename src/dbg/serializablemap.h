@@ -105,6 +105,11 @@ class SerializableTMap
 public:
     using TValuePred = std::function<bool(const TValue & value)>;
 
+    SerializableTMap()
+        : mGeneration(0)
+    {
+    }
+
     virtual ~SerializableTMap()
     {
     }
@@ -134,12 +139,14 @@ public:
     bool Delete(const TKey & key)
     {
         EXCLUSIVE_ACQUIRE(TLock);
+        mGeneration++;
         return mMap.erase(key) > 0;
     }
 
     void DeleteWhere(TValuePred predicate)
     {
         EXCLUSIVE_ACQUIRE(TLock);
+        mGeneration++;
         for(auto itr = mMap.begin(); itr != mMap.end();)
         {
             if(predicate(itr->second))
@@ -162,6 +169,7 @@ public:
     void Clear()
     {
         EXCLUSIVE_ACQUIRE(TLock);
+        mGeneration++;
         mMap.clear();
     }
 
@@ -243,6 +251,13 @@ public:
         return true;
     }
 
+    //Changes every time an entry is added or deleted
+    duint Generation() const
+    {
+        SHARED_ACQUIRE(TLock);
+        return mGeneration;
+    }
+
     TMap & GetDataUnsafe()
     {
         return mMap;
@@ -256,9 +271,11 @@ protected:
 
 private:
     TMap mMap;
+    duint mGeneration;
 
     bool addNoLock(const TValue & value)
     {
+        mGeneration++;
         mMap[makeKey(value)] = value;
         return true;
     }
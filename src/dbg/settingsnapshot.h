@@ -0,0 +1,56 @@
+#ifndef _SETTINGSNAPSHOT_H
+#define _SETTINGSNAPSHOT_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Immutable copy of values read from the settings, shared between threads without a lock
+ * (it only depends on the standard library). The copy is read again when the generation of the
+ * settings store changed, so writes that do not send DBG_SETTINGS_UPDATED are picked up as well.
+**/
+template<typename T>
+class SettingsSnapshot
+{
+public:
+    typedef std::function<size_t()> GenerationFunction;
+    typedef std::function<void(T & value)> ReadFunction;
+
+    SettingsSnapshot(GenerationFunction generation, ReadFunction read)
+        : generation(generation),
+          read(read)
+    {
+    }
+
+    std::shared_ptr<const T> Get()
+    {
+        auto snapshot = std::atomic_load(&current);
+        if(!snapshot || snapshot->generation != generation())
+            return Update();
+        return std::shared_ptr<const T>(snapshot, &snapshot->value);
+    }
+
+    //Reads the settings again
+    std::shared_ptr<const T> Update()
+    {
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->generation = generation(); //before reading, a concurrent write makes the next Get read again
+        read(snapshot->value);
+        std::atomic_store(&current, std::shared_ptr<const Snapshot>(snapshot));
+        return std::shared_ptr<const T>(snapshot, &snapshot->value);
+    }
+
+private:
+    struct Snapshot
+    {
+        size_t generation;
+        T value;
+    };
+
+    GenerationFunction generation;
+    ReadFunction read;
+    std::shared_ptr<const Snapshot> current;
+};
+
+#endif //_SETTINGSNAPSHOT_H
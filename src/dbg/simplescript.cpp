@@ -11,9 +11,37 @@
 #include "debugger.h"
 #include "filehelper.h"
 #include "stringformat.h"
+#include "commandparser.h"
+#include "expressionparser.h"
+#include "value.h"
+
+enum SCRIPTINTERNAL
+{
+    internalnone,
+    internalret,
+    internalinvalid,
+    internalpause,
+    internalnop
+};
+
+//compiled form of a line, everything that does not depend on the state is done once when loading
+struct SCRIPTINSTRUCTION
+{
+    SCRIPTINTERNAL internal;
+    String command; //trimmed command text
+    COMMAND* cmd; //resolved command (null for expressions)
+    unsigned int cmdgeneration; //command list generation cmd was resolved in (0 if unresolved)
+    CommandArguments arguments; //parsed arguments
+    std::shared_ptr<ExpressionParser> expression; //lines that are no command are evaluated as expression
+    int labelline; //line of the branch label
+};
 
 static std::vector<LINEMAPENTRY> linemap;
 
+static std::vector<SCRIPTINSTRUCTION> scriptinstructions; //same indices as linemap
+
+static std::unordered_map<String, int> scriptlabels; //label -> line
+
 static std::vector<SCRIPTBP> scriptbplist;
 
 static std::vector<int> scriptstack;
@@ -51,11 +79,10 @@ static SCRIPTBRANCHTYPE scriptgetbranchtype(const char* text)
 
 static int scriptlabelfind(const char* labelname)
 {
-    int linecount = (int)linemap.size();
-    for(int i = 0; i < linecount; i++)
-        if(linemap.at(i).type == linelabel && !strcmp(linemap.at(i).u.label, labelname))
-            return i + 1;
-    return 0;
+    auto found = scriptlabels.find(labelname);
+    if(found == scriptlabels.end())
+        return 0;
+    return found->second;
 }
 
 static inline bool isEmptyLine(SCRIPTLINETYPE type)
@@ -88,6 +115,8 @@ static bool scriptcreatelinemap(const char* filename)
     LINEMAPENTRY entry;
     memset(&entry, 0, sizeof(entry));
     std::vector<LINEMAPENTRY>().swap(linemap);
+    std::vector<SCRIPTINSTRUCTION>().swap(scriptinstructions);
+    scriptlabels.clear();
     for(size_t i = 0, j = 0; i < len; i++) //make raw line map
     {
         if(filedata[i] == '\r' && filedata[i + 1] == '\n') //windows file
@@ -125,7 +154,10 @@ static bool scriptcreatelinemap(const char* filename)
             linemap.push_back(entry);
         }
         else
-            j += sprintf(temp + j, "%c", filedata[i]);
+        {
+            temp[j++] = filedata[i];
+            temp[j] = '\0';
+        }
     }
     if(*temp)
     {
@@ -186,6 +218,7 @@ static bool scriptcreatelinemap(const char* filename)
                 sprintf(message, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Empty label detected on line %d!")), i + 1);
                 GuiScriptError(0, message);
                 std::vector<LINEMAPENTRY>().swap(linemap);
+                scriptlabels.clear();
                 return false;
             }
             int foundlabel = scriptlabelfind(cur.u.label);
@@ -195,8 +228,10 @@ static bool scriptcreatelinemap(const char* filename)
                 sprintf(message, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Duplicate label \"%s\" detected on lines %d and %d!")), cur.u.label, foundlabel, i + 1);
                 GuiScriptError(0, message);
                 std::vector<LINEMAPENTRY>().swap(linemap);
+                scriptlabels.clear();
                 return false;
             }
+            scriptlabels[cur.u.label] = i + 1;
         }
         else if(scriptgetbranchtype(cur.raw) != scriptnobranch) //branch
         {
@@ -236,6 +271,7 @@ static bool scriptcreatelinemap(const char* filename)
                 sprintf(message, GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Invalid branch label \"%s\" detected on line %d!")), currentLine.u.branch.branchlabel, i + 1);
                 GuiScriptError(0, message);
                 std::vector<LINEMAPENTRY>().swap(linemap);
+                scriptlabels.clear();
                 return false;
             }
             else //set the branch destination line
@@ -253,6 +289,55 @@ static bool scriptcreatelinemap(const char* filename)
     return true;
 }
 
+static bool scriptisinternalcommand(const char* text, const char* cmd);
+
+static void scriptcompile()
+{
+    int linecount = (int)linemap.size();
+    scriptinstructions.resize(linecount);
+    for(int i = 0; i < linecount; i++)
+    {
+        const auto & cur = linemap.at(i);
+        auto & instruction = scriptinstructions.at(i);
+        instruction.internal = internalnone;
+        instruction.cmd = nullptr;
+        instruction.cmdgeneration = 0;
+        instruction.labelline = 0;
+        if(cur.type == linecommand)
+        {
+            if(scriptisinternalcommand(cur.u.command, "ret"))
+                instruction.internal = internalret;
+            else if(scriptisinternalcommand(cur.u.command, "invalid"))
+                instruction.internal = internalinvalid;
+            else if(scriptisinternalcommand(cur.u.command, "pause"))
+                instruction.internal = internalpause;
+            else if(scriptisinternalcommand(cur.u.command, "nop"))
+                instruction.internal = internalnop;
+            else
+                instruction.command = StringUtils::Trim(cur.u.command);
+        }
+        else if(cur.type == linebranch)
+            instruction.labelline = scriptlabelfind(cur.u.branch.branchlabel);
+    }
+}
+
+static void scriptresolve(SCRIPTINSTRUCTION & instruction)
+{
+    //commands can be (un)registered by plugins while the script is loaded
+    if(instruction.cmdgeneration == cmdgeneration())
+        return;
+    instruction.cmdgeneration = cmdgeneration();
+    instruction.cmd = cmdget(instruction.command.c_str());
+    instruction.expression.reset();
+    if(instruction.cmd && instruction.cmd->cbCommand)
+        instruction.arguments.Parse(instruction.command);
+    else
+    {
+        instruction.cmd = nullptr;
+        instruction.expression = std::make_shared<ExpressionParser>(instruction.command);
+    }
+}
+
 static bool scriptinternalbpget(int line) //internal bpget routine
 {
     int bpcount = (int)scriptbplist.size();
@@ -300,20 +385,23 @@ static bool scriptisinternalcommand(const char* text, const char* cmd)
     return false;
 }
 
-static CMDRESULT scriptinternalcmdexec(const char* cmd)
+static CMDRESULT scriptinternalret()
 {
-    if(scriptisinternalcommand(cmd, "ret")) //script finished
+    if(!scriptstack.size()) //nothing on the stack
     {
-        if(!scriptstack.size()) //nothing on the stack
-        {
-            String TranslatedString = GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Script finished!"));
-            GuiScriptMessage(TranslatedString.c_str());
-            return STATUS_EXIT;
-        }
-        scriptIp = scriptstack.back(); //set scriptIp to the call address (scriptinternalstep will step over it)
-        scriptstack.pop_back(); //remove last stack entry
-        return STATUS_CONTINUE;
+        String TranslatedString = GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "Script finished!"));
+        GuiScriptMessage(TranslatedString.c_str());
+        return STATUS_EXIT;
     }
+    scriptIp = scriptstack.back(); //set scriptIp to the call address (scriptinternalstep will step over it)
+    scriptstack.pop_back(); //remove last stack entry
+    return STATUS_CONTINUE;
+}
+
+static CMDRESULT scriptinternalcmdexec(const char* cmd)
+{
+    if(scriptisinternalcommand(cmd, "ret")) //script finished
+        return scriptinternalret();
     else if(scriptisinternalcommand(cmd, "invalid")) //invalid command for testing
         return STATUS_ERROR;
     else if(scriptisinternalcommand(cmd, "pause")) //pause the script
@@ -326,6 +414,45 @@ static CMDRESULT scriptinternalcmdexec(const char* cmd)
     return res;
 }
 
+static CMDRESULT scriptinstructionexec(SCRIPTINSTRUCTION & instruction)
+{
+    switch(instruction.internal)
+    {
+    case internalret:
+        return scriptinternalret();
+    case internalinvalid:
+        return STATUS_ERROR;
+    case internalpause:
+        return STATUS_PAUSE;
+    case internalnop:
+        return STATUS_CONTINUE;
+    default:
+        break;
+    }
+    if(instruction.command.empty())
+        return STATUS_ERROR;
+    scriptresolve(instruction);
+    CMDRESULT res;
+    if(!instruction.cmd) //same as cmddirectexec
+    {
+        duint result;
+        if(instruction.expression->Calculate(result, valuesignedcalc(), true, false))
+        {
+            varset("$ans", result, true);
+            res = STATUS_CONTINUE;
+        }
+        else
+            res = STATUS_ERROR;
+    }
+    else if(instruction.cmd->debugonly && !DbgIsDebugging())
+        res = STATUS_ERROR;
+    else
+        res = instruction.cmd->cbCommand(instruction.arguments.Count(), instruction.arguments.Argv());
+    while(DbgIsDebugging() && dbgisrunning() && !bAbort) //while not locked (NOTE: possible deadlock)
+        Sleep(1);
+    return res;
+}
+
 static bool scriptinternalbranch(SCRIPTBRANCHTYPE type) //determine if we should jump
 {
     duint ezflag = 0;
@@ -373,10 +500,10 @@ static bool scriptinternalbranch(SCRIPTBRANCHTYPE type) //determine if we should
 static bool scriptinternalcmd()
 {
     bool bContinue = true;
-    LINEMAPENTRY cur = linemap.at(scriptIp - 1);
+    const LINEMAPENTRY & cur = linemap.at(scriptIp - 1);
     if(cur.type == linecommand)
     {
-        switch(scriptinternalcmdexec(cur.u.command))
+        switch(scriptinstructionexec(scriptinstructions.at(scriptIp - 1)))
         {
         case STATUS_CONTINUE:
             break;
@@ -401,7 +528,7 @@ static bool scriptinternalcmd()
         if(cur.u.branch.type == scriptcall) //calls have a special meaning
             scriptstack.push_back(scriptIp);
         if(scriptinternalbranch(cur.u.branch.type))
-            scriptIp = scriptlabelfind(cur.u.branch.branchlabel);
+            scriptIp = scriptinstructions.at(scriptIp - 1).labelline;
     }
     return bContinue;
 }
@@ -466,6 +593,7 @@ DWORD WINAPI scriptLoadSync(void* filename)
     bAbort = false;
     if(!scriptcreatelinemap(reinterpret_cast<const char*>(filename)))
         return 1; // Script load failed
+    scriptcompile();
     int lines = (int)linemap.size();
     const char** script = reinterpret_cast<const char**>(BridgeAlloc(lines * sizeof(const char*)));
     for(int i = 0; i < lines; i++) //add script lines
@@ -0,0 +1,182 @@
+#include "snapshotstore.h"
+#include "murmurhash.h"
+#include "analysis/workpool.h"
+#include <cstring>
+#include <algorithm>
+
+SnapshotStore::SnapshotStore(size_t readSize)
+    : readSize(std::max(readSize / PageSize, size_t(1)) * PageSize)
+{
+}
+
+// Returns the stored page with the same contents, or stores a new one (lock must be held)
+SnapshotStore::PagePtr SnapshotStore::store(const unsigned char* data, size_t hash, size_t & newPages)
+{
+    auto found = pages.equal_range(hash);
+    for(auto i = found.first; i != found.second; ++i)
+    {
+        if(memcmp(i->second->data, data, PageSize) == 0)
+            return i->second;
+    }
+
+    auto page = std::make_shared<Page>();
+    page->hash = hash;
+    memcpy(page->data, data, PageSize);
+    pages.insert(std::make_pair(hash, page));
+    newPages++;
+    return page;
+}
+
+size_t SnapshotStore::Capture(WorkPool & pool, SnapshotMemorySource & source, Pages & result)
+{
+    std::vector<SnapshotRegion> regions;
+    source.Regions(regions);
+
+    // Regions are split in blocks, so a huge region is read by every thread and never needs a buffer of its size
+    std::vector<SnapshotRegion> blocks;
+    for(const auto & region : regions)
+    {
+        for(size_t offset = 0; offset < region.size; offset += readSize)
+        {
+            SnapshotRegion block = { region.base + offset, std::min(readSize, region.size - offset) };
+            blocks.push_back(block);
+        }
+    }
+
+    // Every worker reads and hashes its own blocks, only storing the pages takes the lock
+    std::vector<Pages> blockPages(blocks.size());
+    std::vector<size_t> blockNewPages(blocks.size());
+    pool.ParallelFor(blocks.size(), 1, [&](size_t i, size_t, size_t)
+    {
+        auto base = blocks[i].base;
+        auto size = blocks[i].size;
+        std::vector<unsigned char> data(size);
+        std::vector<bool> readable(size / PageSize, true);
+        if(!source.Read(base, data.data(), size))
+        {
+            for(size_t offset = 0; offset < size; offset += PageSize)
+                readable[offset / PageSize] = source.Read(base + offset, data.data() + offset, PageSize);
+        }
+
+        std::vector<size_t> hashes(readable.size());
+        for(size_t page = 0; page < readable.size(); page++)
+            hashes[page] = size_t(murmurhash(data.data() + page * PageSize, int(PageSize)));
+
+        auto & pages = blockPages[i];
+        pages.reserve(readable.size());
+        std::lock_guard<std::mutex> guard(lock);
+        for(size_t page = 0; page < readable.size(); page++)
+        {
+            if(readable[page])
+                pages.push_back(std::make_pair(base + page * PageSize, store(data.data() + page * PageSize, hashes[page], blockNewPages[i])));
+        }
+    });
+
+    // Blocks are sorted and do not overlap
+    result.clear();
+    size_t newPages = 0;
+    for(size_t i = 0; i < blocks.size(); i++)
+    {
+        result.insert(result.end(), blockPages[i].begin(), blockPages[i].end());
+        newPages += blockNewPages[i];
+    }
+    return newPages;
+}
+
+void SnapshotStore::Purge()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    for(auto i = pages.begin(); i != pages.end();)
+    {
+        if(i->second.use_count() == 1)
+            i = pages.erase(i);
+        else
+            ++i;
+    }
+}
+
+void SnapshotStore::Clear()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    pages.clear();
+}
+
+size_t SnapshotStore::StoredPages()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return pages.size();
+}
+
+static void addRange(SnapshotStore::Ranges & ranges, size_t start, size_t end)
+{
+    // Merge adjacent ranges
+    if(!ranges.empty() && ranges.back().second + 1 == start)
+        ranges.back().second = end;
+    else
+        ranges.push_back(std::make_pair(start, end));
+}
+
+void SnapshotStore::Diff(WorkPool & pool, const Pages & oldPages, const Pages & newPages, Ranges & changed)
+{
+    changed.clear();
+
+    // Pages with the same contents share the same stored page (found by hash when they were stored),
+    // so only the pages that are different objects are compared byte by byte, in parallel
+    typedef std::pair<const Page*, const Page*> PagePair;
+    std::vector<std::pair<size_t, PagePair>> pages; // Sorted by page address
+    auto oldItr = oldPages.begin(), newItr = newPages.begin();
+    while(oldItr != oldPages.end() || newItr != newPages.end())
+    {
+        if(newItr == newPages.end() || (oldItr != oldPages.end() && oldItr->first < newItr->first))
+        {
+            pages.push_back(std::make_pair(oldItr->first, PagePair(oldItr->second.get(), nullptr)));
+            ++oldItr;
+        }
+        else if(oldItr == oldPages.end() || newItr->first < oldItr->first)
+        {
+            pages.push_back(std::make_pair(newItr->first, PagePair(nullptr, newItr->second.get())));
+            ++newItr;
+        }
+        else
+        {
+            if(oldItr->second != newItr->second)
+                pages.push_back(std::make_pair(oldItr->first, PagePair(oldItr->second.get(), newItr->second.get())));
+            ++oldItr;
+            ++newItr;
+        }
+    }
+
+    auto grain = pool.Grain(pages.size(), 64);
+    std::vector<Ranges> chunkRanges(WorkPool::ChunkCount(pages.size(), grain));
+    pool.ParallelFor(pages.size(), grain, [&](size_t chunk, size_t start, size_t end)
+    {
+        auto & ranges = chunkRanges[chunk];
+        for(size_t i = start; i < end; i++)
+        {
+            auto addr = pages[i].first;
+            auto oldPage = pages[i].second.first;
+            auto newPage = pages[i].second.second;
+            if(!oldPage || !newPage) // The page was allocated or freed
+            {
+                addRange(ranges, addr, addr + PageSize - 1);
+                continue;
+            }
+            for(size_t offset = 0; offset < PageSize;)
+            {
+                if(oldPage->data[offset] == newPage->data[offset])
+                {
+                    offset++;
+                    continue;
+                }
+                auto runStart = offset;
+                while(offset < PageSize && oldPage->data[offset] != newPage->data[offset])
+                    offset++;
+                addRange(ranges, addr + runStart, addr + offset - 1);
+            }
+        }
+    });
+
+    for(const auto & ranges : chunkRanges)
+        for(const auto & range : ranges)
+            addRange(changed, range.first, range.second);
+}
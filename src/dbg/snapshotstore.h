@@ -0,0 +1,74 @@
+#ifndef _SNAPSHOTSTORE_H
+#define _SNAPSHOTSTORE_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class WorkPool;
+
+struct SnapshotRegion
+{
+    size_t base;
+    size_t size; //multiple of the page size
+};
+
+//Memory that is captured, the debuggee or a fake backend in the tests
+class SnapshotMemorySource
+{
+public:
+    virtual ~SnapshotMemorySource()
+    {
+    }
+
+    //The committed and readable regions, sorted by address
+    virtual void Regions(std::vector<SnapshotRegion> & regions) = 0;
+
+    //Reads size bytes at address, the pages that fail on their own are left out of the snapshot
+    virtual bool Read(size_t address, void* buffer, size_t size) = 0;
+};
+
+/**
+ * @brief Pages of the memory snapshots, stored once per distinct content (it only depends on the standard library).
+ * A snapshot is a sorted list of (address, page), the snapshots share the stored pages.
+**/
+class SnapshotStore
+{
+public:
+    static const size_t PageSize = 0x1000;
+
+    struct Page
+    {
+        size_t hash;
+        unsigned char data[PageSize];
+    };
+
+    typedef std::shared_ptr<const Page> PagePtr;
+    typedef std::vector<std::pair<size_t, PagePtr>> Pages; //sorted by page address
+    typedef std::vector<std::pair<size_t, size_t>> Ranges; //first and last byte
+
+    explicit SnapshotStore(size_t readSize = 1024 * 1024);
+
+    //Reads the memory in blocks of readSize bytes, in parallel, and returns the pages that were not stored before
+    size_t Capture(WorkPool & pool, SnapshotMemorySource & source, Pages & pages);
+
+    //Drops the stored pages that no snapshot uses anymore
+    void Purge();
+    void Clear();
+    size_t StoredPages();
+
+    //The changed bytes between two snapshots, adjacent ranges are merged
+    static void Diff(WorkPool & pool, const Pages & oldPages, const Pages & newPages, Ranges & changed);
+
+private:
+    size_t readSize;
+    std::mutex lock;
+    std::unordered_multimap<size_t, PagePtr> pages; //content hash -> page
+
+    PagePtr store(const unsigned char* data, size_t hash, size_t & newPages);
+};
+
+#endif //_SNAPSHOTSTORE_H
@@ -2,86 +2,76 @@
 #include "value.h"
 #include "symbolinfo.h"
 #include "module.h"
+#include "expressionparser.h"
 
-namespace ValueType
+static String printValue(duint valuint, ValueType::ValueType type)
 {
-    enum ValueType
-    {
-        Unknown,
-        SignedDecimal,
-        UnsignedDecimal,
-        Hex,
-        Pointer,
-        String,
-        AddrInfo,
-        Module
-    };
-}
-
-static String printValue(FormatValueType value, ValueType::ValueType type)
-{
-    duint valuint = 0;
     char string[MAX_STRING_SIZE] = "";
     String result = "???";
-    if(valfromstring(value, &valuint))
+    switch(type)
     {
-        switch(type)
-        {
-        case ValueType::Unknown:
-            break;
+    case ValueType::Unknown:
+        break;
 #ifdef _WIN64
-        case ValueType::SignedDecimal:
-            result = StringUtils::sprintf("%lld", valuint);
-            break;
-        case ValueType::UnsignedDecimal:
-            result = StringUtils::sprintf("%llu", valuint);
-            break;
-        case ValueType::Hex:
-            result = StringUtils::sprintf("%llX", valuint);
-            break;
+    case ValueType::SignedDecimal:
+        result = StringUtils::sprintf("%lld", valuint);
+        break;
+    case ValueType::UnsignedDecimal:
+        result = StringUtils::sprintf("%llu", valuint);
+        break;
+    case ValueType::Hex:
+        result = StringUtils::sprintf("%llX", valuint);
+        break;
 #else //x86
-        case ValueType::SignedDecimal:
-            result = StringUtils::sprintf("%d", valuint);
-            break;
-        case ValueType::UnsignedDecimal:
-            result = StringUtils::sprintf("%u", valuint);
-            break;
-        case ValueType::Hex:
-            result = StringUtils::sprintf("%X", valuint);
-            break;
+    case ValueType::SignedDecimal:
+        result = StringUtils::sprintf("%d", valuint);
+        break;
+    case ValueType::UnsignedDecimal:
+        result = StringUtils::sprintf("%u", valuint);
+        break;
+    case ValueType::Hex:
+        result = StringUtils::sprintf("%X", valuint);
+        break;
 #endif //_WIN64
-        case ValueType::Pointer:
-            result = StringUtils::sprintf("%p", valuint);
-            break;
-        case ValueType::String:
-            if(DbgGetStringAt(valuint, string))
-                result = string;
-            break;
-        case ValueType::AddrInfo:
-        {
-            auto symbolic = SymGetSymbolicName(valuint);
-            if(DbgGetStringAt(valuint, string))
-                result = string;
-            else if(symbolic.length())
-                result = symbolic;
-            else
-                result.clear();
-        }
+    case ValueType::Pointer:
+        result = StringUtils::sprintf("%p", valuint);
         break;
-        case ValueType::Module:
-        {
-            char mod[MAX_MODULE_SIZE] = "";
-            ModNameFromAddr(valuint, mod, true);
-            result = mod;
-        }
+    case ValueType::String:
+        if(DbgGetStringAt(valuint, string))
+            result = string;
+        break;
+    case ValueType::AddrInfo:
+    {
+        auto symbolic = SymGetSymbolicName(valuint);
+        if(DbgGetStringAt(valuint, string))
+            result = string;
+        else if(symbolic.length())
+            result = symbolic;
+        else
+            result.clear();
+    }
+    break;
+    case ValueType::Module:
+    {
+        char mod[MAX_MODULE_SIZE] = "";
+        ModNameFromAddr(valuint, mod, true);
+        result = mod;
+    }
+    break;
+    default:
         break;
-        default:
-            break;
-        }
     }
     return result;
 }
 
+static String printValue(FormatValueType value, ValueType::ValueType type)
+{
+    duint valuint = 0;
+    if(valfromstring(value, &valuint))
+        return printValue(valuint, type);
+    return "???";
+}
+
 static const char* getArgExpressionType(const String & formatString, ValueType::ValueType & type)
 {
     auto hasExplicitType = false;
@@ -191,20 +181,11 @@ String stringformat(String format, const FormatValueVector & values)
     return output;
 }
 
-static String handleFormatStringInline(const String & formatString)
-{
-    auto type = ValueType::Unknown;
-    auto value = getArgExpressionType(formatString, type);
-    if(value && *value)
-        return printValue(value, type);
-    return GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "[Formatting Error]"));
-}
-
-String stringformatinline(String format)
+FormatTemplate::FormatTemplate(String format)
 {
     StringUtils::ReplaceAll(format, "\\n", "\n");
     int len = (int)format.length();
-    String output;
+    String text;
     String formatString;
     bool inFormatter = false;
     for(int i = 0; i < len; i++)
@@ -212,13 +193,13 @@ String stringformatinline(String format)
         //handle escaped format sequences "{{" and "}}"
         if(format[i] == '{' && (i + 1 < len && format[i + 1] == '{'))
         {
-            output += "{";
+            text += "{";
             i++;
             continue;
         }
         if(format[i] == '}' && (i + 1 < len && format[i + 1] == '}'))
         {
-            output += "}";
+            text += "}";
             i++;
             continue;
         }
@@ -233,18 +214,80 @@ String stringformatinline(String format)
             inFormatter = false;
             if(formatString.length())
             {
-                output += handleFormatStringInline(formatString);
+                addText(text);
+                addFormatString(formatString);
                 formatString.clear();
             }
         }
         else if(inFormatter)  //inside brackets
             formatString += format[i];
         else //outside brackets
-            output += format[i];
+            text += format[i];
     }
     if(inFormatter && formatString.size())
-        output += handleFormatStringInline(formatString);
+    {
+        addText(text);
+        addFormatString(formatString);
+    }
     else if(inFormatter)
-        output += "{";
+        text += "{";
+    addText(text);
+}
+
+String FormatTemplate::Print() const
+{
+    String output;
+    for(const auto & segment : mSegments)
+    {
+        if(!segment.expression)
+        {
+            output += segment.text;
+            continue;
+        }
+        duint value = 0;
+        if(segment.expression->Calculate(value, valuesignedcalc(), false))
+            output += printValue(value, segment.type);
+        else
+            output += "???";
+    }
     return output;
 }
+
+void FormatTemplate::addText(String & text)
+{
+    if(text.empty())
+        return;
+    if(!mSegments.empty() && !mSegments.back().expression)
+        mSegments.back().text += text;
+    else
+    {
+        Segment segment;
+        segment.text = text;
+        segment.type = ValueType::Unknown;
+        mSegments.push_back(segment);
+    }
+    text.clear();
+}
+
+void FormatTemplate::addFormatString(const String & formatString)
+{
+    auto type = ValueType::Unknown;
+    auto value = getArgExpressionType(formatString, type);
+    if(value && *value)
+    {
+        Segment segment;
+        segment.type = type;
+        segment.expression = std::make_shared<ExpressionParser>(value);
+        mSegments.push_back(segment);
+    }
+    else
+    {
+        String error = GuiTranslateText(QT_TRANSLATE_NOOP("DBG", "[Formatting Error]"));
+        addText(error);
+    }
+}
+
+String stringformatinline(String format)
+{
+    return FormatTemplate(format).Print();
+}
@@ -2,10 +2,49 @@
 #define _STRINGFORMAT_H
 
 #include "_global.h"
+#include <memory>
+
+class ExpressionParser;
 
 typedef const char* FormatValueType;
 typedef std::vector<FormatValueType> FormatValueVector;
 
+namespace ValueType
+{
+    enum ValueType
+    {
+        Unknown,
+        SignedDecimal,
+        UnsignedDecimal,
+        Hex,
+        Pointer,
+        String,
+        AddrInfo,
+        Module
+    };
+}
+
+//Inline format string parsed once, for text that is printed many times (breakpoint logs for example)
+class FormatTemplate
+{
+public:
+    explicit FormatTemplate(String format);
+    String Print() const;
+
+private:
+    struct Segment
+    {
+        String text; //literal text (when there is no expression)
+        ValueType::ValueType type;
+        std::shared_ptr<ExpressionParser> expression;
+    };
+
+    std::vector<Segment> mSegments;
+
+    void addText(String & text);
+    void addFormatString(const String & formatString);
+};
+
 String stringformat(String format, const FormatValueVector & values);
 String stringformatinline(String format);
 
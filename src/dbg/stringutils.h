@@ -5,6 +5,7 @@
 #include <vector>
 #include <sstream>
 #include <iomanip>
+#include <limits>
 
 typedef std::string String;
 typedef std::wstring WString;
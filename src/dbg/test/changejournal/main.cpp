@@ -0,0 +1,284 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../changejournal.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+typedef ChangeJournal<int, int> Journal;
+
+static bool hasChange(const std::vector<Journal::Change> & changes, int key, Journal::Kind kind, int value)
+{
+    for(const auto & change : changes)
+        if(change.key == key)
+            return change.kind == kind && change.value == value;
+    return false;
+}
+
+static void testSince()
+{
+    Journal journal(8);
+    std::vector<Journal::Change> changes;
+    size_t current;
+    CHECK(journal.Since(0, changes, current) && changes.empty() && current == 0);
+    CHECK(!journal.Since(size_t(-1), changes, current) && current == 0); //never read before
+
+    journal.Record(Journal::Added, 1, 10);
+    journal.Record(Journal::Added, 2, 20);
+    journal.Record(Journal::Modified, 2, 21); //not merged into the addition, a reader could have seen it
+    journal.Record(Journal::Modified, 1, 11);
+    journal.Record(Journal::Modified, 1, 12); //hit counts of the same breakpoint take one entry
+    journal.Record(Journal::Modified, 1, 13);
+    CHECK(journal.Sequence() == 6);
+    CHECK(journal.Since(0, changes, current) && current == 6 && changes.size() == 2);
+    CHECK(hasChange(changes, 1, Journal::Added, 13));
+    CHECK(hasChange(changes, 2, Journal::Added, 21));
+
+    // A reader that saw the additions only gets the modifications
+    CHECK(journal.Since(2, changes, current) && changes.size() == 2);
+    CHECK(hasChange(changes, 1, Journal::Modified, 13));
+    CHECK(hasChange(changes, 2, Journal::Modified, 21));
+    CHECK(journal.Since(6, changes, current) && changes.empty());
+
+    // Removed and added again is a modification, added and removed is a removal
+    journal.Record(Journal::Removed, 1, 13);
+    journal.Record(Journal::Added, 1, 14);
+    journal.Record(Journal::Added, 3, 30);
+    journal.Record(Journal::Removed, 3, 30);
+    CHECK(journal.Since(6, changes, current) && current == 10 && changes.size() == 2);
+    CHECK(hasChange(changes, 1, Journal::Modified, 14));
+    CHECK(hasChange(changes, 3, Journal::Removed, 30));
+
+    // Only the last 8 changes are kept
+    for(int i = 0; i < 8; i++)
+        journal.Record(Journal::Added, 100 + i, i);
+    CHECK(!journal.Since(9, changes, current) && current == 18);
+    CHECK(journal.Since(10, changes, current) && changes.size() == 8);
+
+    journal.Reset();
+    CHECK(!journal.Since(18, changes, current) && current == 19);
+    CHECK(journal.Since(19, changes, current) && changes.empty());
+}
+
+// A view that applies the changes always ends up with the same items as the model, even when it has to reload
+static void testView()
+{
+    std::mt19937 random(1);
+    Journal journal(64);
+    std::map<int, int> model, view;
+    size_t sequence = size_t(-1);
+    std::vector<Journal::Change> changes;
+    int reloads = 0;
+    for(int i = 0; i < 20000; i++)
+    {
+        int key = int(random() % 50);
+        auto found = model.find(key);
+        if(found == model.end())
+        {
+            model[key] = i;
+            journal.Record(Journal::Added, key, i);
+        }
+        else if(random() % 4 == 0)
+        {
+            journal.Record(Journal::Removed, key, found->second);
+            model.erase(found);
+        }
+        else
+        {
+            found->second = i;
+            journal.Record(Journal::Modified, key, i);
+        }
+        if(random() % 8 == 0)
+            journal.Reset();
+
+        if(random() % (i < 10000 ? 2 : 200) == 0) //the view falls behind in the second half
+        {
+            if(journal.Since(sequence, changes, sequence))
+            {
+                for(const auto & change : changes)
+                {
+                    if(change.kind == Journal::Removed)
+                        view.erase(change.key);
+                    else
+                        view[change.key] = change.value;
+                }
+            }
+            else
+            {
+                view = model;
+                reloads++;
+            }
+            CHECK(view == model);
+        }
+    }
+    CHECK(reloads > 0);
+}
+
+// Stand-in for BREAKPOINT, the strings have the sizes of the real one
+struct Breakpoint
+{
+    size_t addr;
+    int type;
+    bool enabled;
+    unsigned int hitcount;
+    char name[256];
+    char mod[256];
+    char breakCondition[256];
+    char logText[256];
+    char logCondition[256];
+    char commandText[256];
+    char commandCondition[256];
+};
+
+typedef std::vector<std::string> Row;
+typedef std::vector<Row> Table;
+typedef ChangeJournal<size_t, size_t> BreakpointJournal;
+
+static const int Types = 5; //hardware, software, memory, dll and exception tables
+
+static Row toRow(const Breakpoint & bp)
+{
+    char address[32];
+    sprintf(address, "%016zX", bp.addr);
+    Row row(9);
+    row[0] = address;
+    row[1] = bp.name;
+    row[2] = std::string("<") + bp.mod + ">";
+    row[3] = bp.enabled ? "Enabled" : "Disabled";
+    row[4] = std::to_string(bp.hitcount);
+    row[5] = bp.logText;
+    row[6] = bp.breakCondition;
+    row[7] = "";
+    row[8] = bp.commandText;
+    return row;
+}
+
+// What reloadData did for every breakpoint update: copy every breakpoint once per table, write every row
+static void reloadTables(const std::map<size_t, Breakpoint> & breakpoints, Table* tables)
+{
+    for(int type = 0; type < Types; type++)
+    {
+        std::vector<Breakpoint> list; //BpGetList
+        list.reserve(breakpoints.size());
+        for(const auto & i : breakpoints)
+            list.push_back(i.second);
+        auto & table = tables[type];
+        table.clear();
+        for(const auto & bp : list)
+            if(bp.type == type)
+                table.push_back(toRow(bp));
+    }
+}
+
+// Only the rows of the breakpoints that changed, the row is found by its address like in the view
+static void applyChanges(const std::map<size_t, Breakpoint> & breakpoints, BreakpointJournal & journal, size_t & sequence, Table* tables)
+{
+    std::vector<BreakpointJournal::Change> changes;
+    if(!journal.Since(sequence, changes, sequence))
+    {
+        reloadTables(breakpoints, tables);
+        return;
+    }
+    for(const auto & change : changes)
+    {
+        const auto & bp = breakpoints.at(change.key);
+        auto row = toRow(bp);
+        auto & table = tables[bp.type];
+        size_t i = 0;
+        while(i < table.size() && table[i][0] != row[0])
+            i++;
+        if(i == table.size())
+            table.push_back(row);
+        else
+            table[i] = row;
+    }
+}
+
+static void benchmark()
+{
+    const int count = 500;
+    const int toggles = 10000;
+    const int hits = 1000;
+    std::mt19937 random(2);
+    std::map<size_t, Breakpoint> breakpoints;
+    for(int i = 0; i < count; i++)
+    {
+        Breakpoint bp;
+        memset(&bp, 0, sizeof(bp));
+        bp.addr = 0x140001000 + i * 0x10;
+        bp.type = i % Types;
+        bp.enabled = true;
+        sprintf(bp.name, "bpx_%d", i);
+        strcpy(bp.mod, "module.exe");
+        breakpoints[bp.addr] = bp;
+    }
+    printf("%d breakpoints, %d toggles and %d hits, the tables are updated after each one\n", count, toggles, hits);
+
+    for(int variant = 0; variant < 2; variant++)
+    {
+        BreakpointJournal journal;
+        size_t sequence = size_t(-1);
+        Table tables[Types];
+        applyChanges(breakpoints, journal, sequence, tables);
+        auto update = [&]()
+        {
+            if(variant == 0)
+                reloadTables(breakpoints, tables);
+            else
+                applyChanges(breakpoints, journal, sequence, tables);
+        };
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for(int i = 0; i < toggles; i++)
+        {
+            auto & bp = breakpoints[0x140001000 + (random() % count) * 0x10];
+            bp.enabled = !bp.enabled;
+            journal.Record(BreakpointJournal::Modified, bp.addr, 0);
+            update();
+        }
+        auto toggleTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        auto & hit = breakpoints[0x140001000 + count / 2 * 0x10];
+        for(int i = 0; i < hits; i++)
+        {
+            hit.hitcount++;
+            journal.Record(BreakpointJournal::Modified, hit.addr, 0);
+            update();
+        }
+        auto hitTime = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+        Table expected[Types];
+        reloadTables(breakpoints, expected);
+        for(int type = 0; type < Types; type++)
+            CHECK(tables[type] == expected[type]);
+        printf("%s: toggles %.1fms (%.1fus each), hits %.1fms\n", variant == 0 ? "reload every table" : "apply the changes",
+               toggleTime * 1e3, toggleTime * 1e6 / toggles, hitTime * 1e3);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testSince();
+    testView();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
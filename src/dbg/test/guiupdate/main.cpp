@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <vector>
+#include "../../guiupdatequeue.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+typedef GuiUpdateQueue::Clock Clock;
+using std::chrono::milliseconds;
+
+// Records what the queue delivers instead of updating the GUI
+struct MockSink
+{
+    std::mutex lock;
+    std::condition_variable delivered;
+    std::vector<GuiUpdateQueue::Update> updates;
+    std::vector<Clock::time_point> times;
+
+    GuiUpdateQueue::Sink sink()
+    {
+        return [this](const GuiUpdateQueue::Update & update)
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            updates.push_back(update);
+            times.push_back(Clock::now());
+            delivered.notify_all();
+        };
+    }
+
+    // Waits until count updates were delivered, returns false on timeout
+    bool wait(size_t count, milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        return delivered.wait_for(guard, timeout, [&]()
+        {
+            return updates.size() >= count;
+        });
+    }
+
+    size_t count()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return updates.size();
+    }
+
+    GuiUpdateQueue::Update last()
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        return updates.back();
+    }
+};
+
+// Requests between two frames end up in one update with the latest values
+static void testCoalesce()
+{
+    MockSink sink;
+    GuiUpdateQueue queue(sink.sink(), 10, milliseconds(50));
+    queue.Request(GUI_UPDATE_MEMORYMAP, 0, false, 0, false);
+    CHECK(sink.wait(1, milliseconds(1000)));
+    for(unsigned int i = 0; i < 1000; i++)
+        queue.Request(GUI_UPDATE_DISASSEMBLY, i, i == 10, 0, false);
+    queue.Request(GUI_UPDATE_STATE, 0, false, 3, false);
+    CHECK(sink.wait(2, milliseconds(1000)));
+    std::this_thread::sleep_for(milliseconds(250));
+    CHECK(sink.count() == 2);
+    auto update = sink.last();
+    CHECK(update.views == (GUI_UPDATE_DISASSEMBLY | GUI_UPDATE_STATE));
+    CHECK(update.disasmAddr == 999);
+    CHECK(update.stack);
+    CHECK(update.state == 3);
+    // the second update waited for the frame
+    CHECK(sink.times[1] - sink.times[0] >= milliseconds(90));
+    auto stats = queue.GetStats();
+    CHECK(stats.requested == 1002);
+    CHECK(stats.delivered == 2);
+    CHECK(stats.flushed == 0);
+}
+
+// Flush does not wait for the frame
+static void testFlush()
+{
+    MockSink sink;
+    GuiUpdateQueue queue(sink.sink(), 1, milliseconds(50));
+    queue.Request(GUI_UPDATE_MEMORYMAP, 0, false, 0, false);
+    CHECK(sink.wait(1, milliseconds(1000)));
+    queue.Request(GUI_UPDATE_DISASSEMBLY, 0x1000, false, 0, false);
+    auto start = Clock::now();
+    queue.Flush();
+    CHECK(sink.wait(2, milliseconds(2000)));
+    CHECK(Clock::now() - start < milliseconds(500));
+    CHECK(queue.GetStats().flushed == 1);
+    queue.Flush(); // nothing pending
+    std::this_thread::sleep_for(milliseconds(100));
+    CHECK(sink.count() == 2);
+}
+
+// A single pause after some idle time is shown right away
+static void testSinglePause()
+{
+    MockSink sink;
+    GuiUpdateQueue queue(sink.sink(), 1, milliseconds(50));
+    queue.Request(GUI_UPDATE_MEMORYMAP, 0, false, 0, false);
+    CHECK(sink.wait(1, milliseconds(1000)));
+    std::this_thread::sleep_for(milliseconds(100));
+    auto start = Clock::now();
+    queue.Request(GUI_UPDATE_STATE | GUI_UPDATE_DISASSEMBLY, 0x1000, false, 2, true);
+    CHECK(sink.wait(2, milliseconds(2000)));
+    CHECK(Clock::now() - start < milliseconds(500));
+}
+
+// Holding a step key: the pauses are throttled and the last one is shown when the stepping stops
+static void testStepping()
+{
+    MockSink sink;
+    GuiUpdateQueue queue(sink.sink(), 20, milliseconds(50));
+    auto start = Clock::now();
+    unsigned int steps = 0;
+    while(Clock::now() - start < milliseconds(500))
+    {
+        queue.Request(GUI_UPDATE_STATE | GUI_UPDATE_DISASSEMBLY, steps, false, 2, true);
+        steps++;
+        std::this_thread::sleep_for(milliseconds(1));
+    }
+    std::this_thread::sleep_for(milliseconds(200));
+    auto count = sink.count();
+    // the first pause is flushed, the rest is limited to 20 frames per second
+    CHECK(count >= 2);
+    CHECK(count <= 14);
+    CHECK(count < steps);
+    CHECK(queue.GetStats().flushed == 1);
+    CHECK(sink.last().disasmAddr == steps - 1);
+    printf("stepping: %u pauses, %u updates\n", steps, (unsigned int)count);
+}
+
+int main()
+{
+    testCoalesce();
+    testFlush();
+    testSinglePause();
+    testStepping();
+    printf("%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,235 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../../historyjournal.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// About the size of TITAN_ENGINE_CONTEXT_t on x64 (registers, debug registers, fxsave area, ymm)
+static const size_t FrameSize = 1232;
+
+struct Preimage
+{
+    size_t addr;
+    std::vector<unsigned char> data;
+
+    bool operator==(const Preimage & other) const
+    {
+        return addr == other.addr && data == other.data;
+    }
+};
+
+struct Step
+{
+    bool valid;
+    std::vector<unsigned char> frame;
+    std::vector<Preimage> preimages;
+};
+
+// A single step changes the instruction pointer, a register or two and the flags
+class Stepper
+{
+public:
+    explicit Stepper(unsigned int seed)
+        : random(seed),
+          frame(FrameSize)
+    {
+        for(auto & byte : frame)
+            byte = (unsigned char)random();
+    }
+
+    Step Next(bool preimages = true)
+    {
+        frame[0] += 1 + random() % 7; //cip
+        frame[16 + random() % 16 * 8] ^= (unsigned char)random(); //a general purpose register
+        if(random() % 2)
+            frame[8] ^= 0x41; //flags
+        if(random() % 50 == 0)
+            frame[256 + random() % 512] ^= (unsigned char)random(); //fpu/sse state
+        Step step;
+        step.valid = true;
+        step.frame = frame;
+        if(preimages)
+        {
+            auto count = random() % 10 < 6 ? 1 : random() % 3;
+            for(unsigned int i = 0; i < count; i++)
+            {
+                Preimage preimage;
+                preimage.addr = 0x7ff000 + random() % 0x1000;
+                preimage.data.resize(random() % 100 == 0 ? HistoryJournal::MaxPreimage : size_t(1) << (random() % 4));
+                for(auto & byte : preimage.data)
+                    byte = (unsigned char)random();
+                step.preimages.push_back(preimage);
+            }
+        }
+        return step;
+    }
+
+private:
+    std::mt19937 random;
+    std::vector<unsigned char> frame;
+};
+
+static void add(HistoryJournal & journal, const Step & step)
+{
+    journal.Begin(step.valid ? step.frame.data() : nullptr);
+    for(const auto & preimage : step.preimages)
+        journal.AddPreimage(preimage.addr, preimage.data.data(), preimage.data.size());
+    journal.Commit();
+}
+
+static bool pop(HistoryJournal & journal, const Step & step)
+{
+    std::vector<unsigned char> frame(FrameSize);
+    std::vector<Preimage> preimages;
+    auto restore = [&](size_t addr, const unsigned char* data, size_t size)
+    {
+        Preimage preimage;
+        preimage.addr = addr;
+        preimage.data.assign(data, data + size);
+        preimages.push_back(preimage);
+    };
+    if(!journal.Pop(frame.data(), restore))
+        return false;
+    return frame == step.frame && preimages == step.preimages;
+}
+
+// Undoing gives back every step in reverse order
+static void testRoundTrip()
+{
+    HistoryJournal journal(FrameSize, 64 * 1024 * 1024);
+    Stepper stepper(1);
+    std::vector<Step> steps;
+    for(int round = 0; round < 3; round++)
+    {
+        for(int i = 0; i < 20000; i++)
+        {
+            steps.push_back(stepper.Next());
+            add(journal, steps.back());
+        }
+        CHECK(journal.Steps() == steps.size());
+        for(int i = 0; i < 5000; i++)
+        {
+            CHECK(pop(journal, steps.back()));
+            steps.pop_back();
+        }
+    }
+    while(!steps.empty())
+    {
+        CHECK(pop(journal, steps.back()));
+        steps.pop_back();
+    }
+    CHECK(journal.Empty());
+    CHECK(journal.Memory() == 0);
+}
+
+// A step that cannot be undone clears the journal when it is reached
+static void testInvalid()
+{
+    HistoryJournal journal(FrameSize, 64 * 1024 * 1024);
+    Stepper stepper(2);
+    auto first = stepper.Next();
+    add(journal, first);
+    Step invalid;
+    invalid.valid = false;
+    add(journal, invalid);
+    auto last = stepper.Next();
+    add(journal, last);
+    CHECK(pop(journal, last));
+    CHECK(!pop(journal, first));
+    CHECK(journal.Empty());
+}
+
+// The oldest steps are dropped at the memory limit, the record offsets are part of it
+static void testLimit()
+{
+    const size_t limit = 1024 * 1024;
+    HistoryJournal journal(FrameSize, limit);
+    Stepper stepper(3);
+    std::vector<Step> steps;
+    size_t maxMemory = 0;
+    for(int i = 0; i < 200000; i++)
+    {
+        steps.push_back(stepper.Next(i % 2 == 0));
+        add(journal, steps.back());
+        maxMemory = std::max(maxMemory, journal.Memory());
+    }
+    CHECK(maxMemory <= limit);
+    CHECK(journal.Steps() < steps.size());
+    CHECK(journal.Memory() >= journal.Steps() * (5 + sizeof(unsigned int)));
+    for(auto count = journal.Steps(); count; count--)
+    {
+        CHECK(pop(journal, steps.back()));
+        steps.pop_back();
+    }
+    CHECK(journal.Empty());
+}
+
+static double elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void benchmark()
+{
+    const size_t limit = 64 * 1024 * 1024;
+    const int count = 2000000;
+    Stepper stepper(4);
+    std::vector<Step> steps;
+    steps.reserve(count);
+    size_t preimageBytes = 0;
+    for(int i = 0; i < count; i++)
+    {
+        steps.push_back(stepper.Next());
+        for(const auto & preimage : steps.back().preimages)
+            preimageBytes += preimage.data.size();
+    }
+
+    HistoryJournal journal(FrameSize, limit);
+    auto start = std::chrono::high_resolution_clock::now();
+    for(const auto & step : steps)
+        add(journal, step);
+    auto addTime = elapsed(start);
+    auto kept = journal.Steps();
+    auto memory = journal.Memory();
+
+    std::vector<unsigned char> frame(FrameSize);
+    size_t restored = 0;
+    auto restore = [&](size_t addr, const unsigned char* data, size_t size)
+    {
+        restored += size + (addr & 1);
+    };
+    start = std::chrono::high_resolution_clock::now();
+    while(journal.Pop(frame.data(), restore))
+        ;
+    auto popTime = elapsed(start);
+
+    printf("%d steps, %u byte frames, %.1f pre-image bytes per step, %u MiB limit\n", count, unsigned(FrameSize), double(preimageBytes) / count, unsigned(limit >> 20));
+    printf("journal: %.1f bytes per step, %u steps kept (%u with a full frame per step)\n", double(memory) / kept, unsigned(kept), unsigned(limit / FrameSize));
+    printf("add: %.0fns per step, undo: %.0fns per step\n", addTime * 1e6 / count, popTime * 1e6 / kept);
+}
+
+int main(int argc, char* argv[])
+{
+    testRoundTrip();
+    testInvalid();
+    testLimit();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
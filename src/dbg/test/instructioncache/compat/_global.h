@@ -0,0 +1,15 @@
+#ifndef _GLOBAL_H
+#define _GLOBAL_H
+
+//Linux stand-in for the debugger's _global.h, only what the instruction cache uses
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <memory>
+
+typedef size_t duint;
+
+using std::min;
+using std::max;
+
+#endif // _GLOBAL_H
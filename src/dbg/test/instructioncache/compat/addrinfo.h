@@ -0,0 +1,10 @@
+#ifndef _ADDRINFO_H
+#define _ADDRINFO_H
+
+//Linux stand-in for the debugger's addrinfo.h, only what the instruction cache uses
+#include "_global.h"
+#include <utility>
+
+typedef std::pair<duint, duint> Range;
+
+#endif // _ADDRINFO_H
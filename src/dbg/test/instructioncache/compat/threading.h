@@ -0,0 +1,21 @@
+#ifndef _THREADING_H
+#define _THREADING_H
+
+//Linux stand-in for the debugger's threading.h, the section locks are plain mutexes
+#include <mutex>
+
+enum SectionLock
+{
+    LockInstructionCache,
+    LockLast
+};
+
+inline std::mutex & SectionMutex(SectionLock Index)
+{
+    static std::mutex locks[LockLast];
+    return locks[Index];
+}
+
+#define EXCLUSIVE_ACQUIRE(Index)    std::lock_guard<std::mutex> __ThreadLock(SectionMutex(Index))
+
+#endif // _THREADING_H
@@ -0,0 +1,240 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "../../analysis/instructioncache.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Raw blob with the zero padding the analyses allocate after their data
+struct Blob
+{
+    duint base;
+    std::vector<unsigned char> bytes;
+
+    Blob(duint base, size_t size, unsigned int seed)
+        : base(base),
+          bytes(size + MAX_DISASM_BUFFER)
+    {
+        std::mt19937 random(seed);
+        for(size_t i = 0; i < size; i++)
+            bytes[i] = (unsigned char)random();
+    }
+
+    duint size() const
+    {
+        return bytes.size() - MAX_DISASM_BUFFER;
+    }
+};
+
+// What every pass did before the cache: a single threaded linear sweep of its own
+static std::vector<duint> linearSweep(const Blob & blob)
+{
+    std::vector<duint> addresses;
+    Capstone cp;
+    for(duint addr = blob.base; addr < blob.base + blob.size();)
+    {
+        if(cp.Disassemble(addr, blob.bytes.data() + (addr - blob.base), MAX_DISASM_BUFFER))
+        {
+            addresses.push_back(addr);
+            addr += cp.Size();
+        }
+        else
+            addr++;
+    }
+    return addresses;
+}
+
+static bool sameSweep(const InstructionCache & cache, const std::vector<duint> & addresses)
+{
+    if(cache.Count() != addresses.size())
+        return false;
+    for(size_t i = 0; i < addresses.size(); i++)
+        if(cache[i].address != addresses[i] || !cache[i].size)
+            return false;
+    return true;
+}
+
+// The parallel build stitches its partitions into exactly one linear sweep
+static void testBuild(size_t size, unsigned int seed)
+{
+    Blob blob(0x401000, size, seed);
+    InstructionCache cache(blob.base, blob.size());
+    cache.Build(blob.bytes.data());
+    auto addresses = linearSweep(blob);
+    CHECK(sameSweep(cache, addresses));
+
+    for(size_t i = 0; i < addresses.size(); i += 7)
+    {
+        CHECK(cache.Find(addresses[i]) == i);
+        CHECK(cache.LowerBound(addresses[i]) == i);
+        if(i + 1 < addresses.size() && addresses[i + 1] > addresses[i] + 1)
+        {
+            CHECK(cache.Find(addresses[i] + 1) == cache.Count());
+            CHECK(cache.LowerBound(addresses[i] + 1) == i + 1);
+        }
+    }
+    CHECK(cache.LowerBound(blob.base + blob.size()) == cache.Count());
+}
+
+// Addresses off the linear sweep are decoded on demand
+static void testDecode()
+{
+    Blob blob(0x10000, 0x1000, 1);
+    InstructionCache cache(blob.base, blob.size());
+    cache.Build(blob.bytes.data());
+    Capstone cp;
+    InstructionCache::Instruction instruction;
+    for(duint addr = blob.base; addr < blob.base + blob.size(); addr++)
+    {
+        auto data = blob.bytes.data() + (addr - blob.base);
+        auto decoded = cache.Decode(cp, addr, data, instruction);
+        CHECK(decoded == cp.Disassemble(addr, data, MAX_DISASM_BUFFER));
+        if(decoded)
+        {
+            CHECK(instruction.address == addr);
+            CHECK(instruction.size == cp.Size());
+        }
+    }
+}
+
+// Patching the dirty ranges gives the same sweep as decoding the new data from scratch
+static void testPatch(unsigned int seed)
+{
+    std::mt19937 random(seed);
+    Blob blob(0x400000, 0x20000, seed);
+    auto cache = std::make_shared<InstructionCache>(blob.base, blob.size());
+    cache->Build(blob.bytes.data());
+    std::shared_ptr<const InstructionCache> current = cache;
+
+    for(int round = 0; round < 20; round++)
+    {
+        std::vector<Range> dirty;
+        duint start = 0;
+        for(int i = 0; i < 5; i++)
+        {
+            start += random() % (blob.size() / 6);
+            auto length = 1 + random() % 32;
+            if(start + length > blob.size())
+                break;
+            for(duint j = start; j < start + length; j++)
+                blob.bytes[j] = (unsigned char)random();
+            dirty.push_back(Range(blob.base + start, blob.base + start + length - 1));
+            start += length;
+        }
+        std::vector<InstructionCache::Instruction> removed, added;
+        auto patched = current->Patch(blob.bytes.data(), dirty, removed, added);
+        CHECK(sameSweep(*patched, linearSweep(blob)));
+        CHECK(patched->Count() == current->Count() - removed.size() + added.size());
+        current = patched;
+    }
+}
+
+// Chained analyses of unchanged data share one snapshot, big snapshots are not kept alive
+static void testAcquire()
+{
+    Blob blob(0x1000000, 0x10000, 2);
+    auto first = InstructionCache::Acquire(blob.base, blob.size(), blob.bytes.data());
+    CHECK(InstructionCache::Acquire(blob.base, blob.size(), blob.bytes.data()) == first);
+    std::weak_ptr<const InstructionCache> small = first;
+    first.reset();
+    CHECK(!small.expired());
+
+    blob.bytes[0x100] ^= 0x55;
+    auto changed = InstructionCache::Acquire(blob.base, blob.size(), blob.bytes.data());
+    CHECK(changed != small.lock());
+    CHECK(InstructionCache::Last(blob.base, blob.size()) == nullptr);
+    InstructionCache::Publish(changed);
+    CHECK(InstructionCache::Last(blob.base, blob.size()) == changed);
+    InstructionCache::Publish(nullptr);
+    CHECK(InstructionCache::Last(blob.base, blob.size()) == nullptr);
+
+    // 16 MiB of records are about 3 MiB of code, a 32 MiB blob is only shared while it is in use
+    Blob big(0x20000000, 32 * 1024 * 1024, 3);
+    auto cache = InstructionCache::Acquire(big.base, big.size(), big.bytes.data());
+    CHECK(InstructionCache::Acquire(big.base, big.size(), big.bytes.data()) == cache);
+    std::weak_ptr<const InstructionCache> weak = cache;
+    cache.reset();
+    CHECK(weak.expired());
+}
+
+static double elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// The analadv chain decodes the range in 5 places (linear xrefs, functions, data xrefs, ...)
+static void benchmark(const Blob & blob)
+{
+    const int passes = 5;
+    printf("%u bytes, %d passes\n", unsigned(blob.size()), passes);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t count = 0;
+    for(int i = 0; i < passes; i++)
+        count = linearSweep(blob).size();
+    auto sweepTime = elapsed(start);
+    printf("every pass sweeps: %.1fms (%u instructions)\n", sweepTime, unsigned(count));
+
+    InstructionCache::Publish(nullptr);
+    start = std::chrono::high_resolution_clock::now();
+    auto cache = InstructionCache::Acquire(blob.base, blob.size(), blob.bytes.data());
+    auto buildTime = elapsed(start);
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 1; i < passes; i++)
+        CHECK(InstructionCache::Acquire(blob.base, blob.size(), blob.bytes.data()) == cache);
+    auto hitTime = elapsed(start);
+    printf("decode once: %.1fms build + %.1fms for %d hits (%.2fx), %u bytes of records\n",
+           buildTime, hitTime, passes - 1, sweepTime / (buildTime + hitTime), unsigned(cache->Count() * sizeof(InstructionCache::Instruction)));
+    CHECK(cache->Count() == count);
+}
+
+int main(int argc, char* argv[])
+{
+    testBuild(1, 0);
+    testBuild(0x1000, 1);
+    testBuild(0x4000 * 13 + 5, 2);
+    testBuild(0x100000, 3);
+    testDecode();
+    testPatch(4);
+    testPatch(5);
+    testAcquire();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        // "instructioncache_test bench file" benchmarks a raw code blob (e.g. a dumped .text section)
+        Blob blob(0x401000, 0, 0);
+        if(argc > 2)
+        {
+            auto file = fopen(argv[2], "rb");
+            if(!file)
+            {
+                printf("can't open %s\n", argv[2]);
+                return 1;
+            }
+            unsigned char buffer[0x10000];
+            blob.bytes.clear();
+            for(size_t read; (read = fread(buffer, 1, sizeof(buffer), file));)
+                blob.bytes.insert(blob.bytes.end(), buffer, buffer + read);
+            fclose(file);
+            blob.bytes.resize(blob.bytes.size() + MAX_DISASM_BUFFER);
+        }
+        else
+            blob = Blob(0x401000, 16 * 1024 * 1024, 6);
+        benchmark(blob);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../../lrucache.h"
+
+typedef std::string String;
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Entries are created once, the least recently used one makes room
+static void testEviction()
+{
+    LruCache<int, int> cache(3);
+    int made = 0;
+    auto get = [&](int key)
+    {
+        return cache.Get(key, [&]()
+        {
+            made++;
+            return key * 10;
+        });
+    };
+    CHECK(get(1) == 10 && get(2) == 20 && get(3) == 30);
+    CHECK(made == 3 && cache.Size() == 3);
+    CHECK(get(1) == 10); //1 is now the most recently used
+    CHECK(made == 3);
+    CHECK(get(4) == 40); //drops 2
+    CHECK(made == 4 && cache.Size() == 3);
+    get(1);
+    get(3);
+    get(4);
+    CHECK(made == 4);
+    get(2);
+    CHECK(made == 5);
+    get(1); //dropped for 2
+    CHECK(made == 6);
+    cache.Clear();
+    CHECK(cache.Size() == 0);
+    get(4);
+    CHECK(made == 7);
+}
+
+// Entries can be modified through the returned reference
+static void testReference()
+{
+    LruCache<String, std::vector<int>> cache(2);
+    auto make = []()
+    {
+        return std::vector<int>();
+    };
+    cache.Get("a", make).push_back(1);
+    cache.Get("a", make).push_back(2);
+    CHECK(cache.Get("a", make).size() == 2);
+    cache.Get("b", make);
+    cache.Get("c", make);
+    CHECK(cache.Get("a", make).empty());
+}
+
+// Stand-in for compiling a condition or log text (ExpressionParser needs the Windows build): tokenize and allocate
+struct Compiled
+{
+    std::vector<String> tokens;
+
+    explicit Compiled(const String & text)
+    {
+        String token;
+        for(char ch : text)
+        {
+            if(strchr(" +-*/&|^!=<>()[]{}:,\"", ch))
+            {
+                if(!token.empty())
+                    tokens.push_back(token);
+                token.clear();
+                if(ch != ' ')
+                    tokens.push_back(String(1, ch));
+            }
+            else
+                token += ch;
+        }
+        if(!token.empty())
+            tokens.push_back(token);
+    }
+};
+
+static const size_t BreakpointCacheMax = 1024;
+
+// What debugger.cpp did before: drop every compiled text when the map is full
+class ClearCache
+{
+public:
+    size_t compiles = 0;
+
+    std::shared_ptr<Compiled> Get(const String & text)
+    {
+        auto & compiled = cache[text];
+        if(!compiled)
+        {
+            if(cache.size() > BreakpointCacheMax)
+            {
+                cache.clear();
+                return Get(text);
+            }
+            compiled = std::make_shared<Compiled>(text);
+            compiles++;
+        }
+        return compiled;
+    }
+
+private:
+    std::unordered_map<String, std::shared_ptr<Compiled>> cache;
+};
+
+static double elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// hot of the breakpoints get hotShare of the hits, the rest are hit uniformly
+static void benchmark(const char* name, int breakpoints, int hot, double hotShare, bool roundRobin)
+{
+    std::vector<String> texts;
+    for(int i = 0; i < breakpoints; i++)
+    {
+        char text[128];
+        sprintf(text, "[esp+%X] == %d && eax & 0x%X || {p:cip} counter %d", i * 4 % 0x40, i, i * 7, i);
+        texts.push_back(text);
+    }
+    std::mt19937 random(breakpoints);
+    std::uniform_real_distribution<double> share(0, 1);
+    const int hits = 2000000;
+    std::vector<int> stream(hits);
+    for(int i = 0; i < hits; i++)
+    {
+        if(roundRobin)
+            stream[i] = i % breakpoints;
+        else if(share(random) < hotShare)
+            stream[i] = random() % hot;
+        else
+            stream[i] = hot + random() % (breakpoints - hot);
+    }
+
+    ClearCache clearCache;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int index : stream)
+        clearCache.Get(texts[index]);
+    auto clearTime = elapsed(start);
+
+    size_t compiles = 0;
+    LruCache<String, std::shared_ptr<Compiled>> lruCache(BreakpointCacheMax);
+    start = std::chrono::high_resolution_clock::now();
+    for(int index : stream)
+    {
+        lruCache.Get(texts[index], [&]()
+        {
+            compiles++;
+            return std::make_shared<Compiled>(texts[index]);
+        });
+    }
+    auto lruTime = elapsed(start);
+
+    printf("%s: %d breakpoints, %d hits\n", name, breakpoints, hits);
+    printf("  clear when full: %.1fms, %u compiles\n", clearTime, unsigned(clearCache.compiles));
+    printf("  least recently used: %.1fms, %u compiles\n", lruTime, unsigned(compiles));
+}
+
+int main(int argc, char* argv[])
+{
+    testEviction();
+    testReference();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        benchmark("fits", 800, 800, 1.0, false);
+        benchmark("hot loop plus logging sweep", 4000, 200, 0.9, false);
+        benchmark("uniform over more than the limit", 2000, 2000, 1.0, false);
+        benchmark("round robin over more than the limit", 2000, 2000, 1.0, true);
+    }
+    return failures ? 1 : 0;
+}
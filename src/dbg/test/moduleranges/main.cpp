@@ -0,0 +1,245 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include "../../moduleranges.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Modules of 64 KiB to 1 MiB with gaps in between, the hash tells the set apart
+static std::vector<MODRANGE> makeModules(int count, size_t key, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::vector<MODRANGE> modules;
+    size_t base = 0x10000000;
+    for(int i = 0; i < count; i++)
+    {
+        MODRANGE range;
+        range.start = base;
+        range.end = base + ((1 + random() % 16) << 16) - 1;
+        range.hash = range.start ^ key;
+        range.party = i % 2;
+        modules.push_back(range);
+        base = range.end + 1 + ((random() % 4) << 16);
+    }
+    return modules;
+}
+
+static void testFind()
+{
+    ModuleRanges ranges;
+    ModuleRanges::Cache cache;
+    MODRANGE range;
+    CHECK(!ranges.Find(0x10000000, range, cache));
+
+    auto modules = makeModules(50, 1, 1);
+    ranges.Publish(modules);
+    for(const auto & module : modules)
+    {
+        CHECK(ranges.Find(module.start, range, cache) && range.start == module.start && range.hash == module.hash);
+        CHECK(ranges.Find(module.end, range, cache) && range.start == module.start); //cached
+        CHECK(ranges.Find((module.start + module.end) / 2, range, cache) && range.end == module.end);
+        CHECK(!ranges.Find(module.end + 1, range, cache) || range.start == module.end + 1);
+    }
+    CHECK(!ranges.Find(modules.front().start - 1, range, cache));
+    CHECK(!ranges.Find(modules.back().end + 1, range, cache));
+
+    // A cached hit is not used after the module is unloaded
+    CHECK(ranges.Find(modules[10].start, range, cache));
+    modules.erase(modules.begin() + 10);
+    ranges.Publish(modules);
+    CHECK(!ranges.Find(range.start, range, cache));
+    ranges.Publish(std::vector<MODRANGE>());
+    CHECK(!ranges.Find(modules[0].start, range, cache));
+}
+
+static bool contains(const std::vector<MODRANGE> & modules, const MODRANGE & range)
+{
+    for(const auto & module : modules)
+        if(module.start == range.start)
+            return module.end == range.end && module.hash == range.hash;
+    return false;
+}
+
+// Readers only ever see complete module sets while a writer keeps replacing them
+static void testConcurrent()
+{
+    ModuleRanges ranges;
+    std::vector<MODRANGE> sets[2] = { makeModules(100, 0xA, 2), makeModules(120, 0xB, 3) };
+    ranges.Publish(sets[0]);
+    std::atomic<bool> stop(false);
+    std::atomic<int> bad(0);
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 4; i++)
+    {
+        readers.push_back(std::thread([&, i]()
+        {
+            std::mt19937 random(i);
+            ModuleRanges::Cache cache;
+            MODRANGE range;
+            while(!stop)
+            {
+                size_t address = 0x10000000 + random() % 0x8000000;
+                if(!ranges.Find(address, range, cache))
+                    continue;
+                auto key = range.hash ^ range.start;
+                if((key != 0xA && key != 0xB) || address < range.start || address > range.end || !contains(sets[key == 0xA ? 0 : 1], range))
+                    bad++;
+            }
+        }));
+    }
+    for(int i = 0; i < 2000; i++)
+        ranges.Publish(sets[i % 2]);
+    stop = true;
+    for(auto & reader : readers)
+        reader.join();
+    CHECK(bad == 0);
+}
+
+typedef std::pair<size_t, size_t> Range;
+
+struct RangeCompare
+{
+    bool operator()(const Range & a, const Range & b) const //a before b?
+    {
+        return a.second < b.first;
+    }
+};
+
+// What the lookups did before: take LockModules shared and search the module map
+class LockedModules
+{
+public:
+    LockedModules()
+    {
+        pthread_rwlock_init(&lock, nullptr);
+    }
+
+    ~LockedModules()
+    {
+        pthread_rwlock_destroy(&lock);
+    }
+
+    void Publish(const std::vector<MODRANGE> & modules)
+    {
+        pthread_rwlock_wrlock(&lock);
+        map.clear();
+        for(const auto & module : modules)
+            map[Range(module.start, module.end)] = module;
+        pthread_rwlock_unlock(&lock);
+    }
+
+    bool Find(size_t address, MODRANGE & range)
+    {
+        pthread_rwlock_rdlock(&lock);
+        auto found = map.find(Range(address, address));
+        bool result = found != map.end();
+        if(result)
+            range = found->second;
+        pthread_rwlock_unlock(&lock);
+        return result;
+    }
+
+private:
+    pthread_rwlock_t lock;
+    std::map<Range, MODRANGE, RangeCompare> map;
+};
+
+// Every thread looks up addresses in a few modules at a time (call targets, stack walks), a module load is published every 10ms
+template<typename Modules, typename Lookup>
+static double lookupsPerSecond(const std::vector<MODRANGE> & modules, int threadCount, Modules & writer, Lookup lookup)
+{
+    const int lookups = 2000000;
+    writer.Publish(modules);
+    std::atomic<bool> stop(false);
+    std::thread publisher([&]()
+    {
+        while(!stop)
+        {
+            writer.Publish(modules);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+    std::atomic<size_t> found(0);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for(int i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread([&, i]()
+        {
+            std::mt19937 random(i);
+            ModuleRanges::Cache cache;
+            MODRANGE range;
+            size_t count = 0;
+            const MODRANGE* module = &modules[0];
+            for(int j = 0; j < lookups; j++)
+            {
+                if(j % 64 == 0)
+                    module = &modules[random() % modules.size()];
+                auto address = random() % 8 ? module->start + random() % (module->end - module->start + 1) : module->end + 1;
+                count += lookup(address, range, cache);
+            }
+            found += count;
+        }));
+    }
+    for(auto & thread : threads)
+        thread.join();
+    auto time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    stop = true;
+    publisher.join();
+    CHECK(found > 0);
+    return lookups * double(threadCount) / time;
+}
+
+static void benchmark()
+{
+    auto modules = makeModules(300, 1, 4);
+    LockedModules locked;
+    ModuleRanges ranges;
+    printf("%u modules, %u hardware threads\n", unsigned(modules.size()), std::thread::hardware_concurrency());
+    for(int threads = 1; threads <= 8; threads *= 2)
+    {
+        auto lockedRate = lookupsPerSecond(modules, threads, locked, [&](size_t address, MODRANGE & range, ModuleRanges::Cache &)
+        {
+            return locked.Find(address, range);
+        });
+        auto snapshotRate = lookupsPerSecond(modules, threads, ranges, [&](size_t address, MODRANGE & range, ModuleRanges::Cache &)
+        {
+            ModuleRanges::Cache none;
+            return ranges.Find(address, range, none);
+        });
+        auto cachedRate = lookupsPerSecond(modules, threads, ranges, [&](size_t address, MODRANGE & range, ModuleRanges::Cache & cache)
+        {
+            return ranges.Find(address, range, cache);
+        });
+        printf("%d threads: locked map %.1fM/s, snapshot %.1fM/s, snapshot + thread cache %.1fM/s\n",
+               threads, lockedRate / 1e6, snapshotRate / 1e6, cachedRate / 1e6);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testFind();
+    testConcurrent();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
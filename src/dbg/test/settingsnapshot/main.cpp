@@ -0,0 +1,220 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../settingsnapshot.h"
+
+typedef std::string String;
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Stand-in for the bridge settings: a locked map, every write bumps the generation like BridgeSettingSet
+class SettingsStore
+{
+public:
+    SettingsStore()
+        : generation(0)
+    {
+    }
+
+    void Set(const String & section, const String & key, bool value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        values[section + "\\" + key] = value;
+        generation++;
+    }
+
+    bool Get(const String & section, const String & key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = values.find(section + "\\" + key);
+        return found != values.end() && found->second;
+    }
+
+    size_t Generation() const
+    {
+        return generation;
+    }
+
+private:
+    std::mutex mutex;
+    std::map<String, bool> values;
+    std::atomic<size_t> generation;
+};
+
+static const char* eventKeys[] = { "SystemBreakpoint", "AttachBreakpoint", "TlsCallbacks", "EntryBreakpoint", "DllEntry", "DllLoad", "DllUnload",
+                                   "ThreadEntry", "ThreadStart", "ThreadEnd", "DebugStrings", "HardcoreThreadSwitchWarning", "TraceRecordEnabledDuringTrace"
+                                 };
+static const int eventKeyCount = sizeof(eventKeys) / sizeof(eventKeys[0]);
+
+// Same shape as EVENT_SETTINGS in debugger.h
+struct EventSettings
+{
+    bool values[eventKeyCount];
+};
+
+static void readEventSettings(SettingsStore & store, EventSettings & settings)
+{
+    for(int i = 0; i < eventKeyCount; i++)
+        settings.values[i] = store.Get("Events", eventKeys[i]);
+}
+
+static SettingsSnapshot<EventSettings> makeSnapshot(SettingsStore & store, int* reads = nullptr)
+{
+    return SettingsSnapshot<EventSettings>([&store]()
+    {
+        return store.Generation();
+    }, [&store, reads](EventSettings & settings)
+    {
+        if(reads)
+            (*reads)++;
+        readEventSettings(store, settings);
+    });
+}
+
+// A write that does not go through dbgupdateeventsettings is seen by the next Get
+static void testDirectWrite()
+{
+    SettingsStore store;
+    int reads = 0;
+    auto snapshot = makeSnapshot(store, &reads);
+    auto first = snapshot.Get();
+    CHECK(reads == 1 && !first->values[0]);
+    CHECK(snapshot.Get() == first); //nothing changed, same copy
+    CHECK(reads == 1);
+
+    store.Set("Events", "SystemBreakpoint", true);
+    auto second = snapshot.Get();
+    CHECK(reads == 2 && second != first && second->values[0]);
+    CHECK(!first->values[0]); //the old copy stays valid for its holders
+
+    auto updated = snapshot.Update(); //DBG_SETTINGS_UPDATED
+    CHECK(reads == 3 && updated->values[0]);
+    CHECK(snapshot.Get() == updated && reads == 3);
+}
+
+// Readers never see a value older than the last write they observed finishing
+static void testConcurrent()
+{
+    SettingsStore store;
+    auto snapshot = makeSnapshot(store);
+    std::atomic<int> written(0); //number of keys set to true, in key order
+    std::atomic<bool> stop(false);
+    std::atomic<int> bad(0);
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 4; i++)
+    {
+        readers.push_back(std::thread([&]()
+        {
+            while(!stop)
+            {
+                int done = written;
+                auto settings = snapshot.Get();
+                for(int j = 0; j < done; j++)
+                    if(!settings->values[j])
+                        bad++;
+            }
+        }));
+    }
+    for(int round = 0; round < 200; round++)
+    {
+        for(int i = 0; i < eventKeyCount; i++)
+        {
+            store.Set("Events", eventKeys[i], true);
+            written = i + 1;
+        }
+        written = 0;
+        for(int i = 0; i < eventKeyCount; i++)
+            store.Set("Events", eventKeys[i], false);
+    }
+    stop = true;
+    for(auto & reader : readers)
+        reader.join();
+    CHECK(bad == 0);
+}
+
+// Every debug event reads the settings once, a setting is written every 10ms
+template<typename Lookup>
+static double lookupsPerSecond(SettingsStore & store, int threadCount, Lookup lookup)
+{
+    const int lookups = 300000;
+    std::atomic<bool> stop(false);
+    std::thread writer([&]()
+    {
+        bool value = false;
+        while(!stop)
+        {
+            store.Set("Engine", "TraceRecordEnabledDuringTrace", value = !value);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    });
+    std::atomic<int> enabled(0);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> threads;
+    for(int i = 0; i < threadCount; i++)
+    {
+        threads.push_back(std::thread([&]()
+        {
+            int count = 0;
+            for(int j = 0; j < lookups; j++)
+                count += lookup();
+            enabled += count;
+        }));
+    }
+    for(auto & thread : threads)
+        thread.join();
+    auto time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    stop = true;
+    writer.join();
+    return lookups * double(threadCount) / time;
+}
+
+static void benchmark()
+{
+    SettingsStore store;
+    for(int i = 0; i < eventKeyCount; i++)
+        store.Set(i < 11 ? "Events" : "Engine", eventKeys[i], i % 2 == 0);
+    auto snapshot = makeSnapshot(store);
+    printf("%d settings per event, %u hardware threads\n", eventKeyCount, std::thread::hardware_concurrency());
+    for(int threads = 1; threads <= 4; threads *= 2)
+    {
+        auto lockedRate = lookupsPerSecond(store, threads, [&]()
+        {
+            EventSettings settings;
+            readEventSettings(store, settings);
+            return settings.values[0];
+        });
+        auto snapshotRate = lookupsPerSecond(store, threads, [&]()
+        {
+            return snapshot.Get()->values[0];
+        });
+        printf("%d threads: read every setting %.2fM/s, snapshot %.2fM/s\n", threads, lockedRate / 1e6, snapshotRate / 1e6);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testDirectWrite();
+    testConcurrent();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
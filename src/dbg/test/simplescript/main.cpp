@@ -0,0 +1,234 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <chrono>
+#include <vector>
+#include "../../commandparser.h"
+
+static const int deflen = CommandArguments::ArgumentSize;
+
+static void strcpy_s(char* dest, size_t size, const char* src)
+{
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Parsing once gives the same argv as parsing every time
+static void testArguments()
+{
+    const char* commands[] =
+    {
+        "nop",
+        "mov eax, 1",
+        "log \"value {eax}\", 1",
+        "bp 0x401000, \"name, with comma\", ss",
+        "msg \"escaped \\\" quote\"",
+        "cmd a\\,b, c\\ d, \\x",
+        "cmd\ttab, \"unterminated",
+        "cmd trailing\\",
+    };
+    for(auto command : commands)
+    {
+        Command parsed(command);
+        CommandArguments arguments;
+        arguments.Parse(command);
+        CHECK(arguments.Count() == parsed.GetArgCount() + 1);
+        for(int round = 0; round < 2; round++)
+        {
+            auto argv = arguments.Argv();
+            CHECK(!strcmp(argv[0], command));
+            for(int i = 0; i < parsed.GetArgCount(); i++)
+            {
+                CHECK(parsed.GetArg(i) == argv[i + 1]);
+                argv[i + 1][0] = '!'; //commands may modify their arguments, the next call is not affected
+            }
+            argv[0][0] = '!';
+        }
+    }
+
+    // Reparsing (the command list changed) replaces the arguments
+    CommandArguments arguments;
+    arguments.Parse("bp 1, 2, 3");
+    arguments.Parse("bc 1");
+    CHECK(arguments.Count() == 2);
+    CHECK(!strcmp(arguments.Argv()[1], "1"));
+}
+
+typedef int (*CALLBACK)(int argc, char* argv[]);
+
+// Same structure and lookup as the debugger's command list (command.cpp)
+struct CommandEntry
+{
+    std::vector<String> names;
+    CALLBACK cbCommand;
+};
+
+static std::vector<CommandEntry> commandList;
+static unsigned long long executed = 0;
+
+static int cbCommand(int argc, char* argv[])
+{
+    for(int i = 0; i < argc; i++)
+        executed += strlen(argv[i]);
+    return 1;
+}
+
+static CommandEntry* cmdfind(const char* name)
+{
+    for(auto & command : commandList)
+        for(const auto & commandName : command.names)
+            if(!strcasecmp(commandName.c_str(), name))
+                return &command;
+    return nullptr;
+}
+
+static CommandEntry* cmdget(const char* cmd)
+{
+    char new_cmd[deflen] = "";
+    strcpy_s(new_cmd, deflen, cmd);
+    int len = (int)strlen(new_cmd);
+    int start = 0;
+    while(new_cmd[start] != ' ' && start < len)
+        start++;
+    new_cmd[start] = 0;
+    return cmdfind(new_cmd);
+}
+
+static String trim(const String & text)
+{
+    auto start = text.find_first_not_of(" \t");
+    auto end = text.find_last_not_of(" \t");
+    return start == String::npos ? String() : text.substr(start, end - start + 1);
+}
+
+// What a script step did before compiling: cmddirectexec on the line text
+static int cmddirectexec(const char* cmd)
+{
+    char command[deflen];
+    strcpy_s(command, deflen, trim(cmd).c_str());
+    auto found = cmdget(command);
+    if(!found)
+        return 0;
+    Command cmdParsed(command);
+    int argcount = cmdParsed.GetArgCount();
+    char** argv = (char**)malloc((argcount + 1) * sizeof(char*));
+    argv[0] = command;
+    for(int i = 0; i < argcount; i++)
+    {
+        argv[i + 1] = (char*)malloc(deflen);
+        strcpy_s(argv[i + 1], deflen, cmdParsed.GetArg(i).c_str());
+    }
+    int res = found->cbCommand(argcount + 1, argv);
+    for(int i = 0; i < argcount; i++)
+        free(argv[i + 1]);
+    free(argv);
+    return res;
+}
+
+// Compiled line, like SCRIPTINSTRUCTION in simplescript.cpp
+struct Instruction
+{
+    CommandEntry* cmd;
+    CommandArguments arguments;
+};
+
+static double elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void benchmark()
+{
+    // The debugger registers about 600 command names, the common ones are spread over the list
+    const char* common[] = { "mov\1set", "log", "add", "cmp", "bp\1bpx", "inc", "test", "msg" };
+    for(int i = 0; i < 600; i++)
+    {
+        CommandEntry entry;
+        entry.cbCommand = cbCommand;
+        if(i % 75 == 74)
+        {
+            auto names = String(common[i / 75]);
+            auto split = names.find('\1');
+            entry.names.push_back(names.substr(0, split));
+            if(split != String::npos)
+                entry.names.push_back(names.substr(split + 1));
+        }
+        else
+        {
+            char name[32];
+            sprintf(name, "command%d", i);
+            entry.names.push_back(name);
+        }
+        commandList.push_back(entry);
+    }
+
+    // Synthetic script with a loop body of typical lines
+    const char* templates[] =
+    {
+        "  mov $counter, $counter + 1",
+        "cmp $counter, 100000",
+        "log \"counter {d:$counter} at {p:cip}\"",
+        "add $sum, [$counter * 4 + 0x401000]",
+        "bp 0x401000, \"breakpoint name\", ss",
+        "inc $loops",
+        "test $sum, 0xFF00",
+        "msg \"done\"",
+    };
+    std::vector<String> script;
+    for(int i = 0; i < 1000; i++)
+        script.push_back(templates[i % (sizeof(templates) / sizeof(templates[0]))]);
+    const int steps = 1000000;
+
+    executed = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < steps; i++)
+        cmddirectexec(script[i % script.size()].c_str());
+    auto lineTime = elapsed(start);
+    auto lineExecuted = executed;
+
+    executed = 0;
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<Instruction> compiled(script.size());
+    for(size_t i = 0; i < script.size(); i++)
+    {
+        auto command = trim(script[i]);
+        compiled[i].cmd = cmdget(command.c_str());
+        compiled[i].arguments.Parse(command);
+    }
+    auto compileTime = elapsed(start);
+    start = std::chrono::high_resolution_clock::now();
+    for(int i = 0; i < steps; i++)
+    {
+        auto & instruction = compiled[i % compiled.size()];
+        instruction.cmd->cbCommand(instruction.arguments.Count(), instruction.arguments.Argv());
+    }
+    auto compiledTime = elapsed(start);
+    CHECK(executed == lineExecuted);
+
+    printf("%d steps over %u lines, %u commands\n", steps, unsigned(script.size()), unsigned(commandList.size()));
+    printf("cmddirectexec per step: %.1fms (%.0f steps/s)\n", lineTime, steps / lineTime * 1000);
+    printf("compiled: %.1fms compile + %.1fms (%.0f steps/s, %.2fx)\n", compileTime, compiledTime, steps / compiledTime * 1000, lineTime / (compileTime + compiledTime));
+}
+
+int main(int argc, char* argv[])
+{
+    testArguments();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
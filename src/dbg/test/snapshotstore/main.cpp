@@ -0,0 +1,296 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
+#include <vector>
+#include "../../snapshotstore.h"
+#include "../../analysis/workpool.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+static const size_t PageSize = SnapshotStore::PageSize;
+static const size_t Unique = ~size_t(0); //period of regions without repeating pages
+
+// Backend that generates its pages, so it can pretend to have gigabytes of memory:
+// zero pages, pages that repeat every few pages, unique pages, written bytes and unreadable pages on top
+class FakeMemory : public SnapshotMemorySource
+{
+public:
+    struct Region
+    {
+        size_t base;
+        size_t size;
+        size_t period; //0: zero pages, n: the contents repeat every n pages
+    };
+
+    std::vector<Region> regions;
+    std::map<size_t, unsigned char> written;
+    std::set<size_t> unreadable; //page addresses
+    std::atomic<size_t> largestRead;
+
+    FakeMemory()
+        : largestRead(0)
+    {
+    }
+
+    void Add(size_t base, size_t size, size_t period)
+    {
+        Region region = { base, size, period };
+        regions.push_back(region);
+        std::sort(regions.begin(), regions.end(), [](const Region & a, const Region & b)
+        {
+            return a.base < b.base;
+        });
+    }
+
+    void Remove(size_t base)
+    {
+        regions.erase(std::find_if(regions.begin(), regions.end(), [base](const Region & region)
+        {
+            return region.base == base;
+        }));
+    }
+
+    void Regions(std::vector<SnapshotRegion> & result) override
+    {
+        for(const auto & region : regions)
+        {
+            SnapshotRegion snapshotRegion = { region.base, region.size };
+            result.push_back(snapshotRegion);
+        }
+    }
+
+    bool Read(size_t address, void* buffer, size_t size) override
+    {
+        size_t largest = largestRead;
+        while(size > largest && !largestRead.compare_exchange_weak(largest, size))
+            ;
+        auto region = std::find_if(regions.begin(), regions.end(), [address](const Region & region)
+        {
+            return address >= region.base && address < region.base + region.size;
+        });
+        if(region == regions.end() || address + size > region->base + region->size)
+            return false;
+        if(!unreadable.empty())
+        {
+            auto found = unreadable.lower_bound(address & ~(PageSize - 1));
+            if(found != unreadable.end() && *found < address + size)
+                return false;
+        }
+        auto data = (unsigned char*)buffer;
+        for(size_t offset = 0; offset < size; offset += PageSize)
+            fillPage(*region, address + offset, data + offset);
+        for(auto i = written.lower_bound(address); i != written.end() && i->first < address + size; ++i)
+            data[i->first - address] = i->second;
+        return true;
+    }
+
+private:
+    static void fillPage(const Region & region, size_t address, unsigned char* data)
+    {
+        if(!region.period)
+        {
+            memset(data, 0, PageSize);
+            return;
+        }
+        auto seed = (unsigned long long)((address - region.base) / PageSize % region.period) * 0x9E3779B97F4A7C15ULL ^ region.base ^ region.period;
+        auto words = (unsigned long long*)data;
+        for(size_t i = 0; i < PageSize / sizeof(unsigned long long); i++)
+            words[i] = seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    }
+};
+
+// Reads everything and lists the changed bytes one by one: the reference for Diff
+static std::map<size_t, std::vector<unsigned char>> readAll(FakeMemory & memory)
+{
+    std::map<size_t, std::vector<unsigned char>> pages;
+    std::vector<SnapshotRegion> regions;
+    memory.Regions(regions);
+    for(const auto & region : regions)
+    {
+        for(size_t address = region.base; address < region.base + region.size; address += PageSize)
+        {
+            std::vector<unsigned char> data(PageSize);
+            if(memory.Read(address, data.data(), PageSize))
+                pages[address].swap(data);
+        }
+    }
+    return pages;
+}
+
+static SnapshotStore::Ranges referenceDiff(const std::map<size_t, std::vector<unsigned char>> & oldPages, const std::map<size_t, std::vector<unsigned char>> & newPages)
+{
+    std::set<size_t> addresses;
+    for(const auto & page : oldPages)
+        addresses.insert(page.first);
+    for(const auto & page : newPages)
+        addresses.insert(page.first);
+    SnapshotStore::Ranges ranges;
+    auto add = [&](size_t address)
+    {
+        if(!ranges.empty() && ranges.back().second + 1 == address)
+            ranges.back().second = address;
+        else
+            ranges.push_back(std::make_pair(address, address));
+    };
+    for(auto address : addresses)
+    {
+        auto oldPage = oldPages.find(address), newPage = newPages.find(address);
+        for(size_t offset = 0; offset < PageSize; offset++)
+            if(oldPage == oldPages.end() || newPage == newPages.end() || oldPage->second[offset] != newPage->second[offset])
+                add(address + offset);
+    }
+    return ranges;
+}
+
+// Pages with the same contents are stored once, also between snapshots
+static void testDedup(WorkPool & pool)
+{
+    FakeMemory memory;
+    memory.Add(0x10000, 64 * PageSize, 0); //zero pages
+    memory.Add(0x400000, 40 * PageSize, Unique);
+    memory.Add(0x800000, 100 * PageSize, 4); //4 distinct pages
+    SnapshotStore store(16 * PageSize);
+    SnapshotStore::Pages first, second;
+    CHECK(store.Capture(pool, memory, first) == 1 + 40 + 4);
+    CHECK(first.size() == 64 + 40 + 100);
+    CHECK(store.StoredPages() == 45);
+    CHECK(first[0].second == first[63].second);
+    CHECK(first[64].second != first[65].second);
+    for(size_t i = 1; i < first.size(); i++)
+        CHECK(first[i - 1].first < first[i].first);
+
+    CHECK(store.Capture(pool, memory, second) == 0); //nothing changed
+    CHECK(second == first);
+
+    memory.written[0x400000 + 5 * PageSize + 7] = 0xCC;
+    CHECK(store.Capture(pool, memory, second) == 1);
+    CHECK(store.StoredPages() == 46);
+    first.clear();
+    store.Purge(); //the old version of the written page is gone
+    CHECK(store.StoredPages() == 45);
+    second.clear();
+    store.Purge();
+    CHECK(store.StoredPages() == 0);
+}
+
+// Diff reports exactly the changed bytes, and huge regions are read in blocks
+static void testDiff(WorkPool & pool)
+{
+    FakeMemory memory;
+    memory.Add(0x10000, 16 * PageSize, 0);
+    memory.Add(0x400000, 300 * PageSize, Unique); //read in several blocks
+    memory.Add(0x800000, 8 * PageSize, 2);
+    memory.Add(0x900000, 4 * PageSize, 3);
+    memory.unreadable.insert(0x400000 + 17 * PageSize);
+    SnapshotStore store(64 * PageSize);
+    SnapshotStore::Pages oldPages, newPages;
+    store.Capture(pool, memory, oldPages);
+    CHECK(oldPages.size() == 16 + 299 + 8 + 4);
+    CHECK(memory.largestRead == 64 * PageSize);
+    auto oldReference = readAll(memory);
+
+    memory.written[0x10000 + 100] = 1; //single byte in a zero page
+    for(size_t i = 0; i < 10; i++) //run over a page boundary
+        memory.written[0x400000 + 2 * PageSize - 5 + i] = 0xAA;
+    memory.written[0x400000 + 64 * PageSize - 1] = 0x55; //last byte of a block
+    memory.written[0x400000 + 64 * PageSize] = 0x66; //first byte of the next one
+    memory.unreadable.erase(0x400000 + 17 * PageSize); //became readable
+    memory.unreadable.insert(0x400000 + 200 * PageSize); //became unreadable
+    memory.Remove(0x800000); //freed
+    memory.Add(0xA00000, 2 * PageSize, Unique); //allocated
+    store.Capture(pool, memory, newPages);
+    auto newReference = readAll(memory);
+
+    SnapshotStore::Ranges changed;
+    SnapshotStore::Diff(pool, oldPages, newPages, changed);
+    auto expected = referenceDiff(oldReference, newReference);
+    CHECK(changed == expected);
+    CHECK(expected.size() == 7);
+
+    SnapshotStore::Diff(pool, newPages, newPages, changed);
+    CHECK(changed.empty());
+    SnapshotStore::Diff(pool, SnapshotStore::Pages(), newPages, changed);
+    CHECK(changed.size() == 5); //every region, the unreadable page splits one
+}
+
+static double elapsed(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 3 GiB: a 2 GiB region that is mostly zero pages, heaps that repeat and unique images
+static void benchmark()
+{
+    const size_t MiB = 1024 * 1024;
+    FakeMemory memory;
+    memory.Add(0x100000000, 2048 * MiB, 0);
+    for(size_t i = 0; i < 64; i++)
+    {
+        memory.Add(0x200000000 + i * 16 * MiB, 8 * MiB, 16);
+        memory.Add(0x300000000 + i * 16 * MiB, 8 * MiB, Unique);
+    }
+    for(size_t i = 0; i < 2048; i++) //scattered writes in the big region
+        memory.written[0x100000000 + i * MiB + i * 13] = (unsigned char)i;
+    auto & pool = WorkPool::Global();
+    SnapshotStore store;
+    SnapshotStore::Pages first, second;
+
+    // Generating the fake contents is part of the capture time
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SnapshotRegion> regions;
+    memory.Regions(regions);
+    std::vector<unsigned char> buffer(MiB);
+    for(const auto & region : regions)
+        for(size_t offset = 0; offset < region.size; offset += MiB)
+            memory.Read(region.base + offset, buffer.data(), MiB);
+    printf("reading the backend alone: %.0fms\n", elapsed(start));
+
+    start = std::chrono::steady_clock::now();
+    auto stored = store.Capture(pool, memory, first);
+    auto captureTime = elapsed(start);
+    printf("capture 3GiB, %u threads: %.0fms (%.2fGiB/s), %u pages, %u stored (%.1fMiB), largest read %uKiB instead of 2GiB\n",
+           unsigned(pool.Threads()), captureTime, 3 / (captureTime / 1000), unsigned(first.size()), unsigned(stored),
+           stored * double(sizeof(SnapshotStore::Page)) / MiB, unsigned(memory.largestRead / 1024));
+
+    for(size_t i = 0; i < 1000; i++)
+        memory.written[0x300000000 + (i % 64) * 16 * MiB + i * 4099] = 0xCC;
+    start = std::chrono::steady_clock::now();
+    stored = store.Capture(pool, memory, second);
+    auto recaptureTime = elapsed(start);
+    SnapshotStore::Ranges changed;
+    start = std::chrono::steady_clock::now();
+    SnapshotStore::Diff(pool, first, second, changed);
+    auto diffTime = elapsed(start);
+    printf("capture after 1000 writes: %.0fms, %u new pages; diff: %.1fms, %u ranges\n",
+           recaptureTime, unsigned(stored), diffTime, unsigned(changed.size()));
+    CHECK(changed.size() == stored); //one write per page, a few of them wrote the same value
+}
+
+int main(int argc, char* argv[])
+{
+    WorkPool serial(0), pool(3);
+    testDedup(serial);
+    testDedup(pool);
+    testDiff(serial);
+    testDiff(pool);
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,231 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <thread>
+#include "../../analysis/workpool.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Every item is visited exactly once, by the chunk that owns it
+static void testCoverage(WorkPool & pool, size_t count, size_t grain)
+{
+    std::vector<std::atomic<int>> visits(count);
+    for(auto & visit : visits)
+        visit = 0;
+    std::atomic<bool> chunksOk(true);
+    pool.ParallelFor(count, grain, [&](size_t chunk, size_t start, size_t end)
+    {
+        size_t realGrain = grain ? grain : 1;
+        if(chunk != start / realGrain || start % realGrain || end > count || end - start > realGrain || (end - start != realGrain && end != count))
+            chunksOk = false;
+        for(size_t i = start; i < end; i++)
+            visits[i]++;
+    });
+    CHECK(chunksOk);
+    for(size_t i = 0; i < count; i++)
+        CHECK(visits[i] == 1);
+}
+
+// ParallelFor inside a chunk of another ParallelFor completes and covers everything
+static void testNested(WorkPool & pool)
+{
+    const size_t outer = 64, inner = 1000;
+    std::vector<std::atomic<int>> visits(outer * inner);
+    for(auto & visit : visits)
+        visit = 0;
+    pool.ParallelFor(outer, 1, [&](size_t, size_t start, size_t end)
+    {
+        for(size_t i = start; i < end; i++)
+        {
+            pool.ParallelFor(inner, 10, [&](size_t, size_t innerStart, size_t innerEnd)
+            {
+                for(size_t j = innerStart; j < innerEnd; j++)
+                    visits[i * inner + j]++;
+            });
+        }
+    });
+    for(auto & visit : visits)
+        CHECK(visit == 1);
+}
+
+// Uneven chunks are stolen by the idle threads
+static void testUneven(WorkPool & pool)
+{
+    std::atomic<unsigned long long> sum(0);
+    pool.ParallelFor(256, 1, [&](size_t chunk, size_t, size_t)
+    {
+        unsigned long long local = 0;
+        size_t work = chunk % 16 == 0 ? 200000 : 1000;
+        for(size_t i = 0; i < work; i++)
+            local += i ^ chunk;
+        sum += local;
+    });
+    unsigned long long expected = 0;
+    for(size_t chunk = 0; chunk < 256; chunk++)
+    {
+        size_t work = chunk % 16 == 0 ? 200000 : 1000;
+        for(size_t i = 0; i < work; i++)
+            expected += i ^ chunk;
+    }
+    CHECK(sum == expected);
+}
+
+static void testGrain(WorkPool & pool)
+{
+    CHECK(WorkPool::ChunkCount(0, 4) == 0);
+    CHECK(WorkPool::ChunkCount(1, 4) == 1);
+    CHECK(WorkPool::ChunkCount(8, 4) == 2);
+    CHECK(WorkPool::ChunkCount(9, 4) == 3);
+    CHECK(pool.Grain(0, 0) == 1);
+    CHECK(pool.Grain(10, 64) == 64);
+    CHECK(pool.Grain(1000000, 1) == 1000000 / (pool.Threads() * 8));
+}
+
+static void test(size_t workers)
+{
+    WorkPool pool(workers);
+    CHECK(pool.Threads() == workers + 1);
+    testGrain(pool);
+    testCoverage(pool, 0, 16);
+    testCoverage(pool, 1, 16);
+    testCoverage(pool, 1000, 0);
+    testCoverage(pool, 1000, 1);
+    testCoverage(pool, 1000, 7);
+    testCoverage(pool, 100000, 100);
+    testCoverage(pool, 100000, pool.Grain(100000, 1));
+    testNested(pool);
+    testUneven(pool);
+}
+
+// The baseline schedule: every thread gets a fixed, contiguous share of the chunks up front
+static void staticFor(size_t threads, size_t count, size_t grain, const WorkPool::ChunkFunction & body)
+{
+    auto chunks = WorkPool::ChunkCount(count, grain);
+    auto share = [&](size_t index)
+    {
+        for(size_t chunk = index * chunks / threads; chunk < (index + 1) * chunks / threads; chunk++)
+            body(chunk, chunk * grain, std::min(count, (chunk + 1) * grain));
+    };
+    std::vector<std::thread> workers;
+    for(size_t i = 1; i < threads; i++)
+        workers.push_back(std::thread(share, i));
+    share(0);
+    for(auto & worker : workers)
+        worker.join();
+}
+
+// Rounds of work per item, skewed puts 16 times the cost in the first eighth (think of a code section followed by data)
+static unsigned int itemCost(size_t index, size_t count, bool skewed)
+{
+    return skewed && index < count / 8 ? 16 : 1;
+}
+
+struct Schedule
+{
+    double time; //ms
+    double busiest; //share of the work done by the busiest thread, 1 / threads is a perfect split
+    unsigned long long result;
+};
+
+template<typename For>
+static Schedule benchmark(const std::vector<unsigned char> & data, bool skewed, size_t grain, For parallelFor)
+{
+    Schedule schedule;
+    std::mutex lock;
+    std::map<std::thread::id, unsigned long long> work;
+    unsigned long long total = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned long long> sums(WorkPool::ChunkCount(data.size(), grain));
+    parallelFor(data.size(), grain, [&](size_t chunk, size_t start, size_t end)
+    {
+        unsigned long long sum = 0, cost = 0;
+        for(size_t i = start; i < end; i++)
+        {
+            auto rounds = itemCost(i, data.size(), skewed);
+            unsigned long long value = data[i];
+            for(unsigned int j = 0; j < rounds; j++)
+                value = value * 6364136223846793005ULL + (i | 1);
+            sum += value;
+            cost += rounds;
+        }
+        sums[chunk] = sum;
+        std::lock_guard<std::mutex> guard(lock);
+        work[std::this_thread::get_id()] += cost;
+        total += cost;
+    });
+    schedule.time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    unsigned long long busiest = 0;
+    for(const auto & thread : work)
+        busiest = std::max(busiest, thread.second);
+    schedule.busiest = total ? double(busiest) / total : 0;
+    schedule.result = 0;
+    for(auto sum : sums)
+        schedule.result += sum;
+    return schedule;
+}
+
+static void benchmark(size_t workers, bool skewed)
+{
+    std::vector<unsigned char> data(64 * 1024 * 1024);
+    for(size_t i = 0; i < data.size(); i++)
+        data[i] = (unsigned char)(i * 2654435761U >> 24);
+    WorkPool serial(0), pool(workers);
+    auto threads = pool.Threads();
+    auto grain = pool.Grain(data.size(), 0x4000);
+    auto serialRun = benchmark(data, skewed, 0x4000, [&](size_t count, size_t grain, const WorkPool::ChunkFunction & body)
+    {
+        serial.ParallelFor(count, grain, body);
+    });
+    auto staticRun = benchmark(data, skewed, grain, [&](size_t count, size_t grain, const WorkPool::ChunkFunction & body)
+    {
+        staticFor(threads, count, grain, body);
+    });
+    auto stealingRun = benchmark(data, skewed, grain, [&](size_t count, size_t grain, const WorkPool::ChunkFunction & body)
+    {
+        pool.ParallelFor(count, grain, body);
+    });
+    printf("%s cost, %u threads: serial %.1fms\n", skewed ? "skewed" : "uniform", unsigned(threads), serialRun.time);
+    printf("  static split: %.1fms (%.2fx), busiest thread did %.0f%% of the work\n",
+           staticRun.time, serialRun.time / staticRun.time, staticRun.busiest * 100);
+    printf("  work stealing: %.1fms (%.2fx), busiest thread did %.0f%% of the work\n",
+           stealingRun.time, serialRun.time / stealingRun.time, stealingRun.busiest * 100);
+    if(staticRun.result != serialRun.result || stealingRun.result != serialRun.result)
+    {
+        printf("benchmark results differ\n");
+        failures++;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    test(0);
+    test(1);
+    test(3);
+    test(std::thread::hardware_concurrency());
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        //at least 4 threads, so the split shows on machines with fewer cores
+        size_t workers = std::max(4u, std::thread::hardware_concurrency()) - 1;
+        benchmark(workers, false);
+        benchmark(workers, true);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,246 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../../yarascan.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Synthetic process image: regions of random bytes, some of them cannot be read
+class FakeMemory : public YaraMemorySource
+{
+public:
+    std::map<size_t, std::vector<unsigned char>> regions;
+    std::set<size_t> unreadable;
+    std::atomic<size_t> largestRead;
+
+    FakeMemory()
+        : largestRead(0)
+    {
+    }
+
+    void AddRegion(size_t base, size_t size, unsigned int seed, bool readable = true)
+    {
+        std::mt19937 random(seed);
+        auto & data = regions[base];
+        data.resize(size);
+        for(auto & byte : data)
+            byte = (unsigned char)random();
+        if(!readable)
+            unreadable.insert(base);
+    }
+
+    void Write(size_t address, const std::string & text)
+    {
+        auto region = --regions.upper_bound(address);
+        memcpy(region->second.data() + (address - region->first), text.data(), text.size());
+    }
+
+    std::vector<YaraRegion> Regions() const
+    {
+        std::vector<YaraRegion> result;
+        for(const auto & region : regions)
+        {
+            YaraRegion yaraRegion = { region.first, region.second.size() };
+            result.push_back(yaraRegion);
+        }
+        return result;
+    }
+
+    bool Read(size_t address, void* buffer, size_t size) override
+    {
+        auto region = --regions.upper_bound(address);
+        if(unreadable.count(region->first) || address + size > region->first + region->second.size())
+            return false;
+        memcpy(buffer, region->second.data() + (address - region->first), size);
+        size_t largest = largestRead;
+        while(size > largest && !largestRead.compare_exchange_weak(largest, size))
+            ;
+        return true;
+    }
+};
+
+typedef std::tuple<size_t, std::string, std::string> Match;
+
+class CollectSink : public YaraMatchSink
+{
+public:
+    std::vector<Match> matches;
+
+    void Add(size_t address, const std::string & rule, const std::string & pattern) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        matches.push_back(Match(address, rule, pattern));
+    }
+
+    std::vector<Match> Sorted()
+    {
+        auto result = matches;
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    std::mutex mutex;
+};
+
+// Stand-in for the compiled rules (libyara is only shipped for Windows): literal strings, and a rule without strings that matches every buffer
+struct LocalRule
+{
+    std::string name;
+    std::vector<std::string> strings;
+};
+
+static const std::vector<LocalRule> localRules =
+{
+    { "Marker", { "MZ_MARKER_X64DBG", "this program cannot be run" } },
+    { "Url", { "http://example.invalid/payload" } },
+    { "Everything", { } },
+};
+
+static int scanLocal(size_t base, const unsigned char* data, size_t size, YaraMatchSink & sink)
+{
+    for(const auto & rule : localRules)
+    {
+        if(rule.strings.empty())
+        {
+            sink.AddRule(base, rule.name);
+            continue;
+        }
+        for(const auto & string : rule.strings)
+        {
+            auto begin = data;
+            auto end = data + size;
+            for(auto found = begin; (found = std::search(found, end, string.begin(), string.end())) != end; found++)
+                sink.Add(base + (found - data), rule.name + ".$" + string.substr(0, 4), string);
+        }
+    }
+    return 0;
+}
+
+// What the command did before: one buffer per region, scanned in one piece
+static std::vector<Match> scanWhole(FakeMemory & memory)
+{
+    CollectSink sink;
+    for(const auto & region : memory.Regions())
+    {
+        std::vector<unsigned char> data(region.size);
+        if(memory.Read(region.base, data.data(), region.size))
+            scanLocal(region.base, data.data(), region.size, sink);
+    }
+    return sink.Sorted();
+}
+
+static void makeImage(FakeMemory & memory)
+{
+    memory.AddRegion(0x10000, 0x1000, 1);
+    memory.AddRegion(0x400000, 0x123000, 2); //several chunks
+    memory.AddRegion(0x7FF00000, 0x40000, 3);
+    memory.AddRegion(0x80000000, 0x8000, 4, false);
+    memory.AddRegion(0x90000000, 0x10, 5); //smaller than the strings
+    memory.Write(0x10000, "MZ_MARKER_X64DBG");
+    memory.Write(0x11000 - 16, "MZ_MARKER_X64DBG"); //ends with the region
+    memory.Write(0x80000100, "MZ_MARKER_X64DBG"); //unreadable
+    //around the chunk boundaries of the big region (chunks of 0x10000)
+    for(size_t boundary = 0x410000; boundary < 0x523000; boundary += 0x10000)
+    {
+        memory.Write(boundary - 5, "MZ_MARKER_X64DBG"); //straddles
+        memory.Write(boundary - 16, "this program cannot be run"); //straddles
+        memory.Write(boundary + 40, "http://example.invalid/payload"); //starts in the overlap of the previous chunk
+    }
+    memory.Write(0x400000 + 0x123000 - 30, "http://example.invalid/payload"); //ends with the region
+    memory.Write(0x7FF20000 - 8, "this program cannot be run");
+}
+
+// Chunked scans report exactly the matches of whole region scans
+static void testChunks(size_t workers, size_t maxThreads, size_t chunkSize, size_t overlap)
+{
+    FakeMemory memory;
+    makeImage(memory);
+    auto expected = scanWhole(memory);
+    CHECK(expected.size() > 40);
+
+    WorkPool pool(workers);
+    YaraRegionScanner scanner(maxThreads, chunkSize, overlap);
+    CollectSink sink;
+    std::atomic<int> active(0), maxActive(0);
+    memory.largestRead = 0;
+    auto err = scanner.Scan(pool, memory.Regions(), memory, sink, [&](const YaraChunk & chunk, const unsigned char* data, YaraMatchSink & chunkSink)
+    {
+        int now = ++active;
+        int most = maxActive;
+        while(now > most && !maxActive.compare_exchange_weak(most, now))
+            ;
+        auto result = scanLocal(chunk.base, data, chunk.size, chunkSink);
+        active--;
+        return result;
+    });
+    CHECK(err == 0);
+    CHECK(sink.Sorted() == expected);
+    CHECK(size_t(maxActive) <= maxThreads);
+    CHECK(memory.largestRead <= chunkSize + overlap);
+}
+
+static void testChunkLayout()
+{
+    YaraRegionScanner scanner(4, 100, 10);
+    YaraRegion region = { 1000, 250 };
+    auto chunks = scanner.Chunks(std::vector<YaraRegion>(1, region));
+    CHECK(chunks.size() == 3);
+    CHECK(chunks[0].base == 1000 && chunks[0].owned == 100 && chunks[0].size == 110 && chunks[0].first);
+    CHECK(chunks[1].base == 1100 && chunks[1].owned == 100 && chunks[1].size == 110 && !chunks[1].first);
+    CHECK(chunks[2].base == 1200 && chunks[2].owned == 50 && chunks[2].size == 50 && !chunks[2].first);
+    region.size = 105;
+    chunks = scanner.Chunks(std::vector<YaraRegion>(1, region));
+    CHECK(chunks.size() == 2 && chunks[0].size == 105 && chunks[1].size == 5);
+    CHECK(scanner.Chunks(std::vector<YaraRegion>()).empty());
+}
+
+// The last error of the scan function is returned, the other chunks are still scanned
+static void testError()
+{
+    FakeMemory memory;
+    makeImage(memory);
+    WorkPool pool(2);
+    YaraRegionScanner scanner(32, 0x10000, 0x100);
+    CollectSink sink;
+    std::atomic<int> scanned(0);
+    auto err = scanner.Scan(pool, memory.Regions(), memory, sink, [&](const YaraChunk & chunk, const unsigned char* data, YaraMatchSink & chunkSink)
+    {
+        scanned++;
+        return chunk.base == 0x7FF00000 ? 1 : scanLocal(chunk.base, data, chunk.size, chunkSink);
+    });
+    CHECK(err == 1);
+    CHECK(scanned == int(scanner.Chunks(memory.Regions()).size()) - 1); //without the unreadable region
+}
+
+int main(int argc, char* argv[])
+{
+    testChunkLayout();
+    testChunks(0, 32, 0x10000, 64);
+    testChunks(3, 32, 0x10000, 64);
+    testChunks(7, 3, 0x10000, 64); //more pool threads than yara allows
+    testChunks(5, 2, 0x100000, 0x1000); //the big region fits in two chunks
+    testChunks(2, 32, 1 << 30, 0); //one chunk per region, like before
+    testError();
+    printf("%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
@@ -69,6 +69,10 @@ enum SectionLock
     LockHistory,
     LockSymbolCache,
     LockLineCache,
+    LockInstructionCache,
+    LockAnalysisDirty,
+    LockYaraRules,
+    LockSnapshots,
 
     // Number of elements in this enumeration. Must always be the last
     // index.
@@ -243,6 +243,7 @@ static void registercommands()
     dbgcmdnew("exinfo", cbInstrExinfo, true); //dump last exception information
     dbgcmdnew("guiupdatedisable", cbInstrDisableGuiUpdate, true); //disable gui message
     dbgcmdnew("guiupdateenable", cbInstrEnableGuiUpdate, true); //enable gui message
+    dbgcmdnew("guiupdatestats", cbInstrGuiUpdateStats, false); //gui update counters
     dbgcmdnew("mnemonichelp", cbInstrMnemonichelp, false); //mnemonic help
     dbgcmdnew("mnemonicbrief", cbInstrMnemonicbrief, false); //mnemonic brief
     dbgcmdnew("virtualmod", cbInstrVirtualmod, true); //virtual module
@@ -282,6 +283,9 @@ static void registercommands()
     dbgcmdnew("Fill\1memset", cbDebugMemset, true); //memset
     dbgcmdnew("getpagerights\1getrightspage", cbDebugGetPageRights, true);
     dbgcmdnew("setpagerights\1setrightspage", cbDebugSetPageRights, true);
+    dbgcmdnew("memsnapshot", cbDebugMemSnapshot, true); //capture the memory
+    dbgcmdnew("memsnapshotdiff", cbDebugMemSnapshotDiff, true); //list the changed memory
+    dbgcmdnew("memsnapshotdel", cbDebugMemSnapshotDelete, true); //delete snapshots
 
     //plugins
     dbgcmdnew("StartScylla\1scylla\1imprec", cbDebugStartScylla, false); //start scylla
@@ -354,6 +358,7 @@ static void registercommands()
     dbgcmdnew("exanal\1exanalyse\1exanalyze", cbInstrExanalyse, true); //exception directory analysis
     dbgcmdnew("analrecur\1analr", cbInstrAnalrecur, true); //analyze a single function
     dbgcmdnew("analxrefs\1analx", cbInstrAnalxrefs, true); //analyze xrefs
+    dbgcmdnew("analinc\1analyse_incremental\1analyze_incremental", cbInstrAnalinc, true); //analyze changes since the last analysis
     dbgcmdnew("analadv", cbInstrAnalyseadv, true); //analyze xref,function and data
 
     //Operating System Control
@@ -688,6 +693,7 @@ extern "C" DLL_EXPORT void _dbg_dbgexitsignal()
     dputs(QT_TRANSLATE_NOOP("DBG", "Cleaning up allocated data..."));
     cmdfree();
     varfree();
+    yaraclearcache();
     yr_finalize();
     Capstone::GlobalFinalize();
     dputs(QT_TRANSLATE_NOOP("DBG", "Checking for mem leaks..."));
@@ -138,6 +138,27 @@ bool XrefDeleteAll(duint Address)
     return xrefs.Delete(Xrefs::VaKey(Address));
 }
 
+bool XrefDelete(duint Address, duint From)
+{
+    EXCLUSIVE_ACQUIRE(LockCrossReferences);
+    auto & mapData = xrefs.GetDataUnsafe();
+    auto found = mapData.find(Xrefs::VaKey(Address));
+    if(found == mapData.end())
+        return false;
+    auto & references = found->second.references;
+    if(!references.erase(From - ModBaseFromAddr(Address)))
+        return false;
+    if(references.empty())
+    {
+        mapData.erase(found);
+        return true;
+    }
+    found->second.type = XREF_DATA;
+    for(const auto & itr : references)
+        found->second.type = max(found->second.type, itr.second.type);
+    return true;
+}
+
 void XrefDelRange(duint Start, duint End)
 {
     xrefs.DeleteRange(Start, End, false);
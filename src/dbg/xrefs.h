@@ -8,6 +8,7 @@ bool XrefGet(duint Address, XREF_INFO* List);
 duint XrefGetCount(duint Address);
 XREFTYPE XrefGetType(duint Address);
 bool XrefDeleteAll(duint Address);
+bool XrefDelete(duint Address, duint From);
 void XrefDelRange(duint Start, duint End);
 void XrefCacheSave(JSON Root);
 void XrefCacheLoad(JSON Root);
@@ -0,0 +1,152 @@
+#ifndef _YARASCAN_H
+#define _YARASCAN_H
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "analysis/workpool.h"
+
+struct YaraRegion
+{
+    size_t base;
+    size_t size;
+};
+
+//Memory that is scanned, the debuggee or a synthetic image in the tests
+class YaraMemorySource
+{
+public:
+    virtual ~YaraMemorySource()
+    {
+    }
+
+    //Reads size bytes at address, the chunk is skipped when this fails
+    virtual bool Read(size_t address, void* buffer, size_t size) = 0;
+};
+
+//Receives the matches, it is called from the scanning threads
+class YaraMatchSink
+{
+public:
+    virtual ~YaraMatchSink()
+    {
+    }
+
+    //A string of the rule matched at address
+    virtual void Add(size_t address, const std::string & rule, const std::string & pattern) = 0;
+
+    //A rule without strings matched the buffer starting at address
+    virtual void AddRule(size_t address, const std::string & rule)
+    {
+        Add(address, rule, "");
+    }
+};
+
+//Part of a region that is scanned as one buffer
+struct YaraChunk
+{
+    size_t base; //address of the first byte
+    size_t size; //bytes in the buffer, including the overlap with the next chunk
+    size_t owned; //matches starting at this offset or later are reported by the next chunk
+    bool first; //first chunk of the region, only this one reports rules without strings
+};
+
+/**
+ * @brief Scans memory regions for the "yara rules, *" command (it only depends on the standard library).
+ * Regions larger than the chunk size are split in chunks that overlap, so a match that starts in one
+ * chunk and is at most overlap bytes long is still found. Every thread reuses one buffer, at most
+ * maxThreads chunks are scanned at the same time (YR_RULES has a fixed number of thread slots).
+**/
+class YaraRegionScanner
+{
+public:
+    //Scans the buffer of a chunk and reports to sink, returns the yara error code
+    typedef std::function<int(const YaraChunk & chunk, const unsigned char* data, YaraMatchSink & sink)> ScanFunction;
+
+    YaraRegionScanner(size_t maxThreads, size_t chunkSize, size_t overlap)
+        : maxThreads(std::max(maxThreads, size_t(1))),
+          chunkSize(std::max(chunkSize, size_t(1))),
+          overlap(overlap)
+    {
+    }
+
+    std::vector<YaraChunk> Chunks(const std::vector<YaraRegion> & regions) const
+    {
+        std::vector<YaraChunk> chunks;
+        for(const auto & region : regions)
+        {
+            for(size_t offset = 0; offset < region.size; offset += chunkSize)
+            {
+                YaraChunk chunk;
+                chunk.base = region.base + offset;
+                chunk.owned = std::min(chunkSize, region.size - offset);
+                chunk.size = chunk.owned + std::min(overlap, region.size - offset - chunk.owned);
+                chunk.first = offset == 0;
+                chunks.push_back(chunk);
+            }
+        }
+        return chunks;
+    }
+
+    //Returns the last error of scan, 0 when every chunk was scanned successfully
+    int Scan(WorkPool & pool, const std::vector<YaraRegion> & regions, YaraMemorySource & source, YaraMatchSink & sink, const ScanFunction & scan) const
+    {
+        auto chunks = Chunks(regions);
+        auto threads = std::min(std::min(pool.Threads(), maxThreads), chunks.size());
+        std::atomic<size_t> next(0);
+        std::atomic<int> err(0);
+        pool.ParallelFor(threads, 1, [&](size_t, size_t, size_t)
+        {
+            std::vector<unsigned char> buffer;
+            for(size_t i; (i = next++) < chunks.size();)
+            {
+                const auto & chunk = chunks[i];
+                buffer.resize(chunk.size);
+                if(!source.Read(chunk.base, buffer.data(), chunk.size))
+                    continue;
+                ChunkSink chunkSink(chunk, sink);
+                auto result = scan(chunk, buffer.data(), chunkSink);
+                if(result)
+                    err = result;
+            }
+        });
+        return err;
+    }
+
+private:
+    //Drops the matches that the neighbouring chunks report
+    class ChunkSink : public YaraMatchSink
+    {
+    public:
+        ChunkSink(const YaraChunk & chunk, YaraMatchSink & sink)
+            : chunk(chunk),
+              sink(sink)
+        {
+        }
+
+        void Add(size_t address, const std::string & rule, const std::string & pattern) override
+        {
+            if(address - chunk.base < chunk.owned)
+                sink.Add(address, rule, pattern);
+        }
+
+        void AddRule(size_t address, const std::string & rule) override
+        {
+            if(chunk.first)
+                sink.AddRule(address, rule);
+        }
+
+    private:
+        const YaraChunk & chunk;
+        YaraMatchSink & sink;
+    };
+
+    size_t maxThreads;
+    size_t chunkSize;
+    size_t overlap;
+};
+
+#endif //_YARASCAN_H
@@ -1,5 +1,6 @@
 #include "AbstractTableView.h"
 #include <QStyleOptionButton>
+#include <QElapsedTimer>
 #include "Configuration.h"
 #include "ColumnReorderDialog.h"
 #include "CachedFontMetrics.h"
@@ -27,7 +28,10 @@ void AbstractTableScrollBar::leaveEvent(QEvent* event)
 
 AbstractTableView::AbstractTableView(QWidget* parent)
     : QAbstractScrollArea(parent),
-      mFontMetrics(nullptr)
+      mFontMetrics(nullptr),
+      mPaintStatistics(ConfigBool("Gui", "PaintStatistics")),
+      mPaintTime(0),
+      mPaintCount(0)
 {
     // Class variable initialization
     mTableOffset = 0;
@@ -91,6 +95,7 @@ AbstractTableView::AbstractTableView(QWidget* parent)
     connect(Config(), SIGNAL(colorsUpdated()), this, SLOT(slot_updateColors()));
     connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(slot_updateFonts()));
     connect(Config(), SIGNAL(shortcutsUpdated()), this, SLOT(slot_updateShortcuts()));
+    connect(Config(), SIGNAL(boolsUpdated()), this, SLOT(slot_updateBools()));
 
     // todo: try Qt::QueuedConnection to init
     Initialize();
@@ -160,6 +165,11 @@ void AbstractTableView::slot_updateShortcuts()
     updateShortcuts();
 }
 
+void AbstractTableView::slot_updateBools()
+{
+    mPaintStatistics = ConfigBool("Gui", "PaintStatistics");
+}
+
 void AbstractTableView::loadColumnFromConfig(const QString & viewName)
 {
     int columnCount = getColumnCount();
@@ -217,6 +227,9 @@ void AbstractTableView::paintEvent(QPaintEvent* event)
     if(!mAllowPainting)
         return;
 
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
     if(getColumnCount()) //make sure the last column is never smaller than the window
     {
         int totalWidth = 0;
@@ -324,9 +337,35 @@ void AbstractTableView::paintEvent(QPaintEvent* event)
         y = getHeaderHeight();
         x += getColumnWidth(j);
     }
+
+    if(mPaintStatistics)
+        updatePaintStatistics(paintTimer.nsecsElapsed());
     //emit repainted();
 }
 
+void AbstractTableView::updatePaintStatistics(qint64 nsecs)
+{
+    mPaintTime += nsecs;
+    if(++mPaintCount < 100)
+        return;
+    QString name = mViewName.length() ? mViewName : QString(metaObject()->className());
+    QString message = QString("%1: %2 paints, %3us per paint, text cache %4 hits, %5 misses%6\n")
+                      .arg(name)
+                      .arg(mPaintCount)
+                      .arg(mPaintTime / mPaintCount / 1000)
+                      .arg(mFontMetrics->textCacheHits())
+                      .arg(mFontMetrics->textCacheMisses())
+                      .arg(paintStatisticsDetails());
+    GuiAddLogMessage(message.toUtf8().constData());
+    mPaintTime = 0;
+    mPaintCount = 0;
+}
+
+QString AbstractTableView::paintStatisticsDetails() const
+{
+    return QString();
+}
+
 
 /************************************************************************************
                             Mouse Management
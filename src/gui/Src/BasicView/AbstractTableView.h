@@ -134,6 +134,7 @@ public slots:
     void slot_updateColors();
     void slot_updateFonts();
     void slot_updateShortcuts();
+    void slot_updateBools();
 
     // Update/Reload/Refresh/Repaint
     virtual void reloadData();
@@ -208,10 +209,19 @@ private:
 
     int getColumnDisplayIndexFromX(int x);
     friend class ColumnReorderDialog;
+
+    // Paint statistics
+    bool mPaintStatistics;
+    qint64 mPaintTime;
+    int mPaintCount;
+    void updatePaintStatistics(qint64 nsecs);
 protected:
     bool mAllowPainting;
     bool mDrawDebugOnly;
 
+    // Extra text for the paint statistics
+    virtual QString paintStatisticsDetails() const;
+
     // Configuration
     QColor backgroundColor;
     QColor textColor;
@@ -141,6 +141,11 @@ void Disassembly::tokenizerConfigUpdatedSlot()
 /************************************************************************************
                             Reimplemented Functions
 ************************************************************************************/
+QString Disassembly::paintStatisticsDetails() const
+{
+    return QString(", instruction cache %1 hits, %2 misses").arg(QBeaEngine::InstructionCacheHits()).arg(QBeaEngine::InstructionCacheMisses());
+}
+
 /**
  * @brief       This method has been reimplemented. It returns the string to paint or paints it
  *              by its own.
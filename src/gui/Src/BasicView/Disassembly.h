@@ -20,6 +20,7 @@ public:
     virtual void updateFonts();
 
     // Reimplemented Functions
+    QString paintStatisticsDetails() const;
     QString paintContent(QPainter* painter, dsint rowBase, int rowOffset, int col, int x, int y, int w, int h);
 
     // Mouse Management
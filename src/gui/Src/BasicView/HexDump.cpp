@@ -4,8 +4,46 @@
 #include "StringUtil.h"
 #include <QMessageBox>
 
+QByteArray HexDump::mSharedWindow;
+duint HexDump::mSharedWindowVa = 0;
+unsigned int HexDump::mSharedWindowGeneration = 0;
+unsigned int HexDump::mWindowGeneration = 1;
+
+struct ByteStrings
+{
+    QString hex[256];
+    QString ascii[256];
+
+    ByteStrings()
+    {
+        for(int i = 0; i < 256; i++)
+        {
+            hex[i] = QString("%1").arg(i, 2, 16, QChar('0')).toUpper();
+            QChar wChar = QChar::fromLatin1((char)i);
+            ascii[i] = wChar.isPrint() ? QString(wChar) : QString(".");
+        }
+    }
+};
+
+static const ByteStrings & byteStrings()
+{
+    static ByteStrings strings;
+    return strings;
+}
+
+static QString hexString(uint64 value, int size)
+{
+    const auto & hex = byteStrings().hex;
+    QString wStr;
+    wStr.reserve(size * 2);
+    for(int i = size - 1; i >= 0; i--)
+        wStr += hex[(value >> (i * 8)) & 0xFF];
+    return wStr;
+}
+
 HexDump::HexDump(QWidget* parent)
-    : AbstractTableView(parent)
+    : AbstractTableView(parent),
+      mWindowVa(0)
 {
     SelectionData_t data;
     memset(&data, 0, sizeof(SelectionData_t));
@@ -23,6 +61,7 @@ HexDump::HexDump(QWidget* parent)
     backgroundColor = ConfigColor("HexDumpBackgroundColor");
     textColor = ConfigColor("HexDumpTextColor");
     selectionColor = ConfigColor("HexDumpSelectionColor");
+    mModifiedBytesColor = ConfigColor("HexDumpModifiedBytesColor");
 
     mRvaDisplayEnabled = false;
     mSyncAddrExpression = "";
@@ -49,6 +88,7 @@ void HexDump::updateColors()
     backgroundColor = ConfigColor("HexDumpBackgroundColor");
     textColor = ConfigColor("HexDumpTextColor");
     selectionColor = ConfigColor("HexDumpSelectionColor");
+    mModifiedBytesColor = ConfigColor("HexDumpModifiedBytesColor");
     reloadData();
 }
 
@@ -79,6 +119,59 @@ void HexDump::updateDumpSlot()
     reloadData();
 }
 
+void HexDump::reloadData()
+{
+    mWindowGeneration++; //memory might have changed, the shared window is stale
+    AbstractTableView::reloadData();
+}
+
+void HexDump::prepareData()
+{
+    AbstractTableView::prepareData();
+
+    int wBytePerRowCount = getBytePerRowCount();
+    dsint wStart = getTableOffset() * wBytePerRowCount - mByteOffset;
+    dsint wEnd = wStart + (getViewableRowsCount() + 1) * wBytePerRowCount;
+    dsint wSize = (dsint)mMemPage->getSize();
+    wStart = wStart < 0 ? 0 : wStart;
+    wEnd = wEnd > wSize ? wSize : wEnd;
+    duint wVa = rvaToVa(wStart);
+    mWindowVa = wVa;
+    if(wEnd <= wStart)
+    {
+        mWindow.clear();
+        return;
+    }
+
+    int wWindowSize = int(wEnd - wStart);
+    if(mSharedWindowGeneration == mWindowGeneration && mSharedWindowVa == wVa && mSharedWindow.size() == wWindowSize)
+    {
+        mWindow = mSharedWindow;
+        return;
+    }
+    mWindow.resize(wWindowSize);
+    if(!mMemPage->read(mWindow.data(), wStart, wWindowSize))
+    {
+        mWindow.clear();
+        return;
+    }
+    mSharedWindow = mWindow;
+    mSharedWindowVa = wVa;
+    mSharedWindowGeneration = mWindowGeneration;
+}
+
+const byte_t* HexDump::readWindow(dsint rva, duint size)
+{
+    duint va = rvaToVa(rva);
+    if(va >= mWindowVa && va + size <= mWindowVa + mWindow.size())
+        return (const byte_t*)mWindow.constData() + (va - mWindowVa);
+    //outside of the visible rows (copying for example)
+    if(mReadBuffer.size() < (int)size)
+        mReadBuffer.resize((int)size);
+    mMemPage->read(mReadBuffer.data(), rva, size);
+    return (const byte_t*)mReadBuffer.constData();
+}
+
 void HexDump::copySelectionSlot()
 {
     Bridge::CopyToClipboard(makeCopyText());
@@ -598,10 +691,7 @@ void HexDump::getColumnRichText(int col, dsint rva, RichTextPainter::List & rich
 
         wBufferByteCount = wBufferByteCount > (dsint)(mMemPage->getSize() - rva) ? mMemPage->getSize() - rva : wBufferByteCount;
 
-        byte_t* wData = new byte_t[wBufferByteCount];
-        //byte_t wData[mDescriptor.at(col).itemCount * wByteCount];
-
-        mMemPage->read(wData, rva, wBufferByteCount);
+        const byte_t* wData = readWindow(rva, wBufferByteCount);
 
         if(desc.textCodec) //convert the row bytes to unicode
         {
@@ -616,14 +706,11 @@ void HexDump::getColumnRichText(int col, dsint rva, RichTextPainter::List & rich
         }
         else
         {
-            QColor highlightColor = ConfigColor("HexDumpModifiedBytesColor");
+            int maxLen = getStringMaxLength(desc.data);
+            QString append = maxLen ? " " : "";
 
             for(wI = 0; wI < desc.itemCount && (rva + wI) < (dsint)mMemPage->getSize(); wI++)
             {
-                int maxLen = getStringMaxLength(mDescriptor.at(col - 1).data);
-                QString append = " ";
-                if(!maxLen)
-                    append = "";
                 if((rva + wI + wByteCount - 1) < (dsint)mMemPage->getSize())
                     wStr = toString(desc.data, (void*)(wData + wI * wByteCount)).rightJustified(maxLen, ' ') + append;
                 else
@@ -632,14 +719,12 @@ void HexDump::getColumnRichText(int col, dsint rva, RichTextPainter::List & rich
                 dsint start = rvaToVa(rva + wI * wByteCount);
                 dsint end = start + wByteCount - 1;
                 if(DbgFunctions()->PatchInRange(start, end))
-                    curData.textColor = highlightColor;
+                    curData.textColor = mModifiedBytesColor;
                 else
                     curData.textColor = textColor;
                 richText.push_back(curData);
             }
         }
-
-        delete[] wData;
     }
 }
 
@@ -697,18 +782,13 @@ QString HexDump::byteToString(byte_t byte, ByteViewMode_e mode)
     {
     case HexByte:
     {
-        wStr = QString("%1").arg((unsigned char)byte, 2, 16, QChar('0')).toUpper();
+        wStr = byteStrings().hex[byte];
     }
     break;
 
     case AsciiByte:
     {
-        QChar wChar = QChar::fromLatin1((char)byte);
-
-        if(wChar.isPrint() == true)
-            wStr = QString(wChar);
-        else
-            wStr = ".";
+        wStr = byteStrings().ascii[byte];
     }
     break;
 
@@ -742,15 +822,14 @@ QString HexDump::wordToString(uint16 word, WordViewMode_e mode)
     {
     case HexWord:
     {
-        wStr = QString("%1").arg((unsigned short)word, 4, 16, QChar('0')).toUpper();
+        wStr = hexString(word, sizeof(word));
     }
     break;
 
     case UnicodeWord:
     {
-        QChar wChar = QChar::fromLatin1((char)word & 0xFF);
-        if(wChar.isPrint() == true && (word >> 8) == 0)
-            wStr = QString(wChar);
+        if((word >> 8) == 0)
+            wStr = byteStrings().ascii[word];
         else
             wStr = ".";
     }
@@ -786,7 +865,7 @@ QString HexDump::dwordToString(uint32 dword, DwordViewMode_e mode)
     {
     case HexDword:
     {
-        wStr = QString("%1").arg((unsigned int)dword, 8, 16, QChar('0')).toUpper();
+        wStr = hexString(dword, sizeof(dword));
     }
     break;
 
@@ -826,7 +905,7 @@ QString HexDump::qwordToString(uint64 qword, QwordViewMode_e mode)
     {
     case HexQword:
     {
-        wStr = QString("%1").arg((unsigned long long)qword, 16, 16, QChar('0')).toUpper();
+        wStr = hexString(qword, sizeof(qword));
     }
     break;
 
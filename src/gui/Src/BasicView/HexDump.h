@@ -154,6 +154,10 @@ public:
 
     void setupCopyMenu();
 
+    // Update/Reload/Refresh/Repaint
+    void prepareData() override;
+    const byte_t* readWindow(dsint rva, duint size);
+
 signals:
     void selectionUpdated();
 
@@ -164,6 +168,7 @@ public slots:
     void copySelectionSlot();
     void copyAddressSlot();
     void copyRvaSlot();
+    void reloadData() override;
 
 private:
     enum GuiState_t {NoState, MultiRowsSelectionState};
@@ -182,6 +187,17 @@ private:
     QList<dsint> mVaHistory;
     int mCurrentVa;
 
+    // Visible memory window, read once per reload
+    QByteArray mWindow;
+    duint mWindowVa;
+    QByteArray mReadBuffer;
+
+    // Last window read by any dump, shared by dumps showing the same memory
+    static QByteArray mSharedWindow;
+    static duint mSharedWindowVa;
+    static unsigned int mSharedWindowGeneration;
+    static unsigned int mWindowGeneration;
+
 protected:
     MemoryPage* mMemPage;
     int mByteOffset;
@@ -191,6 +207,7 @@ protected:
     duint mRvaDisplayBase;
     dsint mRvaDisplayPageBase;
     QString mSyncAddrExpression;
+    QColor mModifiedBytesColor;
     QAction* mCopyAddress;
     QAction* mCopyRva;
     QAction* mCopySelection;
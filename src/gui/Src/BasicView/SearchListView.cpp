@@ -164,16 +164,11 @@ void SearchListView::searchTextChanged(const QString & arg1)
     mSearchList->setRowCount(0);
     int rows = mList->getRowCount();
     int columns = mList->getColumnCount();
-    for(int i = 0, j = 0; i < rows; i++)
-    {
-        if(findTextInList(mList, arg1, i, mSearchStartCol, false))
-        {
-            mSearchList->setRowCount(j + 1);
-            for(int k = 0; k < columns; k++)
-                mSearchList->setCellContent(j, k, mList->getCellContent(i, k));
-            j++;
-        }
-    }
+    auto matches = mList->filterRows(arg1, mSearchStartCol, mRegexCheckbox->checkState() == Qt::Checked);
+    mSearchList->setRowCount(int(matches.size()));
+    for(int j = 0; j < int(matches.size()); j++)
+        for(int k = 0; k < columns; k++)
+            mSearchList->setCellContent(j, k, mList->getCellContent(matches[j], k));
     rows = mSearchList->getRowCount();
     mSearchList->setTableOffset(0);
     for(int i = 0; i < rows; i++)
@@ -1,5 +1,6 @@
 #include "StdTable.h"
 #include "Bridge.h"
+#include <algorithm>
 
 StdTable::StdTable(QWidget* parent) : AbstractTableView(parent)
 {
@@ -258,9 +259,8 @@ void StdTable::addColumnAt(int width, QString title, bool isClickable, QString c
 {
     AbstractTableView::addColumnAt(width, title, isClickable, sortFn);
 
-    //append empty column to list of rows
-    for(int i = 0; i < mData.size(); i++)
-        mData[i].append("");
+    //append empty column
+    mData.push_back(std::vector<QString>(getRowCount()));
 
     //Append copy title
     if(!copyTitle.length())
@@ -271,17 +271,11 @@ void StdTable::addColumnAt(int width, QString title, bool isClickable, QString c
 
 void StdTable::setRowCount(int count)
 {
-    int wRowToAddOrRemove = count - mData.size();
-    for(int i = 0; i < qAbs(wRowToAddOrRemove); i++)
+    for(auto & column : mData)
     {
-        if(wRowToAddOrRemove > 0)
-        {
-            mData.append(QList<QString>());
-            for(int j = 0; j < getColumnCount(); j++)
-                mData.last().append("");
-        }
-        else
-            mData.removeLast();
+        column.resize(count);
+        if(!count)
+            std::vector<QString>().swap(column); //release the memory
     }
     AbstractTableView::setRowCount(count);
 }
@@ -290,28 +284,43 @@ void StdTable::deleteAllColumns()
 {
     setRowCount(0);
     AbstractTableView::deleteAllColumns();
+    mData.clear();
     mCopyTitles.clear();
 }
 
 void StdTable::setCellContent(int r, int c, QString s)
 {
     if(isValidIndex(r, c) == true)
-        mData[r].replace(c, s);
+        mData[c][r] = s;
 }
 
 QString StdTable::getCellContent(int r, int c)
 {
     if(isValidIndex(r, c) == true)
-        return mData[r][c];
+        return mData[c][r];
     else
         return QString("");
 }
 
+//Replaces a whole column without copying the cells, content must have one cell per row
+bool StdTable::swapColumnContent(int c, std::vector<QString> & content)
+{
+    if(c < 0 || c >= int(mData.size()) || content.size() != mData[c].size())
+        return false;
+    mData[c].swap(content);
+    return true;
+}
+
+std::vector<int> StdTable::filterRows(const QString & text, int startCol, bool regex)
+{
+    return TableRows::Filter(mData, text, startCol, regex);
+}
+
 bool StdTable::isValidIndex(int r, int c)
 {
-    if(r < 0 || c < 0 || r >= mData.size())
+    if(r < 0 || c < 0 || c >= int(mData.size()))
         return false;
-    return c < mData.at(r).size();
+    return r < int(mData[c].size());
 }
 
 void StdTable::copyLineSlot()
@@ -524,9 +533,25 @@ void StdTable::headerButtonPressedSlot(int col)
     reloadData();
 }
 
+void StdTable::sortRows(int col, bool greater, const SortBy::t & sortFn)
+{
+    if(col < 0 || col >= int(mData.size()))
+        return;
+    typedef bool (*SortFunction)(const QString &, const QString &);
+    auto fn = sortFn.target<SortFunction>();
+    auto type = TableRows::KeyCustom;
+    if(fn && *fn == SortBy::AsText)
+        type = TableRows::KeyText;
+    else if(fn && *fn == SortBy::AsInt)
+        type = TableRows::KeyInt;
+    else if(fn && *fn == SortBy::AsHex)
+        type = TableRows::KeyHex;
+    TableRows::Reorder(mData, TableRows::SortOrder(mData[col], greater, type, sortFn));
+}
+
 void StdTable::reloadData()
 {
     if(mSort.first != -1) //re-sort if the user wants to sort
-        qSort(mData.begin(), mData.end(), ColumnCompare(mSort.first, mSort.second, getColumnSortBy(mSort.first)));
+        sortRows(mSort.first, mSort.second, getColumnSortBy(mSort.first));
     AbstractTableView::reloadData();
 }
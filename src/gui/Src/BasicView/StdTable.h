@@ -2,6 +2,8 @@
 #define STDTABLE_H
 
 #include "AbstractTableView.h"
+#include "TableRows.h"
+#include <vector>
 
 class StdTable : public AbstractTableView
 {
@@ -35,6 +37,8 @@ public:
     void deleteAllColumns();
     void setCellContent(int r, int c, QString s);
     QString getCellContent(int r, int c);
+    bool swapColumnContent(int c, std::vector<QString> & content);
+    std::vector<int> filterRows(const QString & text, int startCol, bool regex);
     bool isValidIndex(int r, int c);
 
     //context menu helpers
@@ -58,29 +62,7 @@ public slots:
 
 private:
     void copyTable(std::function<int(int)> getMaxColSize);
-
-    class ColumnCompare
-    {
-    public:
-        ColumnCompare(int col, bool greater, SortBy::t fn)
-        {
-            mCol = col;
-            mGreater = greater;
-            mSortFn = fn;
-        }
-
-        inline bool operator()(const QList<QString> & a, const QList<QString> & b) const
-        {
-            bool less = mSortFn(a.at(mCol), b.at(mCol));
-            if(mGreater)
-                return !less;
-            return less;
-        }
-    private:
-        int mCol;
-        int mGreater;
-        SortBy::t mSortFn;
-    };
+    void sortRows(int col, bool greater, const SortBy::t & sortFn);
 
     enum GuiState_t {NoState, MultiRowsSelectionState};
 
@@ -100,7 +82,7 @@ private:
     bool mCopyMenuDebugOnly;
     bool mIsColumnSortingAllowed;
 
-    QList<QList<QString>> mData;
+    TableRows::Columns mData; //one contiguous vector of cells per column
     QList<QString> mCopyTitles;
     QPair<int, bool> mSort;
 };
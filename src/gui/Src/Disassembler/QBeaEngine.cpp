@@ -3,6 +3,10 @@
 #include "EncodeMap.h"
 #include "CodeFolding.h"
 
+static const int MaxCachedInstructions = 0x4000;
+
+InstructionTokenCache<Instruction_t> QBeaEngine::instructionCache(MaxCachedInstructions);
+
 QBeaEngine::QBeaEngine(int maxModuleSize)
     : _tokenizer(maxModuleSize), mCodeFoldingManager(nullptr)
 {
@@ -188,47 +192,75 @@ Instruction_t QBeaEngine::DisassembleAt(byte_t* data, duint size, duint origBase
 
     if(type != enc_unknown && type != enc_code && type != enc_middle)
         return DecodeDataAt(data, size, origBase, origInstRVA, type);
-    //tokenize
-    CapstoneTokenizer::InstructionToken cap;
-    _tokenizer.Tokenize(origBase + origInstRVA, data, size, cap);
-    int len = _tokenizer.Size();
-
-    const auto & cp = _tokenizer.GetCapstone();
-    bool success = cp.Success();
-
 
-    auto branchType = Instruction_t::None;
+    //labels and modules are part of the tokens
+    duint generation = DbgFunctions()->SymbolStateGetGeneration();
+    duint addr = origBase + origInstRVA;
+    int config = _tokenizer.ConfigKey();
     Instruction_t wInst;
-    if(success && (cp.InGroup(CS_GRP_JUMP) || cp.IsLoop() || cp.InGroup(CS_GRP_CALL) || cp.InGroup(CS_GRP_RET)))
+    InstructionTokenCache<Instruction_t>::Entry cached;
+    if(instructionCache.find(generation, addr, config, data, size, cached))
     {
-        wInst.branchDestination = DbgGetBranchDestination(origBase + origInstRVA);
-        switch(cp.GetId())
+        wInst = cached.instruction;
+        if(!cached.fixedBranchDestination)
+            wInst.branchDestination = DbgGetBranchDestination(addr);
+    }
+    else
+    {
+        //tokenize
+        CapstoneTokenizer::InstructionToken cap;
+        _tokenizer.Tokenize(addr, data, size, cap);
+        int len = _tokenizer.Size();
+
+        const auto & cp = _tokenizer.GetCapstone();
+        bool success = cp.Success();
+
+
+        auto branchType = Instruction_t::None;
+        bool fixedBranchDestination = true;
+        if(success && (cp.InGroup(CS_GRP_JUMP) || cp.IsLoop() || cp.InGroup(CS_GRP_CALL) || cp.InGroup(CS_GRP_RET)))
         {
-        case X86_INS_JMP:
-        case X86_INS_LJMP:
-            branchType = Instruction_t::Unconditional;
-            break;
-        case X86_INS_CALL:
-        case X86_INS_LCALL:
-            branchType = Instruction_t::Call;
-            break;
-        default:
-            branchType = cp.InGroup(CS_GRP_RET) ? Instruction_t::None : Instruction_t::Conditional;
-            break;
+            wInst.branchDestination = DbgGetBranchDestination(addr);
+            fixedBranchDestination = cp.OpCount() && cp[0].type == X86_OP_IMM;
+            switch(cp.GetId())
+            {
+            case X86_INS_JMP:
+            case X86_INS_LJMP:
+                branchType = Instruction_t::Unconditional;
+                break;
+            case X86_INS_CALL:
+            case X86_INS_LCALL:
+                branchType = Instruction_t::Call;
+                break;
+            default:
+                branchType = cp.InGroup(CS_GRP_RET) ? Instruction_t::None : Instruction_t::Conditional;
+                break;
+            }
+        }
+        else
+            wInst.branchDestination = 0;
+
+        wInst.instStr = QString(cp.InstructionText().c_str());
+        wInst.dump = QByteArray((const char*)data, len);
+        wInst.branchType = branchType;
+        wInst.tokens = cap;
+
+        //invalid instructions depend on the available size
+        if(success)
+        {
+            cached.instruction = wInst;
+            cached.config = config;
+            cached.fixedBranchDestination = fixedBranchDestination;
+            instructionCache.insert(generation, addr, cached);
         }
     }
-    else
-        wInst.branchDestination = 0;
 
-    wInst.instStr = QString(cp.InstructionText().c_str());
-    wInst.dump = QByteArray((const char*)data, len);
+    int len = wInst.dump.size();
     wInst.rva = origInstRVA;
     if(mCodeFoldingManager && mCodeFoldingManager->isFolded(origInstRVA))
         wInst.length = mCodeFoldingManager->getFoldEnd(origInstRVA + origBase) - (origInstRVA + origBase) + 1;
     else
         wInst.length = len;
-    wInst.branchType = branchType;
-    wInst.tokens = cap;
 
     return wInst;
 }
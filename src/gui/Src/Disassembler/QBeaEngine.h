@@ -3,6 +3,7 @@
 
 #include <QString>
 #include "capstone_gui.h"
+#include "InstructionTokenCache.h"
 
 class EncodeMap;
 class CodeFoldingHelper;
@@ -47,6 +48,16 @@ public:
     void setCodeFoldingManager(CodeFoldingHelper* CodeFoldingManager);
     void UpdateConfig();
 
+    static unsigned long long InstructionCacheHits()
+    {
+        return instructionCache.hits();
+    }
+
+    static unsigned long long InstructionCacheMisses()
+    {
+        return instructionCache.misses();
+    }
+
     EncodeMap* getEncodeMap()
     {
         return mEncodeMap;
@@ -60,6 +71,8 @@ private:
         QString cName;
     };
 
+    static InstructionTokenCache<Instruction_t> instructionCache;
+
     void UpdateDataInstructionMap();
     CapstoneTokenizer _tokenizer;
     QHash<ENCODETYPE, DataInstructionInfo> dataInstMap;
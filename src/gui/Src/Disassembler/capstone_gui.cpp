@@ -174,6 +174,12 @@ void CapstoneTokenizer::SetConfig(bool bUppercase, bool bTabbedMnemonic, bool bA
     _bMemorySpaces = bMemorySpaces;
 }
 
+// Different keys for every configuration that changes the tokens
+int CapstoneTokenizer::ConfigKey() const
+{
+    return _maxModuleLength * 16 + (_bUppercase ? 1 : 0) + (_bTabbedMnemonic ? 2 : 0) + (_bArgumentSpaces ? 4 : 0) + (_bMemorySpaces ? 8 : 0);
+}
+
 int CapstoneTokenizer::Size() const
 {
     return _success ? _cp.Size() : 1;
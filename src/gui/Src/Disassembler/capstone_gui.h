@@ -148,6 +148,7 @@ public:
     bool TokenizeData(const QString & datatype, const QString & data, InstructionToken & instruction);
     void UpdateConfig();
     void SetConfig(bool bUppercase, bool bTabbedMnemonic, bool bArgumentSpaces, bool bMemorySpaces);
+    int ConfigKey() const;
     int Size() const;
     const Capstone & GetCapstone() const;
 
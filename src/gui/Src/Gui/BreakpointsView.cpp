@@ -7,7 +7,10 @@
 #include "StdTable.h"
 #include "LabeledSplitter.h"
 
-BreakpointsView::BreakpointsView(QWidget* parent) : QWidget(parent)
+BreakpointsView::BreakpointsView(QWidget* parent)
+    : QWidget(parent),
+      mBpSequence(duint(-1)),
+      mLabelGeneration(duint(-1))
 {
     // Software
     mSoftBPTable = new StdTable(this);
@@ -127,179 +130,182 @@ BreakpointsView::BreakpointsView(QWidget* parent) : QWidget(parent)
 
 void BreakpointsView::reloadData()
 {
-    BPMAP wBPList;
-    int wI;
-
-    // Hardware
-    DbgGetBpList(bp_hardware, &wBPList);
-    mHardBPTable->setRowCount(wBPList.count);
-    for(wI = 0; wI < wBPList.count; wI++)
+    // The module/label column only changes with the modules (memory map), the labels and the loaded symbols
+    duint labelGeneration = DbgFunctions()->SymbolStateGetGeneration();
+    if(labelGeneration != mLabelGeneration)
     {
-        QString addr_text = QString("%1").arg(wBPList.bp[wI].addr, sizeof(dsint) * 2, 16, QChar('0')).toUpper();
-        mHardBPTable->setCellContent(wI, 0, addr_text);
-        mHardBPTable->setCellContent(wI, 1, QString(wBPList.bp[wI].name));
-
-        QString label_text;
-        char label[MAX_LABEL_SIZE] = "";
-        if(DbgGetLabelAt(wBPList.bp[wI].addr, SEG_DEFAULT, label))
-            label_text = "<" + QString(wBPList.bp[wI].mod) + "." + QString(label) + ">";
-        else
-            label_text = QString(wBPList.bp[wI].mod);
-        mHardBPTable->setCellContent(wI, 2, label_text);
-
-        if(wBPList.bp[wI].active == false)
-            mHardBPTable->setCellContent(wI, 3, tr("Inactive"));
-        else if(wBPList.bp[wI].enabled == true)
-            mHardBPTable->setCellContent(wI, 3, tr("Enabled"));
-        else
-            mHardBPTable->setCellContent(wI, 3, tr("Disabled"));
-
-        mHardBPTable->setCellContent(wI, 4, QString("%1").arg(wBPList.bp[wI].hitCount));
-        mHardBPTable->setCellContent(wI, 5, QString::fromUtf8(wBPList.bp[wI].logText));
-        mHardBPTable->setCellContent(wI, 6, QString::fromUtf8(wBPList.bp[wI].breakCondition));
-        mHardBPTable->setCellContent(wI, 7, wBPList.bp[wI].fastResume ? "X" : "");
-        mHardBPTable->setCellContent(wI, 8, QString::fromUtf8(wBPList.bp[wI].commandText));
-
-        QString comment;
-        if(GetCommentFormat(wBPList.bp[wI].addr, comment))
-            mHardBPTable->setCellContent(wI, 9, comment);
-        else
-            mHardBPTable->setCellContent(wI, 9, "");
-
+        mLabelGeneration = labelGeneration;
+        mLabelCache.clear();
+        mBpSequence = duint(-1); // the addresses and labels of every row can be different
     }
-    mHardBPTable->reloadData();
-    if(wBPList.count)
-        BridgeFree(wBPList.bp);
 
-    // Software
-    DbgGetBpList(bp_normal, &wBPList);
-    mSoftBPTable->setRowCount(wBPList.count);
-    for(wI = 0; wI < wBPList.count; wI++)
+    // Only the breakpoints that changed since the last update are written, the tables are filled again when
+    // the changes are not known (first update, breakpoints cleared or loaded, too many changes in between)
+    BridgeList<BPCHANGE> changes;
+    if(DbgFunctions()->BpGetChanges(&mBpSequence, &changes))
     {
-        QString addr_text = QString("%1").arg(wBPList.bp[wI].addr, sizeof(dsint) * 2, 16, QChar('0')).toUpper();
-        mSoftBPTable->setCellContent(wI, 0, addr_text);
-        mSoftBPTable->setCellContent(wI, 1, QString(wBPList.bp[wI].name));
-
-        QString label_text;
-        char label[MAX_LABEL_SIZE] = "";
-        if(DbgGetLabelAt(wBPList.bp[wI].addr, SEG_DEFAULT, label))
-            label_text = "<" + QString(wBPList.bp[wI].mod) + "." + QString(label) + ">";
-        else
-            label_text = QString(wBPList.bp[wI].mod);
-        mSoftBPTable->setCellContent(wI, 2, label_text);
+        for(int i = 0; i < changes.Count(); i++)
+            applyBpChange(changes[i]);
+    }
+    else
+    {
+        setBpRows(mHardBPTable, bp_hardware);
+        setBpRows(mSoftBPTable, bp_normal);
+        setBpRows(mMemBPTable, bp_memory);
+        setBpRows(mDLLBPTable, bp_dll);
+        setBpRows(mExceptionBPTable, bp_exception);
+    }
 
-        if(wBPList.bp[wI].active == false)
-            mSoftBPTable->setCellContent(wI, 3, tr("Inactive"));
-        else if(wBPList.bp[wI].enabled == true)
-            mSoftBPTable->setCellContent(wI, 3, tr("Enabled"));
-        else
-            mSoftBPTable->setCellContent(wI, 3, tr("Disabled"));
+    // Comments are not cached, they can be format strings that depend on the registers
+    updateComments(mHardBPTable);
+    updateComments(mSoftBPTable);
+    updateComments(mMemBPTable);
 
-        mSoftBPTable->setCellContent(wI, 4, QString("%1").arg(wBPList.bp[wI].hitCount));
-        mSoftBPTable->setCellContent(wI, 5, QString::fromUtf8(wBPList.bp[wI].logText));
-        mSoftBPTable->setCellContent(wI, 6, QString::fromUtf8(wBPList.bp[wI].breakCondition));
-        mSoftBPTable->setCellContent(wI, 7, wBPList.bp[wI].fastResume ? "X" : "");
-        mSoftBPTable->setCellContent(wI, 8, QString::fromUtf8(wBPList.bp[wI].commandText));
+    mHardBPTable->reloadData();
+    mSoftBPTable->reloadData();
+    mMemBPTable->reloadData();
+    mDLLBPTable->reloadData();
+    mExceptionBPTable->reloadData();
+}
 
-        QString comment;
-        if(GetCommentFormat(wBPList.bp[wI].addr, comment))
-            mSoftBPTable->setCellContent(wI, 9, comment);
-        else
-            mSoftBPTable->setCellContent(wI, 9, "");
+StdTable* BreakpointsView::bpTable(BPXTYPE type)
+{
+    switch(type)
+    {
+    case bp_hardware:
+        return mHardBPTable;
+    case bp_normal:
+        return mSoftBPTable;
+    case bp_memory:
+        return mMemBPTable;
+    case bp_dll:
+        return mDLLBPTable;
+    case bp_exception:
+        return mExceptionBPTable;
+    default:
+        return nullptr;
     }
-    mSoftBPTable->reloadData();
+}
+
+void BreakpointsView::setBpRows(StdTable* table, BPXTYPE type)
+{
+    BPMAP wBPList;
+    DbgGetBpList(type, &wBPList);
+    table->setRowCount(wBPList.count);
+    for(int wI = 0; wI < wBPList.count; wI++)
+        setBpRow(table, wI, wBPList.bp[wI]);
     if(wBPList.count)
         BridgeFree(wBPList.bp);
+}
 
-    // Memory
-    DbgGetBpList(bp_memory, &wBPList);
-    mMemBPTable->setRowCount(wBPList.count);
-    for(wI = 0; wI < wBPList.count; wI++)
+// The rows can be sorted by the table, so the row is found by its address (or module for DLL breakpoints)
+void BreakpointsView::applyBpChange(const BPCHANGE & change)
+{
+    const BRIDGEBP & bp = change.bp;
+    StdTable* table = bpTable(bp.type);
+    if(!table)
+        return;
+    int keyColumn = bp.type == bp_dll ? 1 : 0;
+    QString key = bp.type == bp_dll ? QString(bp.mod) : ToPtrString(bp.addr);
+    int rowCount = int(table->getRowCount());
+    int row = 0;
+    while(row < rowCount && table->getCellContent(row, keyColumn) != key)
+        row++;
+
+    if(change.kind == BpChangeRemoved)
     {
-        QString addr_text = QString("%1").arg(wBPList.bp[wI].addr, sizeof(dsint) * 2, 16, QChar('0')).toUpper();
-        mMemBPTable->setCellContent(wI, 0, addr_text);
-        mMemBPTable->setCellContent(wI, 1, QString(wBPList.bp[wI].name));
-
-        QString label_text;
-        char label[MAX_LABEL_SIZE] = "";
-        if(DbgGetLabelAt(wBPList.bp[wI].addr, SEG_DEFAULT, label))
-            label_text = "<" + QString(wBPList.bp[wI].mod) + "." + QString(label) + ">";
-        else
-            label_text = QString(wBPList.bp[wI].mod);
-        mMemBPTable->setCellContent(wI, 2, label_text);
-
-        if(wBPList.bp[wI].active == false)
-            mMemBPTable->setCellContent(wI, 3, tr("Inactive"));
-        else if(wBPList.bp[wI].enabled == true)
-            mMemBPTable->setCellContent(wI, 3, tr("Enabled"));
-        else
-            mMemBPTable->setCellContent(wI, 3, tr("Disabled"));
-
-        mMemBPTable->setCellContent(wI, 4, QString("%1").arg(wBPList.bp[wI].hitCount));
-        mMemBPTable->setCellContent(wI, 5, QString::fromUtf8(wBPList.bp[wI].logText));
-        mMemBPTable->setCellContent(wI, 6, QString::fromUtf8(wBPList.bp[wI].breakCondition));
-        mMemBPTable->setCellContent(wI, 7, wBPList.bp[wI].fastResume ? "X" : "");
-        mMemBPTable->setCellContent(wI, 8, QString::fromUtf8(wBPList.bp[wI].commandText));
-
-        QString comment;
-        if(GetCommentFormat(wBPList.bp[wI].addr, comment))
-            mMemBPTable->setCellContent(wI, 9, comment);
-        else
-            mMemBPTable->setCellContent(wI, 9, "");
+        if(row == rowCount)
+            return;
+        // Move the last row in its place, the table is sorted again when it reloads
+        for(int col = 0; col < table->getColumnCount(); col++)
+            table->setCellContent(row, col, table->getCellContent(rowCount - 1, col));
+        table->setRowCount(rowCount - 1);
+        return;
     }
-    mMemBPTable->reloadData();
+    if(row == rowCount)
+        table->setRowCount(rowCount + 1);
+    setBpRow(table, row, bp);
+}
 
-    // DLL
-    DbgGetBpList(bp_dll, &wBPList);
-    mDLLBPTable->setRowCount(wBPList.count);
-    for(wI = 0; wI < wBPList.count; wI++)
+void BreakpointsView::setBpRow(StdTable* table, int row, const BRIDGEBP & bp)
+{
+    QString state;
+    if(bp.active == false)
+        state = tr("Inactive");
+    else if(bp.enabled == true)
+        state = tr("Enabled");
+    else
+        state = tr("Disabled");
+
+    if(table == mDLLBPTable)
     {
-        mDLLBPTable->setCellContent(wI, 0, QString(wBPList.bp[wI].name));
-        mDLLBPTable->setCellContent(wI, 1, QString(wBPList.bp[wI].mod));
-
-        if(wBPList.bp[wI].active == false)
-            mDLLBPTable->setCellContent(wI, 2, tr("Inactive"));
-        else if(wBPList.bp[wI].enabled == true)
-            mDLLBPTable->setCellContent(wI, 2, tr("Enabled"));
+        table->setCellContent(row, 0, QString(bp.name));
+        table->setCellContent(row, 1, QString(bp.mod));
+        table->setCellContent(row, 2, state);
+        table->setCellContent(row, 3, QString("%1").arg(bp.hitCount));
+        table->setCellContent(row, 4, QString::fromUtf8(bp.logText));
+        table->setCellContent(row, 5, QString::fromUtf8(bp.breakCondition));
+        table->setCellContent(row, 6, bp.fastResume ? "X" : "");
+        table->setCellContent(row, 7, QString::fromUtf8(bp.commandText));
+    }
+    else if(table == mExceptionBPTable)
+    {
+        table->setCellContent(row, 0, ToPtrString(bp.addr));
+        table->setCellContent(row, 1, QString::fromUtf8(bp.name));
+        table->setCellContent(row, 2, state);
+        table->setCellContent(row, 3, QString("%1").arg(bp.hitCount));
+        table->setCellContent(row, 4, QString::fromUtf8(bp.logText));
+        table->setCellContent(row, 5, QString::fromUtf8(bp.breakCondition));
+        if(bp.slot == 1)
+            table->setCellContent(row, 6, tr("First-chance"));
+        else if(bp.slot == 2)
+            table->setCellContent(row, 6, tr("Second-chance"));
+        else if(bp.slot == 3)
+            table->setCellContent(row, 6, tr("All")); // both first-chance and second-chance
         else
-            mDLLBPTable->setCellContent(wI, 2, tr("Disabled"));
-
-        mDLLBPTable->setCellContent(wI, 3, QString("%1").arg(wBPList.bp[wI].hitCount));
-        mDLLBPTable->setCellContent(wI, 4, QString::fromUtf8(wBPList.bp[wI].logText));
-        mDLLBPTable->setCellContent(wI, 5, QString::fromUtf8(wBPList.bp[wI].breakCondition));
-        mDLLBPTable->setCellContent(wI, 6, wBPList.bp[wI].fastResume ? "X" : "");
-        mDLLBPTable->setCellContent(wI, 7, QString::fromUtf8(wBPList.bp[wI].commandText));
+            table->setCellContent(row, 6, "");
+        table->setCellContent(row, 7, QString::fromUtf8(bp.commandText));
     }
-    mDLLBPTable->reloadData();
+    else
+    {
+        table->setCellContent(row, 0, ToPtrString(bp.addr));
+        table->setCellContent(row, 1, QString(bp.name));
+        table->setCellContent(row, 2, getLabelText(bp.addr, bp.mod));
+        table->setCellContent(row, 3, state);
+        table->setCellContent(row, 4, QString("%1").arg(bp.hitCount));
+        table->setCellContent(row, 5, QString::fromUtf8(bp.logText));
+        table->setCellContent(row, 6, QString::fromUtf8(bp.breakCondition));
+        table->setCellContent(row, 7, bp.fastResume ? "X" : "");
+        table->setCellContent(row, 8, QString::fromUtf8(bp.commandText));
+    }
+}
 
-    // Exception
-    DbgGetBpList(bp_exception, &wBPList);
-    mExceptionBPTable->setRowCount(wBPList.count);
-    for(wI = 0; wI < wBPList.count; wI++)
+QString BreakpointsView::getLabelText(duint addr, const char* mod)
+{
+    auto found = mLabelCache.find(addr);
+    if(found != mLabelCache.end())
+        return found.value();
+    QString label_text;
+    char label[MAX_LABEL_SIZE] = "";
+    if(DbgGetLabelAt(addr, SEG_DEFAULT, label))
+        label_text = "<" + QString(mod) + "." + QString(label) + ">";
+    else
+        label_text = QString(mod);
+    mLabelCache.insert(addr, label_text);
+    return label_text;
+}
+
+// The rows can be sorted by the table, so the address is taken from the row itself
+void BreakpointsView::updateComments(StdTable* table)
+{
+    for(int wI = 0; wI < table->getRowCount(); wI++)
     {
-        mExceptionBPTable->setCellContent(wI, 0, ToPtrString(wBPList.bp[wI].addr));
-        mExceptionBPTable->setCellContent(wI, 1, QString::fromUtf8(wBPList.bp[wI].name));
-        if(wBPList.bp[wI].active == false)
-            mExceptionBPTable->setCellContent(wI, 2, tr("Inactive"));
-        else if(wBPList.bp[wI].enabled == true)
-            mExceptionBPTable->setCellContent(wI, 2, tr("Enabled"));
+        QString comment;
+        if(GetCommentFormat(table->getCellContent(wI, 0).toULongLong(0, 16), comment))
+            table->setCellContent(wI, 9, comment);
         else
-            mExceptionBPTable->setCellContent(wI, 2, tr("Disabled"));
-        mExceptionBPTable->setCellContent(wI, 3, QString("%1").arg(wBPList.bp[wI].hitCount));
-        mExceptionBPTable->setCellContent(wI, 4, QString::fromUtf8(wBPList.bp[wI].logText));
-        mExceptionBPTable->setCellContent(wI, 5, QString::fromUtf8(wBPList.bp[wI].breakCondition));
-        if(wBPList.bp[wI].slot == 1)
-            mExceptionBPTable->setCellContent(wI, 6, tr("First-chance"));
-        else if(wBPList.bp[wI].slot == 2)
-            mExceptionBPTable->setCellContent(wI, 6, tr("Second-chance"));
-        else if(wBPList.bp[wI].slot == 3)
-            mExceptionBPTable->setCellContent(wI, 6, tr("All")); // both first-chance and second-chance
-        mExceptionBPTable->setCellContent(wI, 7, QString::fromUtf8(wBPList.bp[wI].commandText));
+            table->setCellContent(wI, 9, "");
     }
-
-    if(wBPList.count)
-        BridgeFree(wBPList.bp);
-    mExceptionBPTable->reloadData();
 }
 
 void BreakpointsView::setupRightClickContextMenu()
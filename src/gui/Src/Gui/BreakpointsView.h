@@ -2,6 +2,7 @@
 #define BREAKPOINTSVIEW_H
 
 #include <QWidget>
+#include <QHash>
 #include "Imports.h"
 
 class StdTable;
@@ -84,6 +85,13 @@ public slots:
     void editBreakpointSlot();
 
 private:
+    StdTable* bpTable(BPXTYPE type);
+    void setBpRows(StdTable* table, BPXTYPE type);
+    void applyBpChange(const BPCHANGE & change);
+    void setBpRow(StdTable* table, int row, const BRIDGEBP & bp);
+    QString getLabelText(duint addr, const char* mod);
+    void updateComments(StdTable* table);
+
     QVBoxLayout* mVertLayout;
     LabeledSplitter* mSplitter;
     StdTable* mHardBPTable;
@@ -91,6 +99,9 @@ private:
     StdTable* mMemBPTable;
     StdTable* mDLLBPTable;
     StdTable* mExceptionBPTable;
+    duint mBpSequence;
+    duint mLabelGeneration;
+    QHash<duint, QString> mLabelCache;
     // Conditional BP Context Menu
     BPXTYPE mCurrentType;
     QAction* mEditBreakpointAction;
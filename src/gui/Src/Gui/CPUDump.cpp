@@ -5,6 +5,7 @@
 #include <QToolTip>
 #include "Configuration.h"
 #include "Bridge.h"
+#include "AnnotationCache.h"
 #include "LineEditDialog.h"
 #include "HexEditDialog.h"
 #include "YaraRuleSelectionDialog.h"
@@ -268,15 +269,11 @@ void CPUDump::getColumnRichText(int col, dsint rva, RichTextPainter::List & rich
         duint data = 0;
         mMemPage->read((byte_t*)&data, rva, sizeof(duint));
 
-        char modname[MAX_MODULE_SIZE] = "";
-        if(!DbgGetModuleAt(data, modname))
-            modname[0] = '\0';
-        char label_text[MAX_LABEL_SIZE] = "";
-        if(DbgGetLabelAt(data, SEG_DEFAULT, label_text))
-            curData.text = QString(modname) + "." + QString(label_text);
-        char string_text[MAX_STRING_SIZE] = "";
-        if(DbgGetStringAt(data, string_text))
-            curData.text = string_text;
+        Annotation annotation = AnnotationCache::instance().get(data);
+        if(annotation.hasLabel)
+            curData.text = annotation.module + "." + annotation.label;
+        if(annotation.hasString)
+            curData.text = annotation.string;
         if(!curData.text.length()) //stack comments
         {
             auto va = rvaToVa(rva);
@@ -1,6 +1,7 @@
 #include "CPUInfoBox.h"
 #include "Configuration.h"
 #include "Bridge.h"
+#include "AnnotationCache.h"
 
 CPUInfoBox::CPUInfoBox(StdTable* parent) : StdTable(parent)
 {
@@ -23,12 +24,30 @@ CPUInfoBox::CPUInfoBox(StdTable* parent) : StdTable(parent)
     connect(this, SIGNAL(doubleClickedSignal()), this, SLOT(doubleClickedSlot()));
     curAddr = 0;
 
+    // The info is computed on a worker, the results of the last selections are kept for back and forth navigation
+    mInfoCache.setMaxCost(256);
+    mInfoGeneration = 0;
+    mRequestSequence = 0;
+    AnnotationCache::instance(); //the worker reads its labels, it has to be created on the GUI thread
+    mInfoThread = new CPUInfoBoxThread(this);
+    connect(mInfoThread, SIGNAL(infoReady()), this, SLOT(infoReadySlot()), Qt::QueuedConnection);
+    connect(Bridge::getBridge(), SIGNAL(updateRegisters()), this, SLOT(invalidateInfo()));
+    connect(Bridge::getBridge(), SIGNAL(updateDump()), this, SLOT(invalidateInfo()));
+    connect(Config(), SIGNAL(tokenizerConfigUpdated()), this, SLOT(invalidateInfo()));
+    mInfoThread->start();
+
     // Deselect any row (visual reasons only)
     setSingleSelection(-1);
 
     setupContextMenu();
 }
 
+CPUInfoBox::~CPUInfoBox()
+{
+    mInfoThread->stop();
+    mInfoThread->wait();
+}
+
 void CPUInfoBox::setupContextMenu()
 {
     mCopyAddressAction = makeAction(tr("Address"), SLOT(copyAddress()));
@@ -66,41 +85,19 @@ void CPUInfoBox::clear()
     setInfoLine(2, "");
 }
 
-QString CPUInfoBox::getSymbolicName(dsint addr)
+duint CPUInfoBox::getInfoGeneration()
 {
-    char labelText[MAX_LABEL_SIZE] = "";
-    char moduleText[MAX_MODULE_SIZE] = "";
-    char string[MAX_STRING_SIZE] = "";
-    bool bHasString = DbgGetStringAt(addr, string);
-    bool bHasLabel = DbgGetLabelAt(addr, SEG_DEFAULT, labelText);
-    bool bHasModule = (DbgGetModuleAt(addr, moduleText) && !QString(labelText).startsWith("JMP.&"));
-    QString addrText = ToHexString(addr);
-    QString finalText;
-    if(bHasString)
-        finalText = addrText + " " + QString(string);
-    else if(bHasLabel && bHasModule) //<module.label>
-        finalText = QString("<%1.%2>").arg(moduleText).arg(labelText);
-    else if(bHasModule) //module.addr
-        finalText = QString("%1.%2").arg(moduleText).arg(addrText);
-    else if(bHasLabel) //<label>
-        finalText = QString("<%1>").arg(labelText);
-    else
-    {
-        finalText = addrText;
-        if(addr == (addr & 0xFF))
-        {
-            QChar c = QChar::fromLatin1((char)addr);
-            if(c.isPrint())
-                finalText += QString(" '%1'").arg((char)addr);
-        }
-        else if(addr == (addr & 0xFFF)) //UNICODE?
-        {
-            QChar c = QChar((ushort)addr);
-            if(c.isPrint())
-                finalText += " L'" + QString(c) + "'";
-        }
-    }
-    return finalText;
+    // Labels and the memory map can change without a view update
+    return mRequestSequence + AnnotationCache::instance().generation();
+}
+
+void CPUInfoBox::setInfo(const CPUInfoBoxInfo & info)
+{
+    curRva = info.rva;
+    curOffset = info.offset;
+    for(int i = 0; i < 3; i++)
+        setCellContent(i, 0, info.lines[i]);
+    reloadData();
 }
 
 void CPUInfoBox::disasmSelectionChanged(dsint parVA)
@@ -109,151 +106,55 @@ void CPUInfoBox::disasmSelectionChanged(dsint parVA)
     curRva = -1;
     curOffset = -1;
 
-    if(!DbgIsDebugging() || !DbgMemIsValidReadPtr(parVA))
+    if(!DbgIsDebugging())
         return;
 
-    // Rather than using clear() or setInfoLine(), only reset the first two cells to reduce flicker
-    setCellContent(0, 0, "");
-    setCellContent(1, 0, "");
-
-    DISASM_INSTR instr;
-    memset(&instr, 0, sizeof(instr));
-    DbgDisasmAt(parVA, &instr);
-    BASIC_INSTRUCTION_INFO basicinfo;
-    memset(&basicinfo, 0, sizeof(basicinfo));
-    DbgDisasmFastAt(parVA, &basicinfo);
-
-    int start = 0;
-    if(basicinfo.branch && !basicinfo.call && (!ConfigBool("Disassembler", "OnlyCipAutoComments") || parVA == DbgValFromString("cip"))) //jump
+    duint generation = getInfoGeneration();
+    if(generation != mInfoGeneration)
     {
-        bool taken = DbgIsJumpGoingToExecute(parVA);
-        if(taken)
-            setInfoLine(0, tr("Jump is taken"));
-        else
-            setInfoLine(0, tr("Jump is not taken"));
-        start = 1;
+        mInfoCache.clear();
+        mInfoGeneration = generation;
     }
 
-    bool bUpper = ConfigBool("Disassembler", "Uppercase");
-
-    for(int i = 0, j = start; i < instr.argcount && j < 2; i++)
+    CPUInfoBoxInfo* info = mInfoCache.object(parVA);
+    if(info)
     {
-        DISASM_ARG arg = instr.arg[i];
-        QString argMnemonic = QString(arg.mnemonic);
-        if(bUpper)
-            argMnemonic = argMnemonic.toUpper();
-        if(arg.type == arg_memory)
-        {
-            QString sizeName = "";
-            int memsize = basicinfo.memory.size;
-            switch(memsize)
-            {
-            case size_byte:
-                sizeName = "byte ";
-                break;
-            case size_word:
-                sizeName = "word ";
-                break;
-            case size_dword:
-                sizeName = "dword ";
-                break;
-            case size_qword:
-                sizeName = "qword ";
-                break;
-            }
-
-#ifdef _WIN64
-            if(arg.segment == SEG_GS)
-                sizeName += "gs:";
-#else //x32
-            if(arg.segment == SEG_FS)
-                sizeName += "fs:";
-#endif
-
-            if(bUpper)
-                sizeName = sizeName.toUpper();
-
-            if(!DbgMemIsValidReadPtr(arg.value))
-                setInfoLine(j, sizeName + "[" + argMnemonic + "]=???");
-            else
-            {
-                QString addrText;
-                if(memsize == sizeof(dsint))
-                    addrText = getSymbolicName(arg.memvalue);
-                else
-                    addrText = ToPtrString(arg.memvalue);
-                setInfoLine(j, sizeName + "[" + argMnemonic + "]=" + addrText);
-            }
-            j++;
-        }
-        else
-        {
-            auto symbolicName = getSymbolicName(arg.value);
-            QString mnemonic(arg.mnemonic);
-            bool ok;
-            mnemonic.toULongLong(&ok, 16);
-            if(ok) //skip certain numbers
-            {
-                if(ToHexString(arg.value) == symbolicName)
-                    continue;
-                setInfoLine(j, symbolicName);
-            }
-            else
-                setInfoLine(j, mnemonic + "=" + symbolicName);
-            j++;
-        }
+        setInfo(*info);
+        return;
     }
-    if(getInfoLine(0) == getInfoLine(1)) //check for duplicate info line
-        setInfoLine(1, "");
-
-    // Set last line
-    //
-    // Format: SECTION:VA MODULE:$RVA :#FILE_OFFSET FUNCTION
-    QString info;
-
-    // Section
-    char section[MAX_SECTION_SIZE * 5];
-    if(DbgFunctions()->SectionFromAddr(parVA, section))
-        info += QString(section) + ":";
 
-    // VA
-    info += ToPtrString(parVA) + " ";
-
-    // Module name, RVA, and file offset
-    char mod[MAX_MODULE_SIZE];
-    if(DbgFunctions()->ModNameFromAddr(parVA, mod, true))
-    {
-        dsint modbase = DbgFunctions()->ModBaseFromAddr(parVA);
-
-        // Append modname
-        info += mod;
-
-        // Module RVA
-        curRva = parVA - modbase;
-        if(modbase)
-            info += QString(":$%1 ").arg(curRva, 0, 16, QChar('0')).toUpper();
-
-        // File offset
-        curOffset = DbgFunctions()->VaToFileOffset(parVA);
-        info += QString("#%1 ").arg(curOffset, 0, 16, QChar('0')).toUpper();
-    }
+    // The previous lines stay until the worker delivers the new ones
+    CPUInfoBoxRequest request;
+    request.va = parVA;
+    request.generation = generation;
+    request.sequence = mRequestSequence;
+    request.upper = ConfigBool("Disassembler", "Uppercase");
+    request.onlyCipAutoComments = ConfigBool("Disassembler", "OnlyCipAutoComments");
+    mInfoThread->request(request);
+}
 
-    // Function/label name
-    char label[MAX_LABEL_SIZE];
-    if(DbgGetLabelAt(parVA, SEG_DEFAULT, label))
-        info += QString("<%1>").arg(label);
-    else
-    {
-        duint start;
-        if(DbgFunctionGet(parVA, &start, nullptr) && DbgGetLabelAt(start, SEG_DEFAULT, label) && start != parVA)
-            info += QString("<%1+%2>").arg(label).arg(ToHexString(parVA - start));
-    }
+void CPUInfoBox::infoReadySlot()
+{
+    CPUInfoBoxInfo info;
+    // A result requested before the last invalidation is stale, even if the generation did not change since
+    if(!mInfoThread->takeInfo(info) || info.sequence != mRequestSequence || info.generation != mInfoGeneration)
+        return;
+    mInfoCache.insert(info.va, new CPUInfoBoxInfo(info));
+    if(info.va == curAddr)
+        setInfo(info);
+}
 
-    setInfoLine(2, info);
+void CPUInfoBox::invalidateInfo()
+{
+    // Values and jump states depend on the registers and memory, recompute the current selection
+    mRequestSequence++;
+    mInfoCache.clear();
+    disasmSelectionChanged(curAddr);
 }
 
 void CPUInfoBox::dbgStateChanged(DBGSTATE state)
 {
+    invalidateInfo();
     if(state == stopped)
         clear();
 }
@@ -1,13 +1,16 @@
 #ifndef INFOBOX_H
 #define INFOBOX_H
 
+#include <QCache>
 #include "StdTable.h"
+#include "CPUInfoBoxThread.h"
 
 class CPUInfoBox : public StdTable
 {
     Q_OBJECT
 public:
     explicit CPUInfoBox(StdTable* parent = 0);
+    ~CPUInfoBox();
     int getHeight();
     void addFollowMenuItem(QMenu* menu, QString name, dsint value);
     void setupFollowMenu(QMenu* menu, dsint wVA);
@@ -22,12 +25,19 @@ public slots:
     void copyRva();
     void copyOffset();
     void doubleClickedSlot();
+    void infoReadySlot();
+    void invalidateInfo();
 
 private:
     dsint curAddr;
     dsint curRva;
     dsint curOffset;
-    QString getSymbolicName(dsint addr);
+    CPUInfoBoxThread* mInfoThread;
+    QCache<dsint, CPUInfoBoxInfo> mInfoCache; //recently selected addresses
+    duint mInfoGeneration;
+    duint mRequestSequence; //advanced by every invalidation, even when not debugging
+    duint getInfoGeneration();
+    void setInfo(const CPUInfoBoxInfo & info);
     void setInfoLine(int line, QString text);
     QString getInfoLine(int line);
     void clear();
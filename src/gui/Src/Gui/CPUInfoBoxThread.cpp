@@ -0,0 +1,265 @@
+#include "CPUInfoBoxThread.h"
+#include "CPUInfoBox.h"
+#include "StringUtil.h"
+#include "AnnotationCache.h"
+
+CPUInfoBoxThread::CPUInfoBoxThread(QObject* parent) : QThread(parent), mHasRequest(false), mHasInfo(false), mStop(false)
+{
+}
+
+void CPUInfoBoxThread::request(const CPUInfoBoxRequest & request)
+{
+    QMutexLocker locker(&mLock);
+    mRequest = request; //replaces the request that was not started yet
+    mHasRequest = true;
+    mWake.wakeOne();
+}
+
+bool CPUInfoBoxThread::takeInfo(CPUInfoBoxInfo & info)
+{
+    QMutexLocker locker(&mLock);
+    if(!mHasInfo)
+        return false;
+    info = mInfo;
+    mHasInfo = false;
+    return true;
+}
+
+void CPUInfoBoxThread::stop()
+{
+    QMutexLocker locker(&mLock);
+    mStop = true;
+    mWake.wakeOne();
+}
+
+bool CPUInfoBoxThread::isStale()
+{
+    QMutexLocker locker(&mLock);
+    return mHasRequest || mStop;
+}
+
+void CPUInfoBoxThread::run()
+{
+    while(true)
+    {
+        mLock.lock();
+        while(!mHasRequest && !mStop)
+            mWake.wait(&mLock);
+        if(mStop)
+        {
+            mLock.unlock();
+            break;
+        }
+        CPUInfoBoxRequest request = mRequest;
+        mHasRequest = false;
+        mLock.unlock();
+
+        CPUInfoBoxInfo info;
+        if(!getInfo(request, info))
+            continue;
+
+        // Drop the result if the selection changed while it was computed
+        mLock.lock();
+        bool ready = !mHasRequest && !mStop;
+        if(ready)
+        {
+            mInfo = info;
+            mHasInfo = true;
+        }
+        mLock.unlock();
+        if(ready)
+            emit infoReady();
+    }
+}
+
+// The labels and modules come from the shared cache, the strings of the annotation cache are GUI thread only
+QString CPUInfoBoxThread::getSymbolicName(dsint addr)
+{
+    Annotation annotation = AnnotationCache::instance().getSymbol(addr);
+    char string[MAX_STRING_SIZE] = "";
+    bool bHasString = DbgGetStringAt(addr, string);
+    bool bHasLabel = annotation.hasLabel;
+    bool bHasModule = (annotation.hasModule && !annotation.label.startsWith("JMP.&"));
+    QString addrText = ToHexString(addr);
+    QString finalText;
+    if(bHasString)
+        finalText = addrText + " " + QString(string);
+    else if(bHasLabel && bHasModule) //<module.label>
+        finalText = QString("<%1.%2>").arg(annotation.module).arg(annotation.label);
+    else if(bHasModule) //module.addr
+        finalText = QString("%1.%2").arg(annotation.module).arg(addrText);
+    else if(bHasLabel) //<label>
+        finalText = QString("<%1>").arg(annotation.label);
+    else
+    {
+        finalText = addrText;
+        if(addr == (addr & 0xFF))
+        {
+            QChar c = QChar::fromLatin1((char)addr);
+            if(c.isPrint())
+                finalText += QString(" '%1'").arg((char)addr);
+        }
+        else if(addr == (addr & 0xFFF)) //UNICODE?
+        {
+            QChar c = QChar((ushort)addr);
+            if(c.isPrint())
+                finalText += " L'" + QString(c) + "'";
+        }
+    }
+    return finalText;
+}
+
+// Returns false when the address has no info or a newer request arrived
+bool CPUInfoBoxThread::getInfo(const CPUInfoBoxRequest & request, CPUInfoBoxInfo & info)
+{
+    dsint parVA = request.va;
+    info.va = parVA;
+    info.generation = request.generation;
+    info.sequence = request.sequence;
+    info.rva = -1;
+    info.offset = -1;
+
+    if(!DbgIsDebugging() || !DbgMemIsValidReadPtr(parVA))
+        return false;
+
+    DISASM_INSTR instr;
+    memset(&instr, 0, sizeof(instr));
+    DbgDisasmAt(parVA, &instr);
+    BASIC_INSTRUCTION_INFO basicinfo;
+    memset(&basicinfo, 0, sizeof(basicinfo));
+    DbgDisasmFastAt(parVA, &basicinfo);
+
+    int start = 0;
+    if(basicinfo.branch && !basicinfo.call && (!request.onlyCipAutoComments || parVA == DbgValFromString("cip"))) //jump
+    {
+        bool taken = DbgIsJumpGoingToExecute(parVA);
+        if(taken)
+            info.lines[0] = CPUInfoBox::tr("Jump is taken");
+        else
+            info.lines[0] = CPUInfoBox::tr("Jump is not taken");
+        start = 1;
+    }
+
+    bool bUpper = request.upper;
+
+    for(int i = 0, j = start; i < instr.argcount && j < 2; i++)
+    {
+        if(isStale())
+            return false;
+
+        DISASM_ARG arg = instr.arg[i];
+        QString argMnemonic = QString(arg.mnemonic);
+        if(bUpper)
+            argMnemonic = argMnemonic.toUpper();
+        if(arg.type == arg_memory)
+        {
+            QString sizeName = "";
+            int memsize = basicinfo.memory.size;
+            switch(memsize)
+            {
+            case size_byte:
+                sizeName = "byte ";
+                break;
+            case size_word:
+                sizeName = "word ";
+                break;
+            case size_dword:
+                sizeName = "dword ";
+                break;
+            case size_qword:
+                sizeName = "qword ";
+                break;
+            }
+
+#ifdef _WIN64
+            if(arg.segment == SEG_GS)
+                sizeName += "gs:";
+#else //x32
+            if(arg.segment == SEG_FS)
+                sizeName += "fs:";
+#endif
+
+            if(bUpper)
+                sizeName = sizeName.toUpper();
+
+            if(!DbgMemIsValidReadPtr(arg.value))
+                info.lines[j] = sizeName + "[" + argMnemonic + "]=???";
+            else
+            {
+                QString addrText;
+                if(memsize == sizeof(dsint))
+                    addrText = getSymbolicName(arg.memvalue);
+                else
+                    addrText = ToPtrString(arg.memvalue);
+                info.lines[j] = sizeName + "[" + argMnemonic + "]=" + addrText;
+            }
+            j++;
+        }
+        else
+        {
+            auto symbolicName = getSymbolicName(arg.value);
+            QString mnemonic(arg.mnemonic);
+            bool ok;
+            mnemonic.toULongLong(&ok, 16);
+            if(ok) //skip certain numbers
+            {
+                if(ToHexString(arg.value) == symbolicName)
+                    continue;
+                info.lines[j] = symbolicName;
+            }
+            else
+                info.lines[j] = mnemonic + "=" + symbolicName;
+            j++;
+        }
+    }
+    if(info.lines[0] == info.lines[1]) //check for duplicate info line
+        info.lines[1] = "";
+
+    if(isStale())
+        return false;
+
+    // Set last line
+    //
+    // Format: SECTION:VA MODULE:$RVA :#FILE_OFFSET FUNCTION
+    QString & line = info.lines[2];
+
+    // Section
+    char section[MAX_SECTION_SIZE * 5];
+    if(DbgFunctions()->SectionFromAddr(parVA, section))
+        line += QString(section) + ":";
+
+    // VA
+    line += ToPtrString(parVA) + " ";
+
+    // Module name, RVA, and file offset
+    char mod[MAX_MODULE_SIZE];
+    if(DbgFunctions()->ModNameFromAddr(parVA, mod, true))
+    {
+        dsint modbase = DbgFunctions()->ModBaseFromAddr(parVA);
+
+        // Append modname
+        line += mod;
+
+        // Module RVA
+        info.rva = parVA - modbase;
+        if(modbase)
+            line += QString(":$%1 ").arg(info.rva, 0, 16, QChar('0')).toUpper();
+
+        // File offset
+        info.offset = DbgFunctions()->VaToFileOffset(parVA);
+        line += QString("#%1 ").arg(info.offset, 0, 16, QChar('0')).toUpper();
+    }
+
+    // Function/label name
+    char label[MAX_LABEL_SIZE];
+    if(DbgGetLabelAt(parVA, SEG_DEFAULT, label))
+        line += QString("<%1>").arg(label);
+    else
+    {
+        duint start;
+        if(DbgFunctionGet(parVA, &start, nullptr) && DbgGetLabelAt(start, SEG_DEFAULT, label) && start != parVA)
+            line += QString("<%1+%2>").arg(label).arg(ToHexString(parVA - start));
+    }
+
+    return true;
+}
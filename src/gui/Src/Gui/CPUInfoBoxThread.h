@@ -0,0 +1,56 @@
+#ifndef CPUINFOBOXTHREAD_H
+#define CPUINFOBOXTHREAD_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include "Imports.h"
+
+struct CPUInfoBoxRequest
+{
+    dsint va;
+    duint generation;
+    duint sequence; //CPUInfoBox::mRequestSequence when the request was made
+    bool upper;
+    bool onlyCipAutoComments;
+};
+
+struct CPUInfoBoxInfo
+{
+    dsint va;
+    duint generation;
+    duint sequence;
+    QString lines[3];
+    dsint rva;
+    dsint offset;
+};
+
+// Computes the info box lines away from the GUI thread, only the latest request is computed
+class CPUInfoBoxThread : public QThread
+{
+    Q_OBJECT
+public:
+    explicit CPUInfoBoxThread(QObject* parent = 0);
+    void request(const CPUInfoBoxRequest & request);
+    bool takeInfo(CPUInfoBoxInfo & info);
+    void stop();
+
+signals:
+    void infoReady();
+
+private:
+    QMutex mLock;
+    QWaitCondition mWake;
+    CPUInfoBoxRequest mRequest;
+    bool mHasRequest;
+    CPUInfoBoxInfo mInfo;
+    bool mHasInfo;
+    bool mStop;
+
+    void run();
+    bool isStale();
+    bool getInfo(const CPUInfoBoxRequest & request, CPUInfoBoxInfo & info);
+    static QString getSymbolicName(dsint addr);
+};
+
+#endif // CPUINFOBOXTHREAD_H
@@ -3,6 +3,7 @@
 #include "Breakpoints.h"
 #include "CPUDisassembly.h"
 #include "CachedFontMetrics.h"
+#include "JumpOffsetTree.h"
 #include <QToolTip>
 
 CPUSideBar::CPUSideBar(CPUDisassembly* Ptr, QWidget* parent) : QAbstractScrollArea(parent)
@@ -17,6 +18,12 @@ CPUSideBar::CPUSideBar(CPUDisassembly* Ptr, QWidget* parent) : QAbstractScrollAr
     mInstrBuffer = mDisas->instructionsBuffer();
 
     memset(&regDump, 0, sizeof(REGDUMP));
+    memset(&mLineRegisters, 0, sizeof(REGISTERCONTEXT));
+    mLineBase = 0;
+    mLineSize = 0;
+    mLineRows = -1;
+    mLineBpGeneration = 0;
+    mLineBookmarkGeneration = 0;
 
     updateSlots();
 
@@ -34,6 +41,7 @@ void CPUSideBar::updateSlots()
     connect(Config(), SIGNAL(colorsUpdated()), this, SLOT(updateColors()));
     connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(updateFonts()));
     connect(Bridge::getBridge(), SIGNAL(foldDisassembly(duint, duint)), this, SLOT(foldDisassembly(duint, duint)));
+    connect(Bridge::getBridge(), SIGNAL(updateWatch()), this, SLOT(updateWatchLabels()));
 
     // Init all other updates once
     updateColors();
@@ -102,9 +110,26 @@ void CPUSideBar::changeTopmostAddress(dsint i)
     topVA = i;
     memset(&regDump, 0, sizeof(REGDUMP));
     DbgGetRegDump(&regDump);
+    updateWatchLabels();
     reload();
 }
 
+void CPUSideBar::updateWatchLabels()
+{
+    mWatchLabels.clear();
+    if(!DbgIsDebugging())
+        return;
+    BridgeList<WATCHINFO> WatchList;
+    DbgGetWatchList(&WatchList);
+    for(int i = 0; i < WatchList.Count(); i++)
+    {
+        if(WatchList[i].varType == WATCHVARTYPE::TYPE_UINT || WatchList[i].varType == WATCHVARTYPE::TYPE_ASCII || WatchList[i].varType == WATCHVARTYPE::TYPE_UNICODE)
+        {
+            mWatchLabels.push_back(std::make_pair(QString(WatchList[i].WatchName), WatchList[i].value));
+        }
+    }
+}
+
 void CPUSideBar::setViewableRows(int rows)
 {
     viewableRows = rows;
@@ -121,21 +146,96 @@ void CPUSideBar::setSelection(dsint selVA)
 
 bool CPUSideBar::isJump(int i) const
 {
-    const Instruction_t & instr = mInstrBuffer->at(i);
-    Instruction_t::BranchType branchType = instr.branchType;
-    if(branchType == Instruction_t::Unconditional || branchType == Instruction_t::Conditional)
+    return i < int(mLineInfo.size()) && mLineInfo[i].isJump;
+}
+
+void CPUSideBar::updateLineInfo()
+{
+    duint base = mDisas->getBase();
+    duint size = mDisas->getSize();
+    duint bpGeneration = DbgFunctions()->BpGetGeneration();
+    duint bookmarkGeneration = DbgFunctions()->BookmarkGetGeneration();
+    bool changed = base != mLineBase || size != mLineSize || viewableRows != mLineRows ||
+                   bpGeneration != mLineBpGeneration || bookmarkGeneration != mLineBookmarkGeneration ||
+                   memcmp(&regDump.regcontext, &mLineRegisters, sizeof(REGISTERCONTEXT)) != 0 ||
+                   mLineInstructions.size() != size_t(mInstrBuffer->size());
+    for(int i = 0; !changed && i < mInstrBuffer->size(); i++)
     {
-        duint start = mDisas->getBase();
-        duint end = start + mDisas->getSize();
-        duint addr = DbgGetBranchDestination(start + instr.rva);
+        const Instruction_t & instr = mInstrBuffer->at(i);
+        changed = mLineInstructions[i].first != instr.rva || mLineInstructions[i].second != instr.dump;
+    }
+    if(!changed)
+        return;
 
-        if(!addr)
-            return false;
+    mLineBase = base;
+    mLineSize = size;
+    mLineRows = viewableRows;
+    mLineBpGeneration = bpGeneration;
+    mLineBookmarkGeneration = bookmarkGeneration;
+    mLineRegisters = regDump.regcontext;
+    mLineInstructions.clear();
+    mLineInfo.clear();
+    if(mInstrBuffer->isEmpty())
+        return;
 
-        return addr >= start && addr < end; //do not draw jumps that go out of the section
-    }
+    duint last_va = mInstrBuffer->last().rva + base;
+    duint first_va = mInstrBuffer->first().rva + base;
+    for(int line = 0; line < mInstrBuffer->size(); line++)
+    {
+        const Instruction_t & instr = mInstrBuffer->at(line);
+        duint instrVA = instr.rva + base;
+        mLineInstructions.push_back(std::make_pair(instr.rva, instr.dump));
+
+        LineInfo info;
+        info.isBp = DbgGetBpxTypeAt(instrVA) != bp_none;
+        info.isBpDisabled = DbgIsBpDisabled(instrVA);
+        info.isBookmark = DbgGetBookmarkAt(instrVA);
+        info.isJump = false;
+        info.isJumpGoingToExecute = false;
+        info.destLine = 0;
+        if(instr.branchType == Instruction_t::Unconditional || instr.branchType == Instruction_t::Conditional)
+        {
+            duint destVA = DbgGetBranchDestination(instrVA);
+            // Do not draw jumps that leave the memory range
+            info.isJump = destVA && destVA >= base && destVA < base + size;
+            if(info.isJump)
+            {
+                info.isJumpGoingToExecute = DbgIsJumpGoingToExecute(instrVA);
 
-    return false;
+                // Do not try to draw EBFE (Jump to the same line)
+                //if(destVA == instrVA)
+                //    continue;
+
+                if(destVA <= last_va && destVA >= first_va)
+                {
+                    int destLine = line;
+                    while(destLine > -1 && destLine < mInstrBuffer->size())
+                    {
+                        duint va = mInstrBuffer->at(destLine).rva + base;
+                        if(destVA > instrVA) //jump goes down
+                        {
+                            duint vaEnd = va + mInstrBuffer->at(destLine).length - 1;
+                            if(vaEnd >= destVA)
+                                break;
+                            destLine++;
+                        }
+                        else //jump goes up
+                        {
+                            if(va <= destVA)
+                                break;
+                            destLine--;
+                        }
+                    }
+                    info.destLine = destLine;
+                }
+                else if(destVA > last_va)
+                    info.destLine = viewableRows + 6;
+                else if(destVA < first_va)
+                    info.destLine = -6;
+            }
+        }
+        mLineInfo.push_back(info);
+    }
 }
 
 void CPUSideBar::paintEvent(QPaintEvent* event)
@@ -157,7 +257,7 @@ void CPUSideBar::paintEvent(QPaintEvent* event)
         mDisas->reloadData();
     }
 
-    int jumpoffset = 0;
+    updateLineInfo();
 
     duint last_va = mInstrBuffer->last().rva + mDisas->getBase();
     duint first_va = mInstrBuffer->first().rva + mDisas->getBase();
@@ -199,15 +299,8 @@ void CPUSideBar::paintEvent(QPaintEvent* event)
 #endif //_WIN64
     if(ConfigBool("Gui", "SidebarWatchLabels"))
     {
-        BridgeList<WATCHINFO> WatchList;
-        DbgGetWatchList(&WatchList);
-        for(int i = 0; i < WatchList.Count(); i++)
-        {
-            if(WatchList[i].varType == WATCHVARTYPE::TYPE_UINT || WatchList[i].varType == WATCHVARTYPE::TYPE_ASCII || WatchList[i].varType == WATCHVARTYPE::TYPE_UNICODE)
-            {
-                appendReg(QString(WatchList[i].WatchName), WatchList[i].value);
-            }
-        }
+        for(const auto & watch : mWatchLabels)
+            appendReg(watch.first, watch.second);
     }
 
     std::vector<JumpLine> jumpLines;
@@ -220,63 +313,25 @@ void CPUSideBar::paintEvent(QPaintEvent* event)
         const Instruction_t & instr = mInstrBuffer->at(line);
         duint instrVA = instr.rva + mDisas->getBase();
         duint instrVAEnd = instrVA + instr.length;
+        const LineInfo & info = mLineInfo[line];
 
         // draw bullet
-        drawBullets(&painter, line, DbgGetBpxTypeAt(instrVA) != bp_none, DbgIsBpDisabled(instrVA), DbgGetBookmarkAt(instrVA));
+        drawBullets(&painter, line, info.isBp, info.isBpDisabled, info.isBookmark);
 
         if(isJump(line)) //handle jumps
         {
             JumpLine jmp;
-            jmp.isJumpGoingToExecute = DbgIsJumpGoingToExecute(instrVA);
+            jmp.isJumpGoingToExecute = info.isJumpGoingToExecute;
             jmp.isSelected = (selectedVA == instrVA);
             jmp.isConditional = instr.branchType == Instruction_t::Conditional;
             jmp.line = line;
+            jmp.destLine = info.destLine;
 
             /*
             if(mDisas->currentEIP() != mInstrBuffer->at(line).rva) //create a setting for this
                 isJumpGoingToExecute=false;
             */
 
-            jumpoffset++;
-
-            duint baseAddr = mDisas->getBase();
-
-            duint destVA = DbgGetBranchDestination(baseAddr + instr.rva);
-
-            // Do not try to draw EBFE (Jump to the same line)
-            //if(destVA == instrVA)
-            //    continue;
-
-            // Do not draw jumps that leave the memory range
-            if(destVA >= mDisas->getBase() + mDisas->getSize() || destVA < mDisas->getBase())
-                continue;
-
-            if(destVA <= last_va && destVA >= first_va)
-            {
-                int destLine = line;
-                while(destLine > -1 && destLine < mInstrBuffer->size())
-                {
-                    duint va = mInstrBuffer->at(destLine).rva + mDisas->getBase();
-                    if(destVA > instrVA) //jump goes down
-                    {
-                        duint vaEnd = va + mInstrBuffer->at(destLine).length - 1;
-                        if(vaEnd >= destVA)
-                            break;
-                        destLine++;
-                    }
-                    else //jump goes up
-                    {
-                        if(va <= destVA)
-                            break;
-                        destLine--;
-                    }
-                }
-                jmp.destLine = destLine;
-            }
-            else if(destVA > last_va)
-                jmp.destLine = viewableRows + 6;
-            else if(destVA < first_va)
-                jmp.destLine = -6;
             jumpLines.emplace_back(jmp);
         }
 
@@ -711,67 +766,18 @@ void CPUSideBar::drawStraightArrow(QPainter* painter, int x1, int y1, int x2, in
 
 void CPUSideBar::AllocateJumpOffsets(std::vector<JumpLine> & jumpLines, std::vector<LabelArrow> & labelArrows)
 {
-    unsigned int* numLines = new unsigned int[viewableRows * 2]; // Low:jump offsets of the vertical jumping line, High:jump offsets of the horizontal jumping line.
-    memset(numLines, 0, sizeof(unsigned int) * viewableRows * 2);
-    // preprocessing
-    for(size_t i = 0; i < jumpLines.size(); i++)
-    {
-        JumpLine & jmp = jumpLines.at(i);
-        jmp.jumpOffset = abs(jmp.destLine - jmp.line);
-    }
-    // Sort jumpLines so that longer jumps are put at the back.
-    std::sort(jumpLines.begin(), jumpLines.end(), [](const JumpLine & op1, const JumpLine & op2)
-    {
-        return op2.jumpOffset > op1.jumpOffset;
-    });
-    // Allocate jump offsets
-    for(size_t i = 0; i < jumpLines.size(); i++)
-    {
-        JumpLine & jmp = jumpLines.at(i);
-        unsigned int maxJmpOffset = 0;
-        if(jmp.line < jmp.destLine)
-        {
-            for(int j = jmp.line; j <= jmp.destLine && j < viewableRows; j++)
-            {
-                if(numLines[j] > maxJmpOffset)
-                    maxJmpOffset = numLines[j];
-            }
-        }
-        else
-        {
-            for(int j = jmp.line; j >= jmp.destLine && j >= 0; j--)
-            {
-                if(numLines[j] > maxJmpOffset)
-                    maxJmpOffset = numLines[j];
-            }
-        }
-        jmp.jumpOffset = maxJmpOffset + 1;
-        if(jmp.line < jmp.destLine)
-        {
-            for(int j = jmp.line; j <= jmp.destLine && j < viewableRows; j++)
-                numLines[j] = jmp.jumpOffset;
-        }
-        else
-        {
-            for(int j = jmp.line; j >= jmp.destLine && j >= 0; j--)
-                numLines[j] = jmp.jumpOffset;
-        }
-        if(jmp.line >= 0 && jmp.line < viewableRows)
-            numLines[jmp.line + viewableRows] = jmp.jumpOffset;
-        if(jmp.destLine >= 0 && jmp.destLine < viewableRows)
-            numLines[jmp.destLine + viewableRows] = jmp.jumpOffset;
-    }
+    std::vector<unsigned int> horizontalLines; // jump offsets of the horizontal jumping lines
+    JumpOffsetTree::allocate(jumpLines, viewableRows, horizontalLines);
     // set label arrows according to jump offsets
     auto viewportWidth = viewport()->width();
     const int JumpPadding = 11;
     for(auto i = labelArrows.begin(); i != labelArrows.end(); i++)
     {
-        if(numLines[i->line + viewableRows] != 0)
-            i->endX = viewportWidth - numLines[i->line + viewableRows] * JumpPadding - 15 - fontHeight; // This expression should be consistent with drawJump
+        if(horizontalLines[i->line] != 0)
+            i->endX = viewportWidth - horizontalLines[i->line] * JumpPadding - 15 - fontHeight; // This expression should be consistent with drawJump
         else
             i->endX = viewportWidth - 1 - 11 - (isFoldingGraphicsPresent(i->line) != 0 ? mBulletRadius + fontHeight : 0);
     }
-    delete[] numLines;
 }
 
 int CPUSideBar::isFoldingGraphicsPresent(int line)
@@ -43,6 +43,7 @@ public slots:
     void setViewableRows(int rows);
     void setSelection(dsint selVA);
     void foldDisassembly(duint startAddress, duint length);
+    void updateWatchLabels();
 
 protected:
     void paintEvent(QPaintEvent* event);
@@ -69,6 +70,27 @@ private:
     CPUDisassembly* mDisas;
     QList<Instruction_t>* mInstrBuffer;
     REGDUMP regDump;
+    std::vector<std::pair<QString, duint>> mWatchLabels;
+
+    // Breakpoints, bookmarks and jumps of the instructions in the window, rebuilt when the window or the debugger state changes
+    struct LineInfo
+    {
+        bool isBp;
+        bool isBpDisabled;
+        bool isBookmark;
+        bool isJump;
+        bool isJumpGoingToExecute;
+        int destLine;
+    };
+    std::vector<LineInfo> mLineInfo;
+    std::vector<std::pair<duint, QByteArray>> mLineInstructions;
+    REGISTERCONTEXT mLineRegisters;
+    duint mLineBase;
+    duint mLineSize;
+    int mLineRows;
+    duint mLineBpGeneration;
+    duint mLineBookmarkGeneration;
+    void updateLineInfo();
 
     struct JumpLine
     {
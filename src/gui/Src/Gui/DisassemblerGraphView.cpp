@@ -8,6 +8,7 @@
 #include <QClipboard>
 #include <QApplication>
 #include <QMimeData>
+#include <QHash>
 
 DisassemblerGraphView::DisassemblerGraphView(QWidget* parent)
     : QAbstractScrollArea(parent),
@@ -631,254 +632,121 @@ void DisassemblerGraphView::prepareGraphNode(DisassemblerBlock & block)
     block.height = (height * this->charHeight) + extra;
 }
 
-void DisassemblerGraphView::adjustGraphLayout(DisassemblerBlock & block, int col, int row)
+static uint hashText(const DisassemblerGraphView::Text & text, uint seed)
 {
-    block.col += col;
-    block.row += row;
-    for(duint edge : block.new_exits)
-        this->adjustGraphLayout(this->blocks[edge], col, row);
-}
-
-void DisassemblerGraphView::computeGraphLayout(DisassemblerBlock & block)
-{
-    //Compute child node layouts and arrange them horizontally
-    int col = 0;
-    int row_count = 1;
-    for(duint edge : block.new_exits)
-    {
-        this->computeGraphLayout(this->blocks[edge]);
-        this->adjustGraphLayout(this->blocks[edge], col, 1);
-        col += this->blocks[edge].col_count;
-        if((this->blocks[edge].row_count + 1) > row_count)
-            row_count = this->blocks[edge].row_count + 1;
-    }
-
-    block.row = 0;
-    if(col >= 2)
+    for(auto & line : text.lines)
     {
-        //Place this node centered over the child nodes
-        block.col = (col - 2) / 2;
-        block.col_count = col;
-    }
-    else
-    {
-        //No child nodes, set single node's width (nodes are 2 columns wide to allow
-        //centering over a branch)
-        block.col = 0;
-        block.col_count = 2;
+        for(auto & part : line)
+            seed = qHash(part.text, seed);
+        seed = qHash(uint(line.size()), seed);
     }
-    block.row_count = row_count;
+    return seed;
 }
 
-bool DisassemblerGraphView::isEdgeMarked(EdgesVector & edges, int row, int col, int index)
+static uint hashFunction(const DisassemblerGraphView::Function & func)
 {
-    if(index >= int(edges[row][col].size()))
-        return false;
-    return edges[row][col][index];
-}
-
-void DisassemblerGraphView::markEdge(EdgesVector & edges, int row, int col, int index)
-{
-    while(int(edges[row][col].size()) <= index)
-        edges[row][col].push_back(false);
-    edges[row][col][index] = true;
-}
-
-int DisassemblerGraphView::findHorizEdgeIndex(EdgesVector & edges, int row, int min_col, int max_col)
-{
-    //Find a valid index
-    int i = 0;
-    while(true)
+    uint seed = qHash(func.entry);
+    for(auto & block : func.blocks)
     {
-        bool valid = true;
-        for(int col = min_col; col < max_col + 1; col++) //TODO: use max_col+1 ?
-            if(isEdgeMarked(edges, row, col, i))
-            {
-                valid = false;
-                break;
-            }
-        if(valid)
-            break;
-        i++;
+        seed = qHash(block.entry, seed);
+        seed = qHash(block.true_path, seed);
+        seed = qHash(block.false_path, seed);
+        for(duint exit : block.exits)
+            seed = qHash(exit, seed);
+        seed = hashText(block.header_text, seed);
+        for(auto & instr : block.instrs)
+        {
+            seed = qHash(instr.addr, seed);
+            seed = hashText(instr.text, seed);
+        }
     }
-
-    //Mark chosen index as used
-    for(int col = min_col; col < max_col + 1; col++) //TODO: use max_col+1 ?
-        this->markEdge(edges, row, col, i);
-    return i;
+    return seed;
 }
 
-int DisassemblerGraphView::findVertEdgeIndex(EdgesVector & edges, int col, int min_row, int max_row)
+bool DisassemblerGraphView::loadCachedLayout(duint entry, uint hash)
 {
-    //Find a valid index
-    int i = 0;
-    while(true)
+    for(auto it = this->layoutCache.begin(); it != this->layoutCache.end(); ++it)
     {
-        bool valid = true;
-        for(int row = min_row; row < max_row + 1; row++) //TODO: use max_row+1 ?
-            if(isEdgeMarked(edges, row, col, i))
-            {
-                valid = false;
-                break;
-            }
-        if(valid)
-            break;
-        i++;
+        if(it->entry != entry || it->hash != hash)
+            continue;
+        this->blocks = it->blocks;
+        this->col_edge_x = it->col_edge_x;
+        this->row_edge_y = it->row_edge_y;
+        this->width = it->width;
+        this->height = it->height;
+        //Edges point into the block map, they have the same order as the exits
+        for(auto & blockIt : this->blocks)
+        {
+            DisassemblerBlock & block = blockIt.second;
+            for(size_t i = 0; i < block.edges.size(); i++)
+                block.edges[i].dest = &this->blocks[block.block.exits[i]];
+        }
+        auto layout = std::move(*it);
+        this->layoutCache.erase(it);
+        this->layoutCache.push_front(std::move(layout));
+        return true;
     }
+    return false;
+}
 
-    //Mark chosen index as used
-    for(int row = min_row; row < max_row + 1; row++) //TODO: use max_row+1 ?
-        this->markEdge(edges, row, col, i);
-    return i;
+void DisassemblerGraphView::storeCachedLayout(duint entry, uint hash)
+{
+    GraphLayout layout;
+    layout.entry = entry;
+    layout.hash = hash;
+    layout.blocks = this->blocks;
+    layout.col_edge_x = this->col_edge_x;
+    layout.row_edge_y = this->row_edge_y;
+    layout.width = this->width;
+    layout.height = this->height;
+    this->layoutCache.push_front(std::move(layout));
+    while(this->layoutCache.size() > 16)
+        this->layoutCache.pop_back();
 }
 
-DisassemblerGraphView::DisassemblerEdge DisassemblerGraphView::routeEdge(EdgesVector & horiz_edges, EdgesVector & vert_edges, Matrix<bool> & edge_valid, DisassemblerBlock & start, DisassemblerBlock & end, QColor color)
+void DisassemblerGraphView::renderFunction(Function & func)
 {
-    DisassemblerEdge edge;
-    edge.color = color;
-    edge.dest = &end;
+    puts("Starting renderFunction");
 
-    //Find edge index for initial outgoing line
-    int i = 0;
-    while(true)
-    {
-        if(!this->isEdgeMarked(vert_edges, start.row + 1, start.col + 1, i))
-            break;
-        i += 1;
-    }
-    this->markEdge(vert_edges, start.row + 1, start.col + 1, i);
-    edge.addPoint(start.row + 1, start.col + 1);
-    edge.start_index = i;
-    bool horiz = false;
-
-    //Find valid column for moving vertically to the target node
-    int min_row, max_row;
-    if(end.row < (start.row + 1))
-    {
-        min_row = end.row;
-        max_row = start.row + 1;
-    }
+    //Reuse the layout when the function did not change since it was last laid out
+    auto hash = hashFunction(func);
+    if(this->loadCachedLayout(func.entry, hash))
+        puts("Use cached layout");
     else
     {
-        min_row = start.row + 1;
-        max_row = end.row;
-    }
-    int col = start.col + 1;
-    if(min_row != max_row)
-    {
-        int ofs = 0;
-        while(true)
-        {
-            col = start.col + 1 - ofs;
-            if(col >= 0)
-            {
-                bool valid = true;
-                for(int row = min_row; row < max_row + 1; row++)
-                {
-                    if(!edge_valid[row][col])
-                    {
-                        valid = false;
-                        break;
-                    }
-                }
-                if(valid)
-                    break;
-            }
-
-            col = start.col + 1 + ofs;
-            if(col < int(edge_valid[min_row].size()))
-            {
-                bool valid = true;
-                for(int row = min_row; row < max_row + 1; row++)
-                {
-                    if(!edge_valid[row][col])
-                    {
-                        valid = false;
-                        break;
-                    }
-                }
-                if(valid)
-                    break;
-            }
-
-            ofs += 1;
-        }
-    }
-
-    if(col != (start.col + 1))
-    {
-        //Not in same column, need to generate a line for moving to the correct column
-        int min_col, max_col;
-        if(col < (start.col + 1))
-        {
-            min_col = col;
-            max_col = start.col + 1;
-        }
-        else
-        {
-            min_col = start.col + 1;
-            max_col = col;
-        }
-        int index = this->findHorizEdgeIndex(horiz_edges, start.row + 1, min_col, max_col);
-        edge.addPoint(start.row + 1, col, index);
-        horiz = true;
+        this->layoutFunction(func);
+        this->storeCachedLayout(func.entry, hash);
     }
 
-    if(end.row != (start.row + 1))
-    {
-        //Not in same row, need to generate a line for moving to the correct row
-        int index = this->findVertEdgeIndex(vert_edges, col, min_row, max_row);
-        edge.addPoint(end.row, col, index);
-        horiz = false;
-    }
+    //Adjust scroll bars for new size
+    auto areaSize = this->viewport()->size();
+    this->adjustSize(areaSize.width(), areaSize.height());
+    puts("Adjust scroll bars for new size");
 
-    if(col != (end.col + 1))
+    if(this->desired_pos)
     {
-        //Not in ending column, need to generate a line for moving to the correct column
-        int min_col, max_col;
-        if(col < (end.col + 1))
-        {
-            min_col = col;
-            max_col = end.col + 1;
-        }
-        else
-        {
-            min_col = end.col + 1;
-            max_col = col;
-        }
-        int index = this->findHorizEdgeIndex(horiz_edges, end.row, min_col, max_col);
-        edge.addPoint(end.row, end.col + 1, index);
-        horiz = true;
+        //There was a position saved, navigate to it
+        this->horizontalScrollBar()->setValue(this->desired_pos[0]);
+        this->verticalScrollBar()->setValue(this->desired_pos[1]);
     }
-
-    //If last line was horizontal, choose the ending edge index for the incoming edge
-    if(horiz)
+    else if(this->cur_instr != 0)
+        this->show_cur_instr();
+    else
     {
-        int index = this->findVertEdgeIndex(vert_edges, end.col + 1, end.row, end.row);
-        edge.points[int(edge.points.size()) - 1].index = index;
+        //Ensure start node is visible
+        auto start_x = this->blocks[func.entry].x + this->renderXOfs + int(this->blocks[func.entry].width / 2);
+        this->horizontalScrollBar()->setValue(start_x - int(areaSize.width() / 2));
+        this->verticalScrollBar()->setValue(0);
     }
 
-    return edge;
-}
-
-template<class T>
-static void removeFromVec(std::vector<T> & vec, T elem)
-{
-    vec.erase(std::remove(vec.begin(), vec.end(), elem), vec.end());
-}
-
-template<class T>
-static void initVec(std::vector<T> & vec, size_t size, T value)
-{
-    vec.resize(size);
-    for(size_t i = 0; i < size; i++)
-        vec[i] = value;
+    this->analysis.update_id = this->update_id = func.update_id;
+    this->ready = true;
+    this->viewport()->update(0, 0, areaSize.width(), areaSize.height());
+    puts("Finished");
 }
 
-void DisassemblerGraphView::renderFunction(Function & func)
+void DisassemblerGraphView::layoutFunction(Function & func)
 {
-    puts("Starting renderFunction");
-
     //Create render nodes
     this->blocks.clear();
     for(Block & block : func.blocks)
@@ -888,206 +756,46 @@ void DisassemblerGraphView::renderFunction(Function & func)
     }
     puts("Create render nodes");
 
-    //Populate incoming lists
-    for(auto & blockIt : this->blocks)
-    {
-        DisassemblerBlock & block = blockIt.second;
-        for(auto & edge : block.block.exits)
-            this->blocks[edge].incoming.push_back(block.block.entry);
-    }
-    puts("Populate incoming lists");
-
-    //Construct acyclic graph where each node is used as an edge exactly once
-    //auto block = func.blocks[func.entry];
-    std::unordered_set<duint> visited;
-    visited.insert(func.entry);
-    std::queue<duint> queue;
-    queue.push(this->blocks[func.entry].block.entry);
-    auto changed = true;
-
-    int best_edges;
-    duint best_parent;
-    while(changed)
-    {
-        changed = false;
-
-        //First pick nodes that have single entry points
-        while(!queue.empty())
-        {
-            DisassemblerBlock & block = this->blocks[queue.front()];
-            queue.pop();
-
-            for(duint edge : block.block.exits)
-            {
-                if(visited.count(edge))
-                    continue;
-
-                //If node has no more unseen incoming edges, add it to the graph layout now
-                if(int(this->blocks[edge].incoming.size()) == 1)
-                {
-                    removeFromVec(this->blocks[edge].incoming, block.block.entry);
-                    block.new_exits.push_back(edge);
-                    queue.push(this->blocks[edge].block.entry);
-                    visited.insert(edge);
-                    changed = true;
-                }
-            }
-        }
-
-        //No more nodes satisfy constraints, pick a node to continue constructing the graph
-        duint best = 0;
-        for(auto & blockIt : this->blocks)
-        {
-            DisassemblerBlock & block = blockIt.second;
-            if(!visited.count(block.block.entry))
-                continue;
-            for(duint edge : block.block.exits)
-            {
-                if(visited.count(edge))
-                    continue;
-                if((best == 0) || (int(this->blocks[edge].incoming.size()) < best_edges) || (
-                            (int(this->blocks[edge].incoming.size()) == best_edges) && (edge < best)))
-                {
-                    best = edge;
-                    best_edges = int(this->blocks[edge].incoming.size());
-                    best_parent = block.block.entry;
-                }
-            }
-        }
-
-        if(best != 0)
-        {
-            DisassemblerBlock & best_parentb = this->blocks[best_parent];
-            removeFromVec(this->blocks[best].incoming, best_parentb.block.entry);
-            best_parentb.new_exits.push_back(best);
-            visited.insert(best);
-            changed = true;
-        }
-    }
-    puts("Construct acyclic graph where each node is used as an edge exactly once");
-
-    //Compute graph layout from bottom up
-    this->computeGraphLayout(this->blocks[func.entry]);
-    puts("Compute graph layout from bottom up");
-
-    //Prepare edge routing
-    EdgesVector horiz_edges, vert_edges;
-    horiz_edges.resize(this->blocks[func.entry].row_count + 1);
-    vert_edges.resize(this->blocks[func.entry].row_count + 1);
-    Matrix<bool> edge_valid;
-    edge_valid.resize(this->blocks[func.entry].row_count + 1);
-    for(int row = 0; row < this->blocks[func.entry].row_count + 1; row++)
-    {
-        horiz_edges[row].resize(this->blocks[func.entry].col_count + 1);
-        vert_edges[row].resize(this->blocks[func.entry].col_count + 1);
-        initVec(edge_valid[row], this->blocks[func.entry].col_count + 1, true);
-        for(int col = 0; col < this->blocks[func.entry].col_count + 1; col++)
-        {
-            horiz_edges[row][col].clear();
-            vert_edges[row][col].clear();
-        }
-    }
-    for(auto & blockIt : this->blocks)
-    {
-        DisassemblerBlock & block = blockIt.second;
-        edge_valid[block.row][block.col + 1] = false;
-    }
-    puts("Prepare edge routing");
-
-    //Perform edge routing
+    //Place the nodes and route the edges
+    CFGLayout layout;
     for(auto & blockIt : this->blocks)
     {
         DisassemblerBlock & block = blockIt.second;
-        DisassemblerBlock & start = block;
-        for(duint edge : block.block.exits)
-        {
-            DisassemblerBlock & end = this->blocks[edge];
-            QColor color = jmpColor;
-            if(edge == block.block.true_path)
-                color = brtrueColor;
-            else if(edge == block.block.false_path)
-                color = brfalseColor;
-            start.edges.push_back(this->routeEdge(horiz_edges, vert_edges, edge_valid, start, end, color));
-        }
+        CFGLayout::Block & node = layout.blocks[blockIt.first];
+        node.entry = block.block.entry;
+        node.exits = block.block.exits;
+        node.width = block.width;
+        node.height = block.height;
     }
-    puts("Perform edge routing");
+    layout.layout(func.entry);
+    puts("Compute graph layout");
 
-    //Compute edge counts for each row and column
-    std::vector<int> col_edge_count, row_edge_count;
-    initVec(col_edge_count, this->blocks[func.entry].col_count + 1, 0);
-    initVec(row_edge_count, this->blocks[func.entry].row_count + 1, 0);
-    for(int row = 0; row < this->blocks[func.entry].row_count + 1; row++)
+    //Take over the node positions and edges
+    for(auto & nodeIt : layout.blocks)
     {
-        for(int col = 0; col < this->blocks[func.entry].col_count + 1; col++)
+        CFGLayout::Block & node = nodeIt.second;
+        DisassemblerBlock & block = this->blocks[nodeIt.first];
+        block.x = node.x;
+        block.y = node.y;
+        for(CFGLayout::Edge & route : node.edges)
         {
-            if(int(horiz_edges[row][col].size()) > row_edge_count[row])
-                row_edge_count[row] = int(horiz_edges[row][col].size());
-            if(int(vert_edges[row][col].size()) > col_edge_count[col])
-                col_edge_count[col] = int(vert_edges[row][col].size());
+            DisassemblerEdge edge;
+            edge.color = jmpColor;
+            if(route.dest == block.block.true_path)
+                edge.color = brtrueColor;
+            else if(route.dest == block.block.false_path)
+                edge.color = brfalseColor;
+            edge.dest = &this->blocks[route.dest];
+            edge.points = std::move(route.points);
+            edge.start_index = route.start_index;
+            block.edges.push_back(std::move(edge));
         }
     }
-    puts("Compute edge counts for each row and column");
-
-    //Compute row and column sizes
-    std::vector<int> col_width, row_height;
-    initVec(col_width, this->blocks[func.entry].col_count + 1, 0);
-    initVec(row_height, this->blocks[func.entry].row_count + 1, 0);
-    for(auto & blockIt : this->blocks)
-    {
-        DisassemblerBlock & block = blockIt.second;
-        if((int(block.width / 2)) > col_width[block.col])
-            col_width[block.col] = int(block.width / 2);
-        if((int(block.width / 2)) > col_width[block.col + 1])
-            col_width[block.col + 1] = int(block.width / 2);
-        if(int(block.height) > row_height[block.row])
-            row_height[block.row] = int(block.height);
-    }
-    puts("Compute row and column sizes");
-
-    //Compute row and column positions
-    std::vector<int> col_x, row_y;
-    initVec(col_x, this->blocks[func.entry].col_count, 0);
-    initVec(row_y, this->blocks[func.entry].row_count, 0);
-    initVec(this->col_edge_x, this->blocks[func.entry].col_count + 1, 0);
-    initVec(this->row_edge_y, this->blocks[func.entry].row_count + 1, 0);
-    int x = 16;
-    for(int i = 0; i < this->blocks[func.entry].col_count; i++)
-    {
-        this->col_edge_x[i] = x;
-        x += 8 * col_edge_count[i];
-        col_x[i] = x;
-        x += col_width[i];
-    }
-    int y = 16;
-    for(int i = 0; i < this->blocks[func.entry].row_count; i++)
-    {
-        this->row_edge_y[i] = y;
-        y += 8 * row_edge_count[i];
-        row_y[i] = y;
-        y += row_height[i];
-    }
-    this->col_edge_x[this->blocks[func.entry].col_count] = x;
-    this->row_edge_y[this->blocks[func.entry].row_count] = y;
-    this->width = x + 16 + (8 * col_edge_count[this->blocks[func.entry].col_count]);
-    this->height = y + 16 + (8 * row_edge_count[this->blocks[func.entry].row_count]);
-    puts("Compute row and column positions");
-
-    //Compute node positions
-    for(auto & blockIt : this->blocks)
-    {
-        DisassemblerBlock & block = blockIt.second;
-        block.x = int(
-                      (col_x[block.col] + col_width[block.col] + 4 * col_edge_count[block.col + 1]) - (block.width / 2));
-        if((block.x + block.width) > (
-                    col_x[block.col] + col_width[block.col] + col_width[block.col + 1] + 8 * col_edge_count[
-                        block.col + 1]))
-        {
-            block.x = int((col_x[block.col] + col_width[block.col] + col_width[block.col + 1] + 8 * col_edge_count[
-                               block.col + 1]) - block.width);
-        }
-        block.y = row_y[block.row];
-    }
-    puts("Compute node positions");
+    this->col_edge_x = std::move(layout.col_edge_x);
+    this->row_edge_y = std::move(layout.row_edge_y);
+    this->width = layout.width;
+    this->height = layout.height;
+    puts("Take over the node positions and edges");
 
     //Precompute coordinates for edges
     for(auto & blockIt : this->blocks)
@@ -1131,32 +839,6 @@ void DisassemblerGraphView::renderFunction(Function & func)
         }
     }
     puts("Precompute coordinates for edges");
-
-    //Adjust scroll bars for new size
-    auto areaSize = this->viewport()->size();
-    this->adjustSize(areaSize.width(), areaSize.height());
-    puts("Adjust scroll bars for new size");
-
-    if(this->desired_pos)
-    {
-        //There was a position saved, navigate to it
-        this->horizontalScrollBar()->setValue(this->desired_pos[0]);
-        this->verticalScrollBar()->setValue(this->desired_pos[1]);
-    }
-    else if(this->cur_instr != 0)
-        this->show_cur_instr();
-    else
-    {
-        //Ensure start node is visible
-        auto start_x = this->blocks[func.entry].x + this->renderXOfs + int(this->blocks[func.entry].width / 2);
-        this->horizontalScrollBar()->setValue(start_x - int(areaSize.width() / 2));
-        this->verticalScrollBar()->setValue(0);
-    }
-
-    this->analysis.update_id = this->update_id = func.update_id;
-    this->ready = true;
-    this->viewport()->update(0, 0, areaSize.width(), areaSize.height());
-    puts("Finished");
 }
 
 void DisassemblerGraphView::updateTimerEvent()
@@ -1252,6 +934,7 @@ bool DisassemblerGraphView::navigate(duint addr)
 void DisassemblerGraphView::fontChanged()
 {
     this->initFont();
+    this->layoutCache.clear(); //the layout depends on the font and the edge colors
 
     if(this->ready)
     {
@@ -12,10 +12,12 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <queue>
+#include <deque>
 #include <algorithm>
 #include <QMutex>
 #include "Bridge.h"
 #include "RichTextPainter.h"
+#include "CFGLayout.h"
 
 class MenuBuilder;
 class CachedFontMetrics;
@@ -26,12 +28,7 @@ class DisassemblerGraphView : public QAbstractScrollArea
 public:
     struct DisassemblerBlock;
 
-    struct Point
-    {
-        int row; //point[0]
-        int col; //point[1]
-        int index; //point[2]
-    };
+    typedef CFGLayout::Point Point;
 
     struct DisassemblerEdge
     {
@@ -42,17 +39,6 @@ public:
 
         QPolygonF polyline;
         QPolygonF arrow;
-
-        void addPoint(int row, int col, int index = 0)
-        {
-            Point point;
-            point.row = row;
-            point.col = col;
-            point.index = 0;
-            this->points.push_back(point);
-            if(int(this->points.size()) > 1)
-                this->points[this->points.size() - 2].index = index;
-        }
     };
 
     struct Token
@@ -166,17 +152,11 @@ public:
 
         Block block;
         std::vector<DisassemblerEdge> edges;
-        std::vector<duint> incoming;
-        std::vector<duint> new_exits;
 
         qreal x = 0.0;
         qreal y = 0.0;
         int width = 0;
         int height = 0;
-        int col = 0;
-        int col_count = 0;
-        int row = 0;
-        int row_count = 0;
     };
 
     struct Function
@@ -187,6 +167,17 @@ public:
         std::vector<Block> blocks;
     };
 
+    struct GraphLayout
+    {
+        duint entry;
+        uint hash; //hash of the blocks and their text
+        std::unordered_map<duint, DisassemblerBlock> blocks;
+        std::vector<int> col_edge_x;
+        std::vector<int> row_edge_y;
+        int width;
+        int height;
+    };
+
     struct Analysis
     {
         duint entry = 0;
@@ -231,18 +222,10 @@ public:
     void mouseReleaseEvent(QMouseEvent* event);
     void mouseDoubleClickEvent(QMouseEvent* event);
     void prepareGraphNode(DisassemblerBlock & block);
-    void adjustGraphLayout(DisassemblerBlock & block, int col, int row);
-    void computeGraphLayout(DisassemblerBlock & block);
     void setupContextMenu();
-
-    template<typename T>
-    using Matrix = std::vector<std::vector<T>>;
-    using EdgesVector = Matrix<std::vector<bool>>;
-    bool isEdgeMarked(EdgesVector & edges, int row, int col, int index);
-    void markEdge(EdgesVector & edges, int row, int col, int index);
-    int findHorizEdgeIndex(EdgesVector & edges, int row, int min_col, int max_col);
-    int findVertEdgeIndex(EdgesVector & edges, int col, int min_row, int max_row);
-    DisassemblerEdge routeEdge(EdgesVector & horiz_edges, EdgesVector & vert_edges, Matrix<bool> & edge_valid, DisassemblerBlock & start, DisassemblerBlock & end, QColor color);
+    void layoutFunction(Function & func);
+    bool loadCachedLayout(duint entry, uint hash);
+    void storeCachedLayout(duint entry, uint hash);
     void renderFunction(Function & func);
     void show_cur_instr();
     bool navigate(duint addr);
@@ -285,6 +268,7 @@ private:
     HighlightToken* highlight_token;
     std::vector<int> col_edge_x;
     std::vector<int> row_edge_y;
+    std::deque<GraphLayout> layoutCache; //most recently used first
     CachedFontMetrics* mFontMetrics;
     MenuBuilder* mMenuBuilder;
     bool drawOverview;
@@ -12,10 +12,12 @@
 #include "GotoDialog.h"
 #include "WordEditDialog.h"
 #include "VirtualModDialog.h"
+#include "MemoryMapMerge.h"
 
 MemoryMapView::MemoryMapView(StdTable* parent)
     : StdTable(parent),
-      mCipBase(0)
+      mCipBase(0),
+      mMapGeneration(duint(-1))
 {
     enableMultiSelection(false);
 
@@ -293,80 +295,89 @@ QString MemoryMapView::paintContent(QPainter* painter, dsint rowBase, int rowOff
 
 void MemoryMapView::refreshMap()
 {
-    MEMMAP wMemMapStruct;
-    int wI;
+    mCipBase = DbgMemFindBaseAddr(DbgValFromString("cip"), nullptr);
 
-    memset(&wMemMapStruct, 0, sizeof(MEMMAP));
+    // Only repaint (for the cip highlight) when the map did not change since the last refresh
+    duint generation = DbgFunctions()->MemGetMapGeneration();
+    if(generation == mMapGeneration)
+    {
+        reloadData();
+        return;
+    }
+    mMapGeneration = generation;
 
+    MEMMAP wMemMapStruct;
+    memset(&wMemMapStruct, 0, sizeof(MEMMAP));
     DbgMemMap(&wMemMapStruct);
-    mCipBase = DbgMemFindBaseAddr(DbgValFromString("cip"), nullptr);
-
-    setRowCount(wMemMapStruct.count);
+    std::vector<MEMPAGE> wPages(wMemMapStruct.page, wMemMapStruct.page + wMemMapStruct.count);
+    if(wMemMapStruct.page != 0)
+        BridgeFree(wMemMapStruct.page);
 
-    for(wI = 0; wI < wMemMapStruct.count; wI++)
+    // Only the regions that were added or changed are formatted again, the selection and the scroll position stay on the same regions
+    MemoryMapMerge wMerge(mPages, wPages, getInitialSelection(), int(getTableOffset()), [](const MEMPAGE & page)
     {
-        QString wS;
-        MEMORY_BASIC_INFORMATION wMbi = (wMemMapStruct.page)[wI].mbi;
+        return duint(page.mbi.BaseAddress);
+    });
+    const int wColumnCount = 6;
+    std::vector<QString> wColumns[wColumnCount];
+    for(auto & column : wColumns)
+        column.resize(wPages.size());
+    for(size_t wI = 0; wI < wPages.size(); wI++)
+    {
+        int wOld = wMerge.oldRows[wI];
+        if(wOld != -1)
+        {
+            for(int wC = 0; wC < wColumnCount; wC++)
+                wColumns[wC][wI] = getCellContent(wOld, wC);
+        }
+        else
+            formatPage(wPages[wI], wColumns, wI);
+    }
 
-        // Base address
-        wS = ToPtrString((duint)wMbi.BaseAddress);
-        setCellContent(wI, 0, wS);
+    setRowCount(int(wPages.size()));
+    for(int wC = 0; wC < wColumnCount; wC++)
+        swapColumnContent(wC, wColumns[wC]);
+    mPages.swap(wPages);
+    setSingleSelection(wMerge.selection);
+    setTableOffset(wMerge.tableOffset);
+    reloadData(); //refresh memory map
+}
 
-        // Size
-        wS = ToPtrString((duint)wMbi.RegionSize);
-        setCellContent(wI, 1, wS);
+void MemoryMapView::formatPage(const MEMPAGE & page, std::vector<QString>* columns, size_t row)
+{
+    const MEMORY_BASIC_INFORMATION & wMbi = page.mbi;
 
-        // Information
-        wS = QString((wMemMapStruct.page)[wI].info);
-        setCellContent(wI, 2, wS);
+    // Base address
+    columns[0][row] = ToPtrString((duint)wMbi.BaseAddress);
 
-        // State
-        switch(wMbi.State)
-        {
-        case MEM_FREE:
-            wS = QString("FREE");
-            break;
-        case MEM_COMMIT:
-            wS = QString("COMM");
-            break;
-        case MEM_RESERVE:
-            wS = QString("RESV");
-            break;
-        default:
-            wS = QString("????");
-        }
-        setCellContent(wI, 3, wS);
+    // Size
+    columns[1][row] = ToPtrString((duint)wMbi.RegionSize);
 
-        // Type
-        switch(wMbi.Type)
-        {
-        case MEM_IMAGE:
-            wS = QString("IMG");
-            break;
-        case MEM_MAPPED:
-            wS = QString("MAP");
-            break;
-        case MEM_PRIVATE:
-            wS = QString("PRV");
-            break;
-        default:
-            wS = QString("N/A");
-            break;
-        }
-        setCellContent(wI, 3, wS);
+    // Information
+    columns[2][row] = QString(page.info);
 
-        // current access protection
-        wS = getProtectionString(wMbi.Protect);
-        setCellContent(wI, 4, wS);
+    // Type
+    switch(wMbi.Type)
+    {
+    case MEM_IMAGE:
+        columns[3][row] = QString("IMG");
+        break;
+    case MEM_MAPPED:
+        columns[3][row] = QString("MAP");
+        break;
+    case MEM_PRIVATE:
+        columns[3][row] = QString("PRV");
+        break;
+    default:
+        columns[3][row] = QString("N/A");
+        break;
+    }
 
-        // allocation protection
-        wS = getProtectionString(wMbi.AllocationProtect);
-        setCellContent(wI, 5, wS);
+    // current access protection
+    columns[4][row] = getProtectionString(wMbi.Protect);
 
-    }
-    if(wMemMapStruct.page != 0)
-        BridgeFree(wMemMapStruct.page);
-    reloadData(); //refresh memory map
+    // allocation protection
+    columns[5][row] = getProtectionString(wMbi.AllocationProtect);
 }
 
 void MemoryMapView::stateChangedSlot(DBGSTATE state)
@@ -44,6 +44,7 @@ public slots:
 
 private:
     QString getProtectionString(DWORD Protect);
+    void formatPage(const MEMPAGE & page, std::vector<QString>* columns, size_t row);
 
     QAction* mFollowDump;
     QAction* mFollowDisassembly;
@@ -72,6 +73,8 @@ private:
     QAction* mAddVirtualMod;
 
     duint mCipBase;
+    duint mMapGeneration;
+    std::vector<MEMPAGE> mPages; //the pages shown in the rows
 };
 
 #endif // MEMORYMAPVIEW_H
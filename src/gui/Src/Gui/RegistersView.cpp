@@ -1,6 +1,7 @@
 #include <QClipboard>
 #include <QMessageBox>
 #include <QListWidget>
+#include <QElapsedTimer>
 #include <stdint.h>
 #include "RegistersView.h"
 #include "CPUWidget.h"
@@ -12,6 +13,7 @@
 #include "EditFloatRegister.h"
 #include "SelectFields.h"
 #include "MiscUtil.h"
+#include "AnnotationCache.h"
 
 int RegistersView::getEstimateHeight()
 {
@@ -1124,11 +1126,16 @@ RegistersView::RegistersView(CPUWidget* parent, CPUMultiDump* multiDump) : QScro
 
     fontsUpdatedSlot();
     connect(Config(), SIGNAL(fontsUpdated()), this, SLOT(fontsUpdatedSlot()));
+    boolsUpdatedSlot();
+    connect(Config(), SIGNAL(boolsUpdated()), this, SLOT(boolsUpdatedSlot()));
 
     memset(&wRegDumpStruct, 0, sizeof(REGDUMP));
     memset(&wCipRegDumpStruct, 0, sizeof(REGDUMP));
     mCip = 0;
     mRegisterUpdates.clear();
+    mLabelGeneration = duint(-1);
+    mPaintTime = 0;
+    mPaintCount = 0;
 
     mButtonHeight = 0;
     yTopSpacing = 4; //set top spacing (in pixels)
@@ -1191,6 +1198,11 @@ RegistersView::~RegistersView()
 {
 }
 
+void RegistersView::boolsUpdatedSlot()
+{
+    mPaintStatistics = ConfigBool("Gui", "PaintStatistics");
+}
+
 void RegistersView::fontsUpdatedSlot()
 {
     auto font = ConfigFont("Registers");
@@ -1345,12 +1357,34 @@ void RegistersView::paintEvent(QPaintEvent* event)
     if(!DbgIsDebugging())
         return;
 
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
     // Iterate all registers
     for(auto itr = mRegisterMapping.begin(); itr != mRegisterMapping.end(); itr++)
     {
         // Paint register at given position
         drawRegister(&wPainter, itr.key(), registerValue(&wRegDumpStruct, itr.key()));
     }
+
+    if(mPaintStatistics)
+        updatePaintStatistics(paintTimer.nsecsElapsed());
+}
+
+void RegistersView::updatePaintStatistics(qint64 nsecs)
+{
+    mPaintTime += nsecs;
+    if(++mPaintCount < 100)
+        return;
+    AnnotationCache & cache = AnnotationCache::instance();
+    QString message = QString("RegistersView: %1 paints, %2us per paint, annotation cache %3 hits, %4 misses\n")
+                      .arg(mPaintCount)
+                      .arg(mPaintTime / mPaintCount / 1000)
+                      .arg(cache.hits())
+                      .arg(cache.misses());
+    GuiAddLogMessage(message.toUtf8().constData());
+    mPaintTime = 0;
+    mPaintCount = 0;
 }
 
 void RegistersView::keyPressEvent(QKeyEvent* event)
@@ -1384,33 +1418,41 @@ void RegistersView::operator delete(void* p)
  */
 QString RegistersView::getRegisterLabel(REGISTER_NAME register_selected)
 {
-    char label_text[MAX_LABEL_SIZE] = "";
-    char module_text[MAX_MODULE_SIZE] = "";
-    char string_text[MAX_STRING_SIZE] = "";
-
-    QString valueText = QString("%1").arg((* ((duint*) registerValue(&wRegDumpStruct, register_selected))), mRegisterPlaces[register_selected].valuesize, 16, QChar('0')).toUpper();
+    AnnotationCache & cache = AnnotationCache::instance();
     duint register_value = (* ((duint*) registerValue(&wRegDumpStruct, register_selected)));
-    QString newText = QString("");
 
-    bool hasString = DbgGetStringAt(register_value, string_text);
-    bool hasLabel = DbgGetLabelAt(register_value, SEG_DEFAULT, label_text);
-    bool hasModule = DbgGetModuleAt(register_value, module_text);
+    // the string depends on the memory, the annotation cache resolves it again after every pause
+    QString string;
+    if(!mONLYMODULEANDLABELDISPLAY.contains(register_selected) && cache.getString(register_value, string))
+        return string;
 
-    if(hasString && !mONLYMODULEANDLABELDISPLAY.contains(register_selected))
+    // the rest only depends on the value and the symbols, so it is kept until one of them changes
+    duint generation = cache.symbolGeneration();
+    if(generation != mLabelGeneration)
     {
-        newText = string_text;
+        mRegisterLabels.clear();
+        mLabelGeneration = generation;
     }
-    else if(hasLabel && hasModule)
+    auto found = mRegisterLabels.constFind(register_selected);
+    if(found != mRegisterLabels.constEnd() && found.value().value == register_value)
+        return found.value().text;
+
+    QString valueText = QString("%1").arg(register_value, mRegisterPlaces[register_selected].valuesize, 16, QChar('0')).toUpper();
+    QString newText = QString("");
+
+    Annotation annotation = cache.getSymbol(register_value);
+
+    if(annotation.hasLabel && annotation.hasModule)
     {
-        newText = "<" + QString(module_text) + "." + QString(label_text) + ">";
+        newText = "<" + annotation.module + "." + annotation.label + ">";
     }
-    else if(hasModule)
+    else if(annotation.hasModule)
     {
-        newText = QString(module_text) + "." + valueText;
+        newText = annotation.module + "." + valueText;
     }
-    else if(hasLabel)
+    else if(annotation.hasLabel)
     {
-        newText = "<" + QString(label_text) + ">";
+        newText = "<" + annotation.label + ">";
     }
     else if(!mONLYMODULEANDLABELDISPLAY.contains(register_selected))
     {
@@ -1435,6 +1477,10 @@ QString RegistersView::getRegisterLabel(REGISTER_NAME register_selected)
         }
     }
 
+    RegisterLabel label;
+    label.value = register_value;
+    label.text = newText;
+    mRegisterLabels.insert(register_selected, label);
     return newText;
 }
 
@@ -133,6 +133,7 @@ protected:
 
 protected slots:
     void fontsUpdatedSlot();
+    void boolsUpdatedSlot();
     void onIncrementAction();
     void onDecrementAction();
     void onIncrementx87StackAction();
@@ -243,6 +244,19 @@ private:
     QAction* wCM_ChangeFPUView;
     QAction* wCM_Highlight;
     dsint mCip;
+    // label/module annotation of a register value, valid for the symbol generation mLabelGeneration
+    struct RegisterLabel
+    {
+        duint value;
+        QString text;
+    };
+    QMap<REGISTER_NAME, RegisterLabel> mRegisterLabels;
+    duint mLabelGeneration;
+    // Paint statistics
+    bool mPaintStatistics;
+    qint64 mPaintTime;
+    int mPaintCount;
+    void updatePaintStatistics(qint64 nsecs);
 };
 
 #endif // REGISTERSVIEW_H
@@ -230,27 +230,7 @@ void SymbolView::clearSymbolLogSlot()
 
 void SymbolView::cbSymbolEnum(SYMBOLINFO* symbol, void* user)
 {
-    StdTable* symbolList = (StdTable*)user;
-    dsint index = symbolList->getRowCount();
-    symbolList->setRowCount(index + 1);
-    symbolList->setCellContent(index, 0, QString("%1").arg(symbol->addr, sizeof(dsint) * 2, 16, QChar('0')).toUpper());
-    if(symbol->decoratedSymbol)
-    {
-        symbolList->setCellContent(index, 2, symbol->decoratedSymbol);
-    }
-    if(symbol->undecoratedSymbol)
-    {
-        symbolList->setCellContent(index, 3, symbol->undecoratedSymbol);
-    }
-
-    if(symbol->isImported)
-    {
-        symbolList->setCellContent(index, 1, tr("Import"));
-    }
-    else
-    {
-        symbolList->setCellContent(index, 1, tr("Export"));
-    }
+    ((SymbolColumns*)user)->add(symbol->addr, symbol->decoratedSymbol, symbol->undecoratedSymbol, symbol->isImported);
 }
 
 void SymbolView::moduleSelectionChanged(int index)
@@ -258,15 +238,24 @@ void SymbolView::moduleSelectionChanged(int index)
     Q_UNUSED(index);
     setUpdatesEnabled(false);
 
-    mSearchListView->mList->setRowCount(0);
+    SymbolColumns columns;
+    columns.importText = tr("Import");
+    columns.exportText = tr("Export");
     for(auto index : mModuleList->mCurList->getSelection())
     {
         QString mod = mModuleList->mCurList->getCellContent(index, 1);
         if(!mModuleBaseList.count(mod))
             continue;
-        DbgSymbolEnumFromCache(mModuleBaseList[mod], cbSymbolEnum, mSearchListView->mList);
+        DbgSymbolEnumFromCache(mModuleBaseList[mod], cbSymbolEnum, &columns);
     }
-    mSearchListView->mList->reloadData();
+    auto symbolList = mSearchListView->mList;
+    symbolList->setRowCount(0);
+    symbolList->setRowCount(int(columns.address.size()));
+    symbolList->swapColumnContent(0, columns.address);
+    symbolList->swapColumnContent(1, columns.type);
+    symbolList->swapColumnContent(2, columns.decorated);
+    symbolList->swapColumnContent(3, columns.undecorated);
+    symbolList->reloadData();
     mSearchListView->mList->setSingleSelection(0);
     mSearchListView->mList->setTableOffset(0);
     if(!mSearchListView->isSearchBoxLocked())
@@ -2,7 +2,9 @@
 #define SYMBOLVIEW_H
 
 #include <QWidget>
+#include <vector>
 #include "Bridge.h"
+#include "SymbolColumns.h"
 
 class QMenu;
 class SearchListView;
@@ -79,6 +81,7 @@ private:
     QAction* mModSetPartyAction;
     QAction* mBrowseInExplorer;
 
+    //the symbols of the selected modules, collected per column and moved into the list at once
     static void cbSymbolEnum(SYMBOLINFO* symbol, void* user);
 };
 
@@ -51,11 +51,11 @@ void CharCommand::redo()
         _xData->insert(_charPos, _newChar);
         break;
     case replace:
-        _oldChar = _xData->data()[_charPos];
+        _oldChar = _xData->at(_charPos);
         _xData->replace(_charPos, _newChar);
         break;
     case remove:
-        _oldChar = _xData->data()[_charPos];
+        _oldChar = _xData->at(_charPos);
         _xData->remove(_charPos, 1);
         break;
     }
@@ -97,11 +97,11 @@ void ArrayCommand::redo()
         _xData->insert(_baPos, _newBa);
         break;
     case replace:
-        _oldBa = _xData->data().mid(_baPos, _len);
+        _oldBa = _xData->slice(_baPos, _len);
         _xData->replace(_baPos, _newBa);
         break;
     case remove:
-        _oldBa = _xData->data().mid(_baPos, _len);
+        _oldBa = _xData->slice(_baPos, _len);
         _xData->remove(_baPos, _len);
         break;
     }
@@ -3,8 +3,7 @@
 
 #include <QUndoCommand>
 #include <QByteArray>
-
-class XByteArray;
+#include "XByteArray.h"
 
 class CharCommand : public QUndoCommand
 {
@@ -46,7 +45,7 @@ private:
     int _len;
     QByteArray _wasChanged;
     QByteArray _newBa;
-    QByteArray _oldBa;
+    XByteArray _oldBa; //shares the pieces of the replaced or removed bytes
 };
 
 #endif // ARRAYCOMMAND_H
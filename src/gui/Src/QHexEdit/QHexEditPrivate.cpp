@@ -166,7 +166,7 @@ void QHexEditPrivate::fill(int index, const QByteArray & ba, const QByteArray &
     QByteArray fillMask = mask.repeated(repeat);
     fillMask.resize(dataSize);
     fillMask = fillMask.toHex();
-    QByteArray origData = _xData.data().mid(index).toHex();
+    QByteArray origData = _xData.mid(index).toHex();
     for(int i = 0; i < dataSize * 2; i++)
         if(fillMask[i] == '1')
             fillData[i] = origData[i];
@@ -455,8 +455,8 @@ void QHexEditPrivate::keyPressEvent(QKeyEvent* event)
         // Change content
         if(_xData.size() > 0)
         {
-            QByteArray hexMask = _xMask.data().mid(posBa, 1).toHex();
-            QByteArray hexValue = _xData.data().mid(posBa, 1).toHex();
+            QByteArray hexMask = _xMask.mid(posBa, 1).toHex();
+            QByteArray hexValue = _xData.mid(posBa, 1).toHex();
             if(key == '?') //wildcard
             {
                 if((charX % 3) == 0)
@@ -490,8 +490,8 @@ void QHexEditPrivate::keyPressEvent(QKeyEvent* event)
         QString result;
         for(int idx = getSelectionBegin(); idx < getSelectionEnd(); idx++)
         {
-            QString byte = _xData.data().mid(idx, 1).toHex();
-            QString mask = _xMask.data().mid(idx, 1).toHex();
+            QString byte = _xData.mid(idx, 1).toHex();
+            QString mask = _xMask.mid(idx, 1).toHex();
             if(mask[0] == '1')
                 result += "?";
             else
@@ -624,10 +624,10 @@ void QHexEditPrivate::keyPressEvent(QKeyEvent* event)
         QString result;
         for(int idx = getSelectionBegin(); idx < getSelectionEnd(); idx++)
         {
-            QString byte = _xData.data().mid(idx, 1).toHex();
+            QString byte = _xData.mid(idx, 1).toHex();
             if(!byte.length())
                 break;
-            QString mask = _xMask.data().mid(idx, 1).toHex();
+            QString mask = _xMask.mid(idx, 1).toHex();
             if(mask[0] == '1')
                 result += "?";
             else
@@ -700,10 +700,10 @@ void QHexEditPrivate::paintEvent(QPaintEvent* event)
     int yPosStart = ((firstLineIdx) / BYTES_PER_LINE) * _charHeight + _charHeight;
 
     // paint hex area
-    QByteArray hexBa(_xData.data().mid(firstLineIdx, lastLineIdx - firstLineIdx + 1).toHex());
+    QByteArray hexBa(_xData.mid(firstLineIdx, lastLineIdx - firstLineIdx + 1).toHex());
     if(_wildcardEnabled)
     {
-        QByteArray hexMask(_xMask.data().mid(firstLineIdx, lastLineIdx - firstLineIdx + 1).toHex());
+        QByteArray hexMask(_xMask.mid(firstLineIdx, lastLineIdx - firstLineIdx + 1).toHex());
         for(int i = 0; i < hexBa.size(); i++)
             if(hexMask[i] == '1')
                 hexBa[i] = '?';
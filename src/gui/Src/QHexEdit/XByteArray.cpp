@@ -1,61 +1,272 @@
 #include "XByteArray.h"
 
-XByteArray::XByteArray()
+static unsigned int piecePriority()
 {
+    static unsigned int state = 0x9E3779B9;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
 }
 
-QByteArray & XByteArray::data()
+XByteArray::XByteArray() : _dataValid(true)
 {
+}
+
+QByteArray XByteArray::data() const
+{
+    if(!_dataValid)
+    {
+        _data = QByteArray(size(), Qt::Uninitialized);
+        copyTo(_root, 0, _data.size(), _data.data());
+        _dataValid = true;
+    }
     return _data;
 }
 
 void XByteArray::setData(const QByteArray & data)
 {
+    _root = data.isEmpty() ? PiecePtr() : makePiece(data, 0, data.size());
     _data = data;
+    _dataValid = true;
 }
 
-int XByteArray::size()
+int XByteArray::size() const
 {
-    return _data.size();
+    return total(_root);
 }
 
-QByteArray & XByteArray::insert(int i, char ch)
+char XByteArray::at(int i) const
 {
-    _data.insert(i, ch);
-    return _data;
+    PiecePtr piece = _root;
+    while(piece)
+    {
+        int leftTotal = total(piece->left);
+        if(i < leftTotal)
+            piece = piece->left;
+        else if(i < leftTotal + piece->length)
+            return piece->buffer.at(piece->offset + i - leftTotal);
+        else
+        {
+            i -= leftTotal + piece->length;
+            piece = piece->right;
+        }
+    }
+    return 0;
 }
 
-QByteArray & XByteArray::insert(int i, const QByteArray & ba)
+QByteArray XByteArray::mid(int pos, int len) const
 {
-    _data.insert(i, ba);
-    return _data;
+    int size = this->size();
+    if(pos < 0)
+        pos = 0;
+    if(pos >= size)
+        return QByteArray();
+    if(len < 0 || len > size - pos)
+        len = size - pos;
+    if(_dataValid || len == size)
+        return data().mid(pos, len);
+    QByteArray result(len, Qt::Uninitialized);
+    copyTo(_root, pos, len, result.data());
+    return result;
 }
 
-QByteArray & XByteArray::remove(int i, int len)
+XByteArray XByteArray::slice(int pos, int len) const
 {
-    _data.remove(i, len);
-    return _data;
+    XByteArray result;
+    PiecePtr left, middle, right;
+    split(_root, pos, left, middle);
+    split(middle, len, middle, right);
+    result.setRoot(middle);
+    return result;
 }
 
-QByteArray & XByteArray::replace(int index, char ch)
+void XByteArray::insert(int i, char ch)
 {
-    _data[index] = ch;
-    return _data;
+    insert(i, QByteArray(1, ch));
+}
+
+void XByteArray::insert(int i, const QByteArray & ba)
+{
+    XByteArray xba;
+    xba.setData(ba);
+    insert(i, xba);
 }
 
-QByteArray & XByteArray::replace(int index, const QByteArray & ba)
+void XByteArray::insert(int i, const XByteArray & xba)
+{
+    if(i < 0 || !xba.size())
+        return;
+    int size = this->size();
+    if(i > size) //like QByteArray, pad with spaces
+    {
+        setRoot(merge(_root, makePiece(QByteArray(i - size, ' '), 0, i - size)));
+        size = i;
+    }
+    PiecePtr left, right;
+    split(_root, i, left, right);
+    setRoot(merge(merge(left, xba._root), right));
+}
+
+void XByteArray::remove(int pos, int len)
+{
+    int size = this->size();
+    if(pos < 0 || len <= 0 || pos >= size)
+        return;
+    if(len > size - pos)
+        len = size - pos;
+    PiecePtr left, middle, right;
+    split(_root, pos, left, middle);
+    split(middle, len, middle, right);
+    setRoot(merge(left, right));
+}
+
+void XByteArray::replace(int index, char ch)
+{
+    if(index < 0)
+        return;
+    int size = this->size();
+    if(index >= size) //like QByteArray::operator[], grow the array
+        insert(size, QByteArray(index - size + 1, char(0)));
+    remove(index, 1);
+    insert(index, ch);
+}
+
+void XByteArray::replace(int index, const QByteArray & ba)
 {
     int len = ba.length();
-    return replace(index, len, ba);
+    replace(index, len, ba);
 }
 
-QByteArray & XByteArray::replace(int index, int length, const QByteArray & ba)
+void XByteArray::replace(int index, int length, const QByteArray & ba)
 {
     int len;
-    if((index + length) > _data.length())
-        len = _data.length() - index;
+    if((index + length) > size())
+        len = size() - index;
     else
         len = length;
-    _data.replace(index, len, ba.mid(0, len));
-    return _data;
+    remove(index, len);
+    insert(index, ba.mid(0, len));
+}
+
+void XByteArray::replace(int index, const XByteArray & xba)
+{
+    int len = xba.size();
+    if((index + len) > size())
+        len = size() - index;
+    remove(index, len);
+    insert(index, xba.slice(0, len));
+}
+
+void XByteArray::setRoot(const PiecePtr & root)
+{
+    _root = root;
+    _data.clear();
+    _dataValid = !_root;
+}
+
+int XByteArray::total(const PiecePtr & piece)
+{
+    return piece ? piece->total : 0;
+}
+
+XByteArray::PiecePtr XByteArray::makePiece(const QByteArray & buffer, int offset, int length)
+{
+    auto piece = std::make_shared<Piece>();
+    piece->buffer = buffer;
+    piece->offset = offset;
+    piece->length = length;
+    piece->total = length;
+    piece->priority = piecePriority();
+    return piece;
+}
+
+// Pieces are never modified, an edit copies the pieces on the path to the change
+XByteArray::PiecePtr XByteArray::copyPiece(const PiecePtr & piece, const PiecePtr & left, const PiecePtr & right)
+{
+    auto copy = std::make_shared<Piece>(*piece);
+    copy->left = left;
+    copy->right = right;
+    copy->total = total(left) + piece->length + total(right);
+    return copy;
+}
+
+XByteArray::PiecePtr XByteArray::merge(const PiecePtr & left, const PiecePtr & right)
+{
+    if(!left)
+        return right;
+    if(!right)
+        return left;
+    if(left->priority > right->priority)
+        return copyPiece(left, left->left, merge(left->right, right));
+    return copyPiece(right, merge(left, right->left), right->right);
+}
+
+// left receives the first pos bytes, right the rest (a piece containing pos is cut in two)
+void XByteArray::split(const PiecePtr & piece, int pos, PiecePtr & left, PiecePtr & right)
+{
+    if(pos <= 0 || !piece)
+    {
+        PiecePtr all = piece;
+        left = PiecePtr();
+        right = all;
+        return;
+    }
+    if(pos >= piece->total)
+    {
+        PiecePtr all = piece;
+        left = all;
+        right = PiecePtr();
+        return;
+    }
+    PiecePtr l, r;
+    int leftTotal = total(piece->left);
+    if(pos <= leftTotal)
+    {
+        split(piece->left, pos, l, r);
+        right = copyPiece(piece, r, piece->right);
+        left = l;
+    }
+    else if(pos >= leftTotal + piece->length)
+    {
+        split(piece->right, pos - leftTotal - piece->length, l, r);
+        left = copyPiece(piece, piece->left, l);
+        right = r;
+    }
+    else
+    {
+        int cut = pos - leftTotal;
+        l = merge(piece->left, makePiece(piece->buffer, piece->offset, cut));
+        r = merge(makePiece(piece->buffer, piece->offset + cut, piece->length - cut), piece->right);
+        left = l;
+        right = r;
+    }
+}
+
+void XByteArray::copyTo(const PiecePtr & piece, int pos, int len, char* dest)
+{
+    const Piece* current = piece.get();
+    while(current && len > 0)
+    {
+        int leftTotal = total(current->left);
+        if(pos < leftTotal)
+        {
+            int count = qMin(len, leftTotal - pos);
+            copyTo(current->left, pos, count, dest);
+            dest += count;
+            pos += count;
+            len -= count;
+        }
+        int inPiece = pos - leftTotal;
+        if(len > 0 && inPiece < current->length)
+        {
+            int count = qMin(len, current->length - inPiece);
+            memcpy(dest, current->buffer.constData() + current->offset + inPiece, count);
+            dest += count;
+            pos += count;
+            len -= count;
+        }
+        pos -= leftTotal + current->length;
+        current = current->right.get();
+    }
 }
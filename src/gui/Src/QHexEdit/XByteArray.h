@@ -2,27 +2,60 @@
 #define XBYTEARRAY_H
 
 #include <QByteArray>
+#include <memory>
 
+// Piece table over implicitly shared QByteArrays. The pieces are kept in a persistent treap
+// ordered by position, so edits are O(log n) and copies/slices share the unchanged pieces.
 class XByteArray
 {
 public:
     explicit XByteArray();
 
-    QByteArray & data();
+    QByteArray data() const;
     void setData(const QByteArray & data);
-    int size();
+    int size() const;
 
-    QByteArray & insert(int i, char ch);
-    QByteArray & insert(int i, const QByteArray & ba);
+    char at(int i) const;
+    QByteArray mid(int pos, int len = -1) const;
+    XByteArray slice(int pos, int len) const;
 
-    QByteArray & remove(int pos, int len);
+    void insert(int i, char ch);
+    void insert(int i, const QByteArray & ba);
+    void insert(int i, const XByteArray & xba);
 
-    QByteArray & replace(int index, char ch);
-    QByteArray & replace(int index, const QByteArray & ba);
-    QByteArray & replace(int index, int length, const QByteArray & ba);
+    void remove(int pos, int len);
+
+    void replace(int index, char ch);
+    void replace(int index, const QByteArray & ba);
+    void replace(int index, int length, const QByteArray & ba);
+    void replace(int index, const XByteArray & xba);
 
 private:
-    QByteArray _data; //raw byte array
+    struct Piece;
+    typedef std::shared_ptr<const Piece> PiecePtr;
+
+    struct Piece
+    {
+        QByteArray buffer; //shared with the other pieces that were cut from the same data
+        int offset;
+        int length;
+        int total; //length of the subtree
+        unsigned int priority;
+        PiecePtr left;
+        PiecePtr right;
+    };
+
+    PiecePtr _root;
+    mutable QByteArray _data; //flattened contents, only built when data() is called
+    mutable bool _dataValid;
+
+    void setRoot(const PiecePtr & root);
+    static int total(const PiecePtr & piece);
+    static PiecePtr makePiece(const QByteArray & buffer, int offset, int length);
+    static PiecePtr copyPiece(const PiecePtr & piece, const PiecePtr & left, const PiecePtr & right);
+    static PiecePtr merge(const PiecePtr & left, const PiecePtr & right);
+    static void split(const PiecePtr & piece, int pos, PiecePtr & left, PiecePtr & right);
+    static void copyTo(const PiecePtr & piece, int pos, int len, char* dest);
 };
 
 #endif // XBYTEARRAY_H
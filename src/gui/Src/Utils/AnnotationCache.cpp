@@ -0,0 +1,131 @@
+#include "AnnotationCache.h"
+#include "Bridge.h"
+
+static const int MaxCachedValues = 0x4000;
+
+AnnotationCache::AnnotationCache(QObject* parent)
+    : QObject(parent),
+      mSymbolGeneration(duint(-1)),
+      mMemoryGeneration(0),
+      mHits(0),
+      mMisses(0)
+{
+    // Every pause and every memory/register edit refreshes these views
+    connect(Bridge::getBridge(), SIGNAL(updateRegisters()), this, SLOT(invalidateMemory()));
+    connect(Bridge::getBridge(), SIGNAL(updateDump()), this, SLOT(invalidateMemory()));
+    connect(Bridge::getBridge(), SIGNAL(dbgStateChanged(DBGSTATE)), this, SLOT(invalidateMemory()));
+}
+
+// Created by the CPU views on the GUI thread before the info box worker uses it
+AnnotationCache & AnnotationCache::instance()
+{
+    static AnnotationCache* cache = new AnnotationCache(Bridge::getBridge());
+    return *cache;
+}
+
+void AnnotationCache::invalidateMemory()
+{
+    mStrings.clear();
+    mMemoryGeneration++;
+}
+
+// mSymbolLock is held
+void AnnotationCache::validateSymbols()
+{
+    duint generation = DbgFunctions()->SymbolStateGetGeneration();
+    if(generation != mSymbolGeneration || mSymbols.size() > MaxCachedValues)
+    {
+        mSymbols.clear();
+        mSymbolGeneration = generation;
+    }
+}
+
+duint AnnotationCache::generation()
+{
+    QMutexLocker locker(&mSymbolLock);
+    validateSymbols();
+    return mSymbolGeneration + mMemoryGeneration;
+}
+
+duint AnnotationCache::symbolGeneration()
+{
+    QMutexLocker locker(&mSymbolLock);
+    validateSymbols();
+    return mSymbolGeneration;
+}
+
+AnnotationCache::SymbolEntry AnnotationCache::symbol(duint value)
+{
+    duint generation;
+    {
+        QMutexLocker locker(&mSymbolLock);
+        validateSymbols();
+        auto found = mSymbols.constFind(value);
+        if(found != mSymbols.constEnd())
+        {
+            mHits++;
+            return found.value();
+        }
+        mMisses++;
+        generation = mSymbolGeneration;
+    }
+
+    // The other thread does not wait for the bridge, the entry is dropped if the symbols changed in the meantime
+    char label[MAX_LABEL_SIZE] = "";
+    char module[MAX_MODULE_SIZE] = "";
+    SymbolEntry entry;
+    entry.hasLabel = DbgGetLabelAt(value, SEG_DEFAULT, label);
+    entry.hasModule = DbgGetModuleAt(value, module);
+    entry.label = label;
+    entry.module = module;
+    QMutexLocker locker(&mSymbolLock);
+    if(generation == mSymbolGeneration)
+        mSymbols.insert(value, entry);
+    return entry;
+}
+
+const AnnotationCache::StringEntry & AnnotationCache::string(duint value)
+{
+    if(mStrings.size() > MaxCachedValues)
+        mStrings.clear();
+    auto found = mStrings.find(value);
+    QMutexLocker locker(&mSymbolLock);
+    if(found != mStrings.end())
+    {
+        mHits++;
+        return found.value();
+    }
+    mMisses++;
+    locker.unlock();
+    char text[MAX_STRING_SIZE] = "";
+    StringEntry entry;
+    entry.hasString = DbgGetStringAt(value, text);
+    entry.string = text;
+    return mStrings.insert(value, entry).value();
+}
+
+Annotation AnnotationCache::get(duint value)
+{
+    Annotation annotation = getSymbol(value);
+    annotation.hasString = getString(value, annotation.string);
+    return annotation;
+}
+
+Annotation AnnotationCache::getSymbol(duint value)
+{
+    SymbolEntry entry = symbol(value);
+    Annotation annotation;
+    annotation.hasString = false;
+    annotation.hasLabel = entry.hasLabel;
+    annotation.hasModule = entry.hasModule;
+    annotation.label = entry.label;
+    annotation.module = entry.module;
+    return annotation;
+}
+
+bool AnnotationCache::getString(duint value, QString & string)
+{
+    const StringEntry & entry = this->string(value);
+    string = entry.string;
+    return entry.hasString;
+}
@@ -0,0 +1,84 @@
+#ifndef ANNOTATIONCACHE_H
+#define ANNOTATIONCACHE_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include "Imports.h"
+
+// String, label and module of a value, as shown next to registers and stack/dump values
+struct Annotation
+{
+    bool hasString;
+    bool hasLabel;
+    bool hasModule;
+    QString string;
+    QString label;
+    QString module;
+};
+
+// Annotations shared by the CPU views. Labels and modules are kept until the memory map, the labels or the
+// loaded symbols change, strings until the debuggee ran or the memory was edited. The labels and modules
+// (getSymbol, symbolGeneration) can also be read from the CPU info box worker, the rest is GUI thread only.
+class AnnotationCache : public QObject
+{
+    Q_OBJECT
+public:
+    static AnnotationCache & instance();
+
+    Annotation get(duint value);
+    // Only the label and module of get()
+    Annotation getSymbol(duint value);
+    // Only the string of get()
+    bool getString(duint value, QString & string);
+    // Changes whenever cached annotations might be stale
+    duint generation();
+    // Changes when the labels and modules might be stale (not on every pause)
+    duint symbolGeneration();
+
+    unsigned long long hits() const
+    {
+        QMutexLocker locker(&mSymbolLock);
+        return mHits;
+    }
+
+    unsigned long long misses() const
+    {
+        QMutexLocker locker(&mSymbolLock);
+        return mMisses;
+    }
+
+public slots:
+    void invalidateMemory();
+
+private:
+    explicit AnnotationCache(QObject* parent = 0);
+    void validateSymbols();
+
+    struct SymbolEntry
+    {
+        bool hasLabel;
+        bool hasModule;
+        QString label;
+        QString module;
+    };
+
+    struct StringEntry
+    {
+        bool hasString;
+        QString string;
+    };
+
+    SymbolEntry symbol(duint value);
+    const StringEntry & string(duint value);
+
+    mutable QMutex mSymbolLock; //mSymbols, mSymbolGeneration and the counters
+    QHash<duint, SymbolEntry> mSymbols;
+    QHash<duint, StringEntry> mStrings;
+    duint mSymbolGeneration;
+    duint mMemoryGeneration;
+    unsigned long long mHits;
+    unsigned long long mMisses;
+};
+
+#endif // ANNOTATIONCACHE_H
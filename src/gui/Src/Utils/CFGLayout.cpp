@@ -0,0 +1,403 @@
+#include "CFGLayout.h"
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <unordered_set>
+
+void CFGLayout::Edge::addPoint(int row, int col, int index)
+{
+    Point point;
+    point.row = row;
+    point.col = col;
+    point.index = 0;
+    this->points.push_back(point);
+    if(int(this->points.size()) > 1)
+        this->points[this->points.size() - 2].index = index;
+}
+
+template<class T>
+static void initVec(std::vector<T> & vec, size_t size, T value)
+{
+    vec.resize(size);
+    for(size_t i = 0; i < size; i++)
+        vec[i] = value;
+}
+
+void CFGLayout::computeGraphLayout(Block & block)
+{
+    //Walk the tree in pre-order without recursion
+    std::vector<std::pair<duint, Block*>> order;
+    std::vector<std::pair<duint, Block*>> stack;
+    stack.push_back({block.entry, &block});
+    while(!stack.empty())
+    {
+        auto node = stack.back();
+        stack.pop_back();
+        order.push_back(node);
+        for(duint edge : node.second->new_exits)
+            stack.push_back({edge, &this->blocks[edge]});
+    }
+
+    //Compute child node layouts bottom up and arrange them horizontally, relative to their parent
+    std::unordered_map<duint, int> offset;
+    for(auto it = order.rbegin(); it != order.rend(); ++it)
+    {
+        Block & node = *it->second;
+        int col = 0;
+        int row_count = 1;
+        for(duint edge : node.new_exits)
+        {
+            Block & child = this->blocks[edge];
+            offset[edge] = col;
+            col += child.col_count;
+            if((child.row_count + 1) > row_count)
+                row_count = child.row_count + 1;
+        }
+
+        node.row = 0;
+        if(col >= 2)
+        {
+            //Place this node centered over the child nodes
+            node.col = (col - 2) / 2;
+            node.col_count = col;
+        }
+        else
+        {
+            //No child nodes, set single node's width (nodes are 2 columns wide to allow
+            //centering over a branch)
+            node.col = 0;
+            node.col_count = 2;
+        }
+        node.row_count = row_count;
+    }
+
+    //Move the subtrees to their absolute position top down
+    std::unordered_map<duint, int> base;
+    base[order.front().first] = 0;
+    for(auto & it : order)
+    {
+        Block & node = *it.second;
+        int nodeBase = base[it.first];
+        for(duint edge : node.new_exits)
+        {
+            base[edge] = nodeBase + offset[edge];
+            this->blocks[edge].row = node.row + 1;
+        }
+        node.col += nodeBase;
+    }
+}
+
+int CFGLayout::findEdgeIndex(EdgesVector & edges, int line, int min, int max)
+{
+    //Find the lowest index no overlapping edge line uses
+    std::vector<bool> used;
+    for(const EdgeLine & other : edges[line])
+    {
+        if(other.max < min || other.min > max)
+            continue;
+        if(int(used.size()) <= other.index)
+            used.resize(other.index + 1, false);
+        used[other.index] = true;
+    }
+    int i = 0;
+    while(i < int(used.size()) && used[i])
+        i++;
+
+    //Mark chosen index as used
+    EdgeLine edge;
+    edge.min = min;
+    edge.max = max;
+    edge.index = i;
+    edges[line].push_back(edge);
+    return i;
+}
+
+CFGLayout::Edge CFGLayout::routeEdge(EdgesVector & horiz_edges, EdgesVector & vert_edges, Matrix<bool> & edge_valid, Block & start, Block & end)
+{
+    Edge edge;
+    edge.dest = end.entry;
+
+    //Find edge index for initial outgoing line
+    int i = this->findEdgeIndex(vert_edges, start.col + 1, start.row + 1, start.row + 1);
+    edge.addPoint(start.row + 1, start.col + 1);
+    edge.start_index = i;
+    bool horiz = false;
+
+    //Find valid column for moving vertically to the target node
+    int min_row, max_row;
+    if(end.row < (start.row + 1))
+    {
+        min_row = end.row;
+        max_row = start.row + 1;
+    }
+    else
+    {
+        min_row = start.row + 1;
+        max_row = end.row;
+    }
+    int col = start.col + 1;
+    if(min_row != max_row)
+    {
+        int ofs = 0;
+        while(true)
+        {
+            col = start.col + 1 - ofs;
+            if(col >= 0)
+            {
+                bool valid = true;
+                for(int row = min_row; row < max_row + 1; row++)
+                {
+                    if(!edge_valid[row][col])
+                    {
+                        valid = false;
+                        break;
+                    }
+                }
+                if(valid)
+                    break;
+            }
+
+            col = start.col + 1 + ofs;
+            if(col < int(edge_valid[min_row].size()))
+            {
+                bool valid = true;
+                for(int row = min_row; row < max_row + 1; row++)
+                {
+                    if(!edge_valid[row][col])
+                    {
+                        valid = false;
+                        break;
+                    }
+                }
+                if(valid)
+                    break;
+            }
+
+            ofs += 1;
+        }
+    }
+
+    if(col != (start.col + 1))
+    {
+        //Not in same column, need to generate a line for moving to the correct column
+        int min_col, max_col;
+        if(col < (start.col + 1))
+        {
+            min_col = col;
+            max_col = start.col + 1;
+        }
+        else
+        {
+            min_col = start.col + 1;
+            max_col = col;
+        }
+        int index = this->findEdgeIndex(horiz_edges, start.row + 1, min_col, max_col);
+        edge.addPoint(start.row + 1, col, index);
+        horiz = true;
+    }
+
+    if(end.row != (start.row + 1))
+    {
+        //Not in same row, need to generate a line for moving to the correct row
+        int index = this->findEdgeIndex(vert_edges, col, min_row, max_row);
+        edge.addPoint(end.row, col, index);
+        horiz = false;
+    }
+
+    if(col != (end.col + 1))
+    {
+        //Not in ending column, need to generate a line for moving to the correct column
+        int min_col, max_col;
+        if(col < (end.col + 1))
+        {
+            min_col = col;
+            max_col = end.col + 1;
+        }
+        else
+        {
+            min_col = end.col + 1;
+            max_col = col;
+        }
+        int index = this->findEdgeIndex(horiz_edges, end.row, min_col, max_col);
+        edge.addPoint(end.row, end.col + 1, index);
+        horiz = true;
+    }
+
+    //If last line was horizontal, choose the ending edge index for the incoming edge
+    if(horiz)
+    {
+        int index = this->findEdgeIndex(vert_edges, end.col + 1, end.row, end.row);
+        edge.points[int(edge.points.size()) - 1].index = index;
+    }
+
+    return edge;
+}
+
+void CFGLayout::layout(duint entry)
+{
+    //Populate incoming lists
+    for(auto & blockIt : this->blocks)
+    {
+        Block & block = blockIt.second;
+        for(auto & edge : block.exits)
+            this->blocks[edge].incoming.push_back(block.entry);
+    }
+
+    //Construct acyclic graph where each node is used as an edge exactly once
+    //The incoming edge count of a node does not change before it is visited,
+    //so the candidate edges out of the visited nodes can be kept in a priority queue
+    typedef std::tuple<int, duint, duint> Candidate; //incoming edges, edge, parent
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates;
+    std::unordered_set<duint> visited;
+    auto addCandidates = [&](Block & block)
+    {
+        for(duint edge : block.exits)
+            if(!visited.count(edge))
+                candidates.push(Candidate(int(this->blocks[edge].incoming.size()), edge, block.entry));
+    };
+    visited.insert(entry);
+    std::queue<duint> queue;
+    queue.push(entry);
+    addCandidates(this->blocks[entry]);
+
+    while(true)
+    {
+        //First pick nodes that have single entry points
+        while(!queue.empty())
+        {
+            Block & block = this->blocks[queue.front()];
+            queue.pop();
+
+            for(duint edge : block.exits)
+            {
+                if(visited.count(edge))
+                    continue;
+
+                //If node has no more unseen incoming edges, add it to the graph layout now
+                if(int(this->blocks[edge].incoming.size()) == 1)
+                {
+                    block.new_exits.push_back(edge);
+                    queue.push(edge);
+                    visited.insert(edge);
+                    addCandidates(this->blocks[edge]);
+                }
+            }
+        }
+
+        //No more nodes satisfy constraints, pick the unvisited node with the least incoming edges to continue constructing the graph
+        while(!candidates.empty() && visited.count(std::get<1>(candidates.top())))
+            candidates.pop();
+        if(candidates.empty())
+            break;
+        duint best = std::get<1>(candidates.top());
+        duint best_parent = std::get<2>(candidates.top());
+        candidates.pop();
+        this->blocks[best_parent].new_exits.push_back(best);
+        visited.insert(best);
+        addCandidates(this->blocks[best]);
+    }
+
+    //Compute graph layout from bottom up
+    this->computeGraphLayout(this->blocks[entry]);
+
+    //Prepare edge routing
+    EdgesVector horiz_edges, vert_edges;
+    horiz_edges.resize(this->blocks[entry].row_count + 1);
+    vert_edges.resize(this->blocks[entry].col_count + 1);
+    Matrix<bool> edge_valid;
+    edge_valid.resize(this->blocks[entry].row_count + 1);
+    for(int row = 0; row < this->blocks[entry].row_count + 1; row++)
+        initVec(edge_valid[row], this->blocks[entry].col_count + 1, true);
+    for(auto & blockIt : this->blocks)
+    {
+        Block & block = blockIt.second;
+        edge_valid[block.row][block.col + 1] = false;
+    }
+
+    //Perform edge routing
+    for(auto & blockIt : this->blocks)
+    {
+        Block & block = blockIt.second;
+        Block & start = block;
+        for(duint edge : block.exits)
+        {
+            Block & end = this->blocks[edge];
+            start.edges.push_back(this->routeEdge(horiz_edges, vert_edges, edge_valid, start, end));
+        }
+    }
+
+    //Compute edge counts for each row and column
+    std::vector<int> col_edge_count, row_edge_count;
+    initVec(col_edge_count, this->blocks[entry].col_count + 1, 0);
+    initVec(row_edge_count, this->blocks[entry].row_count + 1, 0);
+    for(int row = 0; row < this->blocks[entry].row_count + 1; row++)
+    {
+        for(const EdgeLine & edge : horiz_edges[row])
+            if(edge.index + 1 > row_edge_count[row])
+                row_edge_count[row] = edge.index + 1;
+    }
+    for(int col = 0; col < this->blocks[entry].col_count + 1; col++)
+    {
+        for(const EdgeLine & edge : vert_edges[col])
+            if(edge.index + 1 > col_edge_count[col])
+                col_edge_count[col] = edge.index + 1;
+    }
+
+    //Compute row and column sizes
+    std::vector<int> col_width, row_height;
+    initVec(col_width, this->blocks[entry].col_count + 1, 0);
+    initVec(row_height, this->blocks[entry].row_count + 1, 0);
+    for(auto & blockIt : this->blocks)
+    {
+        Block & block = blockIt.second;
+        if((int(block.width / 2)) > col_width[block.col])
+            col_width[block.col] = int(block.width / 2);
+        if((int(block.width / 2)) > col_width[block.col + 1])
+            col_width[block.col + 1] = int(block.width / 2);
+        if(int(block.height) > row_height[block.row])
+            row_height[block.row] = int(block.height);
+    }
+
+    //Compute row and column positions
+    std::vector<int> col_x, row_y;
+    initVec(col_x, this->blocks[entry].col_count, 0);
+    initVec(row_y, this->blocks[entry].row_count, 0);
+    initVec(this->col_edge_x, this->blocks[entry].col_count + 1, 0);
+    initVec(this->row_edge_y, this->blocks[entry].row_count + 1, 0);
+    int x = 16;
+    for(int i = 0; i < this->blocks[entry].col_count; i++)
+    {
+        this->col_edge_x[i] = x;
+        x += 8 * col_edge_count[i];
+        col_x[i] = x;
+        x += col_width[i];
+    }
+    int y = 16;
+    for(int i = 0; i < this->blocks[entry].row_count; i++)
+    {
+        this->row_edge_y[i] = y;
+        y += 8 * row_edge_count[i];
+        row_y[i] = y;
+        y += row_height[i];
+    }
+    this->col_edge_x[this->blocks[entry].col_count] = x;
+    this->row_edge_y[this->blocks[entry].row_count] = y;
+    this->width = x + 16 + (8 * col_edge_count[this->blocks[entry].col_count]);
+    this->height = y + 16 + (8 * row_edge_count[this->blocks[entry].row_count]);
+
+    //Compute node positions
+    for(auto & blockIt : this->blocks)
+    {
+        Block & block = blockIt.second;
+        block.x = int(
+                      (col_x[block.col] + col_width[block.col] + 4 * col_edge_count[block.col + 1]) - (block.width / 2));
+        if((block.x + block.width) > (
+                    col_x[block.col] + col_width[block.col] + col_width[block.col + 1] + 8 * col_edge_count[
+                        block.col + 1]))
+        {
+            block.x = int((col_x[block.col] + col_width[block.col] + col_width[block.col + 1] + 8 * col_edge_count[
+                               block.col + 1]) - block.width);
+        }
+        block.y = row_y[block.row];
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef CFGLAYOUT_H
+#define CFGLAYOUT_H
+#include "Imports.h"
+#include <unordered_map>
+#include <vector>
+
+// Grid layout of a control flow graph, the part of DisassemblerGraphView that does not need Qt.
+// Every block takes two columns so it can be centered over a branch, edges are routed in the gaps between the rows and columns.
+class CFGLayout
+{
+public:
+    struct Point
+    {
+        int row; //point[0]
+        int col; //point[1]
+        int index; //point[2]
+    };
+
+    struct Edge
+    {
+        duint dest;
+        std::vector<Point> points;
+        int start_index = 0;
+
+        void addPoint(int row, int col, int index = 0);
+    };
+
+    struct Block
+    {
+        duint entry = 0;
+        std::vector<duint> exits;
+        int width = 0; //set by the caller
+        int height = 0; //set by the caller
+
+        std::vector<Edge> edges; //same order as the exits
+        std::vector<duint> incoming;
+        std::vector<duint> new_exits;
+        int x = 0;
+        int y = 0;
+        int col = 0;
+        int col_count = 0;
+        int row = 0;
+        int row_count = 0;
+    };
+
+    std::unordered_map<duint, Block> blocks;
+    std::vector<int> col_edge_x;
+    std::vector<int> row_edge_y;
+    int width = 0;
+    int height = 0;
+
+    // Places the blocks reachable from entry, every exit has to be a block
+    void layout(duint entry);
+
+private:
+    template<typename T>
+    using Matrix = std::vector<std::vector<T>>;
+
+    //Cells min to max of a row (horizontal) or column (vertical) taken by an edge line at index
+    struct EdgeLine
+    {
+        int min;
+        int max;
+        int index;
+    };
+    using EdgesVector = std::vector<std::vector<EdgeLine>>; //lines of every row or column
+
+    void computeGraphLayout(Block & block);
+    int findEdgeIndex(EdgesVector & edges, int line, int min, int max);
+    Edge routeEdge(EdgesVector & horiz_edges, EdgesVector & vert_edges, Matrix<bool> & edge_valid, Block & start, Block & end);
+};
+
+#endif // CFGLAYOUT_H
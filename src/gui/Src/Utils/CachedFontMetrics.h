@@ -4,6 +4,8 @@
 #include <QObject>
 #include <QFont>
 #include <QFontMetrics>
+#include <QCache>
+#include <QStaticText>
 
 class CachedFontMetrics : public QObject
 {
@@ -11,7 +13,11 @@ class CachedFontMetrics : public QObject
 public:
     explicit CachedFontMetrics(QObject* parent, const QFont & font)
         : QObject(parent),
-          mFontMetrics(font)
+          mFont(font),
+          mFontMetrics(font),
+          mTextCache(4096),
+          mTextHits(0),
+          mTextMisses(0)
     {
         memset(mWidths, 0, sizeof(mWidths));
         mHeight = mFontMetrics.height();
@@ -54,10 +60,42 @@ public:
         return mHeight;
     }
 
+    //laid out text runs, the color comes from the painter pen so it is not part of the key
+    const QStaticText & staticText(const QString & text)
+    {
+        auto cached = mTextCache.object(text);
+        if(cached)
+        {
+            mTextHits++;
+            return *cached;
+        }
+        mTextMisses++;
+        cached = new QStaticText(text);
+        cached->setTextFormat(Qt::PlainText);
+        cached->setPerformanceHint(QStaticText::AggressiveCaching);
+        cached->prepare(QTransform(), mFont);
+        mTextCache.insert(text, cached); //least recently used runs are evicted
+        return *cached;
+    }
+
+    unsigned int textCacheHits() const
+    {
+        return mTextHits;
+    }
+
+    unsigned int textCacheMisses() const
+    {
+        return mTextMisses;
+    }
+
 private:
+    QFont mFont;
     QFontMetrics mFontMetrics;
     uchar mWidths[0x10000 - 0xE000 + 0xD800];
     int mHeight;
+    QCache<QString, QStaticText> mTextCache;
+    unsigned int mTextHits;
+    unsigned int mTextMisses;
 };
 
 #endif // CACHEDFONTMETRICS_H
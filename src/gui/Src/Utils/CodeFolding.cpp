@@ -1,6 +1,8 @@
 #include "CodeFolding.h"
+#include <algorithm>
 
 CodeFoldingHelper::CodeFoldingHelper()
+    : dirty(true)
 {
 
 }
@@ -17,8 +19,8 @@ CodeFoldingHelper::~CodeFoldingHelper()
  */
 bool CodeFoldingHelper::isFoldStart(duint va) const
 {
-    const FoldTree* temp = getFoldTree(va);
-    return temp != nullptr && va == temp->range.first;
+    int node = findNode(va);
+    return node != -1 && va == nodes[node].start;
 }
 
 /**
@@ -28,7 +30,7 @@ bool CodeFoldingHelper::isFoldStart(duint va) const
  */
 bool CodeFoldingHelper::isFoldBody(duint va) const
 {
-    return root.find(Range(va, va)) != root.cend();
+    return findNode(va) != -1;
 }
 
 /**
@@ -38,8 +40,8 @@ bool CodeFoldingHelper::isFoldBody(duint va) const
  */
 bool CodeFoldingHelper::isFoldEnd(duint va) const
 {
-    const FoldTree* temp = getFoldTree(va);
-    return temp != nullptr && va == temp->range.second;
+    int node = findNode(va);
+    return node != -1 && va == nodes[node].end;
 }
 
 /**
@@ -49,8 +51,8 @@ bool CodeFoldingHelper::isFoldEnd(duint va) const
  */
 bool CodeFoldingHelper::isFolded(duint va) const
 {
-    const FoldTree* temp = getFoldTree(va);
-    return temp != nullptr && temp->folded;
+    int node = findNode(va);
+    return node != -1 && nodes[node].folded != -1;
 }
 
 /**
@@ -61,12 +63,7 @@ bool CodeFoldingHelper::isFolded(duint va) const
  */
 bool CodeFoldingHelper::isDataRangeFolded(duint vaStart, duint vaEnd) const
 {
-    CompareFunc less;
-    Range lower(vaStart, vaStart);
-    Range upper(vaEnd, vaEnd);
-    auto iteratorStart = root.upper_bound(lower);
-    auto iteratorEnd = root.lower_bound(upper);
-    return (iteratorStart != root.cend() && less(iteratorStart->first, upper)) && (iteratorEnd != root.cend() && less(lower, iteratorEnd->first));
+    return findNode(vaStart) != -1 || lowerNode(vaStart) < upperNode(vaEnd);
 }
 
 /**
@@ -76,8 +73,10 @@ bool CodeFoldingHelper::isDataRangeFolded(duint vaStart, duint vaEnd) const
  */
 duint CodeFoldingHelper::getFoldBegin(duint va) const
 {
-    const FoldTree* temp = getFirstFoldedTree(va);
-    return temp == nullptr ? 0 : temp->range.first;
+    int node = findNode(va);
+    if(node == -1)
+        return 0;
+    return nodes[nodes[node].folded != -1 ? nodes[node].folded : node].start;
 }
 
 /**
@@ -87,8 +86,10 @@ duint CodeFoldingHelper::getFoldBegin(duint va) const
  */
 duint CodeFoldingHelper::getFoldEnd(duint va) const
 {
-    const FoldTree* temp = getFirstFoldedTree(va);
-    return temp == nullptr ? 0 : temp->range.second;
+    int node = findNode(va);
+    if(node == -1)
+        return 0;
+    return nodes[nodes[node].folded != -1 ? nodes[node].folded : node].end;
 }
 
 /**
@@ -96,38 +97,19 @@ duint CodeFoldingHelper::getFoldEnd(duint va) const
  * @param vaStart  The beginning virtual address of the range.
  * @param vaEnd    The ending virtual address of the range.
  * @return   The total number bytes that are folded.
+ * @remark  Only the folded segments that start after vaStart and end before vaEnd are counted.
  */
 duint CodeFoldingHelper::getFoldedSize(duint vaStart, duint vaEnd) const
 {
-    CompareFunc less;
-    Range keyLower(vaStart, vaStart);
-    Range keyUpper(vaEnd, vaEnd);
-    duint size = 0;
-    auto iteratorLower = root.upper_bound(keyLower);
-    auto iteratorUpper = root.lower_bound(keyUpper);
-    if(iteratorLower == root.cend() || iteratorUpper == root.cend() || less(iteratorUpper->first, iteratorLower->first))
+    size_t first = upperNode(vaStart);
+    size_t last = upperNode(vaEnd);
+    // The folded segment that contains vaEnd extends past it, the nodes after it are nested in it
+    int node = findNode(vaEnd);
+    if(node != -1 && nodes[node].folded != -1)
+        last = std::min(last, size_t(nodes[node].folded));
+    if(last <= first)
         return 0;
-    for(auto i = iteratorLower; i != iteratorUpper; i ++)
-        size += getFoldedSize(&i->second);
-    return size;
-}
-
-/**
- * @brief    Internal. Get the total bytes that should be invisible due to code folding withing a code folding segment.
- * @param node The code folding segment.
- * @return   Number of bytes folded.
- */
-duint CodeFoldingHelper::getFoldedSize(const FoldTree* node) const
-{
-    if(node->folded)
-        return node->range.second - node->range.first;
-    else
-    {
-        duint size = 0;
-        for(auto i = node->children.cbegin(); i != node->children.cend(); i++)
-            size += getFoldedSize(&i->second);
-        return size;
-    }
+    return foldedSizes[last] - foldedSizes[first];
 }
 
 /**
@@ -137,9 +119,12 @@ duint CodeFoldingHelper::getFoldedSize(const FoldTree* node) const
  */
 void CodeFoldingHelper::setFolded(duint va, bool folded)
 {
-    FoldTree* temp = getFoldTree(va);
-    if(temp)
-        temp->folded = folded;
+    auto segment = findSegment(va);
+    if(segment != segments.end() && segment->second.folded != folded)
+    {
+        segment->second.folded = folded;
+        dirty = true;
+    }
 }
 
 /**
@@ -152,18 +137,27 @@ void CodeFoldingHelper::setFolded(duint va, bool folded)
  */
 bool CodeFoldingHelper::addFoldSegment(duint va, duint length, bool folded)
 {
-    FoldTree* temp = getFoldTree(va);
-    FoldTree* temp2 = getFoldTree(va + length);
-    if(temp != temp2)
-        return false;
-    if(isDataRangeFolded(va, va + length))
-    {
-        // There's some folded code inside the range
+    Range range(va, va + length);
+    if(range.second < range.first)
         return false;
-    }
-    auto map = (temp == nullptr) ? &root : &temp->children;
-    auto result = map->insert(std::make_pair(std::make_pair(va, va + length), FoldTree(folded, va, va + length)));
-    return result.second;
+    // Only the segments that contain the new one may start or end inside of it
+    for(auto i = segments.lower_bound(Range(range.first, duint(-1))); i != segments.end() && i->first.first <= range.second; ++i)
+        if(i->first.first != range.first || i->first.second <= range.second)
+            return false;
+    for(auto i = segmentEnds.lower_bound(range.first); i != segmentEnds.end() && i->first <= range.second; ++i)
+        if(i->first != range.second || i->second >= range.first)
+            return false;
+
+    Segment segment;
+    segment.folded = folded;
+    auto parent = findSegment(va);
+    segment.hasParent = parent != segments.end();
+    if(segment.hasParent)
+        segment.parent = parent->first;
+    segments.insert(std::make_pair(range, segment));
+    segmentEnds.insert(std::make_pair(range.second, range.first));
+    dirty = true;
+    return true;
 }
 
 /**
@@ -173,113 +167,138 @@ bool CodeFoldingHelper::addFoldSegment(duint va, duint length, bool folded)
  */
 bool CodeFoldingHelper::delFoldSegment(duint va)
 {
-    Range key(va, va);
-    auto temp1 = root.find(key);
-    if(temp1 == root.cend())
+    auto segment = findSegment(va);
+    if(segment == segments.end())
         return false;
-    auto parent = &root;
-    do
+    // The segments directly nested in it move up one level
+    for(auto i = std::next(segment); i != segments.end() && i->first.first <= segment->first.second; ++i)
+    {
+        if(i->second.hasParent && i->second.parent == segment->first)
+        {
+            i->second.hasParent = segment->second.hasParent;
+            i->second.parent = segment->second.parent;
+        }
+    }
+    auto ends = segmentEnds.equal_range(segment->first.second);
+    for(auto i = ends.first; i != ends.second; ++i)
     {
-        auto temp2 = temp1->second.children.find(key);
-        if(temp2 == temp1->second.children.cend())
+        if(i->second == segment->first.first)
+        {
+            segmentEnds.erase(i);
             break;
-        parent = &temp1->second.children;
-        temp1 = temp2;
+        }
     }
-    while(true);
-    parent->erase(temp1);
+    segments.erase(segment);
+    dirty = true;
     return true;
 }
 
-const CodeFoldingHelper::FoldTree* CodeFoldingHelper::getFoldTree(duint va) const
+/**
+ * @brief    Expands appropriate code folding segments so that the specified virtual address is unfolded.
+ * @param va The specified virtual address.
+ */
+void CodeFoldingHelper::expandFoldSegment(duint va)
 {
-    Range key(va, va);
-    auto temp1 = root.find(key);
-    if(temp1 == root.cend())
-        return nullptr;
-    do
+    auto segment = findSegment(va);
+    while(segment != segments.end())
     {
-        auto temp2 = temp1->second.children.find(key);
-        if(temp2 == temp1->second.children.cend())
+        if(segment->second.folded)
+        {
+            segment->second.folded = false;
+            dirty = true;
+        }
+        if(!segment->second.hasParent)
             break;
-        temp1 = temp2;
+        segment = segments.find(segment->second.parent);
     }
-    while(true);
-    return &temp1->second;
 }
 
-const CodeFoldingHelper::FoldTree* CodeFoldingHelper::getFirstFoldedTree(duint va) const
+/**
+ * @brief    Internal. Get the innermost code folding segment that contains va.
+ * @param va The virtual address.
+ * @return   The segment, or segments.end() if va is not inside a code folding segment.
+ */
+CodeFoldingHelper::SegmentMap::iterator CodeFoldingHelper::findSegment(duint va)
 {
-    Range key(va, va);
-    auto temp1 = root.find(key);
-    if(temp1 == root.cend())
-        return nullptr;
-    while(!temp1->second.folded)
+    // The last segment that starts at or before va, or one of the segments that contain it
+    auto segment = segments.upper_bound(Range(va, 0));
+    if(segment == segments.begin())
+        return segments.end();
+    --segment;
+    while(segment->first.second < va)
     {
-        auto temp2 = temp1->second.children.find(key);
-        if(temp2 == temp1->second.children.cend())
-            break;
-        temp1 = temp2;
+        if(!segment->second.hasParent)
+            return segments.end();
+        segment = segments.find(segment->second.parent);
     }
-    return &temp1->second;
+    return segment;
 }
 
-CodeFoldingHelper::FoldTree* CodeFoldingHelper::getFoldTree(duint va)
+/**
+ * @brief    Internal. Rebuild the flattened nodes and the folded size prefix sums after a change.
+ */
+void CodeFoldingHelper::update() const
 {
-    Range key(va, va);
-    auto temp1 = root.find(key);
-    if(temp1 == root.cend())
-        return nullptr;
-    do
+    if(!dirty)
+        return;
+    dirty = false;
+    nodes.clear();
+    nodes.reserve(segments.size());
+    foldedSizes.resize(segments.size() + 1);
+    foldedSizes[0] = 0;
+    std::vector<int> open; // the nodes that contain the current one
+    for(auto i = segments.cbegin(); i != segments.cend(); ++i)
     {
-        auto temp2 = temp1->second.children.find(key);
-        if(temp2 == temp1->second.children.cend())
-            break;
-        temp1 = temp2;
+        while(!open.empty() && nodes[open.back()].end < i->first.first)
+            open.pop_back();
+        Node node;
+        node.start = i->first.first;
+        node.end = i->first.second;
+        node.parent = open.empty() ? -1 : open.back();
+        node.folded = node.parent != -1 ? nodes[node.parent].folded : -1;
+        int index = int(nodes.size());
+        if(node.folded == -1 && i->second.folded)
+            node.folded = index;
+        foldedSizes[index + 1] = foldedSizes[index] + (node.folded == index ? node.end - node.start : 0);
+        nodes.push_back(node);
+        open.push_back(index);
     }
-    while(true);
-    return &temp1->second;
 }
 
-CodeFoldingHelper::FoldTree* CodeFoldingHelper::getFirstFoldedTree(duint va)
+/**
+ * @brief    Internal. Get the innermost node that contains va.
+ * @param va The virtual address.
+ * @return   The node index, or -1 if va is not inside a code folding segment.
+ */
+int CodeFoldingHelper::findNode(duint va) const
 {
-    Range key(va, va);
-    auto temp1 = root.find(key);
-    if(temp1 == root.cend())
-        return nullptr;
-    while(!temp1->second.folded)
+    int node = int(upperNode(va)) - 1;
+    while(node != -1 && nodes[node].end < va)
+        node = nodes[node].parent;
+    return node;
+}
+
+// Index of the first node that starts at or after va
+size_t CodeFoldingHelper::lowerNode(duint va) const
+{
+    update();
+    return std::lower_bound(nodes.cbegin(), nodes.cend(), va, [](const Node & node, duint value)
     {
-        auto temp2 = temp1->second.children.find(key);
-        if(temp2 == temp1->second.children.cend())
-            break;
-        temp1 = temp2;
-    }
-    return &temp1->second;
+        return node.start < value;
+    }) - nodes.cbegin();
 }
 
-/**
- * @brief    Expands appropriate code folding segments so that the specified virtual address is unfolded.
- * @param va The specified virtual address.
- */
-void CodeFoldingHelper::expandFoldSegment(duint va)
+// Index of the first node that starts after va
+size_t CodeFoldingHelper::upperNode(duint va) const
 {
-    Range key(va, va);
-    auto temp1 = root.find(key);
-    if(temp1 == root.cend())
-        return;
-    temp1->second.folded = false;
-    do
+    update();
+    return std::upper_bound(nodes.cbegin(), nodes.cend(), va, [](duint value, const Node & node)
     {
-        auto temp2 = temp1->second.children.find(key);
-        if(temp2 == temp1->second.children.cend())
-            break;
-        temp2->second.folded = false;
-        temp1 = temp2;
-    }
-    while(true);
+        return value < node.start;
+    }) - nodes.cbegin();
 }
 
-bool CodeFoldingHelper::CompareFunc::operator()(const CodeFoldingHelper::Range & lhs, const CodeFoldingHelper::Range & rhs) const
+bool CodeFoldingHelper::SegmentOrder::operator()(const CodeFoldingHelper::Range & lhs, const CodeFoldingHelper::Range & rhs) const
 {
-    return lhs.second < rhs.first;
+    return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second > rhs.second);
 }
@@ -2,6 +2,7 @@
 #define CODEFOLDING_H
 #include "Imports.h"
 #include <map>
+#include <vector>
 
 class CodeFoldingHelper
 {
@@ -24,27 +25,40 @@ public:
 
 protected:
     typedef std::pair<duint, duint> Range;
-    class CompareFunc
+    // Ordered by start and then by descending end, every segment comes right before the segments nested in it
+    class SegmentOrder
     {
     public:
         bool operator()(const Range & lhs, const Range & rhs) const;
     };
-    class FoldTree
+    struct Segment
     {
-    public:
-        FoldTree(bool _folded, duint start, duint end) : folded(_folded), range(std::make_pair(start, end)) {}
         bool folded;
-        Range range;
-        std::map<Range, FoldTree, CompareFunc> children;
+        bool hasParent;
+        Range parent; // innermost segment that contains this one
     };
+    typedef std::map<Range, Segment, SegmentOrder> SegmentMap;
+
+    SegmentMap segments;
+    std::multimap<duint, duint> segmentEnds; // end -> start
 
-    std::map<Range, FoldTree, CompareFunc> root;
+    // Flattened copy of the segments for the queries, rebuilt on the first query after a change
+    struct Node
+    {
+        duint start;
+        duint end;
+        int parent;
+        int folded; // outermost folded node that contains this one (itself included), -1 if there is none
+    };
+    mutable std::vector<Node> nodes;
+    mutable std::vector<duint> foldedSizes; // prefix sums of the bytes hidden by the outermost folded nodes
+    mutable bool dirty;
 
-    const FoldTree* getFoldTree(duint va) const;
-    FoldTree* getFoldTree(duint va);
-    const FoldTree* getFirstFoldedTree(duint va) const;
-    FoldTree* getFirstFoldedTree(duint va);
-    duint getFoldedSize(const FoldTree* node) const;
+    SegmentMap::iterator findSegment(duint va);
+    void update() const;
+    int findNode(duint va) const;
+    size_t lowerNode(duint va) const;
+    size_t upperNode(duint va) const;
 };
 
 #endif // CODEFOLDING_H
@@ -207,6 +207,7 @@ Configuration::Configuration() : QObject(), noMoreMsgbox(false)
     guiBool.insert("NoCloseDialog", false);
     guiBool.insert("PidInHex", true);
     guiBool.insert("SidebarWatchLabels", true);
+    guiBool.insert("PaintStatistics", false);
     defaultBools.insert("Gui", guiBool);
 
     QMap<QString, duint> guiUint;
@@ -539,6 +540,12 @@ void Configuration::readBools()
             currentBool[id] = boolFromConfig(category, id);
         }
     }
+    emit boolsUpdated();
+}
+
+void Configuration::emitBoolsUpdated()
+{
+    emit boolsUpdated();
 }
 
 void Configuration::writeBools()
@@ -712,6 +719,7 @@ void Configuration::setBool(const QString category, const QString id, const bool
         if(Bools[category].contains(id))
         {
             Bools[category][id] = b;
+            emit boolsUpdated();
             return;
         }
         if(noMoreMsgbox)
@@ -44,6 +44,7 @@ public:
     void emitTokenizerConfigUpdated();
     void readBools();
     void writeBools();
+    void emitBoolsUpdated();
     void readUints();
     void writeUints();
     void readFonts();
@@ -80,6 +81,7 @@ public:
 
 signals:
     void colorsUpdated();
+    void boolsUpdated();
     void fontsUpdated();
     void shortcutsUpdated();
     void tokenizerConfigUpdated();
@@ -0,0 +1,84 @@
+#ifndef INSTRUCTIONTOKENCACHE_H
+#define INSTRUCTIONTOKENCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <cstring>
+#include "Imports.h"
+
+// Tokenized instructions shared by all disassembler engines, an entry is valid while the bytes, the tokenizer
+// configuration and the symbol state generation are the same. GUI_GET_DISASSEMBLY disassembles on the debugger
+// thread, so every access takes the lock (tokenizing a missed instruction does not).
+template<typename Instruction>
+class InstructionTokenCache
+{
+public:
+    struct Entry
+    {
+        Instruction instruction;
+        int config;
+        bool fixedBranchDestination; //false if the destination depends on the registers
+    };
+
+    explicit InstructionTokenCache(int maxEntries)
+        : mMaxEntries(maxEntries),
+          mGeneration(0),
+          mHits(0),
+          mMisses(0)
+    {
+    }
+
+    // The entries are dropped when the generation changed, the instruction bytes are compared with data
+    bool find(duint generation, duint addr, int config, const unsigned char* data, duint size, Entry & entry)
+    {
+        QMutexLocker locker(&mLock);
+        if(generation != mGeneration)
+        {
+            mEntries.clear();
+            mGeneration = generation;
+        }
+        auto found = mEntries.constFind(addr);
+        if(found == mEntries.constEnd() || found->config != config || duint(found->instruction.dump.size()) > size ||
+                memcmp(found->instruction.dump.constData(), data, found->instruction.dump.size()) != 0)
+        {
+            mMisses++;
+            return false;
+        }
+        mHits++;
+        entry = found.value();
+        return true;
+    }
+
+    // The entry is not stored when the generation changed since it was looked up
+    void insert(duint generation, duint addr, const Entry & entry)
+    {
+        QMutexLocker locker(&mLock);
+        if(generation != mGeneration)
+            return;
+        if(mEntries.size() >= mMaxEntries)
+            mEntries.clear();
+        mEntries.insert(addr, entry);
+    }
+
+    unsigned long long hits()
+    {
+        QMutexLocker locker(&mLock);
+        return mHits;
+    }
+
+    unsigned long long misses()
+    {
+        QMutexLocker locker(&mLock);
+        return mMisses;
+    }
+
+private:
+    QMutex mLock;
+    QHash<duint, Entry> mEntries;
+    int mMaxEntries;
+    duint mGeneration;
+    unsigned long long mHits;
+    unsigned long long mMisses;
+};
+
+#endif // INSTRUCTIONTOKENCACHE_H
@@ -0,0 +1,96 @@
+#ifndef JUMPOFFSETTREE_H
+#define JUMPOFFSETTREE_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+// Segment tree over the lines with the largest jump offset of every range.
+// A new jump gets an offset larger than all offsets it covers, so raising the maximum of its range is enough.
+class JumpOffsetTree
+{
+public:
+    explicit JumpOffsetTree(int lines)
+        : size(1)
+    {
+        while(size < lines)
+            size *= 2;
+        maxOffset.resize(size * 2, 0);
+        rangeOffset.resize(size * 2, 0);
+    }
+
+    unsigned int query(int first, int last) const
+    {
+        return query(1, 0, size - 1, first, last);
+    }
+
+    void raise(int first, int last, unsigned int offset)
+    {
+        raise(1, 0, size - 1, first, last, offset);
+    }
+
+    // Gives every jump (line, destLine and jumpOffset members) a jump offset larger than the ones of the shorter jumps it
+    // overlaps. horizontalLines receives the offset of the last jump that starts or ends on every visible line.
+    template<typename Jump>
+    static void allocate(std::vector<Jump> & jumpLines, int lines, std::vector<unsigned int> & horizontalLines)
+    {
+        JumpOffsetTree verticalLines(lines); // jump offsets of the vertical jumping lines
+        horizontalLines.assign(lines, 0); // jump offsets of the horizontal jumping lines
+        // preprocessing
+        for(size_t i = 0; i < jumpLines.size(); i++)
+        {
+            Jump & jmp = jumpLines.at(i);
+            jmp.jumpOffset = abs(jmp.destLine - jmp.line);
+        }
+        // Sort jumpLines so that longer jumps are put at the back.
+        std::sort(jumpLines.begin(), jumpLines.end(), [](const Jump & op1, const Jump & op2)
+        {
+            return op2.jumpOffset > op1.jumpOffset;
+        });
+        // Allocate jump offsets
+        for(size_t i = 0; i < jumpLines.size(); i++)
+        {
+            Jump & jmp = jumpLines.at(i);
+            int first = std::max(std::min(jmp.line, jmp.destLine), 0);
+            int last = std::min(std::max(jmp.line, jmp.destLine), lines - 1);
+            jmp.jumpOffset = verticalLines.query(first, last) + 1;
+            verticalLines.raise(first, last, jmp.jumpOffset);
+            if(jmp.line >= 0 && jmp.line < lines)
+                horizontalLines[jmp.line] = jmp.jumpOffset;
+            if(jmp.destLine >= 0 && jmp.destLine < lines)
+                horizontalLines[jmp.destLine] = jmp.jumpOffset;
+        }
+    }
+
+private:
+    int size;
+    std::vector<unsigned int> maxOffset; // maximum of the node range
+    std::vector<unsigned int> rangeOffset; // offset raised over the whole node range
+
+    unsigned int query(int node, int left, int right, int first, int last) const
+    {
+        if(last < left || right < first)
+            return 0;
+        if(first <= left && right <= last)
+            return maxOffset[node];
+        int middle = (left + right) / 2;
+        return std::max(rangeOffset[node], std::max(query(node * 2, left, middle, first, last), query(node * 2 + 1, middle + 1, right, first, last)));
+    }
+
+    void raise(int node, int left, int right, int first, int last, unsigned int offset)
+    {
+        if(last < left || right < first)
+            return;
+        maxOffset[node] = std::max(maxOffset[node], offset);
+        if(first <= left && right <= last)
+        {
+            rangeOffset[node] = std::max(rangeOffset[node], offset);
+            return;
+        }
+        int middle = (left + right) / 2;
+        raise(node * 2, left, middle, first, last, offset);
+        raise(node * 2 + 1, middle + 1, right, first, last, offset);
+    }
+};
+
+#endif // JUMPOFFSETTREE_H
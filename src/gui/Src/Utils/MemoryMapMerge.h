@@ -0,0 +1,45 @@
+#ifndef MEMORYMAPMERGE_H
+#define MEMORYMAPMERGE_H
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+
+// Matches the pages of a new memory map with the rows of the old one, the part of MemoryMapView::refreshMap that does not need Qt.
+// Both lists are sorted by base address. A row is kept when the page at the same base is byte for byte the same.
+class MemoryMapMerge
+{
+public:
+    std::vector<int> oldRows; //old row of every new page, -1 when the page has to be formatted again
+    int selection = 0; //new rows of the regions that held the selection and the top of the view
+    int tableOffset = 0;
+
+    template<typename Page, typename BaseOf>
+    MemoryMapMerge(const std::vector<Page> & oldPages, const std::vector<Page> & newPages, int oldSelection, int oldTableOffset, BaseOf baseOf)
+    {
+        auto pageBase = [&](int index)
+        {
+            return index >= 0 && index < int(oldPages.size()) ? size_t(baseOf(oldPages[index])) : 0;
+        };
+        size_t selectedBase = pageBase(oldSelection);
+        size_t topBase = pageBase(oldTableOffset);
+
+        oldRows.resize(newPages.size(), -1);
+        size_t old = 0;
+        for(size_t i = 0; i < newPages.size(); i++)
+        {
+            const Page & page = newPages[i];
+            size_t base = size_t(baseOf(page));
+            while(old < oldPages.size() && size_t(baseOf(oldPages[old])) < base)
+                old++;
+            if(old < oldPages.size() && memcmp(&oldPages[old], &page, sizeof(Page)) == 0)
+                oldRows[i] = int(old);
+            if(base <= selectedBase)
+                selection = int(i);
+            if(base <= topBase)
+                tableOffset = int(i);
+        }
+    }
+};
+
+#endif // MEMORYMAPMERGE_H
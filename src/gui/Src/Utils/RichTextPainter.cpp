@@ -2,7 +2,6 @@
 #include "CachedFontMetrics.h"
 #include <QPainter>
 
-//TODO: fix performance (possibly use QTextLayout?)
 void RichTextPainter::paintRichText(QPainter* painter, int x, int y, int w, int h, int xinc, const List & richText, CachedFontMetrics* fontMetrics)
 {
     QPen pen;
@@ -42,7 +41,10 @@ void RichTextPainter::paintRichText(QPainter* painter, int x, int y, int w, int
             painter->setPen(pen);
             break;
         }
-        painter->drawText(QRect(x + xinc, y, w - xinc, h), Qt::TextBypassShaping, curRichText.text);
+        if(textWidth + xinc <= w) //fully visible, draw the cached text run
+            painter->drawStaticText(x + xinc, y, fontMetrics->staticText(curRichText.text));
+        else //clip to the remaining width
+            painter->drawText(QRect(x + xinc, y, w - xinc, h), Qt::TextBypassShaping, curRichText.text);
         if(curRichText.highlight)
         {
             highlightPen.setColor(curRichText.highlightColor);
@@ -0,0 +1,13 @@
+#include "SymbolColumns.h"
+
+void SymbolColumns::add(duint addr, const char* decoratedSymbol, const char* undecoratedSymbol, bool isImported)
+{
+    //same text as ToPtrString, without sprintf and the UTF-8 decoding
+    char text[sizeof(duint) * 2];
+    for(int i = int(sizeof(text)) - 1; i >= 0; i--, addr >>= 4)
+        text[i] = "0123456789ABCDEF"[addr & 0xF];
+    address.push_back(QString::fromLatin1(text, int(sizeof(text))));
+    type.push_back(isImported ? importText : exportText);
+    decorated.push_back(decoratedSymbol && *decoratedSymbol ? QString(decoratedSymbol) : QString());
+    undecorated.push_back(undecoratedSymbol && *undecoratedSymbol ? QString(undecoratedSymbol) : QString());
+}
@@ -0,0 +1,22 @@
+#ifndef SYMBOLCOLUMNS_H
+#define SYMBOLCOLUMNS_H
+
+#include <QString>
+#include <vector>
+#include "Imports.h"
+
+// Cells of the symbol list, filled by the symbol enumeration and then swapped into the table
+struct SymbolColumns
+{
+    std::vector<QString> address;
+    std::vector<QString> type;
+    std::vector<QString> decorated;
+    std::vector<QString> undecorated;
+    QString importText;
+    QString exportText;
+
+    // The type is shared and a missing name is an empty QString, so only the address and the names allocate
+    void add(duint addr, const char* decoratedSymbol, const char* undecoratedSymbol, bool isImported);
+};
+
+#endif // SYMBOLCOLUMNS_H
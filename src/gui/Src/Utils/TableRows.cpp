@@ -0,0 +1,72 @@
+#include "TableRows.h"
+#include <QRegExp>
+#include <algorithm>
+
+std::vector<int> TableRows::SortOrder(const std::vector<QString> & keys, bool greater, KeyType type, const LessFunction & less)
+{
+    int rowCount = int(keys.size());
+    std::vector<int> order;
+    order.reserve(rowCount);
+    if(type == KeyInt || type == KeyHex)
+    {
+        //parse every key once instead of twice per comparison
+        std::vector<std::pair<qlonglong, int>> parsed(rowCount);
+        bool hex = type == KeyHex;
+        for(int i = 0; i < rowCount; i++)
+            parsed[i] = std::make_pair(hex ? keys[i].toLongLong(0, 16) : keys[i].toLongLong(), i);
+        std::sort(parsed.begin(), parsed.end());
+        for(const auto & key : parsed)
+            order.push_back(key.second);
+        if(greater)
+            std::reverse(order.begin(), order.end());
+    }
+    else
+    {
+        for(int i = 0; i < rowCount; i++)
+            order.push_back(i);
+        bool text = type == KeyText;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+        {
+            if(text)
+                return greater ? QString::compare(keys[b], keys[a]) < 0 : QString::compare(keys[a], keys[b]) < 0;
+            return greater ? less(keys[b], keys[a]) : less(keys[a], keys[b]);
+        });
+    }
+    return order;
+}
+
+void TableRows::Reorder(Columns & columns, const std::vector<int> & order)
+{
+    for(auto & column : columns)
+    {
+        std::vector<QString> sorted;
+        sorted.reserve(column.size());
+        for(auto row : order)
+            sorted.push_back(std::move(column[row]));
+        column.swap(sorted);
+    }
+}
+
+std::vector<int> TableRows::Filter(const Columns & columns, const QString & text, int startCol, bool regex)
+{
+    std::vector<int> rows;
+    if(startCol < 0 || startCol >= int(columns.size()))
+        return rows;
+    QRegExp expression(regex ? text : QString()); //compiled once, not for every cell
+    int rowCount = int(columns[startCol].size());
+    for(int row = 0; row < rowCount; row++)
+    {
+        for(int col = startCol; col < int(columns.size()); col++)
+        {
+            if(row >= int(columns[col].size()))
+                continue;
+            const auto & cell = columns[col][row];
+            if(regex ? cell.contains(expression) : cell.contains(text, Qt::CaseInsensitive))
+            {
+                rows.push_back(row);
+                break;
+            }
+        }
+    }
+    return rows;
+}
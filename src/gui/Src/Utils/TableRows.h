@@ -0,0 +1,32 @@
+#ifndef TABLEROWS_H
+#define TABLEROWS_H
+
+#include <QString>
+#include <functional>
+#include <vector>
+
+// Sorting and filtering of the StdTable cells (one vector per column), the part that does not need a widget
+namespace TableRows
+{
+    enum KeyType
+    {
+        KeyText,
+        KeyInt,
+        KeyHex,
+        KeyCustom
+    };
+
+    typedef std::vector<std::vector<QString>> Columns;
+    typedef std::function<bool(const QString &, const QString &)> LessFunction;
+
+    // Row order that sorts keys, integer keys are parsed once. less is only used for KeyCustom.
+    std::vector<int> SortOrder(const std::vector<QString> & keys, bool greater, KeyType type, const LessFunction & less);
+
+    // Moves the rows of every column in order
+    void Reorder(Columns & columns, const std::vector<int> & order);
+
+    // Rows with a cell from startCol on that contains text (case insensitive) or matches it as a regular expression
+    std::vector<int> Filter(const Columns & columns, const QString & text, int startCol, bool regex);
+}
+
+#endif // TABLEROWS_H
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# CodeFoldingHelper unit test, "codefolding_test bench" also runs the scroll benchmark
+#
+#-------------------------------------------------
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = codefolding_test
+
+DEFINES += NOMINMAX
+
+INCLUDEPATH += \
+    ../../../ \
+    ../../Src \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp \
+    ../../Src/Utils/CodeFolding.cpp
+
+HEADERS += \
+    ../../Src/Utils/CodeFolding.h
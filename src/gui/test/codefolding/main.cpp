@@ -0,0 +1,277 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "CodeFolding.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Straightforward model of the documented behavior, every query is a linear scan
+class NaiveFolding
+{
+public:
+    struct Segment
+    {
+        duint start;
+        duint end;
+        bool folded;
+    };
+    std::vector<Segment> segments;
+
+    bool add(duint va, duint length, bool folded)
+    {
+        duint end = va + length;
+        if(end < va)
+            return false;
+        // every overlapping segment has to contain the new one
+        for(const auto & segment : segments)
+        {
+            if(segment.end < va || segment.start > end)
+                continue;
+            if(segment.start > va || segment.end < end || (segment.start == va && segment.end == end))
+                return false;
+        }
+        Segment segment = { va, end, folded };
+        segments.push_back(segment);
+        return true;
+    }
+
+    int innermost(duint va) const
+    {
+        int found = -1;
+        for(int i = 0; i < int(segments.size()); i++)
+            if(segments[i].start <= va && va <= segments[i].end && (found == -1 || segments[i].end - segments[i].start < segments[found].end - segments[found].start))
+                found = i;
+        return found;
+    }
+
+    int outermostFolded(duint va) const
+    {
+        int found = -1;
+        for(int i = 0; i < int(segments.size()); i++)
+            if(segments[i].folded && segments[i].start <= va && va <= segments[i].end && (found == -1 || segments[i].end - segments[i].start > segments[found].end - segments[found].start))
+                found = i;
+        return found;
+    }
+
+    bool isFolded(duint va) const
+    {
+        return outermostFolded(va) != -1;
+    }
+
+    duint foldBegin(duint va) const
+    {
+        int folded = outermostFolded(va);
+        int inner = innermost(va);
+        return folded != -1 ? segments[folded].start : inner != -1 ? segments[inner].start : 0;
+    }
+
+    duint foldEnd(duint va) const
+    {
+        int folded = outermostFolded(va);
+        int inner = innermost(va);
+        return folded != -1 ? segments[folded].end : inner != -1 ? segments[inner].end : 0;
+    }
+
+    duint foldedSize(duint vaStart, duint vaEnd) const
+    {
+        duint size = 0;
+        for(int i = 0; i < int(segments.size()); i++)
+        {
+            const auto & segment = segments[i];
+            if(segment.folded && segment.start > vaStart && segment.end < vaEnd && outermostFolded(segment.start) == i)
+                size += segment.end - segment.start;
+        }
+        return size;
+    }
+
+    bool rangeFolded(duint vaStart, duint vaEnd) const
+    {
+        if(innermost(vaStart) != -1)
+            return true;
+        for(const auto & segment : segments)
+            if(segment.start >= vaStart && segment.start <= vaEnd)
+                return true;
+        return false;
+    }
+
+    void setFolded(duint va, bool folded)
+    {
+        int found = innermost(va);
+        if(found != -1)
+            segments[found].folded = folded;
+    }
+
+    bool del(duint va)
+    {
+        int found = innermost(va);
+        if(found == -1)
+            return false;
+        segments.erase(segments.begin() + found);
+        return true;
+    }
+
+    void expand(duint va)
+    {
+        for(auto & segment : segments)
+            if(segment.start <= va && va <= segment.end)
+                segment.folded = false;
+    }
+};
+
+static void compare(const CodeFoldingHelper & helper, const NaiveFolding & naive, duint space)
+{
+    for(duint va = 0; va < space; va++)
+    {
+        int inner = naive.innermost(va);
+        CHECK(helper.isFoldBody(va) == (inner != -1));
+        CHECK(helper.isFoldStart(va) == (inner != -1 && naive.segments[inner].start == va));
+        CHECK(helper.isFoldEnd(va) == (inner != -1 && naive.segments[inner].end == va));
+        CHECK(helper.isFolded(va) == naive.isFolded(va));
+        CHECK(helper.getFoldBegin(va) == naive.foldBegin(va));
+        CHECK(helper.getFoldEnd(va) == naive.foldEnd(va));
+    }
+    for(int i = 0; i < 200; i++)
+    {
+        duint vaStart = rand() % space;
+        duint vaEnd = vaStart + rand() % (space - vaStart);
+        CHECK(helper.getFoldedSize(vaStart, vaEnd) == naive.foldedSize(vaStart, vaEnd));
+        CHECK(helper.isDataRangeFolded(vaStart, vaEnd) == naive.rangeFolded(vaStart, vaEnd));
+    }
+}
+
+// Random edits, every query is compared with the model after each one
+static void testRandom()
+{
+    const duint space = 200;
+    srand(1234);
+    for(int round = 0; round < 50 && !failures; round++)
+    {
+        CodeFoldingHelper helper;
+        NaiveFolding naive;
+        for(int step = 0; step < 60 && !failures; step++)
+        {
+            duint va = rand() % space;
+            switch(rand() % 6)
+            {
+            case 0:
+            case 1:
+            case 2:
+            {
+                duint length = rand() % 40;
+                bool folded = rand() % 2 == 0;
+                CHECK(helper.addFoldSegment(va, length, folded) == naive.add(va, length, folded));
+            }
+            break;
+            case 3:
+                CHECK(helper.delFoldSegment(va) == naive.del(va));
+                break;
+            case 4:
+            {
+                bool folded = rand() % 2 == 0;
+                helper.setFolded(va, folded);
+                naive.setFolded(va, folded);
+            }
+            break;
+            case 5:
+                helper.expandFoldSegment(va);
+                naive.expand(va);
+                break;
+            }
+            compare(helper, naive, space);
+        }
+    }
+}
+
+// The ranges of getFoldedSize exclude the segments at or across the bounds
+static void testFoldedSize()
+{
+    CodeFoldingHelper helper;
+    CHECK(helper.addFoldSegment(100, 10)); // 100-110
+    CHECK(helper.addFoldSegment(200, 20, false)); // 200-220
+    CHECK(helper.addFoldSegment(205, 5)); // 205-210, nested
+    CHECK(helper.addFoldSegment(300, 30)); // 300-330
+    CHECK(helper.addFoldSegment(310, 5)); // nested in a folded segment
+    CHECK(!helper.addFoldSegment(90, 30)); // would enclose 100-110
+    CHECK(!helper.addFoldSegment(105, 10)); // overlaps the end of 100-110
+    CHECK(!helper.addFoldSegment(100, 10)); // already there
+    CHECK(helper.getFoldedSize(0, 1000) == 10 + 5 + 30);
+    CHECK(helper.getFoldedSize(100, 1000) == 5 + 30);
+    CHECK(helper.getFoldedSize(99, 110) == 0);
+    CHECK(helper.getFoldedSize(99, 111) == 10);
+    CHECK(helper.getFoldedSize(201, 300) == 5);
+    CHECK(helper.getFoldedSize(0, 320) == 10 + 5);
+    CHECK(helper.getFoldedSize(305, 400) == 0);
+    CHECK(helper.isFolded(312));
+    CHECK(helper.getFoldBegin(312) == 300);
+    CHECK(helper.getFoldEnd(207) == 210);
+    CHECK(helper.getFoldBegin(215) == 200);
+    helper.expandFoldSegment(312);
+    CHECK(!helper.isFolded(312));
+    CHECK(!helper.isFolded(305));
+    CHECK(helper.getFoldedSize(0, 1000) == 10 + 5);
+}
+
+// Scrolling through a disassembly with many folded functions, like Disassembly::paintContent
+template<typename F>
+static double scroll(duint functions, F screen)
+{
+    auto start = std::chrono::steady_clock::now();
+    volatile duint sink = 0;
+    for(duint va = 0; va < functions * 0x40; va += 7)
+        sink += screen(va);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void benchmark(duint functions)
+{
+    CodeFoldingHelper helper;
+    NaiveFolding naive;
+    for(duint i = 0; i < functions; i++)
+    {
+        helper.addFoldSegment(i * 0x40, 0x30, i % 2 == 0);
+        naive.add(i * 0x40, 0x30, i % 2 == 0);
+    }
+    const duint page = 0x400, rows = 50;
+    double helperTime = scroll(functions, [&](duint va)
+    {
+        duint result = helper.getFoldedSize(va, va + page);
+        for(duint row = 0; row < rows; row++)
+            result += helper.isFolded(va + row * 8) + helper.isFoldStart(va + row * 8);
+        return result;
+    });
+    double naiveTime = scroll(functions, [&](duint va)
+    {
+        duint result = naive.foldedSize(va, va + page);
+        for(duint row = 0; row < rows; row++)
+            result += naive.isFolded(va + row * 8) + (naive.innermost(va + row * 8) != -1);
+        return result;
+    });
+    printf("%u segments: %.1fms, linear scan %.1fms\n", (unsigned int)functions, helperTime, naiveTime);
+}
+
+int main(int argc, char* argv[])
+{
+    testFoldedSize();
+    testRandom();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        benchmark(100);
+        benchmark(1000);
+        benchmark(4000);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# CFGLayout unit test, "graphlayout_test bench" also lays out 10k block graphs
+#
+#-------------------------------------------------
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = graphlayout_test
+
+DEFINES += NOMINMAX
+
+INCLUDEPATH += \
+    ../../../ \
+    ../../Src \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp \
+    ../../Src/Utils/CFGLayout.cpp
+
+HEADERS += \
+    ../../Src/Utils/CFGLayout.h
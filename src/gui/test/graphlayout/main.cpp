@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "CFGLayout.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+struct Graph
+{
+    duint entry;
+    std::map<duint, std::vector<duint>> exits;
+};
+
+// Synthetic function: fall through blocks with conditional branches forward, loops back and an occasional switch
+static Graph generate(int count, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    Graph graph;
+    graph.entry = 0x401000;
+    auto address = [&](int index)
+    {
+        return graph.entry + duint(index) * 0x10;
+    };
+    for(int i = 0; i < count; i++)
+    {
+        auto & exits = graph.exits[address(i)];
+        if(i + 1 == count)
+            break; //ret
+        exits.push_back(address(i + 1));
+        auto kind = random() % 20;
+        if(kind < 5) //if
+            exits.push_back(address(std::min(count - 1, i + 2 + int(random() % 20))));
+        else if(kind < 7) //loop
+            exits.push_back(address(std::max(0, i - int(random() % 20))));
+        else if(kind == 7) //switch
+        {
+            for(int cases = 3 + random() % 10; cases; cases--)
+            {
+                auto target = address(std::min(count - 1, i + 2 + int(random() % 30)));
+                if(std::find(exits.begin(), exits.end(), target) == exits.end())
+                    exits.push_back(target);
+            }
+        }
+    }
+    return graph;
+}
+
+static void fill(CFGLayout & layout, const Graph & graph, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    for(auto & it : graph.exits)
+    {
+        auto & block = layout.blocks[it.first];
+        block.entry = it.first;
+        block.exits = it.second;
+        block.width = 100 + random() % 300;
+        block.height = 30 + random() % 200;
+    }
+}
+
+// The tree layout DisassemblerGraphView used before CFGLayout: every node that cannot be placed right away
+// rescans all edges out of the visited nodes, subtrees are moved again at every level of the recursion
+class NaiveTree
+{
+public:
+    struct Node
+    {
+        std::vector<duint> exits;
+        std::vector<duint> new_exits;
+        int incoming = 0;
+        int col = 0;
+        int col_count = 0;
+        int row = 0;
+        int row_count = 0;
+    };
+    std::map<duint, Node> nodes;
+
+    explicit NaiveTree(const Graph & graph)
+    {
+        for(auto & it : graph.exits)
+        {
+            nodes[it.first].exits = it.second;
+            for(duint exit : it.second)
+                nodes[exit].incoming++;
+        }
+
+        std::set<duint> visited;
+        visited.insert(graph.entry);
+        std::vector<duint> queue;
+        queue.push_back(graph.entry);
+        while(true)
+        {
+            for(size_t i = 0; i < queue.size(); i++)
+            {
+                Node & node = nodes[queue[i]];
+                for(duint exit : node.exits)
+                {
+                    if(visited.count(exit) || nodes[exit].incoming != 1)
+                        continue;
+                    node.new_exits.push_back(exit);
+                    queue.push_back(exit);
+                    visited.insert(exit);
+                }
+            }
+            queue.clear();
+
+            bool found = false;
+            int best_edges = 0;
+            duint best = 0, best_parent = 0;
+            for(duint parent : visited)
+            {
+                for(duint exit : nodes[parent].exits)
+                {
+                    if(visited.count(exit))
+                        continue;
+                    if(!found || nodes[exit].incoming < best_edges || (nodes[exit].incoming == best_edges && exit < best))
+                    {
+                        found = true;
+                        best = exit;
+                        best_edges = nodes[exit].incoming;
+                        best_parent = parent;
+                    }
+                }
+            }
+            if(!found)
+                break;
+            nodes[best_parent].new_exits.push_back(best);
+            visited.insert(best);
+        }
+        compute(graph.entry);
+    }
+
+private:
+    void adjust(duint entry, int col, int row)
+    {
+        Node & node = nodes[entry];
+        node.col += col;
+        node.row += row;
+        for(duint exit : node.new_exits)
+            adjust(exit, col, row);
+    }
+
+    void compute(duint entry)
+    {
+        int col = 0;
+        int row_count = 1;
+        for(duint exit : nodes[entry].new_exits)
+        {
+            compute(exit);
+            adjust(exit, col, 1);
+            col += nodes[exit].col_count;
+            row_count = std::max(row_count, nodes[exit].row_count + 1);
+        }
+        Node & node = nodes[entry];
+        node.row = 0;
+        node.col = col >= 2 ? (col - 2) / 2 : 0;
+        node.col_count = std::max(col, 2);
+        node.row_count = row_count;
+    }
+};
+
+// The blocks get the same cells as in the naive layout, do not overlap and every edge is a connected line between them
+static void checkLayout(const Graph & graph, unsigned int seed)
+{
+    CFGLayout layout;
+    fill(layout, graph, seed);
+    layout.layout(graph.entry);
+    NaiveTree naive(graph);
+
+    std::map<std::pair<int, int>, const CFGLayout::Block*> cells;
+    std::set<std::pair<int, int>> centers;
+    for(auto & it : layout.blocks)
+    {
+        const CFGLayout::Block & block = it.second;
+        const NaiveTree::Node & node = naive.nodes[it.first];
+        CHECK(block.row == node.row);
+        CHECK(block.col == node.col);
+        CHECK(cells.insert({ { block.row, block.col }, &block }).second);
+        centers.insert({ block.row, block.col + 1 });
+        CHECK(block.edges.size() == block.exits.size());
+    }
+    for(auto it = cells.begin(); it != cells.end(); ++it)
+    {
+        auto next = std::next(it);
+        if(next == cells.end() || next->first.first != it->first.first)
+            continue;
+        CHECK(next->first.second >= it->first.second + 2);
+        CHECK(next->second->x >= it->second->x + it->second->width);
+    }
+
+    for(auto & it : layout.blocks)
+    {
+        const CFGLayout::Block & block = it.second;
+        for(size_t i = 0; i < block.edges.size(); i++)
+        {
+            const CFGLayout::Edge & edge = block.edges[i];
+            const CFGLayout::Block & dest = layout.blocks[edge.dest];
+            CHECK(edge.dest == block.exits[i]);
+            CHECK(edge.points.front().row == block.row + 1 && edge.points.front().col == block.col + 1);
+            CHECK(edge.points.back().row == dest.row && edge.points.back().col == dest.col + 1);
+            for(size_t j = 1; j < edge.points.size(); j++)
+            {
+                auto & from = edge.points[j - 1];
+                auto & to = edge.points[j];
+                CHECK(from.row == to.row || from.col == to.col);
+                if(from.col != to.col)
+                    continue;
+                //Vertical lines go between the blocks, not through them
+                for(int row = std::min(from.row, to.row); row < std::max(from.row, to.row); row++)
+                    CHECK(!centers.count({ row, from.col }));
+            }
+        }
+    }
+    CHECK(int(layout.col_edge_x.size()) == layout.blocks[graph.entry].col_count + 1);
+    CHECK(int(layout.row_edge_y.size()) == layout.blocks[graph.entry].row_count + 1);
+    CHECK(layout.width > layout.col_edge_x.back() && layout.height > layout.row_edge_y.back());
+}
+
+static void testSmall()
+{
+    //Diamond with a loop back to the entry and a self loop
+    Graph graph;
+    graph.entry = 0x1000;
+    graph.exits[0x1000] = { 0x1010, 0x1020 };
+    graph.exits[0x1010] = { 0x1030 };
+    graph.exits[0x1020] = { 0x1020, 0x1030 };
+    graph.exits[0x1030] = { 0x1000 };
+    checkLayout(graph, 1);
+
+    //Single block
+    graph.exits.clear();
+    graph.exits[0x1000];
+    checkLayout(graph, 2);
+}
+
+static void testRandom()
+{
+    for(unsigned int seed = 0; seed < 50; seed++)
+        checkLayout(generate(10 + seed * 10, seed), seed);
+}
+
+template<typename Function>
+static double measure(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void benchmark(int count)
+{
+    auto graph = generate(count, 1234);
+    CFGLayout layout;
+    fill(layout, graph, 1);
+    double layoutTime = measure([&]()
+    {
+        layout.layout(graph.entry);
+    });
+    double naiveTime = measure([&]()
+    {
+        NaiveTree naive(graph);
+    });
+    auto & entry = layout.blocks[graph.entry];
+    printf("%d blocks (%d rows, %d columns): layout with edge routing %.1fms, naive tree only %.1fms\n",
+           count, entry.row_count, entry.col_count, layoutTime, naiveTime);
+}
+
+int main(int argc, char* argv[])
+{
+    testSmall();
+    testRandom();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        benchmark(1000);
+        benchmark(10000);
+    }
+    return failures ? 1 : 0;
+}
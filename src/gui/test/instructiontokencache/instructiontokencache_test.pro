@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# InstructionTokenCache unit test, "instructiontokencache_test bench" also times scrolling a disassembly window
+#
+#-------------------------------------------------
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = instructiontokencache_test
+
+DEFINES += NOMINMAX
+
+INCLUDEPATH += \
+    ../../../ \
+    ../../Src \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../Src/Utils/InstructionTokenCache.h
@@ -0,0 +1,205 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include <QList>
+#include "InstructionTokenCache.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Stand-in for Instruction_t, the tokens are the strings the disassembly paints
+struct Instruction
+{
+    QByteArray dump;
+    QList<QString> tokens;
+};
+
+typedef InstructionTokenCache<Instruction> Cache;
+
+static const char* const mnemonics[] = { "mov", "lea", "push", "pop", "call", "jmp", "je", "jne", "add", "sub", "cmp", "test", "xor", "and", "ret", "nop" };
+static const char* const registers[] = { "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "rbp", "rsp" };
+
+// Stand-in for CapstoneTokenizer::Tokenize: variable length instructions, a mnemonic, a register,
+// an immediate or memory operand and a module label. It formats the strings, it does not decode x86.
+static Instruction tokenize(duint addr, const unsigned char* data, duint size)
+{
+    Instruction instruction;
+    int len = int(std::min(duint(1 + data[0] % 8), size));
+    instruction.dump = QByteArray((const char*)data, len);
+    instruction.tokens.append(QString(mnemonics[data[0] % 16]));
+    instruction.tokens.append(QString(" "));
+    instruction.tokens.append(QString(registers[data[len - 1] % 8]));
+    instruction.tokens.append(QString(", "));
+    duint value = 0;
+    for(int i = 0; i < len; i++)
+        value = value << 8 | data[i];
+    if(value % 3 == 0)
+        instruction.tokens.append(QString("qword ptr ds:[%1]").arg(qulonglong(addr + value % 0x1000), 16, 16, QChar('0')).toUpper());
+    else
+        instruction.tokens.append(QString("%1").arg(qulonglong(value), 0, 16).toUpper());
+    instruction.tokens.append(QString(" "));
+    instruction.tokens.append(QString("<module.exe+%1>").arg(qulonglong(addr & 0xFFFFF), 0, 16).toUpper());
+    return instruction;
+}
+
+// What QBeaEngine::DisassembleAt does with the cache
+static Instruction disassemble(Cache* cache, duint generation, duint addr, const unsigned char* data, duint size, int config = 0)
+{
+    Cache::Entry entry;
+    if(cache && cache->find(generation, addr, config, data, size, entry))
+        return entry.instruction;
+    entry.instruction = tokenize(addr, data, size);
+    entry.config = config;
+    entry.fixedBranchDestination = true;
+    if(cache)
+        cache->insert(generation, addr, entry);
+    return entry.instruction;
+}
+
+static void testCache()
+{
+    Cache cache(4);
+    unsigned char code[] = { 0x48, 0x8B, 0x05, 0x10, 0x20, 0x30, 0x40, 0x50, 0x90, 0x90 };
+    Cache::Entry entry;
+    CHECK(!cache.find(1, 0x1000, 0, code, sizeof(code), entry));
+    auto first = disassemble(&cache, 1, 0x1000, code, sizeof(code));
+    CHECK(cache.find(1, 0x1000, 0, code, sizeof(code), entry));
+    CHECK(entry.instruction.dump == first.dump && entry.instruction.tokens == first.tokens);
+    CHECK(cache.hits() == 1 && cache.misses() == 2);
+
+    // Different tokenizer settings, fewer bytes available or different bytes are misses
+    CHECK(!cache.find(1, 0x1000, 1, code, sizeof(code), entry));
+    CHECK(!cache.find(1, 0x1000, 0, code, first.dump.size() - 1, entry));
+    code[0] ^= 0x10;
+    CHECK(!cache.find(1, 0x1000, 0, code, sizeof(code), entry));
+    code[0] ^= 0x10;
+    CHECK(cache.find(1, 0x1000, 0, code, sizeof(code), entry));
+
+    // New labels or symbols drop every entry, an entry tokenized before that is not stored
+    CHECK(!cache.find(2, 0x1000, 0, code, sizeof(code), entry));
+    cache.insert(1, 0x1000, entry);
+    CHECK(!cache.find(2, 0x1000, 0, code, sizeof(code), entry));
+
+    // A full cache starts over
+    for(duint addr = 0x2000; addr < 0x2005; addr++)
+        disassemble(&cache, 2, addr, code, sizeof(code));
+    CHECK(cache.find(2, 0x2004, 0, code, sizeof(code), entry));
+    CHECK(!cache.find(2, 0x2000, 0, code, sizeof(code), entry));
+}
+
+// The GUI thread and the debugger thread (GUI_GET_DISASSEMBLY) use the cache at the same time,
+// every instruction that comes out of it matches the bytes it was asked for
+static void testThreads()
+{
+    Cache cache(256);
+    std::vector<unsigned char> code(0x10000 + 16);
+    std::mt19937 random(1);
+    for(auto & byte : code)
+        byte = (unsigned char)random();
+    std::atomic<duint> generation(1);
+    std::atomic<int> bad(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 2; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            std::mt19937 random(t);
+            for(int i = 0; i < 200000; i++)
+            {
+                duint offset = random() % 0x400;
+                if(i % 10000 == 0)
+                    generation++;
+                auto instruction = disassemble(&cache, generation, 0x1000 + offset, code.data() + offset, 16, i % 2);
+                if(memcmp(instruction.dump.constData(), code.data() + offset, instruction.dump.size()) != 0)
+                    bad++;
+            }
+        }));
+    }
+    for(auto & thread : threads)
+        thread.join();
+    CHECK(bad == 0);
+    CHECK(cache.hits() + cache.misses() == 400000);
+}
+
+// Scrolls a disassembly window of 50 rows one instruction at a time, every step paints all rows again
+static double scroll(Cache* cache, const std::vector<unsigned char> & code, int steps, unsigned long long & checksum)
+{
+    const int rows = 50;
+    auto start = std::chrono::high_resolution_clock::now();
+    duint top = 0;
+    for(int step = 0; step < steps; step++)
+    {
+        duint offset = top;
+        for(int row = 0; row < rows; row++)
+        {
+            auto instruction = disassemble(cache, 1, 0x140001000 + offset, code.data() + offset, 16);
+            checksum += instruction.tokens.size() + instruction.tokens.last().size();
+            offset += instruction.dump.size();
+            if(row == 0)
+                top += instruction.dump.size();
+        }
+    }
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static void benchmark()
+{
+    const int steps = 20000;
+    std::vector<unsigned char> code(0x40000 + 16);
+    std::mt19937 random(2);
+    for(auto & byte : code)
+        byte = (unsigned char)random();
+    printf("scrolling %d steps through a 50 row window\n", steps);
+
+    unsigned long long uncachedSum = 0, cachedSum = 0, sharedSum = 0;
+    auto uncached = scroll(nullptr, code, steps, uncachedSum);
+    printf("tokenize every row: %.1fms (%.1fus per step)\n", uncached * 1e3, uncached * 1e6 / steps);
+
+    Cache cache(0x4000);
+    auto cached = scroll(&cache, code, steps, cachedSum);
+    printf("instruction cache: %.1fms (%.1fus per step), %llu hits, %llu misses\n", cached * 1e3, cached * 1e6 / steps, cache.hits(), cache.misses());
+
+    // The debugger thread keeps disassembling other addresses (a trace that logs the instructions)
+    Cache shared(0x4000);
+    std::atomic<bool> stop(false);
+    std::thread debugger([&]()
+    {
+        std::mt19937 random(3);
+        while(!stop)
+        {
+            duint offset = random() % 0x40000;
+            disassemble(&shared, 1, 0x140001000 + offset, code.data() + offset, 16);
+        }
+    });
+    auto contended = scroll(&shared, code, steps, sharedSum);
+    stop = true;
+    debugger.join();
+    printf("instruction cache, debugger thread disassembling at the same time: %.1fms (%.1fus per step)\n", contended * 1e3, contended * 1e6 / steps);
+    CHECK(uncachedSum == cachedSum && cachedSum == sharedSum);
+}
+
+int main(int argc, char* argv[])
+{
+    testCache();
+    testThreads();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
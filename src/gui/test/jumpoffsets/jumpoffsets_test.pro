@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# JumpOffsetTree unit test, "jumpoffsets_test bench" also times it against the old line sweep
+#
+#-------------------------------------------------
+
+CONFIG += console
+CONFIG -= app_bundle qt
+TEMPLATE = app
+TARGET = jumpoffsets_test
+
+INCLUDEPATH += \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../Src/Utils/JumpOffsetTree.h
@@ -0,0 +1,174 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include "JumpOffsetTree.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+struct JumpLine
+{
+    int line;
+    int destLine;
+    unsigned int jumpOffset;
+};
+
+// The line sweep CPUSideBar::AllocateJumpOffsets used before JumpOffsetTree, O(jumps * lines)
+static void sweepJumpOffsets(std::vector<JumpLine> & jumpLines, int viewableRows, std::vector<unsigned int> & horizontalLines)
+{
+    std::vector<unsigned int> numLines(viewableRows * 2, 0); // Low:jump offsets of the vertical jumping line, High:jump offsets of the horizontal jumping line.
+    // preprocessing
+    for(size_t i = 0; i < jumpLines.size(); i++)
+    {
+        JumpLine & jmp = jumpLines.at(i);
+        jmp.jumpOffset = abs(jmp.destLine - jmp.line);
+    }
+    // Sort jumpLines so that longer jumps are put at the back.
+    std::sort(jumpLines.begin(), jumpLines.end(), [](const JumpLine & op1, const JumpLine & op2)
+    {
+        return op2.jumpOffset > op1.jumpOffset;
+    });
+    // Allocate jump offsets
+    for(size_t i = 0; i < jumpLines.size(); i++)
+    {
+        JumpLine & jmp = jumpLines.at(i);
+        unsigned int maxJmpOffset = 0;
+        if(jmp.line < jmp.destLine)
+        {
+            for(int j = jmp.line; j <= jmp.destLine && j < viewableRows; j++)
+            {
+                if(numLines[j] > maxJmpOffset)
+                    maxJmpOffset = numLines[j];
+            }
+        }
+        else
+        {
+            for(int j = jmp.line; j >= jmp.destLine && j >= 0; j--)
+            {
+                if(numLines[j] > maxJmpOffset)
+                    maxJmpOffset = numLines[j];
+            }
+        }
+        jmp.jumpOffset = maxJmpOffset + 1;
+        if(jmp.line < jmp.destLine)
+        {
+            for(int j = jmp.line; j <= jmp.destLine && j < viewableRows; j++)
+                numLines[j] = jmp.jumpOffset;
+        }
+        else
+        {
+            for(int j = jmp.line; j >= jmp.destLine && j >= 0; j--)
+                numLines[j] = jmp.jumpOffset;
+        }
+        if(jmp.line >= 0 && jmp.line < viewableRows)
+            numLines[jmp.line + viewableRows] = jmp.jumpOffset;
+        if(jmp.destLine >= 0 && jmp.destLine < viewableRows)
+            numLines[jmp.destLine + viewableRows] = jmp.jumpOffset;
+    }
+    horizontalLines.assign(numLines.begin() + viewableRows, numLines.end());
+}
+
+// Jumps start on a visible line, the destination may be above or below the view
+static std::vector<JumpLine> denseJumps(int rows, int jumpsPerLine, int maxDistance)
+{
+    std::vector<JumpLine> jumps;
+    for(int line = 0; line < rows; line++)
+    {
+        for(int i = 0; i < jumpsPerLine; i++)
+        {
+            JumpLine jmp;
+            jmp.line = line;
+            jmp.destLine = line + rand() % (maxDistance * 2 + 1) - maxDistance;
+            jmp.jumpOffset = 0;
+            jumps.push_back(jmp);
+        }
+    }
+    return jumps;
+}
+
+static void compare(int rows, int jumpsPerLine, int maxDistance)
+{
+    std::vector<JumpLine> expected = denseJumps(rows, jumpsPerLine, maxDistance);
+    std::vector<JumpLine> actual = expected;
+    std::vector<unsigned int> expectedLines, actualLines;
+    sweepJumpOffsets(expected, rows, expectedLines);
+    JumpOffsetTree::allocate(actual, rows, actualLines);
+    CHECK(actual.size() == expected.size());
+    for(size_t i = 0; i < actual.size() && i < expected.size(); i++)
+    {
+        CHECK(actual[i].line == expected[i].line);
+        CHECK(actual[i].destLine == expected[i].destLine);
+        CHECK(actual[i].jumpOffset == expected[i].jumpOffset);
+    }
+    CHECK(actualLines == expectedLines);
+}
+
+static void testTree()
+{
+    JumpOffsetTree tree(10);
+    CHECK(tree.query(0, 9) == 0);
+    tree.raise(2, 4, 1);
+    tree.raise(6, 6, 3);
+    CHECK(tree.query(0, 1) == 0);
+    CHECK(tree.query(0, 2) == 1);
+    CHECK(tree.query(4, 5) == 1);
+    CHECK(tree.query(5, 9) == 3);
+    CHECK(tree.query(7, 9) == 0);
+    tree.raise(0, 9, 4);
+    CHECK(tree.query(9, 9) == 4);
+    JumpOffsetTree empty(0);
+    CHECK(empty.query(0, 0) == 0);
+}
+
+template<typename F>
+static double measure(const std::vector<JumpLine> & jumps, int rows, F allocate)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < 20; i++)
+    {
+        std::vector<JumpLine> copy = jumps;
+        std::vector<unsigned int> lines;
+        allocate(copy, rows, lines);
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / 20;
+}
+
+static void benchmark(int rows, int jumpsPerLine)
+{
+    std::vector<JumpLine> jumps = denseJumps(rows, jumpsPerLine, rows);
+    double sweep = measure(jumps, rows, sweepJumpOffsets);
+    double tree = measure(jumps, rows, JumpOffsetTree::allocate<JumpLine>);
+    printf("%d lines, %u jumps: sweep %.3fms, tree %.3fms\n", rows, (unsigned int)jumps.size(), sweep, tree);
+}
+
+int main(int argc, char* argv[])
+{
+    srand(1234);
+    testTree();
+    compare(1, 1, 0);
+    compare(1, 3, 2);
+    compare(60, 1, 10);
+    compare(60, 4, 80);
+    compare(200, 2, 400);
+    for(int i = 0; i < 100; i++)
+        compare(1 + rand() % 300, 1 + rand() % 4, 1 + rand() % 400);
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+    {
+        benchmark(60, 1);
+        benchmark(200, 2);
+        benchmark(1000, 4);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "MemoryMapMerge.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// Same layout idea as MEMPAGE: the region and the text of the info column
+struct Page
+{
+    size_t base;
+    size_t size;
+    unsigned int protect;
+    unsigned int type;
+    char info[32];
+};
+
+static size_t baseOf(const Page & page)
+{
+    return page.base;
+}
+
+static Page makePage(size_t base, size_t size, unsigned int protect)
+{
+    Page page;
+    memset(&page, 0, sizeof(page));
+    page.base = base;
+    page.size = size;
+    page.protect = protect;
+    page.type = protect % 3;
+    sprintf(page.info, "region %zX", base);
+    return page;
+}
+
+// Fake source of memory maps: every refresh allocates, frees, splits, merges and reprotects a few regions
+class FakeMap
+{
+public:
+    std::vector<Page> pages;
+
+    FakeMap(int regions, unsigned int seed)
+        : random(seed)
+    {
+        size_t base = 0x10000;
+        for(int i = 0; i < regions; i++)
+        {
+            auto size = (1 + random() % 64) * 0x1000;
+            pages.push_back(makePage(base, size, 1 + random() % 8));
+            base += size + (random() % 4) * 0x10000;
+        }
+    }
+
+    void Churn(int changes)
+    {
+        for(int i = 0; i < changes; i++)
+        {
+            size_t index = pages.empty() ? 0 : random() % pages.size();
+            switch(pages.size() < 2 ? 0 : random() % 5)
+            {
+            case 0: //allocate after the last region
+            {
+                size_t base = pages.empty() ? 0x10000 : pages.back().base + pages.back().size + 0x10000;
+                pages.push_back(makePage(base, 0x1000 * (1 + random() % 16), 1 + random() % 8));
+            }
+            break;
+            case 1: //free
+                pages.erase(pages.begin() + index);
+                break;
+            case 2: //split, like VirtualProtect on a part of the region
+                if(pages[index].size > 0x1000)
+                {
+                    auto first = pages[index];
+                    auto half = first.size / 0x1000 / 2 * 0x1000;
+                    auto second = makePage(first.base + half, first.size - half, first.protect + 1);
+                    first.size = half;
+                    pages[index] = first;
+                    pages.insert(pages.begin() + index + 1, second);
+                }
+                break;
+            case 3: //merge with the next region when they touch
+                if(index + 1 < pages.size() && pages[index].base + pages[index].size == pages[index + 1].base)
+                {
+                    pages[index].size += pages[index + 1].size;
+                    pages.erase(pages.begin() + index + 1);
+                }
+                else
+                    pages[index].protect++;
+                break;
+            case 4: //reprotect, or a new section name in the info column
+                if(random() % 2)
+                    pages[index].protect++;
+                else
+                    pages[index].info[0] = char('A' + random() % 26);
+                break;
+            }
+        }
+    }
+
+private:
+    std::mt19937 random;
+};
+
+// The row that shows a region: the last page that starts at or before its base
+static int rowOf(const std::vector<Page> & pages, size_t base)
+{
+    int row = 0;
+    for(size_t i = 0; i < pages.size(); i++)
+        if(pages[i].base <= base)
+            row = int(i);
+    return row;
+}
+
+static void checkMerge(const std::vector<Page> & oldPages, const std::vector<Page> & newPages, int oldSelection, int oldTop)
+{
+    MemoryMapMerge merge(oldPages, newPages, oldSelection, oldTop, baseOf);
+    CHECK(merge.oldRows.size() == newPages.size());
+    for(size_t i = 0; i < newPages.size(); i++)
+    {
+        int old = merge.oldRows[i];
+        // Reused rows hold exactly the same page, and every page that is still the same is reused
+        bool same = false;
+        for(size_t j = 0; j < oldPages.size(); j++)
+            if(oldPages[j].base == newPages[i].base && memcmp(&oldPages[j], &newPages[i], sizeof(Page)) == 0)
+                same = true;
+        CHECK(same == (old != -1));
+        if(old != -1)
+            CHECK(memcmp(&oldPages[old], &newPages[i], sizeof(Page)) == 0);
+    }
+    auto selectedBase = oldSelection >= 0 && oldSelection < int(oldPages.size()) ? oldPages[oldSelection].base : 0;
+    auto topBase = oldTop >= 0 && oldTop < int(oldPages.size()) ? oldPages[oldTop].base : 0;
+    CHECK(merge.selection == rowOf(newPages, selectedBase));
+    CHECK(merge.tableOffset == rowOf(newPages, topBase));
+    if(!newPages.empty())
+    {
+        CHECK(merge.selection >= 0 && merge.selection < int(newPages.size()));
+        CHECK(merge.tableOffset >= 0 && merge.tableOffset < int(newPages.size()));
+    }
+}
+
+static void testChurn()
+{
+    FakeMap map(300, 1);
+    std::mt19937 random(2);
+    for(int refresh = 0; refresh < 500; refresh++)
+    {
+        auto oldPages = map.pages;
+        map.Churn(1 + random() % 8);
+        int size = int(oldPages.size());
+        checkMerge(oldPages, map.pages, size ? int(random() % size) : 0, size ? int(random() % size) : 0);
+    }
+}
+
+static void testEdges()
+{
+    std::vector<Page> empty, pages;
+    for(int i = 0; i < 5; i++)
+        pages.push_back(makePage(0x10000 * (i + 1), 0x1000, 4));
+    checkMerge(empty, pages, 0, 0);
+    checkMerge(pages, empty, 3, 2);
+    checkMerge(pages, pages, 4, 1);
+    checkMerge(pages, pages, -1, 10); //no selection, offset out of range
+
+    // The selected region was freed: the selection moves to the region before it
+    auto freed = pages;
+    freed.erase(freed.begin() + 2);
+    MemoryMapMerge merge(pages, freed, 2, 0, baseOf);
+    CHECK(merge.selection == 1);
+    CHECK(merge.oldRows[1] == 1 && merge.oldRows[2] == 3);
+}
+
+static void benchmark()
+{
+    FakeMap map(20000, 3);
+    const int refreshes = 200;
+    double total = 0;
+    size_t reused = 0, rows = 0;
+    for(int refresh = 0; refresh < refreshes; refresh++)
+    {
+        auto oldPages = map.pages;
+        map.Churn(20);
+        auto start = std::chrono::high_resolution_clock::now();
+        MemoryMapMerge merge(oldPages, map.pages, int(oldPages.size() / 2), int(oldPages.size() / 3), baseOf);
+        total += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        rows += merge.oldRows.size();
+        reused += std::count_if(merge.oldRows.begin(), merge.oldRows.end(), [](int row)
+        {
+            return row != -1;
+        });
+    }
+    printf("%d refreshes of a %u region map with 20 changes each: %.3fms per merge, %.2f%% of the rows reused\n",
+           refreshes, unsigned(map.pages.size()), total / refreshes, reused * 100.0 / rows);
+}
+
+int main(int argc, char* argv[])
+{
+    testEdges();
+    testChurn();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# MemoryMapMerge unit test, "memorymapmerge_test bench" also times refreshes of a 20k region map
+#
+#-------------------------------------------------
+
+CONFIG += console
+CONFIG -= app_bundle qt
+TEMPLATE = app
+TARGET = memorymapmerge_test
+
+INCLUDEPATH += \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp
+
+HEADERS += \
+    ../../Src/Utils/MemoryMapMerge.h
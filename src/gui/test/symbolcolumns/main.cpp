@@ -0,0 +1,239 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "SymbolColumns.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// What the old SymbolView::cbSymbolEnum did, with ToPtrString
+static QString toPtrString(duint addr)
+{
+    char temp[32];
+    sprintf(temp, sizeof(duint) == 8 ? "%016llX" : "%08llX", (unsigned long long)addr);
+    return QString(temp);
+}
+
+static void oldCallback(SYMBOLINFO* symbol, void* user)
+{
+    auto columns = (SymbolColumns*)user;
+    columns->address.push_back(toPtrString(symbol->addr));
+    columns->type.push_back(symbol->isImported ? columns->importText : columns->exportText);
+    columns->decorated.push_back(symbol->decoratedSymbol ? QString(symbol->decoratedSymbol) : QString());
+    columns->undecorated.push_back(symbol->undecoratedSymbol ? QString(symbol->undecoratedSymbol) : QString());
+}
+
+static void newCallback(SYMBOLINFO* symbol, void* user)
+{
+    ((SymbolColumns*)user)->add(symbol->addr, symbol->decoratedSymbol, symbol->undecoratedSymbol, symbol->isImported);
+}
+
+static void emptyCallback(SYMBOLINFO*, void* user)
+{
+    (*(size_t*)user)++;
+}
+
+static void testAdd()
+{
+    SymbolColumns columns;
+    columns.importText = "Import";
+    columns.exportText = "Export";
+    duint addresses[] = { 0, 1, 0x401000, 0xDEADBEEF, duint(-1), duint(0x7FF612345678ULL) };
+    char name[] = "CreateFileW";
+    char undecorated[] = "public: void __thiscall Foo::bar(void)";
+    char empty[] = "";
+    for(auto addr : addresses)
+    {
+        SYMBOLINFO symbol = { addr, name, nullptr, false };
+        oldCallback(&symbol, &columns);
+        symbol.undecoratedSymbol = undecorated;
+        symbol.isImported = true;
+        newCallback(&symbol, &columns);
+    }
+    CHECK(columns.address.size() == 12);
+    for(size_t i = 0; i < columns.address.size(); i += 2)
+    {
+        CHECK(columns.address[i] == columns.address[i + 1]); //same text as ToPtrString
+        CHECK(columns.address[i].size() == int(sizeof(duint) * 2));
+        CHECK(columns.type[i] == "Export" && columns.type[i + 1] == "Import");
+        CHECK(columns.type[i + 1].constData() == columns.importText.constData()); //shared
+        CHECK(columns.decorated[i + 1] == "CreateFileW" && columns.undecorated[i + 1] == QString(undecorated));
+        CHECK(columns.undecorated[i].isEmpty());
+    }
+    CHECK(columns.address[6] == QString(sizeof(duint) == 8 ? "00000000DEADBEEF" : "DEADBEEF"));
+
+    columns.add(0x1000, nullptr, empty, false);
+    CHECK(columns.decorated.back().isEmpty() && columns.undecorated.back().isEmpty());
+}
+
+// Module with count symbols: mostly exports, some decorated C++ names and imports
+struct SymbolSource
+{
+    std::vector<std::string> names;
+    std::vector<SYMBOLINFO> symbols;
+
+    explicit SymbolSource(int count)
+    {
+        std::mt19937 random(count);
+        names.reserve(count * 2);
+        for(int i = 0; i < count; i++)
+        {
+            SYMBOLINFO symbol = { duint(0x180001000ULL + i * 0x30), nullptr, nullptr, random() % 20 == 0 };
+            bool cpp = random() % 6 == 0;
+            char text[256];
+            if(cpp)
+                sprintf(text, "?Method%d@Class%u@@QEAAXPEAVWidget%u@@H@Z", i, unsigned(random() % 500), unsigned(random() % 100));
+            else
+                sprintf(text, "Export_Function_%d_%u", i, unsigned(random() % 100000));
+            names.push_back(text);
+            if(cpp)
+            {
+                sprintf(text, "public: void __cdecl Class%d::Method%d(class Widget%u * __ptr64,int) __ptr64", i % 500, i, unsigned(random() % 100));
+                names.push_back(text);
+            }
+            symbols.push_back(symbol);
+        }
+        // The names are stable now
+        size_t name = 0;
+        for(auto & symbol : symbols)
+        {
+            symbol.decoratedSymbol = &names[name++][0];
+            if(names[name - 1][0] == '?')
+                symbol.undecoratedSymbol = &names[name++][0];
+        }
+    }
+
+    // DbgSymbolEnumFromCache: one call per symbol through a function pointer
+    void Enum(CBSYMBOLENUM callback, void* user)
+    {
+        volatile CBSYMBOLENUM exported = callback; //called across the DLL boundary, it cannot be inlined
+        for(auto & symbol : symbols)
+        {
+            auto copy = symbol;
+            exported(&copy, user);
+        }
+    }
+};
+
+// The alternative: the debugger packs fixed size records and the names into one block, the GUI builds the columns from it
+struct PackedSymbols
+{
+    struct Record
+    {
+        duint addr;
+        unsigned int decorated; //offset in the arena, ~0 when missing
+        unsigned int undecorated;
+        bool isImported;
+    };
+
+    std::vector<Record> records;
+    std::vector<char> arena;
+
+    unsigned int addString(const char* text)
+    {
+        if(!text)
+            return ~0u;
+        auto offset = (unsigned int)arena.size();
+        arena.insert(arena.end(), text, text + strlen(text) + 1);
+        return offset;
+    }
+
+    static void callback(SYMBOLINFO* symbol, void* user)
+    {
+        auto packed = (PackedSymbols*)user;
+        Record record = { symbol->addr, packed->addString(symbol->decoratedSymbol), packed->addString(symbol->undecoratedSymbol), symbol->isImported };
+        packed->records.push_back(record);
+    }
+
+    void fill(SymbolColumns & columns) const
+    {
+        for(const auto & record : records)
+        {
+            columns.add(record.addr, record.decorated == ~0u ? nullptr : arena.data() + record.decorated,
+                        record.undecorated == ~0u ? nullptr : arena.data() + record.undecorated, record.isImported);
+        }
+    }
+};
+
+static double elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// The columns are released before the next fill, so every fill starts with the same heap
+template<typename Fill>
+static double fillTime(Fill fill, size_t & checksum)
+{
+    SymbolColumns columns;
+    auto start = std::chrono::high_resolution_clock::now();
+    fill(columns);
+    auto time = elapsed(start);
+    checksum = columns.address.size();
+    for(size_t i = 0; i < columns.address.size(); i++)
+        checksum = checksum * 31 + columns.address[i].size() + columns.decorated[i].size() * 7 + columns.undecorated[i].size() * 13;
+    return time;
+}
+
+static void benchmark()
+{
+    const int count = 500000;
+    SymbolSource source(count);
+    printf("%d symbols, best of 5\n", count);
+    size_t calls = 0;
+    double enumTime = 1e9, oldTime = 1e9, newTime = 1e9, packedTime = 1e9, packTime = 1e9, packedSize = 0;
+    for(int round = 0; round < 5; round++)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        source.Enum(emptyCallback, &calls);
+        enumTime = std::min(enumTime, elapsed(start));
+
+        size_t oldChecksum, newChecksum, packedChecksum;
+        oldTime = std::min(oldTime, fillTime([&](SymbolColumns & columns)
+        {
+            source.Enum(oldCallback, &columns);
+        }, oldChecksum));
+        newTime = std::min(newTime, fillTime([&](SymbolColumns & columns)
+        {
+            source.Enum(newCallback, &columns);
+        }, newChecksum));
+        packedTime = std::min(packedTime, fillTime([&](SymbolColumns & columns)
+        {
+            PackedSymbols packed;
+            auto start = std::chrono::high_resolution_clock::now();
+            source.Enum(PackedSymbols::callback, &packed);
+            packTime = std::min(packTime, elapsed(start));
+            packed.fill(columns);
+            packedSize = (packed.records.size() * sizeof(PackedSymbols::Record) + packed.arena.size()) / 1048576.0;
+        }, packedChecksum));
+        CHECK(oldChecksum == newChecksum && oldChecksum == packedChecksum);
+    }
+    CHECK(calls == size_t(count) * 5);
+    printf("callbacks alone: %.1fms\n", enumTime);
+    printf("callback, QString per cell with sprintf: %.1fms\n", oldTime);
+    printf("callback, SymbolColumns::add: %.1fms\n", newTime);
+    printf("packed records and string arena: %.1fms (pack %.1fms, %.1fMiB block)\n", packedTime, packTime, packedSize);
+}
+
+int main(int argc, char* argv[])
+{
+    testAdd();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# SymbolColumns unit test, "symbolcolumns_test bench" also compares ways to transfer 500k symbols
+#
+#-------------------------------------------------
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = symbolcolumns_test
+
+DEFINES += NOMINMAX
+
+INCLUDEPATH += \
+    ../../../ \
+    ../../Src \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp \
+    ../../Src/Utils/SymbolColumns.cpp
+
+HEADERS += \
+    ../../Src/Utils/SymbolColumns.h
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <QList>
+#include <QRegExp>
+#include "TableRows.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// The comparators of AbstractTableView::SortBy
+static bool asText(const QString & a, const QString & b)
+{
+    auto i = QString::compare(a, b);
+    if(i < 0)
+        return true;
+    if(i > 0)
+        return false;
+    return &a < &b;
+}
+
+static bool asInt(const QString & a, const QString & b)
+{
+    return a.toLongLong() < b.toLongLong();
+}
+
+static bool asHex(const QString & a, const QString & b)
+{
+    return a.toLongLong(0, 16) < b.toLongLong(0, 16);
+}
+
+// Rows like the references view: address, size, instruction, comment
+static TableRows::Columns makeTable(int rows, unsigned int seed)
+{
+    static const char* mnemonics[] = { "mov", "push", "call", "lea", "jmp", "cmp", "xor", "test" };
+    std::mt19937 random(seed);
+    TableRows::Columns columns(4);
+    for(auto & column : columns)
+        column.resize(rows);
+    for(int i = 0; i < rows; i++)
+    {
+        columns[0][i] = QString("%1").arg(qulonglong(0x140000000ULL + random() % 0x1000000), 16, 16, QChar('0')).toUpper();
+        columns[1][i] = QString::number(random() % 100000);
+        columns[2][i] = QString("%1 eax, dword ptr [rbp+%2]").arg(mnemonics[random() % 8]).arg(random() % 0x100, 0, 16);
+        columns[3][i] = random() % 4 ? QString() : QString("string \"kernel32.%1\"").arg(random() % 5000);
+    }
+    return columns;
+}
+
+static void testSort()
+{
+    auto columns = makeTable(5000, 1);
+    auto original = columns;
+    auto order = TableRows::SortOrder(columns[0], false, TableRows::KeyHex, nullptr);
+    TableRows::Reorder(columns, order);
+    for(size_t i = 1; i < order.size(); i++)
+        CHECK(columns[0][i - 1].toLongLong(0, 16) <= columns[0][i].toLongLong(0, 16));
+    for(size_t i = 0; i < order.size(); i++) //rows stay together
+        CHECK(columns[2][i] == original[2][order[i]] && columns[3][i] == original[3][order[i]]);
+
+    order = TableRows::SortOrder(columns[1], true, TableRows::KeyInt, nullptr);
+    TableRows::Reorder(columns, order);
+    for(size_t i = 1; i < order.size(); i++)
+        CHECK(columns[1][i - 1].toLongLong() >= columns[1][i].toLongLong());
+
+    // Text sorts are stable, so the previous order remains among equal keys
+    auto before = columns;
+    order = TableRows::SortOrder(columns[3], false, TableRows::KeyText, nullptr);
+    TableRows::Reorder(columns, order);
+    for(size_t i = 1; i < order.size(); i++)
+    {
+        CHECK(QString::compare(columns[3][i - 1], columns[3][i]) <= 0);
+        if(columns[3][i - 1] == columns[3][i])
+            CHECK(order[i - 1] < order[i]);
+    }
+    order = TableRows::SortOrder(columns[3], true, TableRows::KeyText, nullptr);
+    for(size_t i = 1; i < order.size(); i++)
+        CHECK(QString::compare(columns[3][order[i - 1]], columns[3][order[i]]) >= 0);
+
+    // Custom comparators, descending is the reversed ordering and not a negated less
+    order = TableRows::SortOrder(before[2], true, TableRows::KeyCustom, [](const QString & a, const QString & b)
+    {
+        return a.size() < b.size();
+    });
+    for(size_t i = 1; i < order.size(); i++)
+    {
+        CHECK(before[2][order[i - 1]].size() >= before[2][order[i]].size());
+        if(before[2][order[i - 1]].size() == before[2][order[i]].size())
+            CHECK(order[i - 1] < order[i]);
+    }
+
+    TableRows::Columns empty(3);
+    CHECK(TableRows::SortOrder(empty[0], false, TableRows::KeyHex, nullptr).empty());
+    TableRows::Reorder(empty, std::vector<int>());
+    CHECK(empty.size() == 3 && empty[0].empty());
+}
+
+// What SearchListView::findTextInList did for every row
+static bool findTextInRow(const TableRows::Columns & columns, const QString & text, int row, int startCol, bool regex)
+{
+    for(int i = startCol; i < int(columns.size()); i++)
+    {
+        if(regex ? columns[i][row].contains(QRegExp(text)) : columns[i][row].contains(text, Qt::CaseInsensitive))
+            return true;
+    }
+    return false;
+}
+
+static std::vector<int> filterRows(const TableRows::Columns & columns, const QString & text, int startCol, bool regex)
+{
+    std::vector<int> rows;
+    for(int i = 0; i < int(columns[0].size()); i++)
+        if(findTextInRow(columns, text, i, startCol, regex))
+            rows.push_back(i);
+    return rows;
+}
+
+static void testFilter()
+{
+    auto columns = makeTable(3000, 2);
+    CHECK(TableRows::Filter(columns, "CALL", 0, false) == filterRows(columns, "CALL", 0, false));
+    CHECK(TableRows::Filter(columns, "kernel32.1", 2, false) == filterRows(columns, "kernel32.1", 2, false));
+    CHECK(TableRows::Filter(columns, "^(push|call) ", 0, true) == filterRows(columns, "^(push|call) ", 0, true));
+    CHECK(TableRows::Filter(columns, "14000", 1, false) == filterRows(columns, "14000", 1, false));
+    CHECK(!TableRows::Filter(columns, "call", 0, false).empty());
+    CHECK(TableRows::Filter(columns, "call", 4, false).empty());
+    CHECK(TableRows::Filter(columns, "", 0, false).size() == 3000);
+}
+
+static double elapsed(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// What StdTable did before: a list of cells per row, sorted with a comparator that parses the keys every time
+typedef QList<QList<QString>> RowTable;
+
+static void benchmark()
+{
+    const int rowCount = 1000000;
+    auto source = makeTable(rowCount, 3);
+    printf("%d rows, 4 columns\n", rowCount);
+
+    // Fill: setRowCount, then setCellContent for every cell
+    auto start = std::chrono::high_resolution_clock::now();
+    RowTable rows;
+    for(int i = 0; i < rowCount; i++)
+    {
+        rows.append(QList<QString>());
+        for(int j = 0; j < 4; j++)
+            rows.last().append("");
+    }
+    for(int i = 0; i < rowCount; i++)
+        for(int j = 0; j < 4; j++)
+            rows[i].replace(j, source[j][i]);
+    auto rowsFill = elapsed(start);
+    start = std::chrono::high_resolution_clock::now();
+    TableRows::Columns columns(4);
+    for(auto & column : columns)
+        column.resize(rowCount);
+    for(int i = 0; i < rowCount; i++)
+        for(int j = 0; j < 4; j++)
+            columns[j][i] = source[j][i];
+    auto columnsFill = elapsed(start);
+    printf("fill: rows %.0fms, columns %.0fms\n", rowsFill, columnsFill);
+
+    struct SortCase
+    {
+        const char* name;
+        int col;
+        TableRows::KeyType type;
+        bool (*less)(const QString &, const QString &);
+    } cases[] =
+    {
+        { "hex address", 0, TableRows::KeyHex, asHex },
+        { "int size", 1, TableRows::KeyInt, asInt },
+        { "text", 2, TableRows::KeyText, asText },
+    };
+    for(const auto & sortCase : cases)
+    {
+        for(int greater = 0; greater < 2; greater++)
+        {
+            auto copy = rows;
+            auto col = sortCase.col;
+            auto less = sortCase.less;
+            start = std::chrono::high_resolution_clock::now();
+            std::sort(copy.begin(), copy.end(), [col, less, greater](const QList<QString> & a, const QList<QString> & b)
+            {
+                //the old negated less for descending is not a strict weak ordering, swap the arguments instead
+                return greater ? less(b.at(col), a.at(col)) : less(a.at(col), b.at(col));
+            });
+            auto rowsSort = elapsed(start);
+            auto columnsCopy = columns;
+            start = std::chrono::high_resolution_clock::now();
+            TableRows::Reorder(columnsCopy, TableRows::SortOrder(columnsCopy[col], greater != 0, sortCase.type, less));
+            auto columnsSort = elapsed(start);
+            printf("sort %s %s: rows %.0fms, columns %.0fms\n", sortCase.name, greater ? "descending" : "ascending", rowsSort, columnsSort);
+        }
+    }
+
+    struct FilterCase
+    {
+        const char* text;
+        bool regex;
+    } filters[] = { { "kernel32.12", false }, { "CALL", false }, { "^(push|call) ", true } };
+    for(const auto & filter : filters)
+    {
+        start = std::chrono::high_resolution_clock::now();
+        auto before = filterRows(columns, filter.text, 0, filter.regex);
+        auto rowsFilter = elapsed(start);
+        start = std::chrono::high_resolution_clock::now();
+        auto after = TableRows::Filter(columns, filter.text, 0, filter.regex);
+        auto columnsFilter = elapsed(start);
+        CHECK(before == after);
+        printf("filter \"%s\"%s: per row %.0fms, TableRows::Filter %.0fms, %d matches\n",
+               filter.text, filter.regex ? " (regex)" : "", rowsFilter, columnsFilter, int(after.size()));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    testSort();
+    testFilter();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# TableRows unit test, "tablerows_test bench" also fills, sorts and filters a 1M row table
+#
+#-------------------------------------------------
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = tablerows_test
+
+DEFINES += NOMINMAX
+
+INCLUDEPATH += \
+    ../../../ \
+    ../../Src \
+    ../../Src/Utils
+
+SOURCES += \
+    main.cpp \
+    ../../Src/Utils/TableRows.cpp
+
+HEADERS += \
+    ../../Src/Utils/TableRows.h
@@ -0,0 +1,245 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include "XByteArray.h"
+
+static int failures = 0;
+
+#define CHECK(x) \
+    do \
+    { \
+        if(!(x)) \
+        { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #x); \
+            failures++; \
+        } \
+    } while(0)
+
+// The flat QByteArray implementation XByteArray had before the piece table
+class FlatByteArray
+{
+public:
+    QByteArray _data;
+
+    void insert(int i, const QByteArray & ba)
+    {
+        _data.insert(i, ba);
+    }
+
+    void remove(int i, int len)
+    {
+        _data.remove(i, len);
+    }
+
+    void replace(int index, char ch)
+    {
+        _data.data()[index] = ch;
+    }
+
+    void replace(int index, int length, const QByteArray & ba)
+    {
+        int len;
+        if((index + length) > _data.length())
+            len = _data.length() - index;
+        else
+            len = length;
+        _data.replace(index, len, ba.mid(0, len));
+    }
+};
+
+static QByteArray randomBytes(int size)
+{
+    QByteArray bytes(size, Qt::Uninitialized);
+    for(int i = 0; i < size; i++)
+        bytes.data()[i] = char(rand());
+    return bytes;
+}
+
+// Random edits, slices and undo snapshots compared with the flat implementation
+static void testRandom()
+{
+    srand(1234);
+    for(int round = 0; round < 200 && !failures; round++)
+    {
+        XByteArray xba;
+        FlatByteArray flat;
+        QByteArray initial = randomBytes(rand() % 50);
+        xba.setData(initial);
+        flat._data = initial;
+        std::vector<std::pair<XByteArray, QByteArray>> snapshots;
+        for(int step = 0; step < 300 && !failures; step++)
+        {
+            int size = flat._data.size();
+            int index = size ? rand() % (size + 1) : 0;
+            int length = rand() % 10;
+            switch(rand() % 8)
+            {
+            case 0:
+            {
+                char ch = char(rand());
+                xba.insert(index, ch);
+                flat.insert(index, QByteArray(1, ch));
+            }
+            break;
+            case 1:
+            {
+                QByteArray bytes = randomBytes(length);
+                xba.insert(index, bytes);
+                flat.insert(index, bytes);
+            }
+            break;
+            case 2:
+                xba.remove(index, length);
+                flat.remove(index, length);
+                break;
+            case 3:
+                if(index < size)
+                {
+                    char ch = char(rand());
+                    xba.replace(index, ch);
+                    flat.replace(index, ch);
+                }
+                break;
+            case 4:
+            {
+                QByteArray bytes = randomBytes(length);
+                xba.replace(index, bytes);
+                flat.replace(index, bytes.length(), bytes);
+            }
+            break;
+            case 5:
+            {
+                QByteArray bytes = randomBytes(length);
+                int replaced = rand() % 12;
+                xba.replace(index, replaced, bytes);
+                flat.replace(index, replaced, bytes);
+            }
+            break;
+            case 6:
+            {
+                // ArrayCommand keeps slices to undo, they must not change with later edits
+                XByteArray slice = xba.slice(index, length);
+                QByteArray expected = flat._data.mid(index, length);
+                CHECK(slice.data() == expected);
+                snapshots.push_back(std::make_pair(slice, expected));
+                int dest = size ? rand() % (size + 1) : 0;
+                if(rand() % 2)
+                {
+                    xba.replace(dest, slice);
+                    flat.replace(dest, expected.size(), expected);
+                }
+                else
+                {
+                    xba.insert(dest, slice);
+                    flat.insert(dest, expected);
+                }
+            }
+            break;
+            case 7:
+                xba.data(); // flattens, the next edit has to drop the cached copy
+                break;
+            }
+            CHECK(xba.size() == flat._data.size());
+            int pos = rand() % (flat._data.size() + 1);
+            int len = rand() % 20 - 1;
+            CHECK(xba.mid(pos, len) == flat._data.mid(pos, len));
+            if(flat._data.size())
+            {
+                int i = rand() % flat._data.size();
+                CHECK(xba.at(i) == flat._data.at(i));
+            }
+        }
+        CHECK(xba.data() == flat._data);
+        for(size_t i = 0; i < snapshots.size(); i++)
+            CHECK(snapshots[i].first.data() == snapshots[i].second);
+    }
+}
+
+static void testEdges()
+{
+    XByteArray xba;
+    CHECK(xba.size() == 0);
+    CHECK(xba.data().isEmpty());
+    CHECK(xba.mid(0).isEmpty());
+    xba.insert(3, QByteArray(2, 'x')); // pads with spaces like QByteArray
+    CHECK(xba.data() == QByteArray("   xx"));
+    xba.replace(6, 'y'); // grows like QByteArray::operator[]
+    CHECK(xba.size() == 7);
+    CHECK(xba.at(6) == 'y');
+    CHECK(xba.at(5) == 0);
+    xba.replace(5, QByteArray("abc")); // clamped to the end
+    CHECK(xba.size() == 7);
+    CHECK(xba.mid(5) == QByteArray("ab"));
+    xba.remove(1, 100);
+    CHECK(xba.data() == QByteArray(" "));
+    xba.remove(-1, 1);
+    xba.remove(5, 1);
+    CHECK(xba.size() == 1);
+}
+
+template<typename F>
+static double measure(F edit, int count)
+{
+    srand(5678);
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < count; i++)
+        edit();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random 8 and 16 byte edits on a 64 MiB buffer, like a large fill in HexEditDialog
+static void benchmark()
+{
+    const int size = 64 * 1024 * 1024;
+    const int pieceEdits = 100000, flatEdits = 1000;
+    XByteArray xba;
+    xba.setData(QByteArray(size, 'a'));
+    double pieceTime = measure([&]()
+    {
+        int pos = rand() % xba.size();
+        switch(rand() % 3)
+        {
+        case 0:
+            xba.insert(pos, randomBytes(8));
+            break;
+        case 1:
+            xba.remove(pos, 8);
+            break;
+        default:
+            xba.replace(pos, randomBytes(16));
+            break;
+        }
+    }, pieceEdits);
+    FlatByteArray flat;
+    flat._data = QByteArray(size, 'a');
+    double flatTime = measure([&]()
+    {
+        int pos = rand() % flat._data.size();
+        switch(rand() % 3)
+        {
+        case 0:
+            flat.insert(pos, randomBytes(8));
+            break;
+        case 1:
+            flat.remove(pos, 8);
+            break;
+        default:
+            flat.replace(pos, 16, randomBytes(16));
+            break;
+        }
+    }, flatEdits);
+    printf("64 MiB: %.3fms per edit (%d edits), flat QByteArray %.3fms per edit (%d edits)\n", pieceTime / pieceEdits, pieceEdits, flatTime / flatEdits, flatEdits);
+}
+
+int main(int argc, char* argv[])
+{
+    testEdges();
+    testRandom();
+    printf("%d failure(s)\n", failures);
+
+    if(argc > 1 && !strcmp(argv[1], "bench"))
+        benchmark();
+    return failures ? 1 : 0;
+}
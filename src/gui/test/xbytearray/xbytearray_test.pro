@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# XByteArray unit test, "xbytearray_test bench" also runs the 64 MiB edit benchmark
+#
+#-------------------------------------------------
+
+QT = core
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+TARGET = xbytearray_test
+
+INCLUDEPATH += \
+    ../../Src/QHexEdit
+
+SOURCES += \
+    main.cpp \
+    ../../Src/QHexEdit/XByteArray.cpp
+
+HEADERS += \
+    ../../Src/QHexEdit/XByteArray.h
@@ -96,6 +96,7 @@ SOURCES += \
     Src/Gui/BreakpointsView.cpp \
     Src/Utils/Breakpoints.cpp \
     Src/Gui/CPUInfoBox.cpp \
+    Src/Gui/CPUInfoBoxThread.cpp \
     Src/Gui/CPUDump.cpp \
     Src/Gui/ScriptView.cpp \
     Src/Gui/CPUStack.cpp \
@@ -163,6 +164,10 @@ SOURCES += \
     Src/Gui/ColumnReorderDialog.cpp \
     Src/Utils/EncodeMap.cpp \
     Src/Utils/CodeFolding.cpp \
+    Src/Utils/AnnotationCache.cpp \
+    Src/Utils/CFGLayout.cpp \
+    Src/Utils/TableRows.cpp \
+    Src/Utils/SymbolColumns.cpp \
     Src/Gui/WatchView.cpp \
     Src/Gui/FavouriteTools.cpp \
     Src/Gui/BrowseDialog.cpp \
@@ -199,6 +204,7 @@ HEADERS += \
     Src/Gui/BreakpointsView.h \
     Src/Utils/Breakpoints.h \
     Src/Gui/CPUInfoBox.h \
+    Src/Gui/CPUInfoBoxThread.h \
     Src/Gui/CPUDump.h \
     Src/Gui/ScriptView.h \
     Src/Gui/CPUStack.h \
@@ -269,6 +275,13 @@ HEADERS += \
     Src/Gui/ColumnReorderDialog.h \
     Src/Utils/EncodeMap.h \
     Src/Utils/CodeFolding.h \
+    Src/Utils/JumpOffsetTree.h \
+    Src/Utils/MemoryMapMerge.h \
+    Src/Utils/AnnotationCache.h \
+    Src/Utils/CFGLayout.h \
+    Src/Utils/TableRows.h \
+    Src/Utils/SymbolColumns.h \
+    Src/Utils/InstructionTokenCache.h \
     Src/Gui/WatchView.h \
     Src/Gui/FavouriteTools.h \
     Src/Gui/BrowseDialog.h \